@@ -17,6 +17,7 @@
 #include "Ohmbrewer_Thermostat.h"
 #include "Ohmbrewer_RIMS.h"
 #include "Ohmbrewer_Onewire.h"
+#include "Ohmbrewer_Onewire_Bus.h"
 #include "Ohmbrewer_Rhizome.h"
 #include "Ohmbrewer_Runtime_Settings.h"
 //external libraries
@@ -53,7 +54,7 @@ SYSTEM_MODE(SEMI_AUTOMATIC);
  */
 void setup() {
 	//initialize the Dallas Onewire bus pin - Digital 0
-	ow_setPin(D0); //This should later be accomplished by equipment setup OR constructor
+	Ohmbrewer::OnewireBus::getInstance();
 
     if(!Particle.connected()){
         if(EEPROM.read(Ohmbrewer::RuntimeSettings::WIFI_STATUS_ADDR) == Ohmbrewer::RuntimeSettings::EEPROM_WIFI_STATUS_ON){
@@ -72,10 +73,6 @@ void setup() {
  * The bulk of the program. Runs repeatedly until the Rhizome is powered off.
  */
 void loop() {
-    // Call work on all installed equipment in the sprouts list
+    // Run whichever tasks are due: sensors, PID, relays, touch, display and cloud updates
     rhizome.work();
-
-	// Check for button press and refresh the screen
-    rhizome.getScreen()->captureButtonPress();
-    rhizome.getScreen()->refreshDisplay();
 }
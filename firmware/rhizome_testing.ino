@@ -37,8 +37,7 @@ unsigned long lastUpdate = millis();
 
 // EX: Using a Publisher object. Other parts are marked with a (*). You'll probably want to use a different update
 //     rate (more like 30s instead of 10s) below.
-//Ohmbrewer::Publisher::publish_map_t pMap;
-//Ohmbrewer::Publisher* navi = new Ohmbrewer::Publisher(new String("fairies"), &pMap);
+//Ohmbrewer::Publisher* navi = new Ohmbrewer::Publisher("fairies");
 
 // Setting the photon to semi automatic mode, which means it
 // does not connect to WiFi until Particle.connect() is called.
@@ -100,7 +99,7 @@ void setup() {
 
     // Turn on screen
     rhizome.getScreen()->initScreen();
-//    pMap[String("hey")] = String("listen!"); // (*)
+//    navi->add("hey", "listen!"); // (*)
 
     //Turn on for debugging
     Serial.begin(9600);
@@ -133,8 +132,4 @@ void loop() {
 //        lastUpdate = millis();
 //    }
 //    ((Ohmbrewer::RIMS*)rhizome.getSprouts()->front())->getTube()->getSensor()->work(); //Temp patch to make sensor read in Tun temp
-
-    // Check for button press and refresh the screen
-    rhizome.getScreen()->captureButtonPress();
-    rhizome.getScreen()->refreshDisplay();
 }
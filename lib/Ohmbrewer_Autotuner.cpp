@@ -0,0 +1,253 @@
+#include "Ohmbrewer_Autotuner.h"
+#include <math.h>
+
+/**
+ * Constructor. Tuning starts straight away, with the relay high.
+ * @param setpoint The temperature to oscillate around, raw
+ * @param outMax The highest output, e.g. the relay window size. The lowest is 0.
+ */
+Ohmbrewer::Autotuner::Autotuner(int32_t setpoint, int32_t outMax) {
+    _state = RELAY_HIGH;
+    _failure = NONE;
+    _setpoint = setpoint;
+    _outMax = outMax;
+    _bias = outMax / 2;
+    _swing = outMax / 2;
+    _peakHigh = setpoint;
+    _peakLow = setpoint;
+    _startTime = millis();
+    _highTime = _startTime;
+    _lowTime = _startTime;
+    _validTime = _startTime;
+    _cycles = 0;
+    _gainSum = 0;
+    _periodSum = 0;
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::Autotuner::~Autotuner() {
+    // Nothing to do here...
+}
+
+/**
+ * Moves the tuning along. Cheap enough to call every loop. Takes constant time, apart from the
+ * handful of floating point operations at the end of each cycle.
+ * @param input The current raw temperature
+ * @returns The state after the update
+ */
+Ohmbrewer::Autotuner::State Ohmbrewer::Autotuner::update(int32_t input) {
+    unsigned long now = millis();
+
+    if (isFinished()) {
+        return _state;
+    }
+
+    // The sensor may not have been read yet, or may have missed a read - just wait for the next
+    if (input == Temperature::INVALID_RAW) {
+        if (now - _validTime > SENSOR_TIMEOUT) {
+            fail(SENSOR_INVALID);
+        }
+        return _state;
+    }
+    _validTime = now;
+
+    if (input > _setpoint + MAX_OVERSHOOT) {
+        fail(OVERSHOT);
+        return _state;
+    }
+    if (now - _startTime > MAX_DURATION) {
+        fail(TIMED_OUT);
+        return _state;
+    }
+
+    if (input > _peakHigh) {
+        _peakHigh = input;
+    }
+    if (input < _peakLow) {
+        _peakLow = input;
+    }
+
+    if (_state == RELAY_HIGH && input > _setpoint + HYSTERESIS) {
+        _state = RELAY_LOW;
+        _lowTime = now;
+    } else if (_state == RELAY_LOW && input < _setpoint - HYSTERESIS) {
+        endCycle(now);
+        if (_state != DONE) {
+            _state = RELAY_HIGH;
+            _highTime = now;
+            _peakHigh = input;
+            _peakLow = input;
+        }
+    }
+
+    return _state;
+}
+
+/**
+ * @returns Where the tuning is up to
+ */
+Ohmbrewer::Autotuner::State Ohmbrewer::Autotuner::getState() const {
+    return _state;
+}
+
+/**
+ * @returns Whether tuning is over, one way or the other
+ */
+bool Ohmbrewer::Autotuner::isFinished() const {
+    return _state == DONE || _state == FAILED;
+}
+
+/**
+ * @returns Why tuning failed, or NONE if it hasn't
+ */
+Ohmbrewer::Autotuner::Failure Ohmbrewer::Autotuner::getFailure() const {
+    return _failure;
+}
+
+/**
+ * @returns The output to apply: the relay's current level
+ */
+int32_t Ohmbrewer::Autotuner::getOutput() const {
+    switch (_state) {
+        case RELAY_HIGH:
+            return _bias + _swing;
+        case RELAY_LOW:
+            return _bias - _swing;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @returns The setpoint being tuned around, raw
+ */
+int32_t Ohmbrewer::Autotuner::getSetpoint() const {
+    return _setpoint;
+}
+
+/**
+ * @returns The number of relay cycles completed so far
+ */
+int Ohmbrewer::Autotuner::getCycles() const {
+    return _cycles;
+}
+
+/**
+ * @returns The ultimate gain measured, in output units per C. Only meaningful once DONE.
+ */
+double Ohmbrewer::Autotuner::getUltimateGain() const {
+    return _gainSum / MEASURED_CYCLES;
+}
+
+/**
+ * @returns The ultimate period measured, in seconds. Only meaningful once DONE.
+ */
+double Ohmbrewer::Autotuner::getUltimatePeriod() const {
+    return _periodSum / MEASURED_CYCLES;
+}
+
+/**
+ * Works out gains from the measurements. Both are PI: the DS18B20's 1/16 degree steps would make a
+ * D term kick.
+ * @param conservative Set to the Tyreus-Luyben gains - slow, but they barely overshoot
+ * @param aggressive Set to the Ziegler-Nichols gains - quick, for when the temperature is far off
+ * @returns Whether there are gains to give, i.e. whether tuning is DONE
+ */
+bool Ohmbrewer::Autotuner::getProfiles(PIDProfile &conservative, PIDProfile &aggressive) const {
+    if (_state != DONE) {
+        return false;
+    }
+
+    double ku = getUltimateGain();
+    double tu = getUltimatePeriod();
+
+    // Tyreus-Luyben: Kp = Ku / 3.2, Ti = 2.2 Tu
+    double kp = ku / 3.2;
+    conservative = PIDProfile(kp, kp / (2.2 * tu), 0);
+
+    // Ziegler-Nichols PI: Kp = 0.45 Ku, Ti = Tu / 1.2
+    kp = 0.45 * ku;
+    aggressive = PIDProfile(kp, kp / (tu / 1.2), 0);
+
+    return true;
+}
+
+/**
+ * @param state A state
+ * @returns A short description of it, e.g. for the display or a published event
+ */
+const char* Ohmbrewer::Autotuner::stateName(State state) {
+    switch (state) {
+        case RELAY_HIGH:
+            return "heating";
+        case RELAY_LOW:
+            return "cooling";
+        case DONE:
+            return "done";
+        default:
+            return "failed";
+    }
+}
+
+/**
+ * @param failure A failure
+ * @returns A short description of it, e.g. for a published event
+ */
+const char* Ohmbrewer::Autotuner::failureName(Failure failure) {
+    switch (failure) {
+        case TIMED_OUT:
+            return "timed out";
+        case OVERSHOT:
+            return "overshot";
+        case SENSOR_INVALID:
+            return "sensor invalid";
+        default:
+            return "none";
+    }
+}
+
+/**
+ * Ends tuning unsuccessfully
+ * @param failure Why
+ */
+void Ohmbrewer::Autotuner::fail(Failure failure) {
+    _state = FAILED;
+    _failure = failure;
+}
+
+/**
+ * Measures a full cycle and adjusts the bias, as the relay goes high again
+ * @param now millis()
+ */
+void Ohmbrewer::Autotuner::endCycle(unsigned long now) {
+    unsigned long high = _lowTime - _highTime;
+    unsigned long low = now - _lowTime;
+
+    _cycles++;
+
+    // Measure with the swing that drove this cycle, before the bias moves
+    if (_cycles > CYCLES - MEASURED_CYCLES) {
+        // Half the peak to peak swing, in C. The hysteresis keeps it from being 0.
+        double amplitude = (_peakHigh - _peakLow) / (2.0 * Temperature::ONE_DEGREE);
+
+        _gainSum += (4.0 * _swing) / (M_PI * amplitude);
+        _periodSum += (high + low) / 1000.0;
+    }
+
+    // Even out the two halves. The first cycle's high half is the heat up, so it says nothing about the bias.
+    if (_cycles > 1) {
+        _bias += (int32_t)(((int64_t)_swing * ((long)high - (long)low)) / (long)(high + low));
+        if (_bias < _outMax / 16) {
+            _bias = _outMax / 16;
+        } else if (_bias > _outMax - (_outMax / 16)) {
+            _bias = _outMax - (_outMax / 16);
+        }
+        _swing = (_bias > _outMax / 2) ? _outMax - _bias : _bias;
+    }
+
+    if (_cycles == CYCLES) {
+        _state = DONE;
+    }
+}
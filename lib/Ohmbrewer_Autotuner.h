@@ -0,0 +1,234 @@
+/**
+ * This library provides the Autotuner class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_AUTOTUNER_H
+#define OHMBREWER_AUTOTUNER_H
+
+#include "Ohmbrewer_PID_Profile.h"
+#include "Ohmbrewer_Temperature.h"
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * Works out PID gains for a Thermostat by relay feedback (Astrom and Hagglund).
+     *
+     * While tuning, the element is driven like a relay: high until the temperature rises through the setpoint,
+     * then low until it falls back through it, so the temperature settles into a steady oscillation. The size of
+     * that oscillation and its period give the ultimate gain and period of the process, which the usual tuning
+     * rules turn into gains.
+     *
+     * A heating element can only heat, so the relay works around a bias: each cycle, the bias is moved so the
+     * high and low halves take equally long, which keeps the oscillation centred on the setpoint.
+     *
+     * This is just the state machine. It doesn't touch the element itself - whatever owns it calls update() as
+     * often as it likes and applies getOutput(), e.g. as a Thermostat's relay window on-time.
+     */
+    class Autotuner {
+
+        public:
+
+            /**
+             * Where the tuning is up to
+             */
+            enum State {
+                RELAY_HIGH, // Heating toward the top of the oscillation
+                RELAY_LOW,  // Letting the temperature fall to the bottom of it
+                DONE,       // Tuned. The results are ready.
+                FAILED      // Gave up. See getFailure().
+            };
+
+            /**
+             * Why tuning gave up
+             */
+            enum Failure {
+                NONE,
+                TIMED_OUT,      // The oscillation didn't finish in MAX_DURATION
+                OVERSHOT,       // The temperature went MAX_OVERSHOOT past the setpoint
+                SENSOR_INVALID  // The sensor stopped reporting for SENSOR_TIMEOUT
+            };
+
+            /**
+             * How far (raw, 0.25 C) the temperature must pass the setpoint before the relay switches. Keeps the
+             * DS18B20's last bit of noise from switching it, and means every cycle swings at least twice this.
+             */
+            static const int32_t HYSTERESIS = Temperature::ONE_DEGREE / 4;
+
+            /**
+             * How far past the setpoint (raw, 5 C) the temperature may go before tuning gives up
+             */
+            static const int32_t MAX_OVERSHOOT = 5 * Temperature::ONE_DEGREE;
+
+            /**
+             * The cycles run in all. The first ones bring the temperature to the setpoint and settle the bias, so
+             * only the last MEASURED_CYCLES are measured.
+             */
+            static const int CYCLES = 6;
+            static const int MEASURED_CYCLES = 3;
+
+            /**
+             * The longest tuning may take, in milliseconds (2 hours)
+             */
+            static const unsigned long MAX_DURATION = 2UL * 60 * 60 * 1000;
+
+            /**
+             * The longest the sensor may go without a valid reading, in milliseconds. Short, since the relay
+             * may be high in the meantime.
+             */
+            static const unsigned long SENSOR_TIMEOUT = 10000;
+
+            /**
+             * Constructor. Tuning starts straight away, with the relay high.
+             * @param setpoint The temperature to oscillate around, raw
+             * @param outMax The highest output, e.g. the relay window size. The lowest is 0.
+             */
+            Autotuner(int32_t setpoint, int32_t outMax);
+
+            /**
+             * Destructor
+             */
+            virtual ~Autotuner();
+
+            /**
+             * Moves the tuning along. Cheap enough to call every loop. Takes constant time, apart from the
+             * handful of floating point operations at the end of each cycle.
+             * @param input The current raw temperature
+             * @returns The state after the update
+             */
+            State update(int32_t input);
+
+            /**
+             * @returns Where the tuning is up to
+             */
+            State getState() const;
+
+            /**
+             * @returns Whether tuning is over, one way or the other
+             */
+            bool isFinished() const;
+
+            /**
+             * @returns Why tuning failed, or NONE if it hasn't
+             */
+            Failure getFailure() const;
+
+            /**
+             * @returns The output to apply: the relay's current level
+             */
+            int32_t getOutput() const;
+
+            /**
+             * @returns The setpoint being tuned around, raw
+             */
+            int32_t getSetpoint() const;
+
+            /**
+             * @returns The number of relay cycles completed so far
+             */
+            int getCycles() const;
+
+            /**
+             * @returns The ultimate gain measured, in output units per C. Only meaningful once DONE.
+             */
+            double getUltimateGain() const;
+
+            /**
+             * @returns The ultimate period measured, in seconds. Only meaningful once DONE.
+             */
+            double getUltimatePeriod() const;
+
+            /**
+             * Works out gains from the measurements. Both are PI: the DS18B20's 1/16 degree steps would make a
+             * D term kick.
+             * @param conservative Set to the Tyreus-Luyben gains - slow, but they barely overshoot
+             * @param aggressive Set to the Ziegler-Nichols gains - quick, for when the temperature is far off
+             * @returns Whether there are gains to give, i.e. whether tuning is DONE
+             */
+            bool getProfiles(PIDProfile &conservative, PIDProfile &aggressive) const;
+
+            /**
+             * @param state A state
+             * @returns A short description of it, e.g. for the display or a published event
+             */
+            static const char* stateName(State state);
+
+            /**
+             * @param failure A failure
+             * @returns A short description of it, e.g. for a published event
+             */
+            static const char* failureName(Failure failure);
+
+        protected:
+
+            /**
+             * Where the tuning is up to
+             */
+            State _state;
+
+            /**
+             * Why tuning gave up
+             */
+            Failure _failure;
+
+            /**
+             * The temperature to oscillate around, raw
+             */
+            int32_t _setpoint;
+
+            /**
+             * The highest output
+             */
+            int32_t _outMax;
+
+            /**
+             * The relay's midpoint. The output is _bias + _swing while high and _bias - _swing while low.
+             */
+            int32_t _bias;
+
+            /**
+             * Half the relay's span
+             */
+            int32_t _swing;
+
+            /**
+             * The highest and lowest temperatures of the current cycle, raw
+             */
+            int32_t _peakHigh;
+            int32_t _peakLow;
+
+            /**
+             * millis() when tuning started, when the relay last went high and low, and at the last valid reading
+             */
+            unsigned long _startTime;
+            unsigned long _highTime;
+            unsigned long _lowTime;
+            unsigned long _validTime;
+
+            /**
+             * The number of relay cycles completed
+             */
+            int _cycles;
+
+            /**
+             * The sums of the measured cycles' ultimate gains and periods
+             */
+            double _gainSum;
+            double _periodSum;
+
+            /**
+             * Ends tuning unsuccessfully
+             * @param failure Why
+             */
+            void fail(Failure failure);
+
+            /**
+             * Measures a full cycle and adjusts the bias, as the relay goes high again
+             * @param now millis()
+             */
+            void endCycle(unsigned long now);
+    };
+};
+
+#endif
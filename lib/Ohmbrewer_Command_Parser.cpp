@@ -0,0 +1,207 @@
+#include "Ohmbrewer_Command_Parser.h"
+#include <limits.h>
+
+/**
+ * @param text Some null terminated text
+ * @returns Whether the field matches the text, ignoring case
+ */
+bool Ohmbrewer::CommandParser::Token::equalsIgnoreCase(const char* text) const {
+    return strncasecmp(start, text, length) == 0 && text[length] == '\0';
+}
+
+/**
+ * Copies the field, null terminated
+ * @param buffer Where to copy it
+ * @param size The size of the buffer
+ * @returns Whether the field fit
+ */
+bool Ohmbrewer::CommandParser::Token::copyTo(char* buffer, int size) const {
+    if (length >= size) {
+        return false;
+    }
+
+    memcpy(buffer, start, length);
+    buffer[length] = '\0';
+    return true;
+}
+
+/**
+ * Converts the field to an integer. Only an optional sign and digits are allowed.
+ * @param value Set to the integer, if the field is one
+ * @returns Whether the field is an integer that fits in a long
+ */
+bool Ohmbrewer::CommandParser::Token::toInt(long &value) const {
+    int i = 0;
+    bool negative = false;
+
+    if (length > 0 && (start[0] == '-' || start[0] == '+')) {
+        negative = (start[0] == '-');
+        i++;
+    }
+    if (i == length) {
+        return false;
+    }
+
+    long result = 0;
+    for (; i < length; i++) {
+        if (start[i] < '0' || start[i] > '9') {
+            return false;
+        }
+
+        // Too big to hold, rather than quietly wrapping around to some other number
+        int digit = start[i] - '0';
+        if (result > (LONG_MAX - digit) / 10) {
+            return false;
+        }
+        result = result * 10 + digit;
+    }
+
+    value = negative ? -result : result;
+    return true;
+}
+
+/**
+ * Constructor
+ * @param text The argument string. Must outlive the parser.
+ */
+Ohmbrewer::CommandParser::CommandParser(const char* text) {
+    // An empty string has no fields at all, rather than one empty one
+    _cursor = (text == NULL || text[0] == '\0') ? NULL : text;
+}
+
+/**
+ * @returns Whether every field has been read
+ */
+bool Ohmbrewer::CommandParser::atEnd() const {
+    return _cursor == NULL;
+}
+
+/**
+ * @returns The unread part of the argument string
+ */
+const char* Ohmbrewer::CommandParser::remaining() const {
+    return _cursor == NULL ? "" : _cursor;
+}
+
+/**
+ * Checks that every field has been read, for commands that take no more
+ * @returns ParseError::NONE, or TOO_MANY_FIELDS if any are left
+ */
+int Ohmbrewer::CommandParser::checkEnd() const {
+    return _cursor == NULL ? ParseError::NONE : ParseError::TOO_MANY_FIELDS;
+}
+
+/**
+ * Reads the next field as is
+ * @param token Set to the field
+ * @returns Whether there was a field to read
+ */
+bool Ohmbrewer::CommandParser::next(Token &token) {
+    if (_cursor == NULL) {
+        token.start = "";
+        token.length = 0;
+        return false;
+    }
+
+    const char* end = _cursor;
+    while (*end != DELIMITER && *end != '\0') {
+        end++;
+    }
+
+    token.start = _cursor;
+    token.length = end - _cursor;
+    _cursor = (*end == DELIMITER) ? end + 1 : NULL;
+    return true;
+}
+
+/**
+ * Reads the next field as an integer
+ * @param value Set to the integer, if there is one
+ * @returns ParseError::NONE, MISSING_FIELD if there's no field or it's empty, or INVALID_INTEGER
+ *          (which includes integers too big for a long)
+ */
+int Ohmbrewer::CommandParser::nextInt(long &value) {
+    Token token;
+
+    if (!next(token) || token.isEmpty()) {
+        return ParseError::MISSING_FIELD;
+    }
+
+    return token.toInt(value) ? ParseError::NONE : ParseError::INVALID_INTEGER;
+}
+
+/**
+ * Reads the next field as an integer, if there's anything there
+ * @param value Set to the integer, if there is one. Left alone otherwise.
+ * @param given Set to whether the field was given - false if there's no field, or it's empty or "--"
+ * @returns ParseError::NONE or INVALID_INTEGER
+ */
+int Ohmbrewer::CommandParser::nextOptionalInt(long &value, bool &given) {
+    Token token;
+
+    given = next(token) && !isSkipped(token);
+    if (!given) {
+        return ParseError::NONE;
+    }
+
+    return token.toInt(value) ? ParseError::NONE : ParseError::INVALID_INTEGER;
+}
+
+/**
+ * Reads the next field as a decimal number, if there's anything there
+ * @param value Set to the number, if there is one. Left alone otherwise.
+ * @param given Set to whether the field was given - false if there's no field, or it's empty or "--"
+ * @returns ParseError::NONE or INVALID_NUMBER
+ */
+int Ohmbrewer::CommandParser::nextOptionalNumber(double &value, bool &given) {
+    Token token;
+    char number[24];
+    char* end;
+
+    given = next(token) && !isSkipped(token);
+    if (!given) {
+        return ParseError::NONE;
+    }
+
+    // strtod() needs the number null terminated, so it gets a copy on the stack
+    if (!token.copyTo(number, sizeof(number))) {
+        return ParseError::INVALID_NUMBER;
+    }
+
+    double result = strtod(number, &end);
+    if (end == number || *end != '\0') {
+        return ParseError::INVALID_NUMBER;
+    }
+
+    value = result;
+    return ParseError::NONE;
+}
+
+/**
+ * Reads the next field as ON, OFF or -- (no change). A missing or empty field means no change too.
+ * @param value Set to the setting
+ * @returns ParseError::NONE or INVALID_SWITCH
+ */
+int Ohmbrewer::CommandParser::nextSwitch(Switch &value) {
+    Token token;
+
+    if (!next(token) || isSkipped(token)) {
+        value = SWITCH_UNCHANGED;
+    } else if (token.equalsIgnoreCase("ON")) {
+        value = SWITCH_ON;
+    } else if (token.equalsIgnoreCase("OFF")) {
+        value = SWITCH_OFF;
+    } else {
+        return ParseError::INVALID_SWITCH;
+    }
+
+    return ParseError::NONE;
+}
+
+/**
+ * @param token A field
+ * @returns Whether the field is absent - empty, or "--"
+ */
+bool Ohmbrewer::CommandParser::isSkipped(const Token &token) {
+    return token.isEmpty() || token.equalsIgnoreCase("--");
+}
@@ -0,0 +1,166 @@
+/**
+ * This library provides the CommandParser class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_COMMAND_PARSER_H
+#define OHMBREWER_COMMAND_PARSER_H
+
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * Splits the comma delimited argument strings our Particle functions receive into fields, in place.
+     *
+     * The parser only ever points into the string it was given - nothing is copied or allocated, and unlike
+     * strtok() it keeps no global state, so any number of parsers can be in use at once. Fields are read in
+     * order, either as raw Tokens or converted to the type that's expected, with a ParseError code when the
+     * field isn't what it should be.
+     *
+     * Empty fields are kept, not skipped: "1,,ON" is three fields, the second of them empty.
+     */
+    class CommandParser {
+
+        public:
+
+            /**
+             * Provides error codes that may occur while reading a field.
+             */
+            class ParseError {
+                public:
+
+                static const int NONE = 0;
+                static const int MISSING_FIELD = -1;
+                static const int INVALID_INTEGER = -2;
+                static const int INVALID_NUMBER = -3;
+                static const int INVALID_SWITCH = -4;
+                static const int FIELD_TOO_LONG = -5;
+                static const int INVALID_NAME = -6;
+                static const int TOO_MANY_FIELDS = -7;
+            };
+
+            /**
+             * The settings for an on/off field
+             */
+            enum Switch {
+                SWITCH_UNCHANGED, // "--", or left empty
+                SWITCH_ON,        // "ON"
+                SWITCH_OFF        // "OFF"
+            };
+
+            /**
+             * A field, as a view into the parser's string. Not null terminated!
+             */
+            struct Token {
+                const char* start;
+                int length;
+
+                /**
+                 * @returns Whether the field is empty
+                 */
+                bool isEmpty() const { return length == 0; }
+
+                /**
+                 * @param text Some null terminated text
+                 * @returns Whether the field matches the text, ignoring case
+                 */
+                bool equalsIgnoreCase(const char* text) const;
+
+                /**
+                 * Copies the field, null terminated
+                 * @param buffer Where to copy it
+                 * @param size The size of the buffer
+                 * @returns Whether the field fit
+                 */
+                bool copyTo(char* buffer, int size) const;
+
+                /**
+                 * Converts the field to an integer. Only an optional sign and digits are allowed.
+                 * @param value Set to the integer, if the field is one
+                 * @returns Whether the field is an integer that fits in a long
+                 */
+                bool toInt(long &value) const;
+            };
+
+            /**
+             * The delimiter between fields
+             */
+            static const char DELIMITER = ',';
+
+            /**
+             * Constructor
+             * @param text The argument string. Must outlive the parser.
+             */
+            CommandParser(const char* text);
+
+            /**
+             * @returns Whether every field has been read
+             */
+            bool atEnd() const;
+
+            /**
+             * @returns The unread part of the argument string
+             */
+            const char* remaining() const;
+
+            /**
+             * Checks that every field has been read, for commands that take no more
+             * @returns ParseError::NONE, or TOO_MANY_FIELDS if any are left
+             */
+            int checkEnd() const;
+
+            /**
+             * Reads the next field as is
+             * @param token Set to the field
+             * @returns Whether there was a field to read
+             */
+            bool next(Token &token);
+
+            /**
+             * Reads the next field as an integer
+             * @param value Set to the integer, if there is one
+             * @returns ParseError::NONE, MISSING_FIELD if there's no field or it's empty, or INVALID_INTEGER
+             *          (which includes integers too big for a long)
+             */
+            int nextInt(long &value);
+
+            /**
+             * Reads the next field as an integer, if there's anything there
+             * @param value Set to the integer, if there is one. Left alone otherwise.
+             * @param given Set to whether the field was given - false if there's no field, or it's empty or "--"
+             * @returns ParseError::NONE or INVALID_INTEGER
+             */
+            int nextOptionalInt(long &value, bool &given);
+
+            /**
+             * Reads the next field as a decimal number, if there's anything there
+             * @param value Set to the number, if there is one. Left alone otherwise.
+             * @param given Set to whether the field was given - false if there's no field, or it's empty or "--"
+             * @returns ParseError::NONE or INVALID_NUMBER
+             */
+            int nextOptionalNumber(double &value, bool &given);
+
+            /**
+             * Reads the next field as ON, OFF or -- (no change). A missing or empty field means no change too.
+             * @param value Set to the setting
+             * @returns ParseError::NONE or INVALID_SWITCH
+             */
+            int nextSwitch(Switch &value);
+
+        protected:
+
+            /**
+             * The start of the next field, or NULL once every field has been read
+             */
+            const char* _cursor;
+
+            /**
+             * @param token A field
+             * @returns Whether the field is absent - empty, or "--"
+             */
+            static bool isSkipped(const Token &token);
+    };
+};
+
+#endif
@@ -1,13 +1,16 @@
 #include "Ohmbrewer_Equipment.h"
 #include "Ohmbrewer_Screen.h"
+#include "Ohmbrewer_Loop_Stats.h"
+#include "Ohmbrewer_Publisher.h"
 
 /**
  * Constructor
  */
-Ohmbrewer::Equipment::Equipment() {
+Ohmbrewer::Equipment::Equipment() : _stopTimer([this]() { stopTimeReached(); }) {
     _stopTime = 0;
     _state = false;
-
+    _indexStale = true;
+    _indexedState = false;
 }
 
 /**
@@ -16,19 +19,24 @@ Ohmbrewer::Equipment::Equipment() {
  * @param state Whether the Equipment is ON (or OFF). True => ON, False => OFF
  * @param currentTask The unique identifier of the task that the Equipment believes it should be processing
  */
-Ohmbrewer::Equipment::Equipment(int stopTime, bool state, String currentTask) {
+Ohmbrewer::Equipment::Equipment(int stopTime, bool state, String currentTask)
+        : _stopTimer([this]() { stopTimeReached(); }) {
     _stopTime = stopTime;
     _state = state;
+    _indexStale = true;
+    _indexedState = false;
 }
 
 /**
  * Copy Constructor
  * @param clonee The Equipment object to copy
  */
-Ohmbrewer::Equipment::Equipment(const Equipment& clonee) {
+Ohmbrewer::Equipment::Equipment(const Equipment& clonee) : _stopTimer([this]() { stopTimeReached(); }) {
     _stopTime = clonee.getStopTime();
     _state = clonee.getState();
     _currentTask = clonee.getCurrentTask();
+    _indexStale = true;
+    _indexedState = false;
 }
 
 /**
@@ -48,16 +56,49 @@ int Ohmbrewer::Equipment::getStopTime() const {
 }
 
 /**
- * Sets the time at which the Equipment will stop operating.
- * @param stopTime The time at which the Equipment should shut off, assuming it isn't otherwise interrupted
+ * Sets the time at which the Equipment will stop operating, and schedules it to be turned off then.
+ * @param stopTime The time at which the Equipment should shut off, assuming it isn't otherwise interrupted,
+ *                 in Unix time. 0 means it shouldn't.
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::Equipment::setStopTime(const int stopTime) {
-    unsigned long start = millis();
+    unsigned long start = micros();
     
     _stopTime = stopTime;
+
+    if(_stopTime > 0) {
+        long remaining = _stopTime - (long)Time.now();
+        TimerWheel::getInstance()->schedule(&_stopTimer, remaining > 0 ? remaining * 1000UL : 0);
+    } else {
+        TimerWheel::getInstance()->cancel(&_stopTimer);
+    }
     
-    return start - millis();
+    return micros() - start;
+}
+
+/**
+ * Turns the Equipment off once its stop time has come, and tells Ohmbrewer it did, with the stop time.
+ * Called by the stop timer, which only gets as close as the wheel's range allows for stop times far off.
+ */
+void Ohmbrewer::Equipment::stopTimeReached() {
+    // Not there yet - the stop time was beyond the wheel's range, or the clock's been corrected since
+    if(_stopTime > (long)Time.now()) {
+        setStopTime(_stopTime);
+        return;
+    }
+
+    setState(false);
+
+    // Say which stop time it was before forgetting it, so Ohmbrewer can tell this from being turned off
+    char stream[Publisher::MAX_STREAM_LENGTH + 1];
+    getStream(stream, sizeof(stream));
+    Publisher pub = Publisher(stream, "msg", "Stop time reached.");
+    pub.add("id", (long)getID());
+    pub.add("state", "OFF");
+    pub.add("stopTime", (long)_stopTime);
+    pub.publish();
+
+    _stopTime = 0;
 }
 
 /**
@@ -74,11 +115,34 @@ String Ohmbrewer::Equipment::getCurrentTask() const {
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::Equipment::setCurrentTask(String currentTask) {
-    unsigned long start = millis();
+    unsigned long start = micros();
     
     _currentTask = currentTask;
+    _indexStale = true;
     
-    return start - millis();
+    return micros() - start;
+}
+
+/**
+ * This Equipment's entry in the Rhizome's "index" Particle variable. It's cached, and only rebuilt when
+ * the current task or state has changed since it was last asked for.
+ * @returns The entry, as a JSON object
+ */
+const String& Ohmbrewer::Equipment::getIndexEntry() {
+    // Subclasses set their state directly, so compare it rather than relying on being told
+    bool state = getState();
+
+    if(_indexStale || state != _indexedState) {
+        char entry[MAX_INDEX_ENTRY_LENGTH + 1];
+        snprintf(entry, sizeof(entry),
+                 "{  \"id\": \"%d\", \"type\": \"%s\", \"state\": \"%d\", \"current task\": \"%s\" }",
+                 getID(), getType(), state ? 1 : 0, _currentTask.c_str());
+        _indexEntry = entry;
+        _indexStale = false;
+        _indexedState = state;
+    }
+
+    return _indexEntry;
 }
 
 /**
@@ -92,6 +156,15 @@ String Ohmbrewer::Equipment::getStream() const {
     return stream;
 }
 
+/**
+ * The Particle event stream to publish Equipment status updates to, without allocating.
+ * @param buffer Filled with the stream name. Always null terminated.
+ * @param size The size of the buffer
+ */
+void Ohmbrewer::Equipment::getStream(char* buffer, int size) const {
+    snprintf(buffer, size, "%s/%d", this->getType(), this->getID());
+}
+
 /**
  * The name of the Spark.function for updating this Sprout.
  * Currently, looks like "type_#" where # is the Sprout's ID number.
@@ -118,85 +191,120 @@ int Ohmbrewer::Equipment::registerUpdateFunction() {
 
 /**
  * Performs the Equipment's current task. Expect to use this during loop().
- * @returns The time taken to run the method
+ * The time taken is also recorded in the Rhizome's LoopStats, unless the Equipment is part of another
+ * (e.g. a RIMS's tube), whose own time already includes it.
+ * @returns The time taken to run the method, in microseconds
  */
 const int Ohmbrewer::Equipment::work() {
-    return doWork();
+    // How many work()s deep we are - a Thermostat or RIMS works its parts from inside its own doWork()
+    static int depth = 0;
+
+    depth++;
+    int elapsed = doWork();
+    depth--;
+
+    if (depth == 0) {
+        LoopStats::getInstance()->record(getType(), getID(), LoopStats::PHASE_WORK, elapsed);
+    }
+    return elapsed;
 }
 
 /**
  * Draws information to the Rhizome's display.
  * @param screen The Rhizome's touchscreen
- * @returns The time taken to run the method
+ * @returns The time taken to run the method, in microseconds
  */
 const int Ohmbrewer::Equipment::display(Ohmbrewer::Screen *screen) {
-    return doDisplay(screen);
+    int elapsed = doDisplay(screen);
+    LoopStats::getInstance()->record(getType(), getID(), LoopStats::PHASE_DISPLAY, elapsed);
+    return elapsed;
 }
 
 /**
  * Publishes updates to Ohmbrewer, etc.
  * @param args The argument string passed into the Particle Cloud
- * @returns The time taken to run the method
+ * @returns The time taken to run the method, in microseconds
  */
 const int Ohmbrewer::Equipment::update(const String &args) {
-    unsigned long start = millis();
-    unsigned long duration;
-    args_map_t argsMap;
-
-    // Serial.println(args);
-
-    // Parse the supplied arguments into a map to figure out where to put them.
-    parseArgs(args, argsMap);
-
-    // Trim the argument string for further processing.
-    String remainingArgs = cleanArgsString(args, argsMap);
+    int errorCode;
+    return update(args.c_str(), errorCode);
+}
 
-    // Now assign the appropriate variables.
-    assignArgs(argsMap);
+/**
+ * Publishes updates to Ohmbrewer, etc.
+ * The whole update is checked first, as by checkUpdate(), so a bad argument anywhere leaves the
+ * Equipment as it was.
+ * @param args The argument string passed into the Particle Cloud
+ * @param errorCode Set to CommandParser::ParseError::NONE, or the (negative) error in the arguments
+ * @returns The time taken to run the method, in microseconds
+ */
+const int Ohmbrewer::Equipment::update(const char* args, int &errorCode) {
+    unsigned long start = micros();
+    CommandParser parser = CommandParser(args);
+    UpdateArgs updateArgs;
+
+    // Read everything before changing anything
+    errorCode = checkUpdate(args);
+
+    // Then apply the common arguments off the front, and leave whatever's left to the particular type of Equipment
+    if(errorCode == CommandParser::ParseError::NONE) {
+        parseArgs(parser, updateArgs);
+        errorCode = assignArgs(updateArgs);
+    }
+    if(errorCode == CommandParser::ParseError::NONE) {
+        errorCode = doUpdate(parser);
+    }
 
-    // Serial.print("Still have this in the args buffer:");
-    // Serial.println(remainingArgs);
-    duration = millis() - start;
-    return doUpdate(remainingArgs, argsMap) + duration;
+    unsigned long duration = micros() - start;
+    LoopStats::getInstance()->record(getType(), getID(), LoopStats::PHASE_UPDATE, duration);
+    return duration;
 }
 
 /**
- * Publishes updates to Ohmbrewer, etc.
+ * Checks an update without applying any of it, so that it can be applied later knowing that it will succeed.
+ * Both the common arguments and those particular to the type of Equipment are read, and there mustn't
+ * be any arguments left over.
  * @param args The argument string passed into the Particle Cloud
- * @param argsMap A map representing the key/value pairs for the update
- * @returns The time taken to run the method
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
  */
-String Ohmbrewer::Equipment::cleanArgsString(const String &args, args_map_t &argsMap) {
-    unsigned int firstArgsLen = argsMap[String("id")].length() + argsMap[String("current_task")].length() +
-                                argsMap[String("state")].length() + argsMap[String("stop_time")].length() + 4;
+int Ohmbrewer::Equipment::checkUpdate(const char* args) {
+    CommandParser parser = CommandParser(args);
+    UpdateArgs updateArgs;
+    int errorCode = parseArgs(parser, updateArgs);
 
-    firstArgsLen = (args.length() <= firstArgsLen ? args.length() : firstArgsLen); // If there's only 4 args, we've miscounted the commas.
+    if(errorCode == CommandParser::ParseError::NONE) {
+        errorCode = doCheckUpdate(parser);
+    }
+    if(errorCode == CommandParser::ParseError::NONE) {
+        errorCode = parser.checkEnd();
+    }
 
-    return args.substring(firstArgsLen);
+    return errorCode;
 }
 
 /**
  * Publishes updates to Ohmbrewer, etc.
- * @param argsMap A map representing the key/value pairs for the update
+ * @param args The common arguments for the update
  * @returns Any error codes raised during assignment
  */
-int Ohmbrewer::Equipment::assignArgs(args_map_t &argsMap) {
+int Ohmbrewer::Equipment::assignArgs(const UpdateArgs &args) {
+    char currentTask[MAX_TASK_LENGTH + 1];
 
-    setCurrentTask(argsMap[String("current_task")]);
+    // parseArgs() has already made sure it fits
+    args.currentTask.copyTo(currentTask, sizeof(currentTask));
+    setCurrentTask(currentTask);
 
-    if(argsMap[String("state")].equalsIgnoreCase("ON")) {
+    if(args.state == CommandParser::SWITCH_ON) {
         setState(true);
-    } else if(argsMap[String("state")].equalsIgnoreCase("OFF")) {
+    } else if(args.state == CommandParser::SWITCH_OFF) {
         setState(false);
-    } else if(argsMap[String("state")].equalsIgnoreCase("--")) {
-        // Do nothing. Intentional.
     } else {
-        // Do nothing. TODO: Should probably raise an error code...
+        // Do nothing. Intentional.
     }
 
-    setStopTime(argsMap[String("stop_time")].toInt());
+    setStopTime(args.stopTime);
 
-    return 0;
+    return CommandParser::ParseError::NONE;
 }
 
 /**
@@ -208,34 +316,33 @@ Ohmbrewer::Equipment::~Equipment() {
 
 /**
  * Specifies the interface for arguments sent to this Equipment's associated function.
- * Parses the supplied string into an array of strings for setting the Equipment's values.
+ * Reads the arguments common to all Equipment from the front of the update.
  * Most likely will be called during update().
- * @param argsStr The arguments supplied as an update to the Rhizome.
- * @param result A map representing the key/value pairs for the update
- */
-void Ohmbrewer::Equipment::parseArgs(const String &argsStr, Ohmbrewer::Equipment::args_map_t &result) {
-    char* params = new char[argsStr.length() + 1];
-    strcpy(params, argsStr.c_str());
-
-    // Parse the parameters
-    String id          = String(strtok(params, ","));
-    String currentTask = String(strtok(NULL, ","));
-    String state       = String(strtok(NULL, ","));
-    String stopTime    = String(strtok(NULL, ","));
-
-    // Save them to the map
-    result[String("id")] = id;
-    result[String("current_task")] = currentTask;
-    result[String("state")] = state;
-    result[String("stop_time")] = stopTime;
-
-    // Serial.println("Got these results: ");
-    // Serial.println(id);
-    // Serial.println(currentTask);
-    // Serial.println(state);
-    // Serial.println(stopTime);
-
-    // Clear out that dynamically allocated buffer
-    delete params;
+ * @param args The arguments supplied as an update to the Rhizome.
+ * @param result The arguments, parsed
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+ */
+int Ohmbrewer::Equipment::parseArgs(CommandParser &args, UpdateArgs &result) {
+    bool given;
+    int errorCode = args.nextInt(result.id);
+
+    if(errorCode == CommandParser::ParseError::NONE) {
+        args.next(result.currentTask);
+        if(result.currentTask.length > MAX_TASK_LENGTH) {
+            errorCode = CommandParser::ParseError::FIELD_TOO_LONG;
+        }
+    }
+
+    if(errorCode == CommandParser::ParseError::NONE) {
+        errorCode = args.nextSwitch(result.state);
+    }
+
+    if(errorCode == CommandParser::ParseError::NONE) {
+        // No stop time means none at all, as it always has
+        result.stopTime = 0;
+        errorCode = args.nextOptionalInt(result.stopTime, given);
+    }
+
+    return errorCode;
 }
 
@@ -6,13 +6,14 @@
 #ifndef OHMBREWER_RHIZOME_EQUIPMENT_H
 #define OHMBREWER_RHIZOME_EQUIPMENT_H
 
-// Kludge to allow us to use std::map and std::list - for now we have to undefine these macros.
+// Kludge to allow us to use std::list - for now we have to undefine these macros.
 #undef min
 #undef max
 #undef swap
-#include <map>
 #include <list>
 #include "application.h"
+#include "Ohmbrewer_Command_Parser.h"
+#include "Ohmbrewer_Timer_Wheel.h"
 
 
 namespace Ohmbrewer {
@@ -29,10 +30,40 @@ namespace Ohmbrewer {
             const static constexpr char* TYPE_NAME = "equipment";
 
             /**
-             * A map of arguments provided via a Particle cloud function call,
-             * mapped to the appropriate Equipment members.
+             * Compact codes for each type of Equipment, so Sprouts can be indexed and told apart
+             * without comparing type names.
+             */
+            enum TypeCode {
+                TYPE_UNKNOWN = 0,
+                TYPE_TEMPERATURE_SENSOR,
+                TYPE_RELAY,
+                TYPE_PUMP,
+                TYPE_HEATING_ELEMENT,
+                TYPE_THERMOSTAT,
+                TYPE_RIMS,
+                NUM_TYPE_CODES
+            };
+
+            /**
+             * The longest Task ID an update may carry
+             */
+            static const int MAX_TASK_LENGTH = 63;
+
+            /**
+             * The most characters getIndexEntry() will produce: room for the longest ID, type name and Task ID
+             */
+            static const int MAX_INDEX_ENTRY_LENGTH = 160;
+
+            /**
+             * The arguments every Equipment's update starts with, in order:
+             * ID,CURRENT_TASK,STATE,STOP_TIME
              */
-            typedef std::map <String, String> args_map_t;
+            struct UpdateArgs {
+                long id;
+                CommandParser::Token currentTask;
+                CommandParser::Switch state;
+                long stopTime; // 0 if not given
+            };
 
 
             /**
@@ -47,6 +78,12 @@ namespace Ohmbrewer {
              */
             virtual const char* getType() const { return Equipment::TYPE_NAME; };
 
+            /**
+             * The Equipment Type
+             * @returns The Equipment type code
+             */
+            virtual TypeCode getTypeCode() const { return TYPE_UNKNOWN; };
+
             /**
              * The time at which the Equipment will stop operating.
              * @returns The time at which the Equipment should shut off, assuming it isn't otherwise interrupted
@@ -54,8 +91,9 @@ namespace Ohmbrewer {
             int getStopTime() const;
 
             /**
-             * Sets the time at which the Equipment will stop operating.
-             * @param stopTime The time at which the Equipment should shut off, assuming it isn't otherwise interrupted
+             * Sets the time at which the Equipment will stop operating, and schedules it to be turned off then.
+             * @param stopTime The time at which the Equipment should shut off, assuming it isn't otherwise interrupted,
+             *                 in Unix time. 0 means it shouldn't.
              * @returns The time taken to run the method
              */
             const int setStopTime(const int stopTime);
@@ -73,12 +111,26 @@ namespace Ohmbrewer {
              */
             const int setCurrentTask(String currentTask);
 
+            /**
+             * This Equipment's entry in the Rhizome's "index" Particle variable. It's cached, and only rebuilt when
+             * the current task or state has changed since it was last asked for.
+             * @returns The entry, as a JSON object
+             */
+            const String& getIndexEntry();
+
             /**
              * The Particle event stream to publish Equipment status updates to.
              * @returns The Particle event stream the Equipment expects to publish to.
              */
             String getStream() const;
 
+            /**
+             * The Particle event stream to publish Equipment status updates to, without allocating.
+             * @param buffer Filled with the stream name. Always null terminated.
+             * @param size The size of the buffer
+             */
+            void getStream(char* buffer, int size) const;
+
             /**
              * The name of the Spark.function for updating this Sprout.
              * Currently, looks like "type_#" where # is the Sprout's ID number.
@@ -95,23 +147,44 @@ namespace Ohmbrewer {
 
             /**
              * Performs the Equipment's current task. Expect to use this during loop().
-             * @returns The time taken to run the method
+             * The time taken is also recorded in the Rhizome's LoopStats, unless the Equipment is part of another
+             * (e.g. a RIMS's tube), whose own time already includes it.
+             * @returns The time taken to run the method, in microseconds
              */
             const int work();
 
             /**
              * Draws information to the Rhizome's display.
              * @param screen The Rhizome's touchscreen
-             * @returns The time taken to run the method
+             * @returns The time taken to run the method, in microseconds
              */
             const int display(Screen *screen);
 
             /**
              * Publishes updates to Ohmbrewer, etc.
              * @param args The argument string passed into the Particle Cloud
-             * @returns The time taken to run the method
+             * @returns The time taken to run the method, in microseconds
              */
             const int update(const String &args);
+
+            /**
+             * Publishes updates to Ohmbrewer, etc.
+             * The whole update is checked first, as by checkUpdate(), so a bad argument anywhere leaves the
+             * Equipment as it was.
+             * @param args The argument string passed into the Particle Cloud
+             * @param errorCode Set to CommandParser::ParseError::NONE, or the (negative) error in the arguments
+             * @returns The time taken to run the method, in microseconds
+             */
+            const int update(const char* args, int &errorCode);
+
+            /**
+             * Checks an update without applying any of it, so that it can be applied later knowing that it will succeed.
+             * Both the common arguments and those particular to the type of Equipment are read, and there mustn't
+             * be any arguments left over.
+             * @param args The argument string passed into the Particle Cloud
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+             */
+            int checkUpdate(const char* args);
             
             /**
              * Constructors
@@ -139,12 +212,13 @@ namespace Ohmbrewer {
 
             /**
              * Specifies the interface for arguments sent to this Equipment's associated function.
-             * Parses the supplied string into an array of strings for setting the Equipment's values.
+             * Reads the arguments common to all Equipment from the front of the update.
              * Most likely will be called during update().
-             * @param argsStr The arguments supplied as an update to the Rhizome.
-             * @param result A map representing the key/value pairs for the update
+             * @param args The arguments supplied as an update to the Rhizome.
+             * @param result The arguments, parsed
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
              */
-            static void parseArgs(const String &argsStr, args_map_t &result);
+            static int parseArgs(CommandParser &args, UpdateArgs &result);
 
             /*
              * Virtual Functions! All of these need to be defined in child classes! 
@@ -192,12 +266,22 @@ namespace Ohmbrewer {
 
             /**
              * Publishes updates to Ohmbrewer, etc.
-             * This function is called by update().
-             * @param args The argument string passed into the Particle Cloud
-             * @param argsMap A map representing the key/value pairs for the update
-             * @returns The time taken to run the method
+             * This function is called by update(), once the whole update has been checked and the common
+             * arguments applied.
+             * @param args The rest of the arguments passed into the Particle Cloud
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+             */
+            virtual int doUpdate(CommandParser &args) = 0;
+
+            /**
+             * Checks the arguments particular to the type of Equipment, without applying them.
+             * This function is called by checkUpdate(), once the common arguments have been checked. It must read
+             * every argument the Equipment takes, so that any left over can be rejected. Equipment that takes no
+             * arguments of its own has nothing to check.
+             * @param args The rest of the arguments passed into the Particle Cloud
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
              */
-            virtual int doUpdate(String &args, args_map_t &argsMap) = 0;
+            virtual int doCheckUpdate(CommandParser &args) { return CommandParser::ParseError::NONE; };
 
             /**
              * Reports which of the Rhizome's pins are occupied by the
@@ -221,9 +305,27 @@ namespace Ohmbrewer {
              */
             String          _currentTask;
 
+            /**
+             * The cached index entry (see getIndexEntry()), whether the current task has changed since it was
+             * built, and the state it was built with
+             */
+            String          _indexEntry;
+            bool            _indexStale;
+            bool            _indexedState;
+
+            /**
+             * Fires at the Designated Stop Time
+             */
+            TimerWheel::Timer _stopTimer;
+
+            /**
+             * Turns the Equipment off once its stop time has come, and tells Ohmbrewer it did, with the stop time.
+             * Called by the stop timer, which only gets as close as the wheel's range allows for stop times far off.
+             */
+            void stopTimeReached();
+
         private:
-            String cleanArgsString(const String &args, args_map_t &argsMap);
-            int assignArgs(args_map_t &argsMap);
+            int assignArgs(const UpdateArgs &args);
     };
 };
 
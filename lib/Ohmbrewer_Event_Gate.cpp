@@ -0,0 +1,185 @@
+#include "Ohmbrewer_Event_Gate.h"
+#include "Ohmbrewer_Equipment.h"
+#include "Ohmbrewer_Sprout_Registry.h"
+
+Ohmbrewer::EventGate* Ohmbrewer::EventGate::_first = NULL;
+
+/**
+ * Constructor
+ * @param owner The Equipment whose stream the gate's events are published to
+ * @param name Short name for the event, for reporting. Must outlive the gate, so pass a string constant.
+ * @param edges Which changes of level to report
+ * @param minInterval The least time between reports, in milliseconds
+ */
+Ohmbrewer::EventGate::EventGate(const Equipment* owner, const char* name, Edges edges, unsigned long minInterval) {
+    _owner = owner;
+    _name = name;
+    _edges = edges;
+    _minInterval = minInterval;
+    _level = false;
+    _reported = false;
+    _hasReported = false;
+    _lastReport = 0;
+    _emitted = 0;
+    _suppressed = 0;
+
+    _next = _first;
+    _first = this;
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::EventGate::~EventGate() {
+    for (EventGate** link = &_first; *link != NULL; link = &(*link)->_next) {
+        if (*link == this) {
+            *link = _next;
+            break;
+        }
+    }
+}
+
+/**
+ * Allocates from the pool of Event Gates rather than the heap (see getPool())
+ * @param size The size of the object
+ * @returns The memory for it
+ */
+void* Ohmbrewer::EventGate::operator new(size_t size) {
+    return getPool()->allocate(size);
+}
+
+/**
+ * Gives the memory back to the pool of Event Gates
+ * @param ptr The memory
+ */
+void Ohmbrewer::EventGate::operator delete(void* ptr) {
+    getPool()->release(ptr);
+}
+
+/**
+ * @returns The pool Event Gates are allocated from, sized for the most the Rhizome may have
+ *          (see SproutRegistry)
+ */
+Ohmbrewer::ObjectPool* Ohmbrewer::EventGate::getPool() {
+    // One for each Thermostat (a RIMS has one too) and one for each RIMS
+    const int size = SproutRegistry::MAX_THERMOSTATS + (2 * SproutRegistry::MAX_RIMS);
+    static uint64_t storage[ObjectPool::words(sizeof(EventGate), size)];
+    static ObjectPool pool = ObjectPool(storage, sizeof(EventGate), size);
+    return &pool;
+}
+
+/**
+ * Feeds the gate the current level.
+ * @param level The level
+ * @returns Whether to publish the change now
+ */
+bool Ohmbrewer::EventGate::update(bool level) {
+    bool changed = (level != _level);
+    _level = level;
+
+    if (level == _reported) {
+        // Nothing new. For a RISING gate, staying high is what used to get published over and over.
+        if (_edges == RISING && level) {
+            _suppressed++;
+        }
+        return false;
+    }
+
+    if (_edges == RISING && !level) {
+        // Falling edges just re-arm a RISING gate
+        _reported = false;
+        return false;
+    }
+
+    if (!ready()) {
+        if (changed || _edges == RISING) {
+            _suppressed++;
+        }
+        return false;
+    }
+
+    _reported = level;
+    _hasReported = true;
+    _lastReport = millis();
+    _emitted++;
+    return true;
+}
+
+/**
+ * Feeds the gate a value to compare against a threshold. The level goes true once the value reaches
+ * the threshold, and only goes false again once it's fallen below threshold - band.
+ * @param value The value, e.g. the latest raw temperature reading
+ * @param threshold The value at which the level goes true
+ * @param band How far below the threshold the value has to fall before the level goes false
+ * @returns Whether to publish the change now
+ */
+bool Ohmbrewer::EventGate::update(int32_t value, int32_t threshold, int32_t band) {
+    bool level = _level;
+
+    if (value >= threshold) {
+        level = true;
+    } else if (value < threshold - band) {
+        level = false;
+    }
+
+    return update(level);
+}
+
+/**
+ * @returns The level the gate last saw
+ */
+bool Ohmbrewer::EventGate::getLevel() const {
+    return _level;
+}
+
+/**
+ * @returns The number of changes the gate has said to publish
+ */
+unsigned long Ohmbrewer::EventGate::getEmitted() const {
+    return _emitted;
+}
+
+/**
+ * @returns The number of times the gate saw something reportable - a change of level, or a true level
+ *          for a RISING gate - without saying to publish it
+ */
+unsigned long Ohmbrewer::EventGate::getSuppressed() const {
+    return _suppressed;
+}
+
+/**
+ * Zeroes the counters of every live gate
+ */
+void Ohmbrewer::EventGate::resetCounters() {
+    for (EventGate* gate = _first; gate != NULL; gate = gate->_next) {
+        gate->_emitted = 0;
+        gate->_suppressed = 0;
+    }
+}
+
+/**
+ * Writes every live gate's counters as TYPE.ID.NAME=EMITTED,SUPPRESSED; stopping short of
+ * MAX_STRING_LENGTH characters.
+ * @param result The String to write to. Its previous contents are replaced.
+ */
+void Ohmbrewer::EventGate::toString(String &result) {
+    char line[64];
+
+    result = "";
+    for (EventGate* gate = _first; gate != NULL; gate = gate->_next) {
+        int len = snprintf(line, sizeof(line), "%s.%d.%s=%lu,%lu;", gate->_owner->getType(), gate->_owner->getID(),
+                           gate->_name, gate->_emitted, gate->_suppressed);
+
+        if (len < 0 || result.length() + len > MAX_STRING_LENGTH) {
+            break;
+        }
+        result.concat(line);
+    }
+}
+
+/**
+ * @returns Whether enough time has passed since the last report to make another
+ */
+bool Ohmbrewer::EventGate::ready() const {
+    return !_hasReported || millis() - _lastReport >= _minInterval;
+}
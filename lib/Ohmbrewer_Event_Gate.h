@@ -0,0 +1,178 @@
+/**
+ * This library provides the EventGate class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_EVENT_GATE_H
+#define OHMBREWER_EVENT_GATE_H
+
+#include "application.h"
+#include "Ohmbrewer_Object_Pool.h"
+
+namespace Ohmbrewer {
+
+    class Equipment;
+
+    /**
+     * Sits between a piece of Equipment and its Publisher, turning a level the Equipment checks every pass
+     * (a flag, or a temperature against a threshold) into the transitions worth telling Ohmbrewer about.
+     *
+     * Each gate watches one kind of event on one Equipment's stream:
+     *   - Edge detection: update() only says to publish when the level changes. RISING gates only report
+     *     changes to true; a change back to false quietly re-arms them.
+     *   - Hysteresis: update(value, threshold, band) only drops the level once the value falls below
+     *     threshold - band, so a reading hovering at the threshold doesn't chatter.
+     *   - Rate limiting: a change within the gate's minimum interval of the last one it reported is held,
+     *     and reported once the interval has passed if the level still differs from what was last reported.
+     *
+     * Every gate counts what it reported and what it held back, and all live gates can be listed with
+     * toString().
+     */
+    class EventGate {
+
+        public:
+
+            /**
+             * Which changes of level a gate reports
+             */
+            enum Edges {
+                RISING, // Only changes to true
+                BOTH    // Changes either way
+            };
+
+            /**
+             * The default minimum interval between reports, in milliseconds
+             */
+            static const unsigned long DEFAULT_MIN_INTERVAL = 5000;
+
+            /**
+             * The most characters toString() will produce - the limit on a Particle.variable String
+             */
+            static const unsigned int MAX_STRING_LENGTH = 622;
+
+            /**
+             * Constructor
+             * @param owner The Equipment whose stream the gate's events are published to
+             * @param name Short name for the event, for reporting. Must outlive the gate, so pass a string constant.
+             * @param edges Which changes of level to report
+             * @param minInterval The least time between reports, in milliseconds
+             */
+            EventGate(const Equipment* owner, const char* name, Edges edges = BOTH,
+                      unsigned long minInterval = DEFAULT_MIN_INTERVAL);
+
+            /**
+             * Destructor
+             */
+            virtual ~EventGate();
+
+            /**
+             * Allocates from the pool of Event Gates rather than the heap (see getPool())
+             * @param size The size of the object
+             * @returns The memory for it
+             */
+            static void* operator new(size_t size);
+
+            /**
+             * Gives the memory back to the pool of Event Gates
+             * @param ptr The memory
+             */
+            static void operator delete(void* ptr);
+
+            /**
+             * @returns The pool Event Gates are allocated from, sized for the most the Rhizome may have
+             *          (see SproutRegistry)
+             */
+            static ObjectPool* getPool();
+
+            /**
+             * Feeds the gate the current level.
+             * @param level The level
+             * @returns Whether to publish the change now
+             */
+            bool update(bool level);
+
+            /**
+             * Feeds the gate a value to compare against a threshold. The level goes true once the value reaches
+             * the threshold, and only goes false again once it's fallen below threshold - band.
+             * @param value The value, e.g. the latest raw temperature reading
+             * @param threshold The value at which the level goes true
+             * @param band How far below the threshold the value has to fall before the level goes false
+             * @returns Whether to publish the change now
+             */
+            bool update(int32_t value, int32_t threshold, int32_t band);
+
+            /**
+             * @returns The level the gate last saw
+             */
+            bool getLevel() const;
+
+            /**
+             * @returns The number of changes the gate has said to publish
+             */
+            unsigned long getEmitted() const;
+
+            /**
+             * @returns The number of times the gate saw something reportable - a change of level, or a true level
+             *          for a RISING gate - without saying to publish it
+             */
+            unsigned long getSuppressed() const;
+
+            /**
+             * Zeroes the counters of every live gate
+             */
+            static void resetCounters();
+
+            /**
+             * Writes every live gate's counters as TYPE.ID.NAME=EMITTED,SUPPRESSED; stopping short of
+             * MAX_STRING_LENGTH characters.
+             * @param result The String to write to. Its previous contents are replaced.
+             */
+            static void toString(String &result);
+
+        protected:
+            const Equipment* _owner;
+            const char* _name;
+            Edges _edges;
+            unsigned long _minInterval;
+
+            /**
+             * The level last seen
+             */
+            bool _level;
+
+            /**
+             * The level last reported
+             */
+            bool _reported;
+
+            /**
+             * Whether the gate has ever reported
+             */
+            bool _hasReported;
+
+            /**
+             * When the last report was made, in milliseconds
+             */
+            unsigned long _lastReport;
+
+            unsigned long _emitted;
+            unsigned long _suppressed;
+
+            /**
+             * The next live gate. Gates link themselves in on construction and out on destruction.
+             */
+            EventGate* _next;
+
+            /**
+             * The first live gate
+             */
+            static EventGate* _first;
+
+            /**
+             * @returns Whether enough time has passed since the last report to make another
+             */
+            bool ready() const;
+    };
+};
+
+#endif
@@ -0,0 +1,350 @@
+#include "Ohmbrewer_Gain_Schedule.h"
+#include "Ohmbrewer_Runtime_Settings.h"
+#include "crc8.h"
+
+namespace {
+
+    /**
+     * The bytes a point takes in EEPROM: phase, error (int16), then KP, KI and KD as floats
+     */
+    const int STORED_POINT_SIZE = 1 + 2 + (3 * 4);
+
+    /**
+     * The bytes the whole table takes in EEPROM: the point count, the points, then a CRC of the lot
+     */
+    const int STORED_TABLE_SIZE = 1 + (Ohmbrewer::GainSchedule::MAX_POINTS * STORED_POINT_SIZE) + 1;
+
+    /**
+     * Interpolates between two gains
+     */
+    int32_t lerp(int32_t from, int32_t to, int32_t into, int32_t span) {
+        return (int32_t)(from + ((((int64_t)to - from) * into) / span));
+    }
+}
+
+/**
+ * The table all of the Rhizome's Thermostats use. Loaded from EEPROM the first time it's asked for.
+ * @returns The shared table
+ */
+Ohmbrewer::GainSchedule* Ohmbrewer::GainSchedule::getInstance() {
+    static GainSchedule schedule;
+    return &schedule;
+}
+
+/**
+ * Reads a point of the table: PHASE,ERROR,KP,KI,KD. PHASE is any, ramp, hold or cool; ERROR is in Celsius.
+ * @param args The arguments supplied to the Rhizome, positioned at the point
+ * @param result The point, parsed and scaled
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+ */
+int Ohmbrewer::GainSchedule::parsePoint(CommandParser &args, Point &result) {
+    CommandParser::Token name;
+    double values[4];
+    bool given;
+
+    if (!args.next(name) || name.isEmpty()) {
+        return CommandParser::ParseError::MISSING_FIELD;
+    }
+
+    int phase = ANY;
+    while (phase < NUM_PHASES && !name.equalsIgnoreCase(phaseName((Phase)phase))) {
+        phase++;
+    }
+    if (phase == NUM_PHASES) {
+        return CommandParser::ParseError::INVALID_NAME;
+    }
+    result.phase = (Phase)phase;
+
+    // ERROR, KP, KI, KD - all required
+    for (int i = 0; i < 4; i++) {
+        int errorCode = args.nextOptionalNumber(values[i], given);
+        if (errorCode != CommandParser::ParseError::NONE) {
+            return errorCode;
+        } else if (!given) {
+            return CommandParser::ParseError::MISSING_FIELD;
+        }
+    }
+
+    // The error has to fit the int16 it's saved as
+    if (values[0] < 0 || values[0] >= 2048) {
+        return CommandParser::ParseError::INVALID_NUMBER;
+    }
+    result.error = Temperature::toRaw(values[0]);
+    result.profile = PIDProfile(values[1], values[2], values[3]);
+
+    if (!PIDController::makeGains(result.profile, Temperature::ONE_DEGREE, PIDController::DEFAULT_SAMPLE_TIME,
+                                  result.gains)) {
+        return CommandParser::ParseError::INVALID_NUMBER;
+    }
+
+    return CommandParser::ParseError::NONE;
+}
+
+/**
+ * Constructor. Loads the table from EEPROM, or starts with the default points if there isn't one.
+ */
+Ohmbrewer::GainSchedule::GainSchedule() {
+    reset();
+    load();
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::GainSchedule::~GainSchedule() {
+    // Nothing to do here...
+}
+
+/**
+ * Replaces the table. The points don't need to be in order.
+ * @param points The points. They're copied.
+ * @param numPoints The number of points, at most MAX_POINTS
+ * @returns Whether the points were taken. There must be at least one for ANY.
+ */
+bool Ohmbrewer::GainSchedule::setPoints(const Point* points, int numPoints) {
+    bool hasAny = false;
+
+    if (numPoints < 1 || numPoints > MAX_POINTS) {
+        return false;
+    }
+    for (int i = 0; i < numPoints; i++) {
+        hasAny = hasAny || points[i].phase == ANY;
+    }
+    if (!hasAny) {
+        return false;
+    }
+
+    for (int i = 0; i < numPoints; i++) {
+        _points[i] = points[i];
+    }
+    _numPoints = numPoints;
+    index();
+    return true;
+}
+
+/**
+ * Goes back to the default points
+ */
+void Ohmbrewer::GainSchedule::reset() {
+    _numPoints = 0;
+
+    // The gains the Rhizome has always used, in ms of element on-time per C (and per second).
+    // Built here rather than as globals, since the Rhizome itself is a global and gets here first.
+    // No D term: the DS18B20's 1/16 degree steps would make it kick.
+    setDefaultGains(PIDProfile(600, 10, 0), PIDProfile(1000, 20, 0));
+}
+
+/**
+ * Replaces the points for ANY with a conservative point at the target and an aggressive one
+ * AGGRESSIVE_ERROR away, as in the default table. The other phases' points are kept.
+ * @param conservative The gains for close to the target
+ * @param aggressive The gains for far from it
+ * @returns Whether the points were taken. The gains must scale, and the points must fit.
+ */
+bool Ohmbrewer::GainSchedule::setDefaultGains(const PIDProfile &conservative, const PIDProfile &aggressive) {
+    Point points[MAX_POINTS];
+    int numPoints = 2;
+
+    points[0].phase = ANY;
+    points[0].error = 0;
+    points[0].profile = conservative;
+    points[1].phase = ANY;
+    points[1].error = AGGRESSIVE_ERROR;
+    points[1].profile = aggressive;
+
+    for (int i = 0; i < 2; i++) {
+        if (!PIDController::makeGains(points[i].profile, Temperature::ONE_DEGREE, PIDController::DEFAULT_SAMPLE_TIME,
+                                      points[i].gains)) {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < _numPoints; i++) {
+        if (_points[i].phase != ANY) {
+            if (numPoints == MAX_POINTS) {
+                return false;
+            }
+            points[numPoints++] = _points[i];
+        }
+    }
+
+    return setPoints(points, numPoints);
+}
+
+/**
+ * @returns The number of points in the table
+ */
+int Ohmbrewer::GainSchedule::getNumPoints() const {
+    return _numPoints;
+}
+
+/**
+ * Works out the gains for a Thermostat. Takes at most MAX_POINTS steps.
+ * @param phase What the Thermostat is doing
+ * @param error How far the temperature is from the target, raw. Only the size of it matters.
+ * @param gains Set to the gains
+ */
+void Ohmbrewer::GainSchedule::lookup(Phase phase, int32_t error, PIDController::Gains &gains) const {
+    int first = _phaseStart[phase];
+    int count = _phaseCount[phase];
+
+    if (count == 0) {
+        first = _phaseStart[ANY];
+        count = _phaseCount[ANY];
+    }
+
+    const Point* points = &_points[first];
+    if (error < 0) {
+        error = -error;
+    }
+
+    if (error <= points[0].error) {
+        gains = points[0].gains;
+        return;
+    }
+
+    for (int i = 1; i < count; i++) {
+        if (error < points[i].error) {
+            // Points are in order and error is at or past the one before, so the span can't be 0
+            int32_t span = points[i].error - points[i - 1].error;
+            int32_t into = error - points[i - 1].error;
+
+            gains.kp = lerp(points[i - 1].gains.kp, points[i].gains.kp, into, span);
+            gains.ki = lerp(points[i - 1].gains.ki, points[i].gains.ki, into, span);
+            gains.kd = lerp(points[i - 1].gains.kd, points[i].gains.kd, into, span);
+            return;
+        }
+    }
+
+    gains = points[count - 1].gains;
+}
+
+/**
+ * Reads the table from EEPROM. An empty or damaged table leaves the points as they are.
+ * @returns Whether a table was read
+ */
+bool Ohmbrewer::GainSchedule::load() {
+    uint8_t stored[STORED_TABLE_SIZE];
+    Point points[MAX_POINTS];
+
+    for (int i = 0; i < STORED_TABLE_SIZE; i++) {
+        stored[i] = EEPROM.read(RuntimeSettings::GAIN_SCHEDULE_ADDR + i);
+    }
+
+    // Erased EEPROM is all 0xFF, which is too many points
+    int numPoints = stored[0];
+    if (numPoints < 1 || numPoints > MAX_POINTS || crc8(stored, STORED_TABLE_SIZE) != 0) {
+        return false;
+    }
+
+    for (int i = 0; i < numPoints; i++) {
+        const uint8_t* record = &stored[1 + (i * STORED_POINT_SIZE)];
+        int16_t error;
+        float terms[3];
+
+        memcpy(&error, &record[1], sizeof(error));
+        memcpy(terms, &record[3], sizeof(terms));
+
+        points[i].phase = (Phase)record[0];
+        points[i].error = error;
+        points[i].profile = PIDProfile(terms[0], terms[1], terms[2]);
+        if (points[i].phase >= NUM_PHASES ||
+            !PIDController::makeGains(points[i].profile, Temperature::ONE_DEGREE, PIDController::DEFAULT_SAMPLE_TIME,
+                                      points[i].gains)) {
+            return false;
+        }
+    }
+
+    return setPoints(points, numPoints);
+}
+
+/**
+ * Writes the table to EEPROM
+ */
+void Ohmbrewer::GainSchedule::save() const {
+    uint8_t stored[STORED_TABLE_SIZE];
+
+    memset(stored, 0, sizeof(stored));
+    stored[0] = (uint8_t)_numPoints;
+
+    for (int i = 0; i < _numPoints; i++) {
+        uint8_t* record = &stored[1 + (i * STORED_POINT_SIZE)];
+        int16_t error = (int16_t)_points[i].error;
+        float terms[3] = { (float)_points[i].profile.kP(), (float)_points[i].profile.kI(),
+                           (float)_points[i].profile.kD() };
+
+        record[0] = (uint8_t)_points[i].phase;
+        memcpy(&record[1], &error, sizeof(error));
+        memcpy(&record[3], terms, sizeof(terms));
+    }
+
+    // With its own CRC on the end, the whole table CRCs to 0
+    stored[STORED_TABLE_SIZE - 1] = crc8(stored, STORED_TABLE_SIZE - 1);
+
+    for (int i = 0; i < STORED_TABLE_SIZE; i++) {
+        // Only write when actually necessary
+        if (EEPROM.read(RuntimeSettings::GAIN_SCHEDULE_ADDR + i) != stored[i]) {
+            EEPROM.write(RuntimeSettings::GAIN_SCHEDULE_ADDR + i, stored[i]);
+        }
+    }
+}
+
+/**
+ * Writes the table as PHASE,ERROR,KP,KI,KD{,PHASE,ERROR,KP,KI,KD...}, in the form parsePoint() reads
+ * @param result The String to write to. Its previous contents are replaced.
+ */
+void Ohmbrewer::GainSchedule::toString(String &result) const {
+    char line[80];
+
+    result = "";
+    for (int i = 0; i < _numPoints; i++) {
+        snprintf(line, sizeof(line), "%s%s,%.2f,%g,%g,%g", (i > 0) ? "," : "", phaseName(_points[i].phase),
+                 _points[i].error / (double)Temperature::ONE_DEGREE, _points[i].profile.kP(),
+                 _points[i].profile.kI(), _points[i].profile.kD());
+        result.concat(line);
+    }
+}
+
+/**
+ * Sorts the points and works out where each phase's are
+ */
+void Ohmbrewer::GainSchedule::index() {
+    // Insertion sort - there are only ever a handful
+    for (int i = 1; i < _numPoints; i++) {
+        Point point = _points[i];
+        int j = i - 1;
+
+        while (j >= 0 && (_points[j].phase > point.phase ||
+                          (_points[j].phase == point.phase && _points[j].error > point.error))) {
+            _points[j + 1] = _points[j];
+            j--;
+        }
+        _points[j + 1] = point;
+    }
+
+    for (int phase = 0; phase < NUM_PHASES; phase++) {
+        _phaseStart[phase] = 0;
+        _phaseCount[phase] = 0;
+    }
+    for (int i = _numPoints - 1; i >= 0; i--) {
+        _phaseStart[_points[i].phase] = i;
+        _phaseCount[_points[i].phase]++;
+    }
+}
+
+/**
+ * @param phase A phase
+ * @returns The name parsePoint() knows it by
+ */
+const char* Ohmbrewer::GainSchedule::phaseName(Phase phase) {
+    switch (phase) {
+        case RAMP:
+            return "ramp";
+        case HOLD:
+            return "hold";
+        case COOL:
+            return "cool";
+        default:
+            return "any";
+    }
+}
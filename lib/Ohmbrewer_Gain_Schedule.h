@@ -0,0 +1,175 @@
+/**
+ * This library provides the GainSchedule class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_GAIN_SCHEDULE_H
+#define OHMBREWER_GAIN_SCHEDULE_H
+
+#include "Ohmbrewer_PID_Profile.h"
+#include "Ohmbrewer_PID_Controller.h"
+#include "Ohmbrewer_Command_Parser.h"
+#include "Ohmbrewer_Temperature.h"
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * The Thermostats' PID gains, as a table of PIDProfiles indexed by how far the temperature is from its target,
+     * and optionally by what the Thermostat is doing (ramping, holding or cooling).
+     *
+     * Each point of the table gives the gains to use at a particular error. Between two points the gains are
+     * interpolated, so they change smoothly as the temperature closes in rather than jumping at a threshold.
+     * Beyond the first or last point, that point's gains are used. A phase with no points of its own uses the
+     * points given for ANY.
+     *
+     * The table can be replaced through the cloud, and is saved to EEPROM so it survives a reboot. Out of the box
+     * it holds the gains the Rhizome has always used: conservative at the target, aggressive 10 C away.
+     */
+    class GainSchedule {
+
+        public:
+
+            /**
+             * The most points the table can hold
+             */
+            static const int MAX_POINTS = 8;
+
+            /**
+             * How far from the target (raw, 10 C) the default table's aggressive gains apply in full
+             */
+            static const int32_t AGGRESSIVE_ERROR = 10 * Temperature::ONE_DEGREE;
+
+            /**
+             * What a Thermostat is doing, as far as picking gains goes
+             */
+            enum Phase {
+                ANY,  // Points for any phase without points of its own
+                RAMP, // A step program is moving the target
+                HOLD, // Holding a target
+                COOL, // Above the target, waiting for the temperature to come down
+                NUM_PHASES
+            };
+
+            /**
+             * A point of the table
+             */
+            struct Point {
+                Phase phase;
+                int32_t error;             // Raw, the distance from the target at which these gains apply in full
+                PIDProfile profile;        // As given
+                PIDController::Gains gains; // Scaled for the Thermostats' PID loops
+            };
+
+            /**
+             * The table all of the Rhizome's Thermostats use. Loaded from EEPROM the first time it's asked for.
+             * @returns The shared table
+             */
+            static GainSchedule* getInstance();
+
+            /**
+             * Reads a point of the table: PHASE,ERROR,KP,KI,KD. PHASE is any, ramp, hold or cool; ERROR is in Celsius.
+             * @param args The arguments supplied to the Rhizome, positioned at the point
+             * @param result The point, parsed and scaled
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+             */
+            static int parsePoint(CommandParser &args, Point &result);
+
+            /**
+             * Constructor. Loads the table from EEPROM, or starts with the default points if there isn't one.
+             */
+            GainSchedule();
+
+            /**
+             * Destructor
+             */
+            virtual ~GainSchedule();
+
+            /**
+             * Replaces the table. The points don't need to be in order.
+             * @param points The points. They're copied.
+             * @param numPoints The number of points, at most MAX_POINTS
+             * @returns Whether the points were taken. There must be at least one for ANY.
+             */
+            bool setPoints(const Point* points, int numPoints);
+
+            /**
+             * Goes back to the default points
+             */
+            void reset();
+
+            /**
+             * Replaces the points for ANY with a conservative point at the target and an aggressive one
+             * AGGRESSIVE_ERROR away, as in the default table. The other phases' points are kept.
+             * @param conservative The gains for close to the target
+             * @param aggressive The gains for far from it
+             * @returns Whether the points were taken. The gains must scale, and the points must fit.
+             */
+            bool setDefaultGains(const PIDProfile &conservative, const PIDProfile &aggressive);
+
+            /**
+             * @returns The number of points in the table
+             */
+            int getNumPoints() const;
+
+            /**
+             * Works out the gains for a Thermostat. Takes at most MAX_POINTS steps.
+             * @param phase What the Thermostat is doing
+             * @param error How far the temperature is from the target, raw. Only the size of it matters.
+             * @param gains Set to the gains
+             */
+            void lookup(Phase phase, int32_t error, PIDController::Gains &gains) const;
+
+            /**
+             * Reads the table from EEPROM. An empty or damaged table leaves the points as they are.
+             * @returns Whether a table was read
+             */
+            bool load();
+
+            /**
+             * Writes the table to EEPROM
+             */
+            void save() const;
+
+            /**
+             * Writes the table as PHASE,ERROR,KP,KI,KD{,PHASE,ERROR,KP,KI,KD...}, in the form parsePoint() reads
+             * @param result The String to write to. Its previous contents are replaced.
+             */
+            void toString(String &result) const;
+
+        protected:
+
+            /**
+             * The points, in order of phase and then error
+             */
+            Point _points[MAX_POINTS];
+
+            /**
+             * The number of points in _points
+             */
+            int _numPoints;
+
+            /**
+             * The index of each phase's first point
+             */
+            int _phaseStart[NUM_PHASES];
+
+            /**
+             * The number of points each phase has
+             */
+            int _phaseCount[NUM_PHASES];
+
+            /**
+             * Sorts the points and works out where each phase's are
+             */
+            void index();
+
+            /**
+             * @param phase A phase
+             * @returns The name parsePoint() knows it by
+             */
+            static const char* phaseName(Phase phase);
+    };
+};
+
+#endif
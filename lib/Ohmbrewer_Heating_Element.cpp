@@ -1,4 +1,5 @@
 #include "Ohmbrewer_Heating_Element.h"
+#include "Ohmbrewer_Sprout_Registry.h"
 
 /**
  * Constructor
@@ -42,6 +43,35 @@ Ohmbrewer::HeatingElement::HeatingElement(const HeatingElement& clonee) : Ohmbre
 Ohmbrewer::HeatingElement::~HeatingElement() {
 }
 
+/**
+ * Allocates from the pool of Heating Elements rather than the heap (see getPool())
+ * @param size The size of the object
+ * @returns The memory for it
+ */
+void* Ohmbrewer::HeatingElement::operator new(size_t size) {
+    return getPool()->allocate(size);
+}
+
+/**
+ * Gives the memory back to the pool of Heating Elements
+ * @param ptr The memory
+ */
+void Ohmbrewer::HeatingElement::operator delete(void* ptr) {
+    getPool()->release(ptr);
+}
+
+/**
+ * @returns The pool Heating Elements are allocated from, sized for the most the Rhizome may have
+ *          (see SproutRegistry)
+ */
+Ohmbrewer::ObjectPool* Ohmbrewer::HeatingElement::getPool() {
+    // Every Heating Element Sprout, plus the one in each Thermostat (a RIMS has one too)
+    const int size = SproutRegistry::MAX_HEATING_ELEMENTS + SproutRegistry::MAX_THERMOSTATS + SproutRegistry::MAX_RIMS;
+    static uint64_t storage[ObjectPool::words(sizeof(HeatingElement), size)];
+    static ObjectPool pool = ObjectPool(storage, sizeof(HeatingElement), size);
+    return &pool;
+}
+
 /**
  * Draws information to the Rhizome's display.
  * This function is called by display().
@@ -54,22 +84,9 @@ int Ohmbrewer::HeatingElement::doDisplay(Ohmbrewer::Screen *screen) {
 /**
  * Publishes updates to Ohmbrewer, etc.
  * This function is called by update().
- * @param args The argument string passed into the Particle Cloud
- * @param argsMap A map representing the key/value pairs for the update
- * @returns The time taken to run the method
+ * @param args The rest of the arguments passed into the Particle Cloud
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
  */
-int Ohmbrewer::HeatingElement::doUpdate(String &args, Ohmbrewer::Equipment::args_map_t &argsMap) {
-    return Relay::doUpdate(args, argsMap);
+int Ohmbrewer::HeatingElement::doUpdate(CommandParser &args) {
+    return Relay::doUpdate(args);
 }
-
-/**
- * Specifies the interface for arguments sent to this Equipment's associated function.
- * Parses the supplied string into an array of strings for setting the Equipment's values.
- * Most likely will be called during update().
- * @param argsStr The arguments supplied as an update to the Rhizome.
- * @param result A map representing the key/value pairs for the update
- */
-void Ohmbrewer::HeatingElement::parseArgs(const String &argsStr, Ohmbrewer::Equipment::args_map_t &result) {
-    // Nothing special to parse out for this class.
-}
-
@@ -0,0 +1,304 @@
+#include "Ohmbrewer_Loop_Stats.h"
+#include <limits.h>
+
+/**
+ * The Rhizome's stats.
+ * @returns The shared stats
+ */
+Ohmbrewer::LoopStats* Ohmbrewer::LoopStats::getInstance() {
+    static LoopStats stats = LoopStats();
+    return &stats;
+}
+
+/**
+ * @param phase A phase
+ * @returns The phase's short name, as used in toString()
+ */
+const char* Ohmbrewer::LoopStats::phaseName(Phase phase) {
+    switch (phase) {
+        case PHASE_WORK:     return "work";
+        case PHASE_DISPLAY:  return "display";
+        case PHASE_UPDATE:   return "update";
+        case PHASE_RUN:      return "run";
+        case PHASE_LATENESS: return "late";
+    }
+    return "?";
+}
+
+/**
+ * Constructor
+ */
+Ohmbrewer::LoopStats::LoopStats() {
+    _numReserved = 0;
+    reset();
+}
+
+/**
+ * Sets aside an entry that's always tracked, ahead of any that aren't, and isn't forgotten by reset().
+ * Should the table already be full, the newest unreserved entry is given up to make room.
+ * @param name What will be timed - a task name. Must outlive the stats, so pass a string constant.
+ * @param id The Equipment ID, or -1 if there isn't one
+ * @param phase What will be done
+ * @returns Whether there was room for it
+ */
+bool Ohmbrewer::LoopStats::reserve(const char* name, int id, Phase phase) {
+    int index = find(name, id, phase);
+
+    if (index == -1) {
+        if (_numEntries >= MAX_ENTRIES) {
+            if (_numReserved >= MAX_ENTRIES) {
+                return false;
+            }
+            _numEntries--;
+            _dropped += _entries[_numEntries].count;
+        }
+        index = _numEntries++;
+        memset(&_entries[index], 0, sizeof(Entry));
+        _entries[index].name = name;
+        _entries[index].id = id;
+        _entries[index].phase = phase;
+    }
+
+    // Move it up with the other reserved entries, ahead of the Equipment's
+    if (index >= _numReserved) {
+        Entry swapped = _entries[_numReserved];
+        _entries[_numReserved] = _entries[index];
+        _entries[index] = swapped;
+        _numReserved++;
+    }
+
+    return true;
+}
+
+/**
+ * Records a timing
+ * @param name What was timed - an Equipment type name or a task name. Must outlive the stats, so pass
+ *             a string constant.
+ * @param id The Equipment ID, or -1 if there isn't one
+ * @param phase What was being done
+ * @param elapsed How long it took, in microseconds
+ */
+void Ohmbrewer::LoopStats::record(const char* name, int id, Phase phase, long elapsed) {
+    int index = find(name, id, phase);
+    Entry* entry = (index == -1) ? NULL : &_entries[index];
+
+    if (entry == NULL) {
+        if (_numEntries >= MAX_ENTRIES) {
+            _dropped++;
+            return;
+        }
+        entry = &_entries[_numEntries++];
+        entry->name = name;
+        entry->id = id;
+        entry->phase = phase;
+    }
+
+    unsigned long us = elapsed < 0 ? 0 : (unsigned long)elapsed;
+
+    if (entry->count == 0 || us < entry->min) {
+        entry->min = us;
+    }
+    if (us > entry->max) {
+        entry->max = us;
+    }
+    entry->count++;
+
+    int bucket = bucketFor(us);
+    if (entry->buckets[bucket] == 0xFFFF) {
+        // Halve the whole histogram rather than let one bucket saturate, so the shape survives
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            entry->buckets[i] >>= 1;
+        }
+    }
+    entry->buckets[bucket]++;
+}
+
+/**
+ * @returns The number of entries being tracked
+ */
+int Ohmbrewer::LoopStats::getNumEntries() const {
+    return _numEntries;
+}
+
+/**
+ * @returns The number of timings that didn't fit in the table
+ */
+unsigned long Ohmbrewer::LoopStats::getDropped() const {
+    return _dropped;
+}
+
+/**
+ * Summarizes an entry
+ * @param entry The entry, from 0 to getNumEntries() - 1
+ * @param summary Filled in with the entry's summary
+ * @returns Whether the entry exists
+ */
+bool Ohmbrewer::LoopStats::getSummary(int entry, Summary &summary) const {
+    if (entry < 0 || entry >= _numEntries) {
+        return false;
+    }
+
+    const Entry &e = _entries[entry];
+    summary.name = e.name;
+    summary.id = e.id;
+    summary.phase = e.phase;
+    summary.count = e.count;
+    summary.min = e.min;
+    summary.p50 = percentile(e, 0.50);
+    summary.p99 = percentile(e, 0.99);
+    summary.max = e.max;
+    return true;
+}
+
+/**
+ * Forgets everything recorded so far. Reserved entries are kept, but emptied.
+ */
+void Ohmbrewer::LoopStats::reset() {
+    for (int i = 0; i < _numReserved; i++) {
+        _entries[i].count = 0;
+        _entries[i].min = 0;
+        _entries[i].max = 0;
+        memset(_entries[i].buckets, 0, sizeof(_entries[i].buckets));
+    }
+    memset(&_entries[_numReserved], 0, sizeof(Entry) * (MAX_ENTRIES - _numReserved));
+    _numEntries = _numReserved;
+    _dropped = 0;
+}
+
+/**
+ * Writes every entry as NAME.ID.PHASE=COUNT,MIN,P50,P99,MAX; (times in microseconds, ".ID" left out
+ * if there's no ID), reserved entries first, then dropped=N; with the number of timings that didn't fit
+ * in the table. Should that run past MAX_STRING_LENGTH characters, the entries that don't fit are left
+ * out and counted as skipped=M; just before it.
+ * @param result The String to write to. Its previous contents are replaced.
+ */
+void Ohmbrewer::LoopStats::toString(String &result) const {
+    char line[96];
+    char tail[48];
+    Summary summary;
+    int skipped = 0;
+
+    // Leave room for the longest the tail can be
+    const unsigned int maxLength = MAX_STRING_LENGTH - snprintf(tail, sizeof(tail), "skipped=%d;dropped=%lu;",
+                                                                 MAX_ENTRIES, (unsigned long)ULONG_MAX);
+
+    result = "";
+    for (int i = 0; i < _numEntries; i++) {
+        getSummary(i, summary);
+
+        int len;
+        if (summary.id == -1) {
+            len = snprintf(line, sizeof(line), "%s.%s=%lu,%lu,%lu,%lu,%lu;",
+                           summary.name, phaseName(summary.phase),
+                           summary.count, summary.min, summary.p50, summary.p99, summary.max);
+        } else {
+            len = snprintf(line, sizeof(line), "%s.%d.%s=%lu,%lu,%lu,%lu,%lu;",
+                           summary.name, summary.id, phaseName(summary.phase),
+                           summary.count, summary.min, summary.p50, summary.p99, summary.max);
+        }
+
+        if (len < 0 || result.length() + len > maxLength) {
+            skipped = _numEntries - i;
+            break;
+        }
+        result.concat(line);
+    }
+
+    if (skipped > 0) {
+        snprintf(tail, sizeof(tail), "skipped=%d;dropped=%lu;", skipped, _dropped);
+    } else {
+        snprintf(tail, sizeof(tail), "dropped=%lu;", _dropped);
+    }
+    result.concat(tail);
+}
+
+/**
+ * Finds an entry
+ * @param name What was timed
+ * @param id The Equipment ID, or -1 if there isn't one
+ * @param phase What was being done
+ * @returns The entry's index in _entries, or -1 if it isn't being tracked
+ */
+int Ohmbrewer::LoopStats::find(const char* name, int id, Phase phase) const {
+    for (int i = 0; i < _numEntries; i++) {
+        if (_entries[i].id == id && _entries[i].phase == phase && strcmp(_entries[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @param elapsed A timing in microseconds
+ * @returns The histogram bucket it falls in
+ */
+int Ohmbrewer::LoopStats::bucketFor(unsigned long elapsed) {
+    if (elapsed < SUB_BUCKETS) {
+        return (int)elapsed;
+    }
+
+    // Position of the highest set bit, then the bits just below it pick the sub-bucket
+    int msb = SUB_BUCKET_BITS;
+    while ((elapsed >> (msb + 1)) != 0) {
+        msb++;
+    }
+
+    int bucket = (SUB_BUCKETS * (msb - SUB_BUCKET_BITS + 1)) +
+                 (int)((elapsed >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+}
+
+/**
+ * @param bucket A histogram bucket
+ * @returns The smallest timing that falls in the bucket, in microseconds
+ */
+unsigned long Ohmbrewer::LoopStats::bucketFloor(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return (unsigned long)bucket;
+    }
+
+    int msb = (bucket / SUB_BUCKETS) + SUB_BUCKET_BITS - 1;
+    return (unsigned long)(SUB_BUCKETS + (bucket % SUB_BUCKETS)) << (msb - SUB_BUCKET_BITS);
+}
+
+/**
+ * Estimates a percentile from an entry's histogram
+ * @param entry The entry
+ * @param fraction The percentile, from 0 to 1
+ * @returns The estimated timing, in microseconds
+ */
+unsigned long Ohmbrewer::LoopStats::percentile(const Entry &entry, double fraction) {
+    unsigned long total = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        total += entry.buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    // Rank of the sample we're after, rounding up
+    unsigned long rank = (unsigned long)(fraction * total);
+    if (rank < fraction * total || rank < 1) {
+        rank++;
+    }
+
+    unsigned long seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        seen += entry.buckets[i];
+        if (seen >= rank) {
+            // Middle of the bucket, kept inside what was actually seen
+            unsigned long low = bucketFloor(i);
+            unsigned long high = (i + 1 < NUM_BUCKETS) ? bucketFloor(i + 1) : entry.max + 1;
+            unsigned long estimate = low + ((high - 1 - low) / 2);
+            if (estimate < entry.min) {
+                estimate = entry.min;
+            }
+            if (estimate > entry.max) {
+                estimate = entry.max;
+            }
+            return estimate;
+        }
+    }
+
+    return entry.max;
+}
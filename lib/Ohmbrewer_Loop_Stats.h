@@ -0,0 +1,194 @@
+/**
+ * This library provides the LoopStats class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef RHIZOME_OHMBREWER_LOOP_STATS_H
+#define RHIZOME_OHMBREWER_LOOP_STATS_H
+
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * Collects how long the Rhizome spends in each phase of its loop, per piece of Equipment and per task.
+     *
+     * Every timing lands in a fixed-size, log-scaled histogram (2 buckets per power of two, so percentiles are
+     * good to within ~25%), alongside exact min, max and count. Nothing is allocated after construction; once
+     * MAX_ENTRIES distinct (name, ID, phase) combinations have been seen, further ones are counted as dropped.
+     * The scheduler's tasks reserve their entries when they're registered (see reserve()), so they're always
+     * tracked however much Equipment there is, and the Equipment gets whatever's left.
+     *
+     * Each entry is 116 bytes on the Photon, most of it the histogram, so the whole table is about 3.6 KB. That's
+     * room for the 16 task entries and work, display and update for 5 Sprouts; finer buckets or more entries
+     * cost RAM the Sprouts' pools need more.
+     */
+    class LoopStats {
+
+    public:
+        /**
+         * What was being timed
+         */
+        enum Phase {
+            PHASE_WORK,      // Equipment::work()
+            PHASE_DISPLAY,   // Equipment::display()
+            PHASE_UPDATE,    // Equipment::update()
+            PHASE_RUN,       // A scheduler task's run time
+            PHASE_LATENESS   // How long after it was due a scheduler task started - i.e. its jitter
+        };
+
+        /**
+         * The most (name, ID, phase) combinations we'll track
+         */
+        static const int MAX_ENTRIES = 32;
+
+        /**
+         * Histogram buckets per power of two, and the bits of a timing below its highest set bit that pick one
+         */
+        static const int SUB_BUCKET_BITS = 1;
+        static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+        /**
+         * Histogram buckets in all. Covers 0us to ~8s; anything longer lands in the last bucket.
+         */
+        static const int NUM_BUCKETS = 46;
+
+        /**
+         * The most characters toString() will produce - the limit on a Particle.variable String
+         */
+        static const unsigned int MAX_STRING_LENGTH = 622;
+
+        /**
+         * A summary of one entry's timings, in microseconds
+         */
+        struct Summary {
+            const char* name;
+            int id;
+            Phase phase;
+            unsigned long count;
+            unsigned long min;
+            unsigned long p50;
+            unsigned long p99;
+            unsigned long max;
+        };
+
+        /**
+         * The Rhizome's stats.
+         * @returns The shared stats
+         */
+        static LoopStats* getInstance();
+
+        /**
+         * @param phase A phase
+         * @returns The phase's short name, as used in toString()
+         */
+        static const char* phaseName(Phase phase);
+
+        /**
+         * Sets aside an entry that's always tracked, ahead of any that aren't, and isn't forgotten by reset().
+         * Should the table already be full, the newest unreserved entry is given up to make room.
+         * @param name What will be timed - a task name. Must outlive the stats, so pass a string constant.
+         * @param id The Equipment ID, or -1 if there isn't one
+         * @param phase What will be done
+         * @returns Whether there was room for it
+         */
+        bool reserve(const char* name, int id, Phase phase);
+
+        /**
+         * Records a timing
+         * @param name What was timed - an Equipment type name or a task name. Must outlive the stats, so pass
+         *             a string constant.
+         * @param id The Equipment ID, or -1 if there isn't one
+         * @param phase What was being done
+         * @param elapsed How long it took, in microseconds
+         */
+        void record(const char* name, int id, Phase phase, long elapsed);
+
+        /**
+         * @returns The number of entries being tracked
+         */
+        int getNumEntries() const;
+
+        /**
+         * @returns The number of timings that didn't fit in the table
+         */
+        unsigned long getDropped() const;
+
+        /**
+         * Summarizes an entry
+         * @param entry The entry, from 0 to getNumEntries() - 1
+         * @param summary Filled in with the entry's summary
+         * @returns Whether the entry exists
+         */
+        bool getSummary(int entry, Summary &summary) const;
+
+        /**
+         * Forgets everything recorded so far. Reserved entries are kept, but emptied.
+         */
+        void reset();
+
+        /**
+         * Writes every entry as NAME.ID.PHASE=COUNT,MIN,P50,P99,MAX; (times in microseconds, ".ID" left out
+         * if there's no ID), reserved entries first, then dropped=N; with the number of timings that didn't fit
+         * in the table. Should that run past MAX_STRING_LENGTH characters, the entries that don't fit are left
+         * out and counted as skipped=M; just before it.
+         * @param result The String to write to. Its previous contents are replaced.
+         */
+        void toString(String &result) const;
+
+    protected:
+        /**
+         * One (name, ID, phase) combination's timings
+         */
+        struct Entry {
+            const char* name;
+            int id;
+            Phase phase;
+            unsigned long count;
+            unsigned long min;
+            unsigned long max;
+            uint16_t buckets[NUM_BUCKETS];
+        };
+
+        Entry _entries[MAX_ENTRIES];
+        int _numEntries;
+        int _numReserved; // The first _numReserved of _entries are reserved
+        unsigned long _dropped;
+
+        /**
+         * Constructor
+         */
+        LoopStats();
+
+        /**
+         * Finds an entry
+         * @param name What was timed
+         * @param id The Equipment ID, or -1 if there isn't one
+         * @param phase What was being done
+         * @returns The entry's index in _entries, or -1 if it isn't being tracked
+         */
+        int find(const char* name, int id, Phase phase) const;
+
+        /**
+         * @param elapsed A timing in microseconds
+         * @returns The histogram bucket it falls in
+         */
+        static int bucketFor(unsigned long elapsed);
+
+        /**
+         * @param bucket A histogram bucket
+         * @returns The smallest timing that falls in the bucket, in microseconds
+         */
+        static unsigned long bucketFloor(int bucket);
+
+        /**
+         * Estimates a percentile from an entry's histogram
+         * @param entry The entry
+         * @param fraction The percentile, from 0 to 1
+         * @returns The estimated timing, in microseconds
+         */
+        static unsigned long percentile(const Entry &entry, double fraction);
+    };
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "Ohmbrewer_Menu.h"
 #include "Ohmbrewer_Thermostat.h"
 #include "Ohmbrewer_RIMS.h"
+#include "Ohmbrewer_Sprout_Registry.h"
 
 /**
  * Constructors
@@ -37,17 +38,8 @@ void Ohmbrewer::MenuHome::displayMenu() {
         _screen->displayThermostats();
 
         // We want to show a different border for the Manual Relays section if there were any Thermostats or RIMS
-        int thermostats = 0;
-        int rims = 0;
-        for (std::deque<Ohmbrewer::Equipment *>::iterator itr = _screen->getSprouts()->begin();
-             itr != _screen->getSprouts()->end(); itr++) {
-            if (strcmp((*itr)->getType(), Thermostat::TYPE_NAME) == 0) {
-                thermostats++;
-            }
-            if (strcmp((*itr)->getType(), RIMS::TYPE_NAME) == 0) {
-                rims++;
-            }
-        }
+        int thermostats = _screen->getRegistry()->count(Equipment::TYPE_THERMOSTAT);
+        int rims = _screen->getRegistry()->count(Equipment::TYPE_RIMS);
 
         if ((thermostats + rims) > 2) {
             // Don't print the header line
@@ -0,0 +1,101 @@
+#include "Ohmbrewer_Object_Pool.h"
+#include <new>
+
+unsigned long Ohmbrewer::ObjectPool::_overflows = 0;
+
+/**
+ * Constructor. Every block starts out free.
+ * @param storage The blocks, e.g. a static array of words(blockSize, count) uint64_t, so every block is
+ *                aligned for anything
+ * @param blockSize The size of each block, in bytes
+ * @param count The number of blocks
+ */
+Ohmbrewer::ObjectPool::ObjectPool(uint64_t* storage, size_t blockSize, int count) {
+    _storage = (uint8_t*)storage;
+    _blockSize = words(blockSize, 1) * sizeof(uint64_t);
+    _capacity = count;
+    _available = count;
+
+    // Thread the free list through the blocks, in order, so the first allocations are at the start
+    _free = NULL;
+    for (int i = count - 1; i >= 0; i--) {
+        FreeBlock* block = (FreeBlock*)(_storage + (i * _blockSize));
+        block->next = _free;
+        _free = block;
+    }
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::ObjectPool::~ObjectPool() {
+    // Nothing to do here... the storage isn't ours
+}
+
+/**
+ * Takes a free block
+ * @param size The size needed, in bytes
+ * @returns The block, or memory from the heap if there are none free or size is too big for them
+ *          (counted in getOverflows())
+ */
+void* Ohmbrewer::ObjectPool::allocate(size_t size) {
+    if (_free == NULL || size > _blockSize) {
+        _overflows++;
+        return ::operator new(size);
+    }
+
+    FreeBlock* block = _free;
+    _free = block->next;
+    _available--;
+    return block;
+}
+
+/**
+ * Gives back a block from allocate()
+ * @param ptr The block. Freed to the heap if it didn't come from the pool; ignored if NULL.
+ */
+void Ohmbrewer::ObjectPool::release(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    if (!owns(ptr)) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    FreeBlock* block = (FreeBlock*)ptr;
+    block->next = _free;
+    _free = block;
+    _available++;
+}
+
+/**
+ * @param ptr Some memory
+ * @returns Whether it's one of the pool's blocks
+ */
+bool Ohmbrewer::ObjectPool::owns(const void* ptr) const {
+    const uint8_t* bytes = (const uint8_t*)ptr;
+    return bytes >= _storage && bytes < _storage + (_capacity * _blockSize);
+}
+
+/**
+ * @returns The number of blocks
+ */
+int Ohmbrewer::ObjectPool::getCapacity() const {
+    return _capacity;
+}
+
+/**
+ * @returns The number of blocks free
+ */
+int Ohmbrewer::ObjectPool::getAvailable() const {
+    return _available;
+}
+
+/**
+ * @returns The number of allocations, across every pool, that have had to go to the heap
+ */
+unsigned long Ohmbrewer::ObjectPool::getOverflows() {
+    return _overflows;
+}
@@ -0,0 +1,133 @@
+/**
+ * This library provides the ObjectPool class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_OBJECT_POOL_H
+#define OHMBREWER_OBJECT_POOL_H
+
+#include <stddef.h>
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * A fixed number of equally sized blocks of memory, set aside up front, for a class to allocate its instances
+     * from instead of the heap.
+     *
+     * Sprouts come and go as a recipe is set up, and each one is several allocations of different sizes (the
+     * Equipment, its sensors, their probes and readings...). On the heap that churn fragments the Photon's little
+     * RAM. Each of those classes gets a pool of its own instead, sized for the most instances the Rhizome allows
+     * (see SproutRegistry::MAX_PUMPS and the like), and overrides operator new and delete to use it:
+     *
+     *   void* Ohmbrewer::Pump::operator new(size_t size) {
+     *       return pool().allocate(size);
+     *   }
+     *
+     * Freed blocks go on a free list, so allocating and releasing take constant time. The pools are sized so they
+     * can't run out, but should one run out anyway, or be asked for a block bigger than it holds (e.g. for a
+     * subclass), it falls back to the heap rather than hand a constructor NULL. Every fallback is counted (see
+     * getOverflows()), and Rhizome::addSprout() refuses any Sprout that needed one, so a pool that's too small
+     * shows up as a failed add rather than as fragmentation.
+     */
+    class ObjectPool {
+
+        public:
+
+            /**
+             * The words of storage a pool needs
+             * @param blockSize The size of each block, in bytes
+             * @param count The number of blocks
+             * @returns The size of the array of uint64_t to give the constructor
+             */
+            static constexpr size_t words(size_t blockSize, int count) {
+                return ((blockSize + sizeof(uint64_t) - 1) / sizeof(uint64_t)) * count;
+            }
+
+            /**
+             * Constructor. Every block starts out free.
+             * @param storage The blocks, e.g. a static array of words(blockSize, count) uint64_t, so every block is
+             *                aligned for anything
+             * @param blockSize The size of each block, in bytes
+             * @param count The number of blocks
+             */
+            ObjectPool(uint64_t* storage, size_t blockSize, int count);
+
+            /**
+             * Destructor
+             */
+            virtual ~ObjectPool();
+
+            /**
+             * Takes a free block
+             * @param size The size needed, in bytes
+             * @returns The block, or memory from the heap if there are none free or size is too big for them
+             *          (counted in getOverflows())
+             */
+            void* allocate(size_t size);
+
+            /**
+             * Gives back a block from allocate()
+             * @param ptr The block. Freed to the heap if it didn't come from the pool; ignored if NULL.
+             */
+            void release(void* ptr);
+
+            /**
+             * @param ptr Some memory
+             * @returns Whether it's one of the pool's blocks
+             */
+            bool owns(const void* ptr) const;
+
+            /**
+             * @returns The number of blocks
+             */
+            int getCapacity() const;
+
+            /**
+             * @returns The number of blocks free
+             */
+            int getAvailable() const;
+
+            /**
+             * @returns The number of allocations, across every pool, that have had to go to the heap
+             */
+            static unsigned long getOverflows();
+
+        protected:
+
+            /**
+             * A free block holds the next free block
+             */
+            struct FreeBlock {
+                FreeBlock* next;
+            };
+
+            /**
+             * The blocks
+             */
+            uint8_t* _storage;
+
+            /**
+             * The size of each block, rounded up to a whole number of words
+             */
+            size_t _blockSize;
+
+            /**
+             * The number of blocks, and the number free
+             */
+            int _capacity;
+            int _available;
+
+            /**
+             * The first free block, or NULL if there are none
+             */
+            FreeBlock* _free;
+
+            /**
+             * The number of allocations, across every pool, that have had to go to the heap
+             */
+            static unsigned long _overflows;
+    };
+};
+
+#endif
@@ -1,7 +1,8 @@
 #include "Ohmbrewer_Temperature.h"
 #include "Ohmbrewer_Onewire.h"
-#include "ds18x20.h"
+#include "Ohmbrewer_Onewire_Bus.h"
 #include "onewire.h"
+#include "Ohmbrewer_Sprout_Registry.h"
 
 
 /**
@@ -17,6 +18,63 @@ Ohmbrewer::Onewire::Onewire() : Ohmbrewer::Probe(){
 Ohmbrewer::Onewire::Onewire(int probeIndex) : Ohmbrewer::Probe(){
 //    ow_setPin(D0);
     _probeIndex = probeIndex;
+    OnewireBus::getInstance()->bindProbe(_probeIndex);
+}
+
+/**
+ * Constructor
+ * @param rom The probe's 8 byte ROM code. The probe is looked up (or added) in the OnewireBus's probe table.
+ */
+Ohmbrewer::Onewire::Onewire(const uint8_t rom[8]) : Ohmbrewer::Probe(){
+    _probeIndex = OnewireBus::getInstance()->claimProbe(rom);
+    OnewireBus::getInstance()->bindProbe(_probeIndex);
+}
+
+/**
+ * Copy Constructor
+ * @param clonee The Onewire object to copy. The copy uses the same probe.
+ */
+Ohmbrewer::Onewire::Onewire(const Onewire& clonee) : Ohmbrewer::Probe(clonee){
+    _probeIndex = clonee._probeIndex;
+    _dataPin = clonee._dataPin;
+    OnewireBus::getInstance()->bindProbe(_probeIndex);
+}
+
+/**
+ * Destructor. Lets the OnewireBus give the probe's slot to another probe, should it go missing.
+ */
+Ohmbrewer::Onewire::~Onewire() {
+    OnewireBus::getInstance()->unbindProbe(_probeIndex);
+}
+
+/**
+ * Allocates from the pool of Onewire probes rather than the heap (see getPool())
+ * @param size The size of the object
+ * @returns The memory for it
+ */
+void* Ohmbrewer::Onewire::operator new(size_t size) {
+    return getPool()->allocate(size);
+}
+
+/**
+ * Gives the memory back to the pool of Onewire probes
+ * @param ptr The memory
+ */
+void Ohmbrewer::Onewire::operator delete(void* ptr) {
+    getPool()->release(ptr);
+}
+
+/**
+ * @returns The pool Onewire probes are allocated from, sized for the most the Rhizome may have
+ *          (see SproutRegistry)
+ */
+Ohmbrewer::ObjectPool* Ohmbrewer::Onewire::getPool() {
+    // One for each Temperature Sensor, whether it's a Sprout or part of one
+    const int size = SproutRegistry::MAX_TEMPERATURE_SENSORS + SproutRegistry::MAX_THERMOSTATS +
+                     (2 * SproutRegistry::MAX_RIMS);
+    static uint64_t storage[ObjectPool::words(sizeof(Onewire), size)];
+    static ObjectPool pool = ObjectPool(storage, sizeof(Onewire), size);
+    return &pool;
 }
 
 /**
@@ -28,101 +86,29 @@ int Ohmbrewer::Onewire::getID() const {
 }
 
 /**
- * @returns the Celsius reading from the specified connected DS18b20 probe
- *      returns Temperature::INVALID_TEMPERATURE for no value
+ * Looks up this probe's entry in the shared OnewireBus reading table. Never touches the bus itself.
+ * See getLastReadTime() for when the returned value was taken.
+ * @returns the last completed reading from the specified connected DS18b20 probe, in 1/16ths of a degree Celsius
+ *      returns Temperature::INVALID_RAW for no value
  */
-double Ohmbrewer::Onewire::getReading(){
-    //char uid[8];                   //need the unique ID of the probe to search for.
-    uint8_t sensors[80];
-
-
-    uint8_t subzero, cel, celFracBits;        //local vars
-//    char msg[100];
-    double tempC = Temperature::INVALID_TEMPERATURE;
-    //log("Starting measurement");
-    //Asks all DS18x20 devices to start temperature measurement, takes up to 750ms at max resolution
-    DS18X20_start_meas( DS18X20_POWER_PARASITE, NULL );
-    //If your code has other tasks, you can store the timestamp instead and return when a second has passed.
-    delay(1000);                                        //TODO change / manage this delay
-    uint8_t numSensors = ow_search_sensors(10, sensors);
-    //sprintf(msg, "Found %i sensors", numSensors);
-    //log(msg);
+int32_t Ohmbrewer::Onewire::getReading(){
+    OnewireBus* bus = OnewireBus::getInstance();
 
     /*
      * This section is where we can filter for the desired probe UID and only report that one. for now we will simply
      * state that there is only one and use sensors[0] as the probe reading.
      */
-    if (_probeIndex == -1) {
-        if (DS18X20_read_meas(&sensors[0], &subzero, &cel, &celFracBits) == DS18X20_OK) {
-            char sign = (subzero) ? '-' : '+';
-            int frac = celFracBits * DS18X20_FRACCONV;
-            tempC = (double) cel;
-            if (sign == '-') {
-                tempC = tempC * -1;
-            }
-            tempC = tempC + (.0001 * (double) frac);
-            //getTemp()->fromC(tempC);
-        }
-    }else {//_probeIndex is set
-        //if _probeIndex < numSensors (good to go) else you stupid.
-
-        //read sensors[_probeIndex * OW_ROMCODE_SIZE]
-
-
-        if (_probeIndex < numSensors){
-            if (sensors[_probeIndex * OW_ROMCODE_SIZE + 0] == 0x10 ||
-                sensors[_probeIndex * OW_ROMCODE_SIZE + 0] == 0x28) //0x10=DS18S20, 0x28=DS18B20
-            {
-        // filters for a desired probe.
-//        for (uint8_t i = 0; i < numSensors; i++) {
-//            //current probe ID
-//            char probeId[8] = {
-//                    sensors[(i * OW_ROMCODE_SIZE) + 0],
-//                    sensors[(i * OW_ROMCODE_SIZE) + 1],
-//                    sensors[(i * OW_ROMCODE_SIZE) + 2],
-//                    sensors[(i * OW_ROMCODE_SIZE) + 3],
-//                    sensors[(i * OW_ROMCODE_SIZE) + 4],
-//                    sensors[(i * OW_ROMCODE_SIZE) + 5],
-//                    sensors[(i * OW_ROMCODE_SIZE) + 6],
-//                    sensors[(i * OW_ROMCODE_SIZE) + 7]};
-
-//            if (sensors[i * OW_ROMCODE_SIZE + 0] == 0x10 ||
-//                sensors[i * OW_ROMCODE_SIZE + 0] == 0x28) //0x10=DS18S20, 0x28=DS18B20
-//            {
-                // if current probe matches the probe we are looking for
-
-//                if ( _probeId == (unsigned int)probeId ) {
-                    if (DS18X20_read_meas(&sensors[ _probeIndex * OW_ROMCODE_SIZE ], &subzero,
-                                          &cel, &celFracBits) == DS18X20_OK) {
-                        //char sign = (subzero) ? '-' : '+';
-                        int frac = celFracBits * DS18X20_FRACCONV;
-                        tempC = (double) cel;
-                        tempC = tempC + (.0001 * (double) frac);
-                        //getTemp()->fromC(tempC);
-                    }
-//                    else {
-//                        if (i == numSensors - 1) {
-//                            //sprintf(msg, "Sensor %s not connected", _probeId); //TODO inject probe ID?
-//                            //log(msg);
-//                            tempC = Temperature::INVALID_TEMPERATURE;
-//                        }
-//                    }
-//                }
-            }
-        }
-    }
-
-
-
-    return tempC;
-
+    int index = (_probeIndex == -1) ? 0 : _probeIndex;
 
+    _lastReadTime = bus->getLastReadTime(index);
+    return bus->getReading(index);
 }
 
 /**
  * outputs probe IDs and their current temperatures to the screen
  *
- * Primarily for use as a manual identification tool for probe IDs
+ * Primarily for use as a manual identification tool for probe IDs. Reports the OnewireBus's last cycle rather
+ * than blocking on a fresh conversion.
  *
  * FIXME probeID output is currently in HEX something or other, *non readable*
  */
@@ -139,73 +125,18 @@ void Ohmbrewer::Onewire::displayProbeIds(Ohmbrewer::Screen *screen){
     screen->printMargin(2);
 
     char msg[100];
-    uint8_t sensors[80];
-    uint8_t subzero, cel, celFracBits;        //local vars
-    double tempC;
-    //Asks all DS18x20 devices to start temperature measurement, takes up to 750ms at max resolution
-    DS18X20_start_meas( DS18X20_POWER_PARASITE, NULL );
-    //If your code has other tasks, you can store the timestamp instead and return when a second has passed.
-    delay(1000);
-    uint8_t numSensors = ow_search_sensors(10, sensors);
-
-    for (uint8_t i=0; i<numSensors; i++){
-        //current probe ID
-        char probeId[8] = {
-                sensors[(i*OW_ROMCODE_SIZE)+0],
-                sensors[(i*OW_ROMCODE_SIZE)+1],
-                sensors[(i*OW_ROMCODE_SIZE)+2],
-                sensors[(i*OW_ROMCODE_SIZE)+3],
-                sensors[(i*OW_ROMCODE_SIZE)+4],
-                sensors[(i*OW_ROMCODE_SIZE)+5],
-                sensors[(i*OW_ROMCODE_SIZE)+6],
-                sensors[(i*OW_ROMCODE_SIZE)+7]};
-
-        if (sensors[i*OW_ROMCODE_SIZE+0] == 0x10 || sensors[i*OW_ROMCODE_SIZE+0] == 0x28){ //0x10=DS18S20, 0x28=DS18B20
-           //for each probe print probe and temp to screen
-            if ( DS18X20_read_meas( &sensors[i*OW_ROMCODE_SIZE], &subzero, &cel, &celFracBits) == DS18X20_OK ) {
-                char sign = (subzero) ? '-' : '+';
-                int frac = celFracBits*DS18X20_FRACCONV;
-                tempC = (double)cel;
-                tempC = tempC + (.0001*(double)frac);
-
-                //print the ID and temp
-
-                sprintf(msg, "ID:  %02X%02X%02X%02X%02X%02X%02X%02X   "
-                                "Temperature:   %c%d.%04d",
-                        sensors[(i*OW_ROMCODE_SIZE)+0],
-                        sensors[(i*OW_ROMCODE_SIZE)+1],
-                        sensors[(i*OW_ROMCODE_SIZE)+2],
-                        sensors[(i*OW_ROMCODE_SIZE)+3],
-                        sensors[(i*OW_ROMCODE_SIZE)+4],
-                        sensors[(i*OW_ROMCODE_SIZE)+5],
-                        sensors[(i*OW_ROMCODE_SIZE)+6],
-                        sensors[(i*OW_ROMCODE_SIZE)+7],
-                        sign,
-                        cel,
-                        frac
-                );
-                screen->println(msg);
-//                screen->print((unsigned int)probeId);
-//                screen->print((char)(probeId[0]));
-//                screen->print((char)probeId[1]);
-//                screen->print((char)probeId[2]);
-//                screen->print((char)probeId[3]);
-//                screen->print((char)probeId[4]);
-//                screen->print((char)probeId[5]);
-//                screen->print((char)probeId[6]);
-//                screen->print((char)probeId[7]);
-//                screen->print(" : ");
-//                screen->println(tempC);
-
-            }
-            else {//not sure this block is actually needed
-                if (i == numSensors - 1) {
-                    //error
-                    screen->print(probeId);
-                    screen->print(" : ");
-                    screen->println(Temperature::INVALID_TEMPERATURE);
-                }
-            }
+    uint8_t rom[8];
+    OnewireBus* bus = OnewireBus::getInstance();
+
+    for (int i=0; i<OnewireBus::MAX_PROBES; i++){
+        if (bus->getRom(i, rom)){
+            //for each probe print probe and temp to screen
+            sprintf(msg, "%d ID:  %02X%02X%02X%02X%02X%02X%02X%02X   "
+                            "Temperature:   %.4f",
+                    i, rom[0], rom[1], rom[2], rom[3], rom[4], rom[5], rom[6], rom[7],
+                    bus->getReading(i) / (double)Temperature::ONE_DEGREE
+            );
+            screen->println(msg);
         }
     }
 }
@@ -230,7 +161,10 @@ void Ohmbrewer::Onewire::displayProbeIds(Ohmbrewer::Screen *screen){
  * @param probe id  Unique index ID.
  */
 void Ohmbrewer::Onewire::setProbeIndex(int index){
+    OnewireBus* bus = OnewireBus::getInstance();
+    bus->unbindProbe(_probeIndex);
     _probeIndex = index;
+    bus->bindProbe(_probeIndex);
 }
 
 /**
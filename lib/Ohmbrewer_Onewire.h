@@ -4,6 +4,7 @@
 
 #include "Ohmbrewer_Probe.h"
 #include "application.h"
+#include "Ohmbrewer_Object_Pool.h"
 #include "Ohmbrewer_Screen.h"
 
 
@@ -20,6 +21,42 @@ namespace Ohmbrewer {
 
         Onewire(int probeIndex);
 
+        /**
+         * Constructor
+         * @param rom The probe's 8 byte ROM code. The probe is looked up (or added) in the OnewireBus's probe table.
+         */
+        Onewire(const uint8_t rom[8]);
+
+        /**
+         * Copy Constructor
+         * @param clonee The Onewire object to copy. The copy uses the same probe.
+         */
+        Onewire(const Onewire& clonee);
+
+        /**
+         * Destructor. Lets the OnewireBus give the probe's slot to another probe, should it go missing.
+         */
+        virtual ~Onewire();
+
+        /**
+         * Allocates from the pool of Onewire probes rather than the heap (see getPool())
+         * @param size The size of the object
+         * @returns The memory for it
+         */
+        static void* operator new(size_t size);
+
+        /**
+         * Gives the memory back to the pool of Onewire probes
+         * @param ptr The memory
+         */
+        static void operator delete(void* ptr);
+
+        /**
+         * @returns The pool Onewire probes are allocated from, sized for the most the Rhizome may have
+         *          (see SproutRegistry)
+         */
+        static ObjectPool* getPool();
+
         /**
          * The Equipment ID
          * @returns The Sprout ID to use for this piece of Equipment
@@ -27,13 +64,15 @@ namespace Ohmbrewer {
         virtual int getID() const;
 
         /**
-         * @returns the Celsius reading from the specified connected DS18b20 probe
-         *      returns Temperature::INVALID_TEMPERATURE for no value
+         * Looks up this probe's entry in the shared OnewireBus reading table. Never touches the bus itself.
+         * See getLastReadTime() for when the returned value was taken.
+         * @returns the last completed reading from the specified connected DS18b20 probe, in 1/16ths of a degree Celsius
+         *      returns Temperature::INVALID_RAW for no value
          */
-        double getReading();
+        int32_t getReading();
 
         /**
-         * outputs probe IDs and their current temperatures to the screen
+         * outputs probe IDs and their current temperatures to the screen, as of the OnewireBus's last cycle
          *
          * Primarily for use as a manual identification tool for probe IDs
          */
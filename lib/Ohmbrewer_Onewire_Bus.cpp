@@ -0,0 +1,439 @@
+#include "Ohmbrewer_Onewire_Bus.h"
+#include "Ohmbrewer_Runtime_Settings.h"
+#include "Ohmbrewer_Temperature.h"
+#include "Ohmbrewer_Loop_Stats.h"
+#include "ds18x20.h"
+#include "onewire.h"
+#include "crc8.h"
+
+/**
+ * The bus all of the Rhizome's DS18b20 probes are on (Digital 0).
+ * @returns The shared bus
+ */
+Ohmbrewer::OnewireBus* Ohmbrewer::OnewireBus::getInstance() {
+    static OnewireBus bus(D0);
+    return &bus;
+}
+
+/**
+ * Parses a ROM code written as 16 hex digits, most significant byte (the family code) first.
+ * e.g. 28FF4A1B04160011
+ * @param hex The ROM code string
+ * @param rom Array to fill with the 8 byte ROM code
+ * @returns Whether the string was a ROM code
+ */
+bool Ohmbrewer::OnewireBus::parseRom(const char* hex, uint8_t rom[8]) {
+    if (hex == NULL || strlen(hex) != OW_ROMCODE_SIZE * 2) {
+        return false;
+    }
+
+    for (int i = 0; i < OW_ROMCODE_SIZE * 2; i++) {
+        char c = hex[i];
+        uint8_t nibble;
+
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else {
+            return false;
+        }
+
+        if (i % 2 == 0) {
+            rom[i / 2] = nibble << 4;
+        } else {
+            rom[i / 2] |= nibble;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Puts a DS18B20 reading, as DS18X20_read_meas() splits it up, back together as a raw Temperature.
+ * @param subzero Whether the reading is below zero
+ * @param cel The whole degrees Celsius, without the sign
+ * @param celFracBits The 1/16ths of a degree
+ * @returns The reading in 1/16ths of a degree Celsius
+ */
+int32_t Ohmbrewer::OnewireBus::decodeReading(uint8_t subzero, uint8_t cel, uint8_t celFracBits) {
+    // The probe counts in 1/16ths too, so this is exact
+    int32_t reading = ((int32_t)cel << Temperature::FRACTION_BITS) | (celFracBits & (Temperature::ONE_DEGREE - 1));
+    return subzero ? -reading : reading;
+}
+
+/**
+ * Constructor. Loads the probe table from EEPROM and searches the bus.
+ * @param pin The Digital pin the bus is on
+ */
+Ohmbrewer::OnewireBus::OnewireBus(int pin) {
+    _pin = pin;
+    _state = CYCLE_IDLE;
+    _conversionStartTime = 0;
+    _cycleCount = 0;
+    _rescanNeeded = false;
+    _lastRescanTime = 0;
+    _rescanCount = 0;
+
+    for (int i = 0; i < MAX_PROBES; i++) {
+        _used[i] = false;
+        _present[i] = false;
+        _lastSeen[i] = 0;
+        _bindings[i] = 0;
+        _readings[i] = Temperature::INVALID_RAW;
+        _readTimes[i] = 0;
+    }
+
+    ow_setPin(_pin);
+
+    loadTable();
+    rescan();
+
+    // The first conversion starts on the next tick
+    LoopStats::getInstance()->reserve("sensors", -1, LoopStats::PHASE_RUN);
+    _cycleTimer.fn = [this]() { LoopStats::getInstance()->record("sensors", -1, LoopStats::PHASE_RUN, work()); };
+    TimerWheel::getInstance()->schedule(&_cycleTimer, 0);
+}
+
+/**
+ * Moves the bus's conversion cycle along without blocking: collects the last conversion and starts the next.
+ * The bus's own timer calls this as each conversion finishes, so there's no need to call it from loop().
+ * @returns The time taken to run the method
+ */
+int Ohmbrewer::OnewireBus::work() {
+    unsigned long start = micros();
+
+    if (_state == CYCLE_CONVERTING) {
+        // DS18B20s can't be polled for completion on parasite power, so give them the full conversion time
+        unsigned long elapsed = millis() - _conversionStartTime;
+        if (elapsed < CONVERSION_TIME) {
+            // Timers fire on the tick, which can fall just short of the conversion time
+            TimerWheel::getInstance()->schedule(&_cycleTimer, CONVERSION_TIME - elapsed);
+            return micros() - start;
+        }
+        collectCycle();
+    }
+
+    // Only search when something has gone wrong, and not too often
+    if (_rescanNeeded && millis() - _lastRescanTime >= RESCAN_INTERVAL) {
+        rescan();
+    }
+
+    // Come back once the conversion's done, or try again shortly if it couldn't be started
+    TimerWheel::getInstance()->schedule(&_cycleTimer, startCycle() ? CONVERSION_TIME : RETRY_INTERVAL);
+
+    return micros() - start;
+}
+
+/**
+ * Searches the bus, adding any new probes to the table and noting which known probes are present.
+ * @returns The number of probes found on the bus
+ */
+int Ohmbrewer::OnewireBus::rescan() {
+    uint8_t sensors[MAX_PROBES * 8];
+    uint8_t numSensors = ow_search_sensors(MAX_PROBES, sensors);
+
+    _rescanCount++;
+    _lastRescanTime = millis();
+    _rescanNeeded = false;
+
+    for (int i = 0; i < MAX_PROBES; i++) {
+        _present[i] = false;
+    }
+
+    for (int i = 0; i < numSensors; i++) {
+        uint8_t* rom = &sensors[i * OW_ROMCODE_SIZE];
+
+        if (rom[0] != 0x10 && rom[0] != 0x28) { //0x10=DS18S20, 0x28=DS18B20
+            continue;
+        }
+
+        int index = findProbe(rom);
+        if (index != -1) {
+            _present[index] = true;
+            _lastSeen[index] = _rescanCount;
+        }
+    }
+
+    // Only hand out slots once every known probe that answered has been marked, so none of them is reclaimed
+    for (int i = 0; i < numSensors; i++) {
+        uint8_t* rom = &sensors[i * OW_ROMCODE_SIZE];
+
+        if ((rom[0] != 0x10 && rom[0] != 0x28) || findProbe(rom) != -1) {
+            continue;
+        }
+
+        // New probe. It keeps the slot until it goes missing while nothing uses it and another needs the room.
+        int slot = freeSlot();
+        if (slot != -1) {
+            memcpy(&_roms[slot * OW_ROMCODE_SIZE], rom, OW_ROMCODE_SIZE);
+            _used[slot] = true;
+            saveSlot(slot);
+            _present[slot] = true;
+            _lastSeen[slot] = _rescanCount;
+        }
+    }
+
+    return numSensors;
+}
+
+/**
+ * Finds the slot for a probe in the table.
+ * @param rom The probe's 8 byte ROM code
+ * @returns The probe's index, or -1 if it isn't in the table
+ */
+int Ohmbrewer::OnewireBus::findProbe(const uint8_t rom[8]) const {
+    for (int i = 0; i < MAX_PROBES; i++) {
+        if (_used[i] && memcmp(&_roms[i * OW_ROMCODE_SIZE], rom, OW_ROMCODE_SIZE) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Finds the slot for a probe, searching the bus for it if it isn't in the table yet.
+ * @param rom The probe's 8 byte ROM code
+ * @returns The probe's index, or -1 if it can't be found
+ */
+int Ohmbrewer::OnewireBus::claimProbe(const uint8_t rom[8]) {
+    int index = findProbe(rom);
+
+    if (index == -1) {
+        rescan();
+        index = findProbe(rom);
+    }
+
+    return index;
+}
+
+/**
+ * Marks a probe as in use by a Sprout, so its slot is never given to another probe. Each call must be
+ * matched by a call to unbindProbe().
+ * @param index The probe's index on the bus. Ignored if it isn't a slot in the table.
+ */
+void Ohmbrewer::OnewireBus::bindProbe(int index) {
+    if (index >= 0 && index < MAX_PROBES) {
+        _bindings[index]++;
+    }
+}
+
+/**
+ * Marks a probe as no longer in use by a Sprout
+ * @param index The probe's index on the bus. Ignored if it isn't a slot in the table.
+ */
+void Ohmbrewer::OnewireBus::unbindProbe(int index) {
+    if (index >= 0 && index < MAX_PROBES && _bindings[index] > 0) {
+        _bindings[index]--;
+    }
+}
+
+/**
+ * @param index The probe's index on the bus
+ * @returns Whether any Sprout is using the probe
+ */
+bool Ohmbrewer::OnewireBus::isBound(int index) const {
+    return index >= 0 && index < MAX_PROBES && _bindings[index] > 0;
+}
+
+/**
+ * Broadcasts a conversion to every probe on the bus.
+ * @returns Whether the conversion was started
+ */
+bool Ohmbrewer::OnewireBus::startCycle() {
+    if (getNumProbes() == 0) {
+        _state = CYCLE_IDLE;
+        _rescanNeeded = true;
+        return false;
+    }
+
+    //Asks all DS18x20 devices to start temperature measurement, takes up to 750ms at max resolution
+    if (DS18X20_start_meas( DS18X20_POWER_PARASITE, NULL ) != DS18X20_OK) {
+        // Nobody answered the reset pulse
+        _state = CYCLE_IDLE;
+        _rescanNeeded = true;
+        return false;
+    }
+
+    _conversionStartTime = millis();
+    _state = CYCLE_CONVERTING;
+    return true;
+}
+
+/**
+ * Reads every present probe's scratchpad into the reading table.
+ */
+void Ohmbrewer::OnewireBus::collectCycle() {
+    uint8_t subzero, cel, celFracBits;
+
+    for (int i = 0; i < MAX_PROBES; i++) {
+        if (!isSlotUsed(i)) {
+            continue;
+        }
+
+        int32_t reading = Temperature::INVALID_RAW;
+
+        if (_present[i]) {
+            if (DS18X20_read_meas(&_roms[i * OW_ROMCODE_SIZE], &subzero, &cel, &celFracBits) == DS18X20_OK) {
+                reading = decodeReading(subzero, cel, celFracBits);
+            } else {
+                // Bad CRC or the probe didn't answer. Either way, check who's really out there.
+                _present[i] = false;
+                _rescanNeeded = true;
+            }
+        }
+
+        _readings[i] = reading;
+        _readTimes[i] = millis();
+    }
+
+    _cycleCount++;
+    _state = CYCLE_IDLE;
+}
+
+/**
+ * Whether a slot in the table holds a ROM code
+ * @param index The slot
+ */
+bool Ohmbrewer::OnewireBus::isSlotUsed(int index) const {
+    return index >= 0 && index < MAX_PROBES && _used[index];
+}
+
+/**
+ * Finds a slot for a new probe: the first empty one or, if the table is full, the slot of the unbound probe
+ * that has been missing from the bus the longest. Its old probe is forgotten.
+ * @returns The slot, or -1 if every slot holds a probe that's on the bus or in use
+ */
+int Ohmbrewer::OnewireBus::freeSlot() {
+    int oldest = -1;
+
+    for (int i = 0; i < MAX_PROBES; i++) {
+        if (!isSlotUsed(i)) {
+            return i;
+        }
+        if (!_present[i] && !isBound(i) && (oldest == -1 || _lastSeen[i] < _lastSeen[oldest])) {
+            oldest = i;
+        }
+    }
+
+    if (oldest != -1) {
+        // The old probe's readings mustn't be mistaken for the new one's
+        _readings[oldest] = Temperature::INVALID_RAW;
+        _readTimes[oldest] = 0;
+    }
+
+    return oldest;
+}
+
+/**
+ * Reads the probe table from EEPROM. Slots that don't hold a valid ROM code are left empty.
+ */
+void Ohmbrewer::OnewireBus::loadTable() {
+    for (int i = 0; i < MAX_PROBES * OW_ROMCODE_SIZE; i++) {
+        _roms[i] = EEPROM.read(RuntimeSettings::PROBE_TABLE_ADDR + i);
+    }
+
+    // Erased EEPROM is all 0xFF, which fails the ROM's own CRC check
+    for (int i = 0; i < MAX_PROBES; i++) {
+        uint8_t* rom = &_roms[i * OW_ROMCODE_SIZE];
+        _used[i] = rom[0] != 0x00 && rom[0] != 0xFF && crc8(rom, OW_ROMCODE_SIZE) == 0;
+    }
+}
+
+/**
+ * Writes a slot of the probe table out to EEPROM.
+ * @param index The slot
+ */
+void Ohmbrewer::OnewireBus::saveSlot(int index) {
+    int addr = RuntimeSettings::PROBE_TABLE_ADDR + (index * OW_ROMCODE_SIZE);
+
+    for (int i = 0; i < OW_ROMCODE_SIZE; i++) {
+        // Only write when actually necessary
+        if (EEPROM.read(addr + i) != _roms[index * OW_ROMCODE_SIZE + i]) {
+            EEPROM.write(addr + i, _roms[index * OW_ROMCODE_SIZE + i]);
+        }
+    }
+}
+
+/**
+ * The last completed reading for a probe
+ * @param index The probe's index on the bus
+ * @returns The reading in 1/16ths of a degree Celsius, or Temperature::INVALID_RAW if the probe hasn't been
+ *          read or couldn't be read
+ */
+int32_t Ohmbrewer::OnewireBus::getReading(int index) const {
+    if (!isSlotUsed(index)) {
+        return Temperature::INVALID_RAW;
+    }
+    return _readings[index];
+}
+
+/**
+ * The time at which a probe's reading was taken
+ * @param index The probe's index on the bus
+ * @returns millis() at the probe's last completed reading, or 0 if it hasn't been read
+ */
+unsigned long Ohmbrewer::OnewireBus::getLastReadTime(int index) const {
+    if (index < 0 || index >= MAX_PROBES) {
+        return 0;
+    }
+    return _readTimes[index];
+}
+
+/**
+ * Copies out a probe's ROM code
+ * @param index The probe's index on the bus
+ * @param rom Array to fill with the 8 byte ROM code
+ * @returns Whether the index refers to a known probe
+ */
+bool Ohmbrewer::OnewireBus::getRom(int index, uint8_t rom[8]) const {
+    if (!isSlotUsed(index)) {
+        return false;
+    }
+    memcpy(rom, &_roms[index * OW_ROMCODE_SIZE], OW_ROMCODE_SIZE);
+    return true;
+}
+
+/**
+ * @param index The probe's index on the bus
+ * @returns Whether the probe answered the last search and hasn't failed a read since
+ */
+bool Ohmbrewer::OnewireBus::isPresent(int index) const {
+    return isSlotUsed(index) && _present[index];
+}
+
+/**
+ * @returns The number of probes in the table
+ */
+int Ohmbrewer::OnewireBus::getNumProbes() const {
+    int count = 0;
+    for (int i = 0; i < MAX_PROBES; i++) {
+        if (isSlotUsed(i)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @returns The number of completed conversion cycles
+ */
+unsigned long Ohmbrewer::OnewireBus::getCycleCount() const {
+    return _cycleCount;
+}
+
+/**
+ * @returns The number of times the bus has been searched
+ */
+unsigned long Ohmbrewer::OnewireBus::getRescanCount() const {
+    return _rescanCount;
+}
+
+/**
+ * @returns The Digital pin the bus is on
+ */
+int Ohmbrewer::OnewireBus::getPin() const {
+    return _pin;
+}
@@ -0,0 +1,300 @@
+/**
+ * This library provides the OnewireBus class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef RHIZOME_OHMBREWER_ONEWIRE_BUS_H
+#define RHIZOME_OHMBREWER_ONEWIRE_BUS_H
+
+#include "Ohmbrewer_Timer_Wheel.h"
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * Owns the Dallas Onewire bus that all of the DS18b20 probes share.
+     *
+     * The bus keeps a table of known probes keyed by their 64 bit ROM codes. The table is saved to EEPROM, so a
+     * probe keeps the same slot (its probe index) across reboots and no matter what else is plugged in or pulled
+     * out. The bus is only searched at startup, on demand, or after a probe fails its CRC or presence check.
+     *
+     * Once the table is full, a new probe takes over the slot of the probe that has been missing from the bus the
+     * longest, as long as no Sprout is using it (see bindProbe()). So swapping out a failed probe never leaves the
+     * table clogged with ROM codes that will never answer again.
+     *
+     * Each cycle the bus issues a single broadcast conversion to every probe at once, waits out the conversion
+     * time without blocking, then reads every present probe's scratchpad in one pass into a reading table.
+     * Onewire probes look their readings up in that table rather than talking to the bus themselves.
+     */
+    class OnewireBus {
+
+    public:
+        /**
+         * The most probes we'll track on the bus
+         */
+        static const int MAX_PROBES = 10;
+
+        /**
+         * How long a DS18B20 takes to finish a conversion at 12 bit resolution, in milliseconds
+         */
+        static const unsigned long CONVERSION_TIME = 750;
+
+        /**
+         * The shortest time between searches triggered by a failing probe, in milliseconds.
+         * Keeps a probe that has been unplugged for good from costing a search every cycle.
+         */
+        static const unsigned long RESCAN_INTERVAL = 30000;
+
+        /**
+         * How long to wait before trying again when a conversion couldn't be started, in milliseconds
+         */
+        static const unsigned long RETRY_INTERVAL = 100;
+
+        /**
+         * Where the bus is in its conversion cycle
+         */
+        enum CycleState {
+            CYCLE_IDLE,
+            CYCLE_CONVERTING
+        };
+
+        /**
+         * The bus all of the Rhizome's DS18b20 probes are on (Digital 0).
+         * @returns The shared bus
+         */
+        static OnewireBus* getInstance();
+
+        /**
+         * Parses a ROM code written as 16 hex digits, most significant byte (the family code) first.
+         * e.g. 28FF4A1B04160011
+         * @param hex The ROM code string
+         * @param rom Array to fill with the 8 byte ROM code
+         * @returns Whether the string was a ROM code
+         */
+        static bool parseRom(const char* hex, uint8_t rom[8]);
+
+        /**
+         * Puts a DS18B20 reading, as DS18X20_read_meas() splits it up, back together as a raw Temperature.
+         * @param subzero Whether the reading is below zero
+         * @param cel The whole degrees Celsius, without the sign
+         * @param celFracBits The 1/16ths of a degree
+         * @returns The reading in 1/16ths of a degree Celsius
+         */
+        static int32_t decodeReading(uint8_t subzero, uint8_t cel, uint8_t celFracBits);
+
+        /**
+         * Moves the bus's conversion cycle along without blocking: collects the last conversion and starts the next.
+         * The bus's own timer calls this as each conversion finishes, so there's no need to call it from loop().
+         * @returns The time taken to run the method
+         */
+        int work();
+
+        /**
+         * Searches the bus, adding any new probes to the table and noting which known probes are present.
+         * @returns The number of probes found on the bus
+         */
+        int rescan();
+
+        /**
+         * Finds the slot for a probe in the table.
+         * @param rom The probe's 8 byte ROM code
+         * @returns The probe's index, or -1 if it isn't in the table
+         */
+        int findProbe(const uint8_t rom[8]) const;
+
+        /**
+         * Finds the slot for a probe, searching the bus for it if it isn't in the table yet.
+         * @param rom The probe's 8 byte ROM code
+         * @returns The probe's index, or -1 if it can't be found
+         */
+        int claimProbe(const uint8_t rom[8]);
+
+        /**
+         * Marks a probe as in use by a Sprout, so its slot is never given to another probe. Each call must be
+         * matched by a call to unbindProbe().
+         * @param index The probe's index on the bus. Ignored if it isn't a slot in the table.
+         */
+        void bindProbe(int index);
+
+        /**
+         * Marks a probe as no longer in use by a Sprout
+         * @param index The probe's index on the bus. Ignored if it isn't a slot in the table.
+         */
+        void unbindProbe(int index);
+
+        /**
+         * @param index The probe's index on the bus
+         * @returns Whether any Sprout is using the probe
+         */
+        bool isBound(int index) const;
+
+        /**
+         * The last completed reading for a probe
+         * @param index The probe's index on the bus
+         * @returns The reading in 1/16ths of a degree Celsius, or Temperature::INVALID_RAW if the probe hasn't been
+         *          read or couldn't be read
+         */
+        int32_t getReading(int index) const;
+
+        /**
+         * The time at which a probe's reading was taken
+         * @param index The probe's index on the bus
+         * @returns millis() at the probe's last completed reading, or 0 if it hasn't been read
+         */
+        unsigned long getLastReadTime(int index) const;
+
+        /**
+         * Copies out a probe's ROM code
+         * @param index The probe's index on the bus
+         * @param rom Array to fill with the 8 byte ROM code
+         * @returns Whether the index refers to a known probe
+         */
+        bool getRom(int index, uint8_t rom[8]) const;
+
+        /**
+         * @param index The probe's index on the bus
+         * @returns Whether the probe answered the last search and hasn't failed a read since
+         */
+        bool isPresent(int index) const;
+
+        /**
+         * @returns The number of probes in the table
+         */
+        int getNumProbes() const;
+
+        /**
+         * @returns The number of completed conversion cycles
+         */
+        unsigned long getCycleCount() const;
+
+        /**
+         * @returns The number of times the bus has been searched
+         */
+        unsigned long getRescanCount() const;
+
+        /**
+         * @returns The Digital pin the bus is on
+         */
+        int getPin() const;
+
+    protected:
+        /**
+         * Constructor. Loads the probe table from EEPROM and searches the bus.
+         * @param pin The Digital pin the bus is on
+         */
+        OnewireBus(int pin);
+
+        /**
+         * Broadcasts a conversion to every probe on the bus.
+         * @returns Whether the conversion was started
+         */
+        bool startCycle();
+
+        /**
+         * Reads every present probe's scratchpad into the reading table.
+         */
+        void collectCycle();
+
+        /**
+         * Whether a slot in the table holds a ROM code
+         * @param index The slot
+         */
+        bool isSlotUsed(int index) const;
+
+        /**
+         * Finds a slot for a new probe: the first empty one or, if the table is full, the slot of the unbound probe
+         * that has been missing from the bus the longest. Its old probe is forgotten.
+         * @returns The slot, or -1 if every slot holds a probe that's on the bus or in use
+         */
+        int freeSlot();
+
+        /**
+         * Reads the probe table from EEPROM. Slots that don't hold a valid ROM code are left empty.
+         */
+        void loadTable();
+
+        /**
+         * Writes a slot of the probe table out to EEPROM.
+         * @param index The slot
+         */
+        void saveSlot(int index);
+
+        /**
+         * Digital pin that the data stream is on
+         */
+        int _pin;
+
+        /**
+         * Where the bus is in its conversion cycle
+         */
+        CycleState _state;
+
+        /**
+         * millis() when the current conversion was broadcast
+         */
+        unsigned long _conversionStartTime;
+
+        /**
+         * Fires when the current conversion is done, or it's time to try starting one again
+         */
+        TimerWheel::Timer _cycleTimer;
+
+        /**
+         * Number of completed conversion cycles
+         */
+        unsigned long _cycleCount;
+
+        /**
+         * Whether a probe has gone missing or failed a read since the last search
+         */
+        bool _rescanNeeded;
+
+        /**
+         * millis() at the last search
+         */
+        unsigned long _lastRescanTime;
+
+        /**
+         * Number of times the bus has been searched
+         */
+        unsigned long _rescanCount;
+
+        /**
+         * ROM codes of the known probes, 8 bytes apiece. Mirrored in EEPROM.
+         */
+        uint8_t _roms[MAX_PROBES * 8];
+
+        /**
+         * Whether each slot of the table holds a ROM code
+         */
+        bool _used[MAX_PROBES];
+
+        /**
+         * Whether each known probe answered the last search
+         */
+        bool _present[MAX_PROBES];
+
+        /**
+         * The search count (see getRescanCount()) at which each known probe last answered. Not saved, so a probe
+         * that never answers after a reboot counts as missing since then.
+         */
+        unsigned long _lastSeen[MAX_PROBES];
+
+        /**
+         * How many Sprouts are using each probe
+         */
+        uint8_t _bindings[MAX_PROBES];
+
+        /**
+         * The last completed reading for each probe, in 1/16ths of a degree Celsius
+         */
+        int16_t _readings[MAX_PROBES];
+
+        /**
+         * millis() at each probe's last completed reading
+         */
+        unsigned long _readTimes[MAX_PROBES];
+    };
+};
+
+#endif
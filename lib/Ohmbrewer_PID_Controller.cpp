@@ -0,0 +1,215 @@
+#include "Ohmbrewer_PID_Controller.h"
+
+/**
+ * Constructor. The controller starts in manual, with an output of outMin.
+ * @param outMin The lowest output
+ * @param outMax The highest output
+ * @param inputScale Raw input units per unit of the gains, e.g. Temperature::ONE_DEGREE for gains per degree
+ * @param sampleTime The time between computations, in milliseconds
+ */
+Ohmbrewer::PIDController::PIDController(int32_t outMin, int32_t outMax, int32_t inputScale,
+                                        unsigned long sampleTime) {
+    _gains.kp = 0;
+    _gains.ki = 0;
+    _gains.kd = 0;
+    _hasGains = false;
+    _inputScale = inputScale;
+    _sampleTime = sampleTime;
+    _outMin = 0;
+    _outMax = 0;
+    _output = 0;
+    _integral = 0;
+    _lastInput = 0;
+    _lastError = 0;
+    _automatic = false;
+
+    setOutputLimits(outMin, outMax);
+    _output = _outMin;
+
+    // The first computation happens straight away
+    _lastTime = millis() - _sampleTime;
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::PIDController::~PIDController() {
+    // Nothing to do here...
+}
+
+/**
+ * Scales a profile's gains for a controller's units and sample time.
+ * @param profile The gains, in output units per unit of input (and per second, for I and D)
+ * @param inputScale Raw input units per unit of the gains
+ * @param sampleTime The controller's time between computations, in milliseconds
+ * @param gains Set to the scaled gains
+ * @returns Whether the gains could be scaled - they must be positive, and small enough to fit
+ */
+bool Ohmbrewer::PIDController::makeGains(const PIDProfile &profile, int32_t inputScale, unsigned long sampleTime,
+                                         Gains &gains) {
+    double sampleSecs = sampleTime / 1000.0;
+
+    if (profile.kP() < 0 || profile.kI() < 0 || profile.kD() < 0) {
+        return false;
+    }
+
+    return scaleGain(profile.kP() / inputScale, gains.kp) &&
+           scaleGain((profile.kI() * sampleSecs) / inputScale, gains.ki) &&
+           scaleGain((profile.kD() / sampleSecs) / inputScale, gains.kd);
+}
+
+/**
+ * Scales a profile's gains for this controller's units and sample time.
+ * @param profile The gains, in output units per unit of input (and per second, for I and D)
+ * @param gains Set to the scaled gains
+ * @returns Whether the gains could be scaled - they must be positive, and small enough to fit
+ */
+bool Ohmbrewer::PIDController::makeGains(const PIDProfile &profile, Gains &gains) const {
+    return makeGains(profile, _inputScale, _sampleTime, gains);
+}
+
+/**
+ * Sets the gains the controller uses. Switching is bumpless.
+ * @param gains The scaled gains. They're copied.
+ */
+void Ohmbrewer::PIDController::setGains(const Gains &gains) {
+    // Hand the change in the proportional term to the integral, so the output carries on where it was
+    if (_automatic && _hasGains && gains.kp != _gains.kp) {
+        _integral += (int64_t)(_gains.kp - gains.kp) * _lastError;
+        clampIntegral();
+    }
+
+    _gains = gains;
+    _hasGains = true;
+}
+
+/**
+ * @returns The gains the controller is using - all zero if it hasn't been given any
+ */
+const Ohmbrewer::PIDController::Gains& Ohmbrewer::PIDController::getGains() const {
+    return _gains;
+}
+
+/**
+ * Changes the output limits, clamping the output and the integral to them
+ * @param outMin The lowest output
+ * @param outMax The highest output
+ */
+void Ohmbrewer::PIDController::setOutputLimits(int32_t outMin, int32_t outMax) {
+    if (outMin >= outMax || outMin < -MAX_OUTPUT || outMax > MAX_OUTPUT) {
+        return;
+    }
+
+    _outMin = outMin;
+    _outMax = outMax;
+    setOutput(_output);
+    clampIntegral();
+}
+
+/**
+ * Switches between automatic and manual. Going to automatic carries on from the current output.
+ * @param automatic Whether the controller should compute its output
+ * @param input The current input, so the derivative doesn't kick on the first computation
+ */
+void Ohmbrewer::PIDController::setAutomatic(bool automatic, int32_t input) {
+    if (automatic && !_automatic) {
+        _integral = (int64_t)_output << GAIN_BITS;
+        _lastInput = input;
+        _lastError = 0;
+        clampIntegral();
+    }
+
+    _automatic = automatic;
+}
+
+/**
+ * @returns Whether the controller is computing its output
+ */
+bool Ohmbrewer::PIDController::isAutomatic() const {
+    return _automatic;
+}
+
+/**
+ * Sets the output, as when the controller is in manual.
+ * @param output The output. It's clamped to the output limits.
+ */
+void Ohmbrewer::PIDController::setOutput(int32_t output) {
+    if (output > _outMax) {
+        output = _outMax;
+    } else if (output < _outMin) {
+        output = _outMin;
+    }
+    _output = output;
+}
+
+/**
+ * Recomputes the output, if the sample time has passed since it was last computed. Cheap enough to
+ * call every loop. Takes constant time.
+ * @param input The measurement, e.g. the current raw Temperature
+ * @param setpoint Where the measurement should be
+ * @returns Whether the output was recomputed
+ */
+bool Ohmbrewer::PIDController::compute(int32_t input, int32_t setpoint) {
+    unsigned long now = millis();
+
+    if (!_automatic || !_hasGains || (now - _lastTime) < _sampleTime) {
+        return false;
+    }
+
+    int32_t error = setpoint - input;
+
+    _integral += (int64_t)_gains.ki * error;
+    clampIntegral();
+
+    // Derivative on measurement, so moving the setpoint doesn't kick the output
+    int64_t result = ((int64_t)_gains.kp * error) + _integral - ((int64_t)_gains.kd * (input - _lastInput));
+
+    // Back to output units, rounding to the nearest
+    result = (result + (1 << (GAIN_BITS - 1))) >> GAIN_BITS;
+    if (result > _outMax) {
+        result = _outMax;
+    } else if (result < _outMin) {
+        result = _outMin;
+    }
+    _output = (int32_t)result;
+
+    _lastInput = input;
+    _lastError = error;
+    _lastTime = now;
+    return true;
+}
+
+/**
+ * @returns The output
+ */
+int32_t Ohmbrewer::PIDController::getOutput() const {
+    return _output;
+}
+
+/**
+ * Scales a gain, rounding to the nearest step
+ * @param gain The gain, already in output per raw unit (per sample)
+ * @param scaled Set to the gain << GAIN_BITS
+ * @returns Whether the gain fit
+ */
+bool Ohmbrewer::PIDController::scaleGain(double gain, int32_t &scaled) {
+    double shifted = (gain * (1L << GAIN_BITS)) + 0.5;
+
+    if (shifted >= 2147483647.0) {
+        return false;
+    }
+
+    scaled = (int32_t)shifted;
+    return true;
+}
+
+/**
+ * Clamps the integral to the output limits
+ */
+void Ohmbrewer::PIDController::clampIntegral() {
+    if (_integral > ((int64_t)_outMax << GAIN_BITS)) {
+        _integral = (int64_t)_outMax << GAIN_BITS;
+    } else if (_integral < ((int64_t)_outMin << GAIN_BITS)) {
+        _integral = (int64_t)_outMin << GAIN_BITS;
+    }
+}
@@ -0,0 +1,217 @@
+/**
+ * This library provides the PIDController class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_PID_CONTROLLER_H
+#define OHMBREWER_PID_CONTROLLER_H
+
+#include "Ohmbrewer_PID_Profile.h"
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * A PID loop in fixed point, for a Photon with no FPU.
+     *
+     * The input and setpoint are raw Temperatures (1/16ths of a degree Celsius) and the output is a whole number,
+     * e.g. milliseconds of element on-time per relay window. Gains are scaled once, by makeGains(), into Gains that
+     * work directly on those units at the controller's sample time, so compute() is a handful of integer multiplies
+     * and never divides. Switching gains is just copying three integers in, so they can change as often as every
+     * computation (e.g. from a GainSchedule).
+     *
+     * Like Brett Beauregard's Arduino PID library, which this replaces:
+     *   - The derivative is taken on the measurement rather than the error, so a setpoint change doesn't kick.
+     *   - The integral is kept in output units and clamped to the output limits, so it can't wind up past them.
+     *   - Going from manual to automatic starts the integral at the current output, so the output doesn't jump.
+     * Switching Gains is bumpless too: the integral takes up the difference in the proportional term.
+     */
+    class PIDController {
+
+        public:
+
+            /**
+             * Gains, scaled for a controller's units and sample time. Build them with makeGains().
+             */
+            struct Gains {
+                int32_t kp; // Output per raw unit of error, << GAIN_BITS
+                int32_t ki; // Output per raw unit of error per sample, << GAIN_BITS
+                int32_t kd; // Output per raw unit of change in input per sample, << GAIN_BITS
+            };
+
+            /**
+             * The number of fractional bits in scaled gains and in the integral
+             */
+            static const int GAIN_BITS = 16;
+
+            /**
+             * The default time between computations, in milliseconds
+             */
+            static const unsigned long DEFAULT_SAMPLE_TIME = 100;
+
+            /**
+             * The widest the output limits can be. Keeps the integral and each term inside 32 bits once shifted back.
+             */
+            static const int32_t MAX_OUTPUT = 32767;
+
+            /**
+             * Constructor. The controller starts in manual, with an output of outMin.
+             * @param outMin The lowest output
+             * @param outMax The highest output
+             * @param inputScale Raw input units per unit of the gains, e.g. Temperature::ONE_DEGREE for gains per degree
+             * @param sampleTime The time between computations, in milliseconds
+             */
+            PIDController(int32_t outMin, int32_t outMax, int32_t inputScale,
+                          unsigned long sampleTime = DEFAULT_SAMPLE_TIME);
+
+            /**
+             * Destructor
+             */
+            virtual ~PIDController();
+
+            /**
+             * Scales a profile's gains for a controller's units and sample time.
+             * @param profile The gains, in output units per unit of input (and per second, for I and D)
+             * @param inputScale Raw input units per unit of the gains
+             * @param sampleTime The controller's time between computations, in milliseconds
+             * @param gains Set to the scaled gains
+             * @returns Whether the gains could be scaled - they must be positive, and small enough to fit
+             */
+            static bool makeGains(const PIDProfile &profile, int32_t inputScale, unsigned long sampleTime, Gains &gains);
+
+            /**
+             * Scales a profile's gains for this controller's units and sample time.
+             * @param profile The gains, in output units per unit of input (and per second, for I and D)
+             * @param gains Set to the scaled gains
+             * @returns Whether the gains could be scaled - they must be positive, and small enough to fit
+             */
+            bool makeGains(const PIDProfile &profile, Gains &gains) const;
+
+            /**
+             * Sets the gains the controller uses. Switching is bumpless.
+             * @param gains The scaled gains. They're copied.
+             */
+            void setGains(const Gains &gains);
+
+            /**
+             * @returns The gains the controller is using - all zero if it hasn't been given any
+             */
+            const Gains& getGains() const;
+
+            /**
+             * Changes the output limits, clamping the output and the integral to them
+             * @param outMin The lowest output
+             * @param outMax The highest output
+             */
+            void setOutputLimits(int32_t outMin, int32_t outMax);
+
+            /**
+             * Switches between automatic and manual. Going to automatic carries on from the current output.
+             * @param automatic Whether the controller should compute its output
+             * @param input The current input, so the derivative doesn't kick on the first computation
+             */
+            void setAutomatic(bool automatic, int32_t input);
+
+            /**
+             * @returns Whether the controller is computing its output
+             */
+            bool isAutomatic() const;
+
+            /**
+             * Sets the output, as when the controller is in manual.
+             * @param output The output. It's clamped to the output limits.
+             */
+            void setOutput(int32_t output);
+
+            /**
+             * Recomputes the output, if the sample time has passed since it was last computed. Cheap enough to
+             * call every loop. Takes constant time.
+             * @param input The measurement, e.g. the current raw Temperature
+             * @param setpoint Where the measurement should be
+             * @returns Whether the output was recomputed
+             */
+            bool compute(int32_t input, int32_t setpoint);
+
+            /**
+             * @returns The output
+             */
+            int32_t getOutput() const;
+
+        protected:
+
+            /**
+             * The gains in use
+             */
+            Gains _gains;
+
+            /**
+             * Whether the controller has been given gains
+             */
+            bool _hasGains;
+
+            /**
+             * Raw input units per unit of the gains
+             */
+            int32_t _inputScale;
+
+            /**
+             * The time between computations, in milliseconds
+             */
+            unsigned long _sampleTime;
+
+            /**
+             * The lowest output
+             */
+            int32_t _outMin;
+
+            /**
+             * The highest output
+             */
+            int32_t _outMax;
+
+            /**
+             * The output
+             */
+            int32_t _output;
+
+            /**
+             * The integral term, in output units << GAIN_BITS
+             */
+            int64_t _integral;
+
+            /**
+             * The input at the last computation
+             */
+            int32_t _lastInput;
+
+            /**
+             * The error at the last computation
+             */
+            int32_t _lastError;
+
+            /**
+             * millis() at the last computation
+             */
+            unsigned long _lastTime;
+
+            /**
+             * Whether the controller is computing its output
+             */
+            bool _automatic;
+
+            /**
+             * Scales a gain, rounding to the nearest step
+             * @param gain The gain, already in output per raw unit (per sample)
+             * @param scaled Set to the gain << GAIN_BITS
+             * @returns Whether the gain fit
+             */
+            static bool scaleGain(double gain, int32_t &scaled);
+
+            /**
+             * Clamps the integral to the output limits
+             */
+            void clampIntegral();
+    };
+};
+
+#endif
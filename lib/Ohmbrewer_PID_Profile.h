@@ -8,6 +8,15 @@ namespace Ohmbrewer {
 
     public:
 
+        /**
+         * Constructor. All of the terms are 0.
+         */
+        PIDProfile() {
+            _kP = 0;
+            _kI = 0;
+            _kD = 0;
+        }
+
         /**
          * Constructor
          * @param p P term
@@ -24,19 +33,19 @@ namespace Ohmbrewer {
          * Getter for the P term
          * @returns P
          */
-        const double kP() { return _kP; }
+        const double kP() const { return _kP; }
 
         /**
          * Getter for the I term
          * @returns I
          */
-        const double kI() { return _kI; }
+        const double kI() const { return _kI; }
 
         /**
          * Getter for the D term
          * @returns D
          */
-        const double kD() { return _kD; }
+        const double kD() const { return _kD; }
 
     protected:
         /**
@@ -0,0 +1,132 @@
+#include "Ohmbrewer_Pin_Allocator.h"
+#include "Ohmbrewer_Equipment.h"
+
+/**
+ * Constructor
+ * @param sharedPins The pins any number of Sprouts may claim at once
+ */
+Ohmbrewer::PinAllocator::PinAllocator(pin_mask_t sharedPins) {
+    _shared = sharedPins;
+    clear();
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::PinAllocator::~PinAllocator() {
+    // Nothing to do here...
+}
+
+/**
+ * @param pin A pin number
+ * @returns The set holding just that pin, or no pins if it's out of range
+ */
+Ohmbrewer::PinAllocator::pin_mask_t Ohmbrewer::PinAllocator::maskOf(int pin) {
+    if (pin < 0 || pin >= MAX_PINS) {
+        return 0;
+    }
+    return ((pin_mask_t)1) << pin;
+}
+
+/**
+ * @param pins Some pin numbers
+ * @returns The set of those pins
+ */
+Ohmbrewer::PinAllocator::pin_mask_t Ohmbrewer::PinAllocator::maskOf(const std::list<int>* pins) {
+    pin_mask_t mask = 0;
+
+    for (std::list<int>::const_iterator itr = pins->begin(); itr != pins->end(); itr++) {
+        mask |= maskOf(*itr);
+    }
+
+    return mask;
+}
+
+/**
+ * @param sprout A Sprout
+ * @returns The set of pins the Sprout reports it's connected to
+ */
+Ohmbrewer::PinAllocator::pin_mask_t Ohmbrewer::PinAllocator::maskOf(Equipment* sprout) {
+    std::list<int> pins;
+    sprout->whichPins(&pins);
+    return maskOf(&pins);
+}
+
+/**
+ * Determines if any of the pins are already claimed, including shared pins in use
+ * @param pins The pins to check for
+ * @returns Whether any of them are in use
+ */
+bool Ohmbrewer::PinAllocator::inUse(pin_mask_t pins) const {
+    return (pins & (_exclusive | _sharedInUse)) != 0;
+}
+
+/**
+ * Claims every pin a Sprout is connected to on its behalf. Either all of them are claimed or none are.
+ * @param sprout The Sprout
+ * @returns Whether the pins were claimed - false if any of its unshared pins are in use
+ */
+bool Ohmbrewer::PinAllocator::claim(Equipment* sprout) {
+    pin_mask_t pins = maskOf(sprout);
+    pin_mask_t exclusive = pins & ~_shared;
+    pin_mask_t shared = pins & _shared;
+
+    // Unshared pins can't overlap anything; shared pins only can't overlap an exclusive claim
+    if (inUse(exclusive) || (shared & _exclusive) != 0) {
+        return false;
+    }
+
+    for (int pin = 0; pin < MAX_PINS; pin++) {
+        if (exclusive & maskOf(pin)) {
+            _owners[pin] = sprout;
+        } else if (shared & maskOf(pin)) {
+            _users[pin]++;
+        }
+    }
+
+    _exclusive |= exclusive;
+    _sharedInUse |= shared;
+    return true;
+}
+
+/**
+ * Releases every pin a Sprout claimed, at once
+ * @param sprout The Sprout
+ */
+void Ohmbrewer::PinAllocator::release(Equipment* sprout) {
+    pin_mask_t pins = maskOf(sprout);
+
+    for (int pin = 0; pin < MAX_PINS; pin++) {
+        pin_mask_t bit = maskOf(pin);
+
+        if ((pins & _exclusive & bit) && _owners[pin] == sprout) {
+            _owners[pin] = NULL;
+            _exclusive &= ~bit;
+        } else if ((pins & _sharedInUse & bit) && --_users[pin] == 0) {
+            _sharedInUse &= ~bit;
+        }
+    }
+}
+
+/**
+ * Releases every pin
+ */
+void Ohmbrewer::PinAllocator::clear() {
+    _exclusive = 0;
+    _sharedInUse = 0;
+    for (int pin = 0; pin < MAX_PINS; pin++) {
+        _owners[pin] = NULL;
+        _users[pin] = 0;
+    }
+}
+
+/**
+ * @param pin A pin number
+ * @returns The Sprout that owns the pin, or NULL if it's unclaimed or shared
+ */
+Ohmbrewer::Equipment* Ohmbrewer::PinAllocator::ownerOf(int pin) const {
+    if (maskOf(pin) == 0) {
+        return NULL;
+    }
+    return _owners[pin];
+}
@@ -0,0 +1,134 @@
+/**
+ * This library provides the PinAllocator class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_PIN_ALLOCATOR_H
+#define OHMBREWER_PIN_ALLOCATOR_H
+
+#undef min
+#undef max
+#undef swap
+#include <list>
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    class Equipment;
+
+    /**
+     * Keeps track of which of the Photon's pins belong to which Sprout.
+     *
+     * Pins are held as a bitmap, one bit per pin number, so checking a whole Sprout's worth of pins against
+     * everything already claimed is a single AND. Each claimed pin remembers the Sprout that owns it.
+     *
+     * Some pins are shared by design - every onewire probe reports the onewire bus pin - so the allocator
+     * is told up front which pins are shared. Any number of Sprouts can claim a shared pin, but no Sprout
+     * can claim it exclusively (e.g. as a relay pin) while anything is using it, and vice versa.
+     *
+     * Pin numbers outside 0 to MAX_PINS - 1 (Relays use -1 for "no pin") are ignored.
+     */
+    class PinAllocator {
+
+        public:
+
+            /**
+             * A set of pins, one bit per pin number
+             */
+            typedef uint32_t pin_mask_t;
+
+            /**
+             * One more than the highest pin number the allocator can track
+             */
+            static const int MAX_PINS = 32;
+
+            /**
+             * Constructor
+             * @param sharedPins The pins any number of Sprouts may claim at once
+             */
+            PinAllocator(pin_mask_t sharedPins);
+
+            /**
+             * Destructor
+             */
+            virtual ~PinAllocator();
+
+            /**
+             * @param pin A pin number
+             * @returns The set holding just that pin, or no pins if it's out of range
+             */
+            static pin_mask_t maskOf(int pin);
+
+            /**
+             * @param pins Some pin numbers
+             * @returns The set of those pins
+             */
+            static pin_mask_t maskOf(const std::list<int>* pins);
+
+            /**
+             * @param sprout A Sprout
+             * @returns The set of pins the Sprout reports it's connected to
+             */
+            static pin_mask_t maskOf(Equipment* sprout);
+
+            /**
+             * Determines if any of the pins are already claimed, including shared pins in use
+             * @param pins The pins to check for
+             * @returns Whether any of them are in use
+             */
+            bool inUse(pin_mask_t pins) const;
+
+            /**
+             * Claims every pin a Sprout is connected to on its behalf. Either all of them are claimed or none are.
+             * @param sprout The Sprout
+             * @returns Whether the pins were claimed - false if any of its unshared pins are in use
+             */
+            bool claim(Equipment* sprout);
+
+            /**
+             * Releases every pin a Sprout claimed, at once
+             * @param sprout The Sprout
+             */
+            void release(Equipment* sprout);
+
+            /**
+             * Releases every pin
+             */
+            void clear();
+
+            /**
+             * @param pin A pin number
+             * @returns The Sprout that owns the pin, or NULL if it's unclaimed or shared
+             */
+            Equipment* ownerOf(int pin) const;
+
+        protected:
+
+            /**
+             * The pins any number of Sprouts may claim at once
+             */
+            pin_mask_t _shared;
+
+            /**
+             * The pins claimed by one Sprout alone
+             */
+            pin_mask_t _exclusive;
+
+            /**
+             * The shared pins at least one Sprout has claimed
+             */
+            pin_mask_t _sharedInUse;
+
+            /**
+             * The owner of each exclusively claimed pin
+             */
+            Equipment* _owners[MAX_PINS];
+
+            /**
+             * How many Sprouts have claimed each shared pin
+             */
+            uint8_t _users[MAX_PINS];
+    };
+};
+
+#endif
@@ -5,7 +5,7 @@
  * Constructor
  */
 Ohmbrewer::Probe::Probe(){
-
+    _lastReadTime = 0;
 }
 
 /**
@@ -16,6 +16,14 @@ int Ohmbrewer::Probe::getID() const {
     return -1;
 }
 
+/**
+ * The time at which the value returned by getReading() was taken
+ * @returns millis() at the last completed reading, or 0 if no reading has completed yet
+ */
+unsigned long Ohmbrewer::Probe::getLastReadTime() const {
+    return _lastReadTime;
+}
+
 /**
 * Destructor
 */
@@ -3,6 +3,7 @@
 #define RHIZOME_OHMBREWER_PROBE_H
 
 //#include "Ohmbrewer_Temperature_Sensor.h"
+#include "application.h"
 
 
 namespace Ohmbrewer {
@@ -12,9 +13,9 @@ namespace Ohmbrewer {
     public:
 
         /**
-         * @returns the Celsius temperature reading from the connected probe
+         * @returns the temperature reading from the connected probe, in 1/16ths of a degree Celsius
          */
-        virtual double getReading() = 0;
+        virtual int32_t getReading() = 0;
 
         /**
          * Constructor
@@ -37,11 +38,22 @@ namespace Ohmbrewer {
          */
         virtual int getPin() = 0;
 
+        /**
+         * The time at which the value returned by getReading() was taken
+         * @returns millis() at the last completed reading, or 0 if no reading has completed yet
+         */
+        unsigned long getLastReadTime() const;
+
     protected:
         /**
          * Digital pin that the data stream is on
          */
         int _dataPin;
+
+        /**
+         * millis() at the last completed reading
+         */
+        unsigned long _lastReadTime;
     };
 };
 #endif
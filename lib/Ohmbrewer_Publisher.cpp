@@ -1,27 +1,48 @@
 #include "Ohmbrewer_Publisher.h"
 
 /**
- * The JSON representation of the provided keys and values.
- * Expects all values to be Strings, so if you need nested objects or arrays
- * you'll have to do the conversion yourself.
- * @returns JSON string of the map provided to the Publisher instance
+ * The JSON representation of the provided keys and values, in order of their keys.
+ * Every value is written as a JSON string, as it always has been.
+ * @param buffer Where to write the JSON. Always null terminated.
+ * @param size The size of the buffer
+ * @returns The length of the full JSON, which is size or more if it didn't fit
  */
-String Ohmbrewer::Publisher::toJSON() const {
-    String returnVal = String("{");
-
-    for(publish_map_t::const_iterator itr = _data->begin(); itr != _data->end(); ++itr) {
-        returnVal.concat(" \"");
-        returnVal.concat(itr->first);
-        returnVal.concat("\": \"");
-        returnVal.concat(itr->second);
-        returnVal.concat("\"");
-        if(itr->first != _data->rbegin()->first) {
-            returnVal.concat(",");
+int Ohmbrewer::Publisher::toJSON(char* buffer, int size) const {
+    int length = 0;
+
+    // Like snprintf(), keep counting once the buffer's full so the caller can tell it was cut short
+    auto append = [&](int written) {
+        if (written > 0) {
+            length += written;
+        }
+    };
+    auto remaining = [&]() -> char* { return length < size ? buffer + length : NULL; };
+    auto room = [&]() -> size_t { return length < size ? (size_t)(size - length) : 0; };
+
+    append(snprintf(remaining(), room(), "{"));
+
+    for (int i = 0; i < _numFields; i++) {
+        const Field &field = _data[i];
+
+        switch (field.type) {
+            case TEXT:
+                append(snprintf(remaining(), room(), " \"%s\": \"%s\"", field.key, field.text));
+                break;
+            case INTEGER:
+                append(snprintf(remaining(), room(), " \"%s\": \"%ld\"", field.key, field.integer));
+                break;
+            case REAL:
+                append(snprintf(remaining(), room(), " \"%s\": \"%.*f\"", field.key, field.decimalPlaces, field.real));
+                break;
+        }
+
+        if (i < _numFields - 1) {
+            append(snprintf(remaining(), room(), ","));
         }
     }
-    returnVal.concat(" }");
+    append(snprintf(remaining(), room(), " }"));
 
-    return returnVal;
+    return length;
 }
 
 /**
@@ -29,51 +50,89 @@ String Ohmbrewer::Publisher::toJSON() const {
  * @returns int Time taken to do the publishing
  */
 int Ohmbrewer::Publisher::publish() const {
-    unsigned long start = millis();
+    // Publishing only ever happens from the main loop, so every Publisher can share one buffer
+    static char json[MAX_JSON_LENGTH + 1];
+    unsigned long start = micros();
 
-    Spark.publish(*_stream, toJSON(), 30, PRIVATE);
+    toJSON(json, sizeof(json));
+    Spark.publish(_stream, json, 30, PRIVATE);
 
-    return start - millis();
+    return micros() - start;
 }
 
 /**
  * Constructor
- * @param stream The Particle cloud event stream to publish to
- * @param data A map of data to publish as a JSON.
+ * @param stream The Particle cloud event stream to publish to. It's copied.
  */
-Ohmbrewer::Publisher::Publisher(String *stream, publish_map_t *data) {
-    _stream = stream;
-    _data = data;
+Ohmbrewer::Publisher::Publisher(const char* stream) {
+    strncpy(_stream, stream, MAX_STREAM_LENGTH);
+    _stream[MAX_STREAM_LENGTH] = '\0';
+    _numFields = 0;
 }
 
 /**
- * Constructor that initializes the data map internally.
- * @param stream The Particle cloud event stream to publish to
+ * Constructor
+ * @param stream The Particle cloud event stream to publish to. It's copied.
+ * @param key A single key for data to publish as a JSON.
+ * @param value A single value for data to publish as a JSON.
  */
-Ohmbrewer::Publisher::Publisher(String *stream) {
-    _stream = stream;
-    _data = new publish_map_t;
+Ohmbrewer::Publisher::Publisher(const char* stream, const char* key, const char* value) : Publisher(stream) {
+    add(key, value);
 }
 
 /**
- * Constructor that adds the provided key/value pair to the Publisher's stream map.
+ * Adds the provided key/value pair to the Publisher's stream map, replacing any value the key
+ * already has. Neither the key nor the value is copied, so both must outlive the Publisher.
  * @param key A single key for data to publish as a JSON.
  * @param value A single value for data to publish as a JSON.
+ * @return Whether the key/value pair was added successfully.
  */
-Ohmbrewer::Publisher::Publisher(String *stream, String key, String value) {
-    _stream = stream;
-    _data = new publish_map_t;
-    (*_data)[key] = value;
+bool Ohmbrewer::Publisher::add(const char* key, const char* value) {
+    Field* field = fieldFor(key);
+    if (field == NULL) {
+        return false;
+    }
+
+    field->type = TEXT;
+    field->text = value;
+    return true;
 }
 
 /**
- * Constructor
- * @param stream The Particle cloud event stream to publish to
- * @param data A map of data to publish as a JSON.
+ * Adds the provided key/value pair to the Publisher's stream map, replacing any value the key
+ * already has. The key isn't copied, so it must outlive the Publisher.
+ * @param key A single key for data to publish as a JSON.
+ * @param value A single value for data to publish as a JSON.
  * @return Whether the key/value pair was added successfully.
  */
-bool Ohmbrewer::Publisher::add(String key, String value) {
-    (*_data)[key] = value;
+bool Ohmbrewer::Publisher::add(const char* key, long value) {
+    Field* field = fieldFor(key);
+    if (field == NULL) {
+        return false;
+    }
+
+    field->type = INTEGER;
+    field->integer = value;
+    return true;
+}
+
+/**
+ * Adds the provided key/value pair to the Publisher's stream map, replacing any value the key
+ * already has. The key isn't copied, so it must outlive the Publisher.
+ * @param key A single key for data to publish as a JSON.
+ * @param value A single value for data to publish as a JSON.
+ * @param decimalPlaces How many decimal places to write - by default, as many as String(double) does
+ * @return Whether the key/value pair was added successfully.
+ */
+bool Ohmbrewer::Publisher::add(const char* key, double value, int decimalPlaces) {
+    Field* field = fieldFor(key);
+    if (field == NULL) {
+        return false;
+    }
+
+    field->type = REAL;
+    field->real = value;
+    field->decimalPlaces = decimalPlaces;
     return true;
 }
 
@@ -81,12 +140,35 @@ bool Ohmbrewer::Publisher::add(String key, String value) {
  * Clears the internal data map
  */
 void Ohmbrewer::Publisher::clear() {
-    (*_data).clear();
+    _numFields = 0;
 }
 
 /**
- * Destructor
+ * Finds the field for a key, making room for it if it's new
+ * @param key The key
+ * @returns The key's field, or NULL if it's new and the Publisher is full
  */
-Ohmbrewer::Publisher::~Publisher() {
-    delete _stream;
+Ohmbrewer::Publisher::Field* Ohmbrewer::Publisher::fieldFor(const char* key) {
+    // Keys are kept sorted, the same order the std::map we used to keep them in had
+    int i = 0;
+    while (i < _numFields && strcmp(_data[i].key, key) < 0) {
+        i++;
+    }
+
+    if (i < _numFields && strcmp(_data[i].key, key) == 0) {
+        return &_data[i];
+    }
+
+    if (_numFields >= MAX_FIELDS) {
+        return NULL;
+    }
+
+    for (int j = _numFields; j > i; j--) {
+        _data[j] = _data[j - 1];
+    }
+    _numFields++;
+
+    _data[i].key = key;
+    _data[i].decimalPlaces = 0;
+    return &_data[i];
 }
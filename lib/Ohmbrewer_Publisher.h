@@ -6,28 +6,42 @@
 #ifndef OHMBREWER_PUBLISHER_H
 #define OHMBREWER_PUBLISHER_H
 
-// Kludge to allow us to use std::map - for now we have to undefine these macros.
-#undef min
-#undef max
-#undef swap
-#include <map>
 #include "application.h"
 
 namespace Ohmbrewer {
 
+    /**
+     * Publishes a flat JSON object of key/value pairs to a Particle cloud event stream.
+     * Nothing is allocated: the keys and values live in a small inline array, and the JSON is written
+     * into a fixed buffer shared by every Publisher.
+     */
     class Publisher {
 
         public:
 
-            typedef std::map<String, String> publish_map_t;
+            /**
+             * The most key/value pairs a single message can hold
+             */
+            static const int MAX_FIELDS = 8;
+
+            /**
+             * The longest event stream name the Particle cloud accepts
+             */
+            static const int MAX_STREAM_LENGTH = 63;
 
             /**
-             * The JSON representation of the provided keys and values.
-             * Expects all values to be Strings, so if you need nested objects or arrays
-             * you'll have to do the conversion yourself.
-             * @returns JSON string of the map provided to the Publisher instance
+             * The longest JSON a single message can be - the limit on a Particle event's data
              */
-            String toJSON() const;
+            static const int MAX_JSON_LENGTH = 255;
+
+            /**
+             * The JSON representation of the provided keys and values, in order of their keys.
+             * Every value is written as a JSON string, as it always has been.
+             * @param buffer Where to write the JSON. Always null terminated.
+             * @param size The size of the buffer
+             * @returns The length of the full JSON, which is size or more if it didn't fit
+             */
+            int toJSON(char* buffer, int size) const;
 
             /**
              * Where we actually publish the provided information
@@ -37,56 +51,98 @@ namespace Ohmbrewer {
 
             /**
              * Constructor
-             * @param stream The Particle cloud event stream to publish to
-             * @param data A map of data to publish as a JSON.
+             * @param stream The Particle cloud event stream to publish to. It's copied.
              */
-            Publisher(String *stream, publish_map_t *data);
+            Publisher(const char* stream);
 
             /**
-             * Constructor that initializes the data map internally.
-             * @param stream The Particle cloud event stream to publish to
+             * Constructor
+             * @param stream The Particle cloud event stream to publish to. It's copied.
+             * @param key A single key for data to publish as a JSON.
+             * @param value A single value for data to publish as a JSON.
              */
-            Publisher(String *stream);
+            Publisher(const char* stream, const char* key, const char* value);
 
             /**
-             * Constructor
-             * @param stream The Particle cloud event stream to publish to
+             * Adds the provided key/value pair to the Publisher's stream map, replacing any value the key
+             * already has. Neither the key nor the value is copied, so both must outlive the Publisher.
              * @param key A single key for data to publish as a JSON.
              * @param value A single value for data to publish as a JSON.
+             * @return Whether the key/value pair was added successfully.
              */
-            Publisher(String *stream, String key, String value);
+            bool add(const char* key, const char* value);
 
             /**
-             * Adds the provided key/value pair to the Publisher's stream map.
+             * Adds the provided key/value pair to the Publisher's stream map, replacing any value the key
+             * already has. The key isn't copied, so it must outlive the Publisher.
              * @param key A single key for data to publish as a JSON.
              * @param value A single value for data to publish as a JSON.
              * @return Whether the key/value pair was added successfully.
              */
-            bool add(String key, String value);
+            bool add(const char* key, long value);
+
+            /**
+             * Adds the provided key/value pair to the Publisher's stream map, replacing any value the key
+             * already has. The key isn't copied, so it must outlive the Publisher.
+             * @param key A single key for data to publish as a JSON.
+             * @param value A single value for data to publish as a JSON.
+             * @param decimalPlaces How many decimal places to write - by default, as many as String(double) does
+             * @return Whether the key/value pair was added successfully.
+             */
+            bool add(const char* key, double value, int decimalPlaces = 6);
 
             /**
              * Clears the internal data map
              */
             void clear();
-            
+
+        protected:
+
             /**
-             * Destructor
+             * The kinds of value a field can hold
              */
-            virtual ~Publisher();
-    
-        protected:
+            enum ValueType {
+                TEXT,
+                INTEGER,
+                REAL
+            };
+
+            /**
+             * A single key/value pair
+             */
+            struct Field {
+                const char* key;
+                ValueType type;
+                int decimalPlaces;
+                union {
+                    const char* text;
+                    long integer;
+                    double real;
+                };
+            };
+
             /**
-             * The map of the JSON objects to publish, in order of presentation
+             * The key/value pairs to publish, kept in order of their keys
              */
-            publish_map_t* _data;
+            Field _data[MAX_FIELDS];
+
+            /**
+             * The number of key/value pairs in _data
+             */
+            int _numFields;
 
             /**
              * The stream to publish to
              */
-            String* _stream;
+            char _stream[MAX_STREAM_LENGTH + 1];
+
+            /**
+             * Finds the field for a key, making room for it if it's new
+             * @param key The key
+             * @returns The key's field, or NULL if it's new and the Publisher is full
+             */
+            Field* fieldFor(const char* key);
     };
 };
 
 #endif
-
-
@@ -1,4 +1,5 @@
 #include "Ohmbrewer_Pump.h"
+#include "Ohmbrewer_Sprout_Registry.h"
 
 /**
  * Constructor
@@ -38,6 +39,35 @@ Ohmbrewer::Pump::~Pump() {
     // Nothing to do here...
 }
 
+/**
+ * Allocates from the pool of Pumps rather than the heap (see getPool())
+ * @param size The size of the object
+ * @returns The memory for it
+ */
+void* Ohmbrewer::Pump::operator new(size_t size) {
+    return getPool()->allocate(size);
+}
+
+/**
+ * Gives the memory back to the pool of Pumps
+ * @param ptr The memory
+ */
+void Ohmbrewer::Pump::operator delete(void* ptr) {
+    getPool()->release(ptr);
+}
+
+/**
+ * @returns The pool Pumps are allocated from, sized for the most the Rhizome may have
+ *          (see SproutRegistry)
+ */
+Ohmbrewer::ObjectPool* Ohmbrewer::Pump::getPool() {
+    // Every Pump Sprout, plus each RIMS's recirculation pump
+    const int size = SproutRegistry::MAX_PUMPS + SproutRegistry::MAX_RIMS;
+    static uint64_t storage[ObjectPool::words(sizeof(Pump), size)];
+    static ObjectPool pool = ObjectPool(storage, sizeof(Pump), size);
+    return &pool;
+}
+
 /**
  * Draws information to the Rhizome's display.
  * This function is called by display().
@@ -50,21 +80,9 @@ int Ohmbrewer::Pump::doDisplay(Ohmbrewer::Screen *screen) {
 /**
  * Publishes updates to Ohmbrewer, etc.
  * This function is called by update().
- * @param args The argument string passed into the Particle Cloud
- * @param argsMap A map representing the key/value pairs for the update
- * @returns The time taken to run the method
- */
-int Ohmbrewer::Pump::doUpdate(String &args, Ohmbrewer::Equipment::args_map_t &argsMap) {
-    return Relay::doUpdate(args, argsMap);
-}
-
-/**
- * Specifies the interface for arguments sent to this Equipment's associated function.
- * Parses the supplied string into an array of strings for setting the Equipment's values.
- * Most likely will be called during update().
- * @param argsStr The arguments supplied as an update to the Rhizome.
- * @param result A map representing the key/value pairs for the update
+ * @param args The rest of the arguments passed into the Particle Cloud
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
  */
-void Ohmbrewer::Pump::parseArgs(const String &argsStr, Ohmbrewer::Equipment::args_map_t &result) {
-    // Nothing special to parse out for this class.
+int Ohmbrewer::Pump::doUpdate(CommandParser &args) {
+    return Relay::doUpdate(args);
 }
@@ -13,6 +13,7 @@
 #include <list>
 #include "Ohmbrewer_Relay.h"
 #include "application.h"
+#include "Ohmbrewer_Object_Pool.h"
 
 namespace Ohmbrewer {
 
@@ -26,19 +27,16 @@ namespace Ohmbrewer {
             const static constexpr char* TYPE_NAME = "pump";
 
             /**
-             * Specifies the interface for arguments sent to this Equipment's associated function.
-             * Parses the supplied string into an array of strings for setting the Equipment's values.
-             * Most likely will be called during update().
-             * @param argsStr The arguments supplied as an update to the Rhizome.
-             * @param result A map representing the key/value pairs for the update
+             * The Equipment Type
+             * @returns The Equipment type name
              */
-            static void parseArgs(const String &argsStr, args_map_t &result);
+            virtual const char* getType() const { return Pump::TYPE_NAME; };
 
             /**
              * The Equipment Type
-             * @returns The Equipment type name
+             * @returns The Equipment type code
              */
-            virtual const char* getType() const { return Pump::TYPE_NAME; };
+            virtual TypeCode getTypeCode() const { return TYPE_PUMP; };
 
             /**
              * Constructor
@@ -66,6 +64,25 @@ namespace Ohmbrewer {
              */
             virtual ~Pump();
 
+            /**
+             * Allocates from the pool of Pumps rather than the heap (see getPool())
+             * @param size The size of the object
+             * @returns The memory for it
+             */
+            static void* operator new(size_t size);
+
+            /**
+             * Gives the memory back to the pool of Pumps
+             * @param ptr The memory
+             */
+            static void operator delete(void* ptr);
+
+            /**
+             * @returns The pool Pumps are allocated from, sized for the most the Rhizome may have
+             *          (see SproutRegistry)
+             */
+            static ObjectPool* getPool();
+
             /**
              * Draws information to the Rhizome's display.
              * This function is called by display().
@@ -77,11 +94,10 @@ namespace Ohmbrewer {
             /**
              * Publishes updates to Ohmbrewer, etc.
              * This function is called by update().
-             * @param args The argument string passed into the Particle Cloud
-             * @param argsMap A map representing the key/value pairs for the update
-             * @returns The time taken to run the method
+             * @param args The rest of the arguments passed into the Particle Cloud
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
              */
-            int doUpdate(String &args, args_map_t &argsMap);
+            int doUpdate(CommandParser &args);
 
 
     };
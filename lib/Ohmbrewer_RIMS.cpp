@@ -3,6 +3,7 @@
 #include "Ohmbrewer_Publisher.h"
 #include "Ohmbrewer_Onewire.h"
 #include "Ohmbrewer_Temperature.h"
+#include "Ohmbrewer_Sprout_Registry.h"
 
 
 /**
@@ -57,6 +58,8 @@ Ohmbrewer::RIMS::RIMS(std::list<int>* thermPins, int pumpPin, int safetyIndex, i
 Ohmbrewer::RIMS::RIMS(const Ohmbrewer::RIMS& clonee) : Ohmbrewer::Equipment(clonee) {
     _tube = clonee.getTube();
     _recirc = clonee.getRecirculator();
+    _pumpOverride = clonee.getPumpOverride();
+    _tubeEvents = new EventGate(this, "thermostat");
 
 //    registerUpdateFunction();
 }
@@ -69,6 +72,35 @@ Ohmbrewer::RIMS::~RIMS() {
     delete _tube;
     delete _safetySensor;
     delete _safetyTemp;
+    delete _tubeEvents;
+}
+
+/**
+ * Allocates from the pool of RIMSes rather than the heap (see getPool())
+ * @param size The size of the object
+ * @returns The memory for it
+ */
+void* Ohmbrewer::RIMS::operator new(size_t size) {
+    return getPool()->allocate(size);
+}
+
+/**
+ * Gives the memory back to the pool of RIMSes
+ * @param ptr The memory
+ */
+void Ohmbrewer::RIMS::operator delete(void* ptr) {
+    getPool()->release(ptr);
+}
+
+/**
+ * @returns The pool RIMSes are allocated from, sized for the most the Rhizome may have
+ *          (see SproutRegistry)
+ */
+Ohmbrewer::ObjectPool* Ohmbrewer::RIMS::getPool() {
+    const int size = SproutRegistry::MAX_RIMS;
+    static uint64_t storage[ObjectPool::words(sizeof(RIMS), size)];
+    static ObjectPool pool = ObjectPool(storage, sizeof(RIMS), size);
+    return &pool;
 }
 
 /**
@@ -78,8 +110,9 @@ Ohmbrewer::RIMS::~RIMS() {
  * @param safetyIndex - onewire index of the probe attached for safetySensor (RIMS tube)
  */
 void Ohmbrewer::RIMS::initRIMS(std::list<int>* thermPins, int pumpPin, int safetyIndex){
+    _tubeEvents = new EventGate(this, "thermostat");
     int size = thermPins->size();
-    if ( (size == 4) ){
+    if ( (size == 3 || size == 4) ){ // The heating element's power pin is optional
 
         //busPin unused for now
         _safetySensor = new TemperatureSensor(new Onewire(safetyIndex));
@@ -88,13 +121,11 @@ void Ohmbrewer::RIMS::initRIMS(std::list<int>* thermPins, int pumpPin, int safet
         //set therm timer?
     }else{//incorrect number of pins supplied
         //publish error
-        Ohmbrewer::Publisher::publish_map_t pMap;
-        Ohmbrewer::Publisher* pub = new Ohmbrewer::Publisher(new String("error_log"), &pMap);
-        pMap[String("list_check_rims")] = String("improperly formed array - RIMS(int, int<list>, int");
-        pub->publish();
-        delete pub;
+        Ohmbrewer::Publisher pub("error_log", "list_check_rims", "improperly formed array - RIMS(int, int<list>, int");
+        pub.publish();
     }
     _recirc = new Pump(pumpPin);
+    _pumpOverride = CommandParser::SWITCH_UNCHANGED;
     _safetyTemp = new Temperature();
 }
 
@@ -136,9 +167,9 @@ Ohmbrewer::Temperature* Ohmbrewer::RIMS::getSafetyTemp() const{
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::RIMS::setSafetyTemp(const double safetyTemp){
-    unsigned long start = millis();
+    unsigned long start = micros();
     _safetyTemp->set(safetyTemp);
-    return start - millis();
+    return micros() - start;
 }
 /**
  * The Thermostat's safety temperature sensor
@@ -154,9 +185,9 @@ Ohmbrewer::TemperatureSensor* Ohmbrewer::RIMS::getSafetySensor() const{
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::RIMS::setSafetySensor(Ohmbrewer::TemperatureSensor* sensor){
-    unsigned long start = millis();
+    unsigned long start = micros();
     _safetySensor = sensor;
-    return start - millis();
+    return micros() - start;
 }
 
 /**
@@ -167,46 +198,47 @@ Ohmbrewer::Pump* Ohmbrewer::RIMS::getRecirculator() const {
     return _recirc;
 }
 
+/**
+ * Forces the recirculation pump on or off, e.g. for a step program's rest, rather than running it
+ * only while the tube is hotter than the tun (see PUMP_MARGIN)
+ * @param pumpState SWITCH_ON or SWITCH_OFF to force the pump, or SWITCH_UNCHANGED to go back to the margin
+ * @returns The time taken to run the method
+ */
+const int Ohmbrewer::RIMS::setPumpOverride(const CommandParser::Switch pumpState) {
+    unsigned long start = micros();
+    _pumpOverride = pumpState;
+    return micros() - start;
+}
+
+/**
+ * Whether the recirculation pump is being forced on or off
+ * @returns SWITCH_ON or SWITCH_OFF if it's forced, or SWITCH_UNCHANGED if it follows the margin
+ */
+Ohmbrewer::CommandParser::Switch Ohmbrewer::RIMS::getPumpOverride() const {
+    return _pumpOverride;
+}
+
 /**
  * Specifies the interface for arguments sent to this Equipment's associated function.
- * Parses the supplied string into an array of strings for setting the Equipment's values.
+ * Reads the arguments particular to a RIMS, which follow the common ones.
  * Most likely will be called during update().
- * @param argsStr The arguments supplied as an update to the Rhizome.
- * @param result A map reprsenting the key/value pairs for the update
- */
-void Ohmbrewer::RIMS::parseArgs(const String &argsStr, Ohmbrewer::Equipment::args_map_t &result) {
-
-    if(argsStr.length() > 0) {
-        // FIXME These should probably be converted into private const variables
-        String safetySensorKey = String("safety_sensor_state");
-        String rPumpKey = String("r_pump_state");
-        String thermKey = String("therm_params");
-        char* params = new char[argsStr.length() + 1];
-        strcpy(params, argsStr.c_str());
-
-        // Parse the parameters
-        String tunSensorState = String(strtok(params, ","));
-        String rPumpState     = String(strtok(NULL, ","));
-
-        // Save them to the map
-        if(tunSensorState.length() > 0) {
-            result[safetySensorKey] = tunSensorState;
-        }
-        if(rPumpState.length() > 0) {
-            result[rPumpKey] = rPumpState;
-        }
-
-        result[thermKey] = argsStr.substring(tunSensorState.length() + rPumpState.length() + 2);
+ * @param args The arguments supplied as an update to the Rhizome.
+ * @param result The arguments, parsed
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+ */
+int Ohmbrewer::RIMS::parseArgs(CommandParser &args, RIMSArgs &result) {
+    int errorCode = args.nextSwitch(result.safetySensorState);
 
-        // Serial.println("Got these additional RIMS results: ");
-        // Serial.println(tunSensorState);
-        // Serial.println(rPumpState);
-        // Serial.println(result[thermKey]);
+    if(errorCode == CommandParser::ParseError::NONE) {
+        errorCode = args.nextSwitch(result.pumpState);
+    }
 
-        // Clear out that dynamically allocated buffer
-        delete params;
+    // The rest are for the Tube (a Thermostat)
+    if(errorCode == CommandParser::ParseError::NONE) {
+        errorCode = Thermostat::parseArgs(args, result.tube);
     }
 
+    return errorCode;
 }
 
 /**
@@ -216,14 +248,14 @@ void Ohmbrewer::RIMS::parseArgs(const String &argsStr, Ohmbrewer::Equipment::arg
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::RIMS::setState(const bool state) {
-    unsigned long start = millis();
+    unsigned long start = micros();
     _state = state;
     getTube()->setState(state);
     getTunSensor()->setState(state);
     getSafetySensor()->setState(state);
     getRecirculator()->setState(state);
 
-    return start - millis();
+    return micros() - start;
 }
 
 /**
@@ -263,47 +295,26 @@ int Ohmbrewer::RIMS::doWork() {
     //FANCY RIMS, turns the pump off to rest when tun temp is good and safety temp is good.
     if (getState()) {//IF RIMS ON
 
-        // make sure R. PUMP is ON if tube temp > tun temp +3(margin)
-        if (getSafetySensor()->getTemp()->c() > (getTunSensor()->getTemp()->c() + 3) &&
+        int32_t tube = getSafetySensor()->getTemp()->raw();
+        int32_t tun = getTunSensor()->getTemp()->raw();
+
+        // a forced pump (see setPumpOverride()) stays as it was forced,
+        // otherwise make sure R. PUMP is ON if tube temp > tun temp +3(margin)
+        if (_pumpOverride == CommandParser::SWITCH_ON) {
+            getRecirculator()->setState(true);
+        } else if (_pumpOverride == CommandParser::SWITCH_OFF) {
+            getRecirculator()->setState(false);
+        } else if (tube > (tun + PUMP_MARGIN) &&
                 !(getRecirculator()->getState()) ){
             getRecirculator()->setState(true); // turn on pump
-        }else if ( getSafetySensor()->getTemp()->c() <= (getTunSensor()->getTemp()->c() + 3) &&
+        }else if ( tube <= (tun + PUMP_MARGIN) &&
                 getRecirculator()->getState() ){
             getRecirculator()->setState(false); // turn off pump
         }
 
-        // safetySensor guard on Therm (if: tube temp > safety setting, then: NO heat )
-        if ( getSafetyTemp()->c() > getSafetySensor()->getTemp()->c() &&
-                !getTube()->getState() ) { //safety temp > tube temp(safe) and therm==OFF
-            //tube temperature < safetyTemp
-            getTube()->setState(true); // turn on therm
-
-            // Notify Ohmbrewer that the Thermostat has been turned on.
-            Publisher pub = Publisher(new String(getStream()),
-                                      String("thermostat"),
-                                      String("ON"));
-            pub.add(String("last_read_time"),
-                    String(getTube()->getSensor()->getLastReadTime()));
-            pub.add(String("temperature"),
-                    String(getTube()->getSensor()->getTemp()->c()));
-            pub.publish();
-
-        }else if ( getSafetyTemp()->c() <= getSafetySensor()->getTemp()->c() &&
-                getTube()->getState() ) {// tube temp >= safety temp and therm == ON
-            //shut therm off
-            getTube()->setState(false);//PID should be able to handle this.
-            //TODO  with timers simply stop the timer
-
-            // Notify Ohmbrewer that the Thermostat has been turned off.
-            Publisher pub = Publisher(new String(getStream()),
-                                      String("thermostat"),
-                                      String("OFF"));
-            pub.add(String("last_read_time"),
-                    String(getTube()->getSensor()->getLastReadTime()));
-            pub.add(String("temperature"),
-                    String(getTube()->getSensor()->getTemp()->c()));
-            pub.publish();
-        }
+        // safetySensor guard on Therm (if: tube temp >= safety setting, then: NO heat )
+        getTube()->setState(getSafetyTemp()->raw() > tube);
+        //TODO  with timers simply stop the timer
     }else{//IF RIMS OFF
 
         // make sure R. PUMP is OFF
@@ -311,6 +322,16 @@ int Ohmbrewer::RIMS::doWork() {
         // turn OFF therm
         getTube()->setState(false);
     }
+
+    // Notify Ohmbrewer when the Thermostat is turned on or off
+    if (_tubeEvents->update(getTube()->getState())) {
+        char stream[Publisher::MAX_STREAM_LENGTH + 1];
+        getStream(stream, sizeof(stream));
+        Publisher pub = Publisher(stream, "thermostat", getTube()->getState() ? "ON" : "OFF");
+        pub.add("last_read_time", (long)getTube()->getSensor()->getLastReadTime());
+        pub.add("temperature", getTube()->getSensor()->getTemp()->c());
+        pub.publish();
+    }
         
     getSafetySensor()->work();
     getRecirculator()->work();
@@ -367,10 +388,10 @@ unsigned long Ohmbrewer::RIMS::displayTunTemp(Ohmbrewer::Screen *screen) {
 
     uint16_t color = screen->YELLOW;
 
-    if(getTunSensor()->getTemp()->c() > getTube()->getTargetTemp()->c()) {
+    if(getTunSensor()->getTemp()->raw() > getTube()->getTargetTemp()->raw()) {
         // Too hot
         color = screen->RED;
-    } else if(getTunSensor()->getTemp()->c() < getTube()->getTargetTemp()->c()) {
+    } else if(getTunSensor()->getTemp()->raw() < getTube()->getTargetTemp()->raw()) {
         // Too cold
         color = screen->CYAN;
     }
@@ -401,10 +422,10 @@ unsigned long Ohmbrewer::RIMS::displaySafetyTemp(Ohmbrewer::Screen *screen) {
     // Tube °C:  88.0  90.0
     uint16_t color = screen->YELLOW;
 
-    if(getSafetySensor()->getTemp()->c() >= getSafetyTemp()->c()) {
+    if(getSafetySensor()->getTemp()->raw() >= getSafetyTemp()->raw()) {
         // Too hot
         color = screen->RED;
-    } else if(getSafetySensor()->getTemp()->c() < getSafetyTemp()->c()) {
+    } else if(getSafetySensor()->getTemp()->raw() < getSafetyTemp()->raw()) {
         // Too cold ... ie ok
         color = screen->CYAN;
     }
@@ -481,56 +502,44 @@ unsigned long Ohmbrewer::RIMS::displayRecircStatus(Ohmbrewer::Screen *screen) {
 /**
  * Publishes updates to Ohmbrewer, etc.
  * This function is called by update().
- * @param args The argument string passed into the Particle Cloud
- * @param argsMap A map representing the key/value pairs for the update
- * @returns The time taken to run the method
+ * @param args The rest of the arguments passed into the Particle Cloud
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
  */
-int Ohmbrewer::RIMS::doUpdate(String &args, Ohmbrewer::Equipment::args_map_t &argsMap) {
-    unsigned long start = millis();
-
-    // If there are any remaining parameters
-    if(args.length() > 0) {
-        String safetySensorKey = String("safety_sensor_state");
-        String rPumpKey = String("r_pump_state");
-        String thermKey = String("therm_params");
-
-        parseArgs(args, argsMap);
-
-        // The remaining settings are optional/convenience parameters
-        if(argsMap.count(safetySensorKey) != 0) {
-            if(argsMap[safetySensorKey].equalsIgnoreCase("ON")) {
-                getSafetySensor()->setState(true);
-            } else if(argsMap[safetySensorKey].equalsIgnoreCase("OFF")) {
-                getSafetySensor()->setState(false);
-            } else if(argsMap[safetySensorKey].equalsIgnoreCase("--")) {
-                // Do nothing. Intentional.
-            } else {
-                // Do nothing. TODO: Should probably raise an error code...
-            }
-        }
-
-        if(argsMap.count(rPumpKey) != 0) {
-            if(argsMap[rPumpKey].equalsIgnoreCase("ON")) {
-                getRecirculator()->setState(true);
-            } else if(argsMap[rPumpKey].equalsIgnoreCase("OFF")) {
-                getRecirculator()->setState(false);
-            } else if(argsMap[rPumpKey].equalsIgnoreCase("--")) {
-                // Do nothing. Intentional.
-            } else {
-                // Do nothing. TODO: Should probably raise an error code...
-            }
-        }
+int Ohmbrewer::RIMS::doUpdate(CommandParser &args) {
+    RIMSArgs rimsArgs;
+    int errorCode = parseArgs(args, rimsArgs);
 
+    if(errorCode != CommandParser::ParseError::NONE) {
+        return errorCode;
+    }
 
-        if(argsMap.count(thermKey) != 0) {
-            // Pass the remaining parameters down to the Tube (a Thermostat)
-            getTube()->doUpdate(argsMap[thermKey], argsMap);
-        }
+    // The remaining settings are optional/convenience parameters
+    if(rimsArgs.safetySensorState == CommandParser::SWITCH_ON) {
+        getSafetySensor()->setState(true);
+    } else if(rimsArgs.safetySensorState == CommandParser::SWITCH_OFF) {
+        getSafetySensor()->setState(false);
+    }
 
+    if(rimsArgs.pumpState == CommandParser::SWITCH_ON) {
+        getRecirculator()->setState(true);
+    } else if(rimsArgs.pumpState == CommandParser::SWITCH_OFF) {
+        getRecirculator()->setState(false);
     }
 
+    getTube()->applyArgs(rimsArgs.tube);
+
+    return errorCode;
+}
 
-    return millis() - start;
+/**
+ * Checks the arguments particular to a RIMS, without applying them.
+ * This function is called by checkUpdate().
+ * @param args The rest of the arguments passed into the Particle Cloud
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+ */
+int Ohmbrewer::RIMS::doCheckUpdate(CommandParser &args) {
+    RIMSArgs rimsArgs;
+    return parseArgs(args, rimsArgs);
 }
 
 /**
@@ -16,7 +16,9 @@
 #include "Ohmbrewer_Pump.h"
 #include "Ohmbrewer_Temperature.h"
 #include "Ohmbrewer_Publisher.h"
+#include "Ohmbrewer_Event_Gate.h"
 #include "application.h"
+#include "Ohmbrewer_Object_Pool.h"
 
 
 namespace Ohmbrewer {
@@ -30,12 +32,33 @@ namespace Ohmbrewer {
              */
             const static constexpr char* TYPE_NAME = "rims";
 
+            /**
+             * How much hotter than the tun the tube has to be (raw, 3 C) for the recirculation pump to run
+             */
+            const static int32_t PUMP_MARGIN = 3 * Temperature::ONE_DEGREE;
+
+            /**
+             * The arguments particular to a RIMS's update, in order:
+             * SAFETY_SENSOR_STATE,PUMP_STATE{,Thermostat arguments}
+             */
+            struct RIMSArgs {
+                CommandParser::Switch safetySensorState;
+                CommandParser::Switch pumpState;
+                Thermostat::ThermostatArgs tube;
+            };
+
             /**
              * The Equipment Type
              * @returns The Equipment type name
              */
             virtual const char* getType() const { return RIMS::TYPE_NAME; };
 
+            /**
+             * The Equipment Type
+             * @returns The Equipment type code
+             */
+            virtual TypeCode getTypeCode() const { return TYPE_RIMS; };
+
             /**
              * Constructor
              * @param thermPins list with formatting of: [ temp busPin ; onewire index ;  heating controlPin ; heating powerPin ]
@@ -78,6 +101,25 @@ namespace Ohmbrewer {
              */
             virtual ~RIMS();
 
+            /**
+             * Allocates from the pool of RIMSes rather than the heap (see getPool())
+             * @param size The size of the object
+             * @returns The memory for it
+             */
+            static void* operator new(size_t size);
+
+            /**
+             * Gives the memory back to the pool of RIMSes
+             * @param ptr The memory
+             */
+            static void operator delete(void* ptr);
+
+            /**
+             * @returns The pool RIMSes are allocated from, sized for the most the Rhizome may have
+             *          (see SproutRegistry)
+             */
+            static ObjectPool* getPool();
+
 
             /**
              * Initializes the members of the RIMS class
@@ -134,14 +176,29 @@ namespace Ohmbrewer {
              */
             Pump* getRecirculator() const;
 
+            /**
+             * Forces the recirculation pump on or off, e.g. for a step program's rest, rather than running it
+             * only while the tube is hotter than the tun (see PUMP_MARGIN)
+             * @param pumpState SWITCH_ON or SWITCH_OFF to force the pump, or SWITCH_UNCHANGED to go back to the margin
+             * @returns The time taken to run the method
+             */
+            const int setPumpOverride(const CommandParser::Switch pumpState);
+
+            /**
+             * Whether the recirculation pump is being forced on or off
+             * @returns SWITCH_ON or SWITCH_OFF if it's forced, or SWITCH_UNCHANGED if it follows the margin
+             */
+            CommandParser::Switch getPumpOverride() const;
+
             /**
              * Specifies the interface for arguments sent to this Equipment's associated function.
-             * Parses the supplied string into an array of strings for setting the Equipment's values.
+             * Reads the arguments particular to a RIMS, which follow the common ones.
              * Most likely will be called during update().
-             * @param argsStr The arguments supplied as an update to the Rhizome.
-             * @param result A map representing the key/value pairs for the update
+             * @param args The arguments supplied as an update to the Rhizome.
+             * @param result The arguments, parsed
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
              */
-            static void parseArgs(const String &argsStr, args_map_t &result);
+            static int parseArgs(CommandParser &args, RIMSArgs &result);
 
             /**
              * Sets the Equipment state. True => On, False => Off
@@ -214,11 +271,18 @@ namespace Ohmbrewer {
             /**
              * Publishes updates to Ohmbrewer, etc.
              * This function is called by update().
-             * @param args The argument string passed into the Particle Cloud
-             * @param argsMap A map representing the key/value pairs for the update
-             * @returns The time taken to run the method
+             * @param args The rest of the arguments passed into the Particle Cloud
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
              */
-            int doUpdate(String &args, args_map_t &argsMap);
+            int doUpdate(CommandParser &args);
+
+            /**
+             * Checks the arguments particular to a RIMS, without applying them.
+             * This function is called by checkUpdate().
+             * @param args The rest of the arguments passed into the Particle Cloud
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+             */
+            int doCheckUpdate(CommandParser &args);
 
             /**
              * Reports which of the Rhizome's pins are occupied by the
@@ -252,6 +316,16 @@ namespace Ohmbrewer {
              */
             Pump* _recirc;
 
+            /**
+             * Whether the recirculation pump is forced on or off, or follows the margin (SWITCH_UNCHANGED)
+             */
+            CommandParser::Switch _pumpOverride;
+
+            /**
+             * Decides which of the tube Thermostat's changes of state are worth telling Ohmbrewer about
+             */
+            EventGate* _tubeEvents;
+
     };
 };
 
@@ -87,10 +87,10 @@ void Ohmbrewer::Relay::initRelay(std::list<int>* relayPins) {
     }else if (size == 1){ //relay only
         controlPin = relayPins->front();
     }else {//publish error
-        Publisher pub = Publisher(new String(getStream()), String("error_log"),
-                                  String("Relay"));
-        pub.add(String("list_check_relay"),
-                String("improperly formed input - Relay(int, int<list>)"));
+        char stream[Publisher::MAX_STREAM_LENGTH + 1];
+        getStream(stream, sizeof(stream));
+        Publisher pub = Publisher(stream, "error_log", "Relay");
+        pub.add("list_check_relay", "improperly formed input - Relay(int, int<list>)");
         pub.publish();
     }
     //will be set to -1 for error checking if not enabled, enable pins for output
@@ -127,11 +127,11 @@ int Ohmbrewer::Relay::getPowerPin() const{
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::Relay::setPowerPin(const int pinNum) {
-    unsigned long start = millis();
+    unsigned long start = micros();
 
     _powerPin = pinNum;
 
-    return start - millis();
+    return micros() - start;
 }
 
 
@@ -150,22 +150,11 @@ int Ohmbrewer::Relay::getControlPin() const {
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::Relay::setControlPin(const int pinNum) {
-    unsigned long start = millis();
+    unsigned long start = micros();
 
     _controlPin = pinNum;
 
-    return start - millis();
-}
-
-/**
- * Specifies the interface for arguments sent to this Equipment's associated function.
- * Parses the supplied string into an array of strings for setting the Equipment's values.
- * Most likely will be called during update().
- * @param argsStr The arguments supplied as an update to the Rhizome.
- * @param result A map representing the key/value pairs for the update
- */
-void Ohmbrewer::Relay::parseArgs(const String &argsStr, Ohmbrewer::Equipment::args_map_t &result) {
-    // Nothing special to parse out for this class.
+    return micros() - start;
 }
 
 /**
@@ -174,11 +163,11 @@ void Ohmbrewer::Relay::parseArgs(const String &argsStr, Ohmbrewer::Equipment::ar
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::Relay::setState(const bool state) {
-    unsigned long start = millis();
+    unsigned long start = micros();
 
     _state = state;
 
-    return start - millis();
+    return micros() - start;
 }
 
 /**
@@ -214,7 +203,7 @@ bool Ohmbrewer::Relay::isOff() const {
  * @returns The time taken to run the method
  */
 int Ohmbrewer::Relay::doWork() {
-    int startTime = millis();
+    unsigned long startTime = micros();
 
     if (_powerPin != -1){ //powerPin ENABLED
         if (getState()) {               //turn pin on
@@ -232,7 +221,7 @@ int Ohmbrewer::Relay::doWork() {
         }
     }
 
-    return millis()-startTime;
+    return micros() - startTime;
 }
 
 /**
@@ -272,14 +261,12 @@ int Ohmbrewer::Relay::doDisplay(Ohmbrewer::Screen *screen) {
 /**
  * Publishes updates to Ohmbrewer, etc.
  * This function is called by update().
- * @param args The argument string passed into the Particle Cloud
- * @param argsMap A map representing the key/value pairs for the update
- * @returns The time taken to run the method
+ * @param args The rest of the arguments passed into the Particle Cloud
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
  */
-int Ohmbrewer::Relay::doUpdate(String &args, Ohmbrewer::Equipment::args_map_t &argsMap) {
-    unsigned long start = millis();
+int Ohmbrewer::Relay::doUpdate(CommandParser &args) {
     // Nothing to do as it is...
-    return millis() - start;
+    return CommandParser::ParseError::NONE;
 }
 
 /**
@@ -34,6 +34,12 @@ namespace Ohmbrewer {
              */
             virtual const char* getType() const { return Relay::TYPE_NAME; };
 
+            /**
+             * The Equipment Type
+             * @returns The Equipment type code
+             */
+            virtual TypeCode getTypeCode() const { return TYPE_RELAY; };
+
             /**
              * Constructor - used by Pump to manually instantiate Relay
              * @param pumpPin - Single speed pump will only have PowerPin
@@ -122,15 +128,6 @@ namespace Ohmbrewer {
              */
             const int setControlPin(const int pinNum);
 
-            /**
-             * Specifies the interface for arguments sent to this Equipment's associated function.
-             * Parses the supplied string into an array of strings for setting the Equipment's values.
-             * Most likely will be called during update().
-             * @param argsStr The arguments supplied as an update to the Rhizome.
-             * @param result A map representing the key/value pairs for the update
-             */
-            static void parseArgs(const String &argsStr, args_map_t &result);
-
             /**
              * Sets the Equipment state. True => On, False => Off
              * @param state Whether the Equipment is ON (or OFF). True => ON, False => OFF
@@ -174,11 +171,10 @@ namespace Ohmbrewer {
             /**
              * Publishes updates to Ohmbrewer, etc.
              * This function is called by update().
-             * @param args The argument string passed into the Particle Cloud
-             * @param argsMap A map representing the key/value pairs for the update
-             * @returns The time taken to run the method
+             * @param args The rest of the arguments passed into the Particle Cloud
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
              */
-            int doUpdate(String &args, args_map_t &argsMap);
+            int doUpdate(CommandParser &args);
 
             /**
              * Reports which of the Rhizome's pins are occupied by the
@@ -8,23 +8,50 @@
 #include "Ohmbrewer_Thermostat.h"
 #include "Ohmbrewer_RIMS.h"
 #include "Ohmbrewer_Onewire.h"
+#include "Ohmbrewer_Onewire_Bus.h"
 #include "Ohmbrewer_Screen.h"
+#include "Ohmbrewer_Scheduler.h"
+#include "Ohmbrewer_Loop_Stats.h"
+#include "Ohmbrewer_Event_Gate.h"
+#include "Ohmbrewer_Pin_Allocator.h"
+#include "Ohmbrewer_Step_Program.h"
+#include "Ohmbrewer_Timer_Wheel.h"
+#include "Ohmbrewer_Object_Pool.h"
+#include "Ohmbrewer_Gain_Schedule.h"
 
 
 /**
  * Constructor
  */
 Ohmbrewer::Rhizome::Rhizome() {
-    _sprouts = new std::deque< Equipment* >;
+    _registry = new SproutRegistry();
+    // Every onewire probe reports the bus pin, so it's the one pin Sprouts can share
+    _pins = new PinAllocator(PinAllocator::maskOf(D0));
     _settings = new RuntimeSettings();
-    _screen = new Screen(D6, D7, A6, _sprouts, _settings);
+    _screen = new Screen(D6, D7, A6, _registry, _settings);
+    _scheduler = new Scheduler();
+    _telemetry = new Telemetry();
 
-    _periodicUpdateTimer = new Timer(15000, &Rhizome::publishPeriodicUpdates, *this);
+    // The timer wheel is advanced ahead of the tasks on every pass, so its stats are kept alongside theirs
+    LoopStats::getInstance()->reserve("timers", -1, LoopStats::PHASE_RUN);
+    initScheduler();
 
     Particle.function("add", &Rhizome::addSprout, this);
     Particle.function("update", &Rhizome::updateSprout, this);
     Particle.function("remove", &Rhizome::removeSprouts, this);
-    Particle.variable("index", _index);
+    Particle.function("stats", &Rhizome::resetStats, this);
+    Particle.function("batch", &Rhizome::batchUpdate, this);
+    Particle.function("program", &Rhizome::loadProgram, this);
+    Particle.function("gains", &Rhizome::loadGains, this);
+    Particle.function("tune", &Rhizome::tuneSprout, this);
+    _index.reserve(MAX_INDEX_LENGTH);
+    Particle.variable("index", std::function<String()>([this]() { return getIndex(); }));
+    Particle.variable("stats", _stats);
+    Particle.variable("events", _events);
+    Particle.variable("batch", _batchResults);
+    Particle.variable("gains", _gains);
+
+    GainSchedule::getInstance()->toString(_gains);
 
 }
 
@@ -32,10 +59,37 @@ Ohmbrewer::Rhizome::Rhizome() {
  * Destructor. Kills the internal deque.
  */
 Ohmbrewer::Rhizome::~Rhizome() {
-    delete _sprouts;
+    for (std::deque<Ohmbrewer::StepProgram*>::iterator itr = _programs.begin(); itr != _programs.end(); itr++) {
+        delete (*itr);
+    }
+    std::deque<Ohmbrewer::Equipment*>* sprouts = _registry->getSprouts();
+    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = sprouts->begin(); itr != sprouts->end(); itr++) {
+        delete (*itr);
+    }
+    delete _registry;
+    delete _pins;
     delete _screen;
     delete _settings;
-    delete _periodicUpdateTimer;
+    delete _scheduler;
+    delete _telemetry;
+}
+
+/**
+ * Sets up the Rhizome's periodic tasks. Tasks run in the order they're added here, most time critical first.
+ */
+void Ohmbrewer::Rhizome::initScheduler() {
+    _scheduler->addTask("pid", PID_TASK_PERIOD, 50000, [this]() { workSprouts(); });
+    _scheduler->addTask("program", PROGRAM_TASK_PERIOD, 20000, [this]() { workPrograms(); });
+    _scheduler->addTask("touch", TOUCH_TASK_PERIOD, 20000, [this]() { _screen->captureButtonPress(); });
+    _scheduler->addTask("display", DISPLAY_TASK_PERIOD, 500000, [this]() { _screen->refreshDisplay(); });
+    _scheduler->addTask("flush", FLUSH_TASK_PERIOD, 10000, [this]() { _screen->flushDisplay(); });
+    _scheduler->addTask("publish", PUBLISH_TASK_PERIOD, 1000000, [this]() { publishPeriodicUpdates(); });
+    _scheduler->addTask("stats", STATS_TASK_PERIOD, 1000000, [this]() {
+        LoopStats::getInstance()->toString(_stats);
+        EventGate::toString(_events);
+        // An autotune may have replaced the gains since
+        GainSchedule::getInstance()->toString(_gains);
+    });
 }
 
 /**
@@ -57,44 +111,57 @@ Ohmbrewer::Rhizome::~Rhizome() {
  */
 int Ohmbrewer::Rhizome::addSprout(String argsStr) {
     int errorCode = 0;
-    char* params = new char[argsStr.length() + 1];
-    strcpy(params, argsStr.c_str());
+    CommandParser params = CommandParser(argsStr.c_str());
+    CommandParser::Token type;
 
     // Parse the parameters
-    String type = String(strtok(params, ","));
+    params.next(type);
+    Equipment::TypeCode typeCode = SproutRegistry::typeFromName(type);
 
-    // Now, depending on the type we need to parse differently. Then we add the Equipment.
-    if(type.equalsIgnoreCase(Ohmbrewer::TemperatureSensor::TYPE_NAME)) {
-        errorCode = addTemperatureSensor(params);
-    } else if(type.equalsIgnoreCase(Ohmbrewer::Pump::TYPE_NAME)) {
-        errorCode = addPump(params);
-    } else if(type.equalsIgnoreCase(Ohmbrewer::HeatingElement::TYPE_NAME)) {
-        errorCode = addHeatingElement(params);
-    } else if(type.equalsIgnoreCase(Ohmbrewer::Thermostat::TYPE_NAME)) {
-        errorCode = addThermostat(params);
-    } else if(type.equalsIgnoreCase(Ohmbrewer::RIMS::TYPE_NAME)) {
-        errorCode = addRIMS(params);
-    } else {
-        // Trying to add an unrecognized Equipment Type.
-        errorCode = AddSproutError::SPROUT_NOT_IMPLEMENTED;
+    // Each type of Equipment comes out of a pool with room for only so many
+    if(typeCode != Equipment::TYPE_UNKNOWN && _registry->isFull(typeCode)) {
+        return AddSproutError::TOO_MANY_SPROUTS;
     }
 
-    // Clear out that dynamically allocated buffer
-    delete params;
+    // Now, depending on the type we need to parse differently. Then we add the Equipment.
+    unsigned long overflows = ObjectPool::getOverflows();
+    switch(typeCode) {
+        case Equipment::TYPE_TEMPERATURE_SENSOR:
+            errorCode = addTemperatureSensor(params);
+            break;
+        case Equipment::TYPE_PUMP:
+            errorCode = addPump(params);
+            break;
+        case Equipment::TYPE_HEATING_ELEMENT:
+            errorCode = addHeatingElement(params);
+            break;
+        case Equipment::TYPE_THERMOSTAT:
+            errorCode = addThermostat(params);
+            break;
+        case Equipment::TYPE_RIMS:
+            errorCode = addRIMS(params);
+            break;
+        default:
+            // Trying to add an unrecognized Equipment Type.
+            errorCode = AddSproutError::SPROUT_NOT_IMPLEMENTED;
+            break;
+    }
 
     // Simply return an error code if it failed
     if(errorCode != 0) {
         return errorCode;
     }
 
-    if(_sprouts->size() == 1) {
-        // We should only have to start the update timer if this is the first Sprout
-        _periodicUpdateTimer->start();
+    // A Sprout that didn't fit in its pools went on the heap. The pools are sized so that can't happen,
+    // but if it does, don't keep it around to fragment the heap.
+    if(ObjectPool::getOverflows() != overflows) {
+        removeSprout(typeCode, _registry->getSprouts()->back()->getID());
+        return AddSproutError::OUT_OF_MEMORY;
     }
 
     // Otherwise, refresh the screen and return success.
-    _screen->initScreen();
-    return _sprouts->back()->getID(); // Success!
+    _screen->reinitScreen();
+    return _registry->getSprouts()->back()->getID(); // Success!
 }
 
 /**
@@ -115,48 +182,204 @@ int Ohmbrewer::Rhizome::addSprout(String argsStr) {
  *          (negative) error codes if unsuccessful (see Rhizome::UpdateSproutError)
  */
 int Ohmbrewer::Rhizome::updateSprout(String argsStr) {
-    char* params = new char[argsStr.length() + 1];
-    strcpy(params, argsStr.c_str());
+    Equipment* sprout;
+    const char* updateArgs;
+    int errorCode = findUpdateTarget(argsStr.c_str(), sprout, updateArgs);
+
+    if(errorCode != UpdateSproutError::NONE) {
+        return errorCode;
+    }
+
+    // Update the equipment, minus the Type Name
+    sprout->update(updateArgs, errorCode);
+    if(errorCode != CommandParser::ParseError::NONE) {
+        return UpdateSproutError::INVALID_ARGUMENTS; // Fail! Bad arguments.
+    }
+
+    return sprout->getID(); // Success!
+}
+
+/**
+ * Updates several Equipment at once. Every update is checked before any of them are applied, so either
+ * the whole batch is applied or none of it is. Particle runs cloud functions between passes of loop(),
+ * so work() never sees a half-applied batch.
+ *
+ * The argument string for this function must match the following format:
+ * UPDATE;UPDATE;...
+ * where each UPDATE is the TYPE,ID,UPDATE_STRING argument string that updateSprout() takes.
+ *
+ * The result of each update is left in the "batch" Particle variable, comma delimited and in order:
+ * the Equipment ID if it was applied, (negative) error codes for those that were rejected (see
+ * Rhizome::UpdateSproutError), and 0 for those that were fine but not applied because others were rejected.
+ *
+ * @param argsStr The argument string passed via the Particle Cloud.
+ * @returns The number of updates applied if successful,
+ *          (negative) error codes if unsuccessful (see Rhizome::BatchError)
+ */
+int Ohmbrewer::Rhizome::batchUpdate(String argsStr) {
+    char batch[MAX_BATCH_LENGTH + 1];
+    const char* commands[MAX_BATCH_COMMANDS];
+    Equipment* sprouts[MAX_BATCH_COMMANDS];
+    const char* updateArgs[MAX_BATCH_COMMANDS];
+    int results[MAX_BATCH_COMMANDS];
+    int count = 0;
+    bool rejected = false;
+
+    _batchResults = "";
+
+    if(argsStr.length() == 0) {
+        return BatchError::EMPTY;
+    }
+    if(argsStr.length() > MAX_BATCH_LENGTH) {
+        return BatchError::TOO_LONG;
+    }
+
+    // Split the batch into its updates, in a copy on the stack
+    strcpy(batch, argsStr.c_str());
+    char* cursor = batch;
+    while(cursor != NULL) {
+        if(count == MAX_BATCH_COMMANDS) {
+            return BatchError::TOO_MANY_COMMANDS;
+        }
+        commands[count++] = cursor;
+
+        cursor = strchr(cursor, BATCH_DELIMITER);
+        if(cursor != NULL) {
+            *cursor = '\0';
+            cursor++;
+        }
+    }
+
+    // Check every update before touching anything
+    for(int i = 0; i < count; i++) {
+        results[i] = findUpdateTarget(commands[i], sprouts[i], updateArgs[i]);
+        if(results[i] == UpdateSproutError::NONE &&
+           sprouts[i]->checkUpdate(updateArgs[i]) != CommandParser::ParseError::NONE) {
+            results[i] = UpdateSproutError::INVALID_ARGUMENTS;
+        }
+        rejected = rejected || (results[i] != UpdateSproutError::NONE);
+    }
+
+    // Then apply them all, in order. They've been checked, so they can't fail part way through.
+    if(!rejected) {
+        for(int i = 0; i < count; i++) {
+            int errorCode;
+            sprouts[i]->update(updateArgs[i], errorCode);
+            results[i] = sprouts[i]->getID();
+        }
+    }
+
+    for(int i = 0; i < count; i++) {
+        if(i > 0) {
+            _batchResults += ",";
+        }
+        _batchResults += String(results[i]);
+    }
+
+    return rejected ? BatchError::REJECTED : count;
+}
+
+/**
+ * Loads a step program (see StepProgram) onto a Thermostat or RIMS and starts it, replacing any program
+ * it was already running. The program then runs on the Rhizome, without any further cloud calls.
+ *
+ * The argument string for this function must match one of the following formats:
+ * TYPE,ID,STEP{,STEP...}
+ * TYPE,ID,stop
+ * where
+ * TYPE is the TYPE_NAME of a Thermostat or RIMS
+ * ID matches the ID of the desired Equipment
+ * STEP is TARGET_TEMP,RAMP_RATE,HOLD_TIME,PUMP_STATE (see StepProgram::parseStep())
+ *
+ * @param argsStr The argument string passed via the Particle Cloud.
+ * @returns Equipment ID if successful,
+ *          (negative) error codes if unsuccessful (see Rhizome::ProgramError)
+ */
+int Ohmbrewer::Rhizome::loadProgram(String argsStr) {
+    CommandParser params = CommandParser(argsStr.c_str());
+    CommandParser::Token type;
+    CommandParser::Token first;
+    StepProgram::Step steps[StepProgram::MAX_STEPS];
+    int numSteps = 0;
+    long id;
 
     // Parse the parameters
-    String type    = String(strtok(params, ","));
-    String idStr   = String(strtok(NULL, ","));
-    int id = idStr.toInt();
+    params.next(type);
 
-    // Type should be valid
-    if(!type.equalsIgnoreCase(Ohmbrewer::TemperatureSensor::TYPE_NAME) &&
-       !type.equalsIgnoreCase(Ohmbrewer::Pump::TYPE_NAME) &&
-       !type.equalsIgnoreCase(Ohmbrewer::HeatingElement::TYPE_NAME) &&
-       !type.equalsIgnoreCase(Ohmbrewer::Thermostat::TYPE_NAME) &&
-       !type.equalsIgnoreCase(Ohmbrewer::RIMS::TYPE_NAME)) {
-        delete params;
-        return UpdateSproutError::INVALID_TYPE; // Fail! Bad Type.
-    } else {
-        // Ok, we like this Type. Let's remove it (and the comma) from the args string
-        // so it doesn't get in the way of further processing.
-        argsStr.remove(0, type.length() + 1);
+    // Only Equipment with a Thermostat can run a program
+    Equipment::TypeCode typeCode = SproutRegistry::typeFromName(type);
+    if(typeCode != Equipment::TYPE_THERMOSTAT && typeCode != Equipment::TYPE_RIMS) {
+        return ProgramError::INVALID_TYPE; // Fail! Bad Type.
     }
 
-    // If toInt() fails due to a bad parse, it gives 0.
-    if(isFakeZero(idStr)) {
-        delete params;
-        return UpdateSproutError::INVALID_ID; // Fail! Bad ID.
+    if(params.nextInt(id) != CommandParser::ParseError::NONE) {
+        return ProgramError::INVALID_ID; // Fail! Bad ID.
+    }
+
+    Equipment* sprout = _registry->find(typeCode, id);
+    if(sprout == NULL) {
+        return ProgramError::SPROUT_NOT_FOUND; // Fail! Not Found!
     }
 
-    std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin();
-    for (itr; itr != _sprouts->end(); itr++) {
-        if (((*itr)->getID() == id) && (type.equalsIgnoreCase((*itr)->getType()))) {
-            // Update the equipment, removing the Type Name from the string that's passed in
-            (*itr)->update(argsStr);
+    StepProgram* program = findProgram(sprout);
+
+    // Look ahead for a stop, leaving the steps to be parsed
+    CommandParser lookahead = params;
+    lookahead.next(first);
+    if(first.equalsIgnoreCase("stop")) {
+        if(program == NULL) {
+            return ProgramError::NO_PROGRAM; // Fail! Nothing to stop.
+        }
+        program->stop();
+        return id; // Success!
+    }
 
-            delete params; // Clean up
-            return id; // Success!
+    // Read every step before replacing the current program
+    while(!params.atEnd()) {
+        if(numSteps == StepProgram::MAX_STEPS) {
+            return ProgramError::TOO_MANY_STEPS; // Fail!
         }
+        if(StepProgram::parseStep(params, steps[numSteps]) != CommandParser::ParseError::NONE) {
+            return ProgramError::INVALID_STEP; // Fail!
+        }
+        numSteps++;
+    }
+
+    if(numSteps == 0) {
+        return ProgramError::INVALID_STEP; // Fail! No steps.
+    }
+
+    // A program sets its own targets, so it can't run alongside tuning
+    Thermostat* therm = (typeCode == Equipment::TYPE_RIMS) ? ((RIMS*)sprout)->getTube() : (Thermostat*)sprout;
+    therm->stopAutotune();
+
+    if(program == NULL) {
+        program = new StepProgram(sprout);
+        _programs.push_back(program);
+    } else {
+        program->clear();
+    }
+
+    for(int i = 0; i < numSteps; i++) {
+        program->addStep(steps[i]);
     }
+    program->start();
 
-    // Clear out that dynamically allocated buffer
-    delete params;
-    return UpdateSproutError::SPROUT_NOT_FOUND; // Fail! Not Found!
+    return id; // Success!
+}
+
+/**
+ * Finds the step program loaded onto a Sprout
+ * @param sprout The Sprout
+ * @returns The program, or NULL if it has none
+ */
+Ohmbrewer::StepProgram* Ohmbrewer::Rhizome::findProgram(Equipment* sprout) {
+    for (std::deque<Ohmbrewer::StepProgram*>::iterator itr = _programs.begin(); itr != _programs.end(); itr++) {
+        if ((*itr)->getSprout() == sprout) {
+            return *itr;
+        }
+    }
+    return NULL;
 }
 
 /**
@@ -170,27 +393,27 @@ int Ohmbrewer::Rhizome::updateSprout(String argsStr) {
  *          (negative) error codes if unsuccessful (see Rhizome::RemoveSproutError)
  */
 int Ohmbrewer::Rhizome::removeSprouts(String argsStr) {
-    char* params = new char[argsStr.length() + 1];
-    strcpy(params, argsStr.c_str());
+    CommandParser params = CommandParser(argsStr.c_str());
+    CommandParser::Token type;
+    CommandParser::Token idStr;
+    long id;
 
     // Parse the parameters
-    String type = String(strtok(params, ","));
-    String idStr = String(strtok(NULL, ","));
-    delete params;
+    params.next(type);
+    params.next(idStr);
 
     if(idStr.equalsIgnoreCase("all")) {
         if(type.equalsIgnoreCase("all")) {
             return removeAllSprouts();
         } else {
-            return removeAllSprouts(type);
+            return removeAllSprouts(SproutRegistry::typeFromName(type));
         }
     } else {
-        // If toInt() fails due to a bad parse, it gives 0.
-        if(isFakeZero(idStr)) {
+        if(!idStr.toInt(id)) {
             return RemoveSproutError::INVALID_ID; // Fail!
         }
 
-        return removeSprout(type, idStr.toInt());
+        return removeSprout(SproutRegistry::typeFromName(type), id);
     }
 }
 
@@ -202,17 +425,15 @@ int Ohmbrewer::Rhizome::removeSprouts(String argsStr) {
  * @returns Equipment ID if successful,
  *          (negative) error codes if unsuccessful (see Rhizome::RemoveSproutError)
  */
-int Ohmbrewer::Rhizome::removeSprout(String type, int id) {
-    std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin();
-    for (itr; itr != _sprouts->end(); itr++) {
-        if (((*itr)->getID() == id) && (type.equalsIgnoreCase((*itr)->getType()))) {
-            _sprouts->erase(itr);
-            refreshSprouts();
-            return id; // Success!
-        }
+int Ohmbrewer::Rhizome::removeSprout(Equipment::TypeCode type, int id) {
+    Equipment* sprout = _registry->remove(type, id);
+    if(sprout == NULL) {
+        return RemoveSproutError::SPROUT_NOT_FOUND; // Fail!
     }
 
-    return RemoveSproutError::SPROUT_NOT_FOUND; // Fail!
+    discardSprout(sprout);
+    refreshSprouts();
+    return id; // Success!
 }
 
 /**
@@ -222,7 +443,12 @@ int Ohmbrewer::Rhizome::removeSprout(String type, int id) {
  *          (negative) error codes if unsuccessful (see Rhizome::RemoveSproutError)
  */
 int Ohmbrewer::Rhizome::removeAllSprouts() {
-    _sprouts->clear();
+    std::deque<Ohmbrewer::Equipment*>* sprouts = _registry->getSprouts();
+    while(!sprouts->empty()) {
+        Equipment* sprout = sprouts->back();
+        discardSprout(_registry->remove(sprout->getTypeCode(), sprout->getID()));
+    }
+
     refreshSprouts();
     return RemoveSproutError::NONE; // Success!
 }
@@ -234,24 +460,15 @@ int Ohmbrewer::Rhizome::removeAllSprouts() {
  * @returns 0 if successful
  *          (negative) error codes if unsuccessful (see Rhizome::RemoveSproutError)
  */
-int Ohmbrewer::Rhizome::removeAllSprouts(String type) {
-    bool foundNone = true;
-    int currentIndex = 0;
-    std::deque<Ohmbrewer::Equipment *>::iterator itr;
-
-    while((_sprouts->begin() + currentIndex) != _sprouts->end()) {
-        itr = _sprouts->begin() + currentIndex;
-        if (type.equalsIgnoreCase((*itr)->getType())) {
-            foundNone = false;
-            _sprouts->erase(itr);
-            continue;
-        }
+int Ohmbrewer::Rhizome::removeAllSprouts(Equipment::TypeCode type) {
+    const std::deque<Ohmbrewer::Equipment*>& sprouts = _registry->ofType(type);
 
-        currentIndex++;
+    if(sprouts.empty()) {
+        return RemoveSproutError::SPROUT_NOT_FOUND;
     }
 
-    if(foundNone) {
-        return RemoveSproutError::SPROUT_NOT_FOUND;
+    while(!sprouts.empty()) {
+        discardSprout(_registry->remove(type, sprouts.front()->getID()));
     }
 
     refreshSprouts();
@@ -259,8 +476,151 @@ int Ohmbrewer::Rhizome::removeAllSprouts(String type) {
 }
 
 /**
- * Publishes any periodic updates that need to be published.
- * @see _periodicUpdateTimer
+ * Tunes the PID gains of a Thermostat or RIMS by relay feedback (see Autotuner), around its target
+ * temperature. The Equipment is turned on, and any step program it was running is stopped. Tuning runs
+ * on the Rhizome; when it's over, the outcome is published to the Equipment's stream and, if it
+ * succeeded, the tuned gains replace the gain schedule's gains for any phase (see GainSchedule).
+ *
+ * The argument string for this function must match one of the following formats:
+ * TYPE,ID{,TARGET_TEMP}
+ * TYPE,ID,stop
+ * where
+ * TYPE is the TYPE_NAME of a Thermostat or RIMS
+ * ID matches the ID of the desired Equipment
+ * TARGET_TEMP is the temperature to tune around, in Celsius. Defaults to the current target.
+ *
+ * @param argsStr The argument string passed via the Particle Cloud.
+ * @returns Equipment ID if successful,
+ *          (negative) error codes if unsuccessful (see Rhizome::TuneError)
+ */
+int Ohmbrewer::Rhizome::tuneSprout(String argsStr) {
+    CommandParser params = CommandParser(argsStr.c_str());
+    CommandParser::Token type;
+    CommandParser::Token first;
+    double target;
+    bool hasTarget;
+    long id;
+
+    // Parse the parameters
+    params.next(type);
+
+    // Only Equipment with a Thermostat can be tuned
+    Equipment::TypeCode typeCode = SproutRegistry::typeFromName(type);
+    if(typeCode != Equipment::TYPE_THERMOSTAT && typeCode != Equipment::TYPE_RIMS) {
+        return TuneError::INVALID_TYPE; // Fail! Bad Type.
+    }
+
+    if(params.nextInt(id) != CommandParser::ParseError::NONE) {
+        return TuneError::INVALID_ID; // Fail! Bad ID.
+    }
+
+    Equipment* sprout = _registry->find(typeCode, id);
+    if(sprout == NULL) {
+        return TuneError::SPROUT_NOT_FOUND; // Fail! Not Found!
+    }
+
+    // The Thermostat that does the heating - the Equipment itself, or a RIMS's tube
+    Thermostat* therm = (typeCode == Equipment::TYPE_RIMS) ? ((RIMS*)sprout)->getTube() : (Thermostat*)sprout;
+
+    // Look ahead for a stop
+    CommandParser lookahead = params;
+    lookahead.next(first);
+    if(first.equalsIgnoreCase("stop")) {
+        if(therm->getAutotuner() == NULL) {
+            return TuneError::NOT_TUNING; // Fail! Nothing to stop.
+        }
+        therm->stopAutotune();
+        return id; // Success!
+    }
+
+    if(params.nextOptionalNumber(target, hasTarget) != CommandParser::ParseError::NONE || !params.atEnd()) {
+        return TuneError::INVALID_TARGET; // Fail! Bad target.
+    }
+
+    StepProgram* program = findProgram(sprout);
+    if(program != NULL) {
+        program->stop();
+    }
+
+    if(hasTarget) {
+        therm->setTargetTemp(target);
+    }
+    sprout->setState(true);
+    therm->startAutotune();
+
+    return id; // Success!
+}
+
+/**
+ * Replaces the gain schedule (see GainSchedule) all of the Thermostats pick their PID gains from, and
+ * saves it to EEPROM. The current schedule is in the "gains" Particle variable.
+ *
+ * The argument string for this function must match one of the following formats:
+ * POINT{,POINT...}
+ * reset
+ * where
+ * POINT is PHASE,ERROR,KP,KI,KD (see GainSchedule::parsePoint())
+ * At least one POINT must be for the "any" phase. reset goes back to the default schedule.
+ *
+ * @param argsStr The argument string passed via the Particle Cloud.
+ * @returns The number of points in the schedule if successful,
+ *          (negative) error codes if unsuccessful (see Rhizome::GainsError)
+ */
+int Ohmbrewer::Rhizome::loadGains(String argsStr) {
+    CommandParser params = CommandParser(argsStr.c_str());
+    CommandParser lookahead = params;
+    CommandParser::Token first;
+    GainSchedule::Point points[GainSchedule::MAX_POINTS];
+    GainSchedule* schedule = GainSchedule::getInstance();
+    int numPoints = 0;
+
+    lookahead.next(first);
+    if(first.equalsIgnoreCase("reset")) {
+        schedule->reset();
+    } else {
+        // Read every point before replacing the current schedule
+        while(!params.atEnd()) {
+            if(numPoints == GainSchedule::MAX_POINTS) {
+                return GainsError::TOO_MANY_POINTS; // Fail!
+            }
+            if(GainSchedule::parsePoint(params, points[numPoints]) != CommandParser::ParseError::NONE) {
+                return GainsError::INVALID_POINT; // Fail!
+            }
+            numPoints++;
+        }
+
+        if(numPoints == 0) {
+            return GainsError::INVALID_POINT; // Fail! No points.
+        }
+        if(!schedule->setPoints(points, numPoints)) {
+            return GainsError::NO_DEFAULT; // Fail! Nothing for the phases without points.
+        }
+    }
+
+    schedule->save();
+    schedule->toString(_gains);
+    return schedule->getNumPoints(); // Success!
+}
+
+/**
+ * Clears the loop timing stats and event counts, so the next "stats" and "events" readings only cover
+ * what happens from now on. The argument string is ignored.
+ *
+ * @param argsStr The argument string passed via the Particle Cloud.
+ * @returns 0
+ */
+int Ohmbrewer::Rhizome::resetStats(String argsStr) {
+    LoopStats::getInstance()->reset();
+    _scheduler->resetStats();
+    EventGate::resetCounters();
+    _stats = "";
+    _events = "";
+    return 0;
+}
+
+/**
+ * Publishes any periodic updates that need to be published - the status of every Sprout,
+ * batched into telemetry frames (see Telemetry). Runs as the scheduler's "publish" task.
  */
 void Ohmbrewer::Rhizome::publishPeriodicUpdates() {
     // Do not attempt to publish updates if disconnected from the cloud
@@ -270,34 +630,27 @@ void Ohmbrewer::Rhizome::publishPeriodicUpdates() {
             Particle.connect();
         }
     } else {
-        // Publish all the Temperature Sensor updates
-        for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-            if (strcmp((*itr)->getType(), TemperatureSensor::TYPE_NAME) == 0) {
-                ((TemperatureSensor*)(*itr))->publishSensorReading();
-                continue;
-            }
-            if (strcmp((*itr)->getType(), Thermostat::TYPE_NAME) == 0) {
-                ((Thermostat*)(*itr))->getSensor()->publishSensorReading();
-                continue;
-            }
-            if (strcmp((*itr)->getType(), RIMS::TYPE_NAME) == 0) {
-                ((RIMS*)(*itr))->getTunSensor()->publishSensorReading();
-                ((RIMS*)(*itr))->getSafetySensor()->publishSensorReading();
-            }
-        }
-
-        _periodicUpdateTimer->reset();
+        // Publish every Sprout's status in one go, rather than an event per Temperature Sensor
+        _telemetry->publish(_registry->getSprouts());
     }
 
     return;
 }
 
 /**
- * Gets the deque of Sprouts
- * @returns The settings
+ * Gets the deque of Sprouts. Read only - add and remove Sprouts through the registry.
+ * @returns The Sprouts
  */
 std::deque< Ohmbrewer::Equipment* >* Ohmbrewer::Rhizome::getSprouts() {
-    return _sprouts;
+    return _registry->getSprouts();
+}
+
+/**
+ * Gets the Sprout registry
+ * @returns The registry
+ */
+Ohmbrewer::SproutRegistry* Ohmbrewer::Rhizome::getRegistry() {
+    return _registry;
 }
 
 /**
@@ -317,31 +670,66 @@ Ohmbrewer::Screen* Ohmbrewer::Rhizome::getScreen() {
 }
 
 /**
- * Called in loop, iterates through the the spouts equipment list
- * and calls work() on each equipment stored in the sprouts list
+ * Called in loop, fires whichever timers have come due (relay windows, sensor conversions, stop times
+ * and the like), then runs whichever of the Rhizome's tasks have come due (see initScheduler())
  */
 void Ohmbrewer::Rhizome::work() {
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        (*itr)->work();
+    LoopStats::getInstance()->record("timers", -1, LoopStats::PHASE_RUN, TimerWheel::getInstance()->advance());
+    _scheduler->run();
+}
+
+/**
+ * Gets the task scheduler
+ * @returns The scheduler
+ */
+Ohmbrewer::Scheduler* Ohmbrewer::Rhizome::getScheduler() {
+    return _scheduler;
+}
+
+/**
+ * Assembles the index of all registered Sprouts from their cached entries (see
+ * Equipment::getIndexEntry()), so it's current whenever it's read. Exposed as the "index" Particle variable.
+ * @returns The index, in JSON format
+ */
+const String& Ohmbrewer::Rhizome::getIndex() {
+    std::deque<Ohmbrewer::Equipment*>* sprouts = _registry->getSprouts();
+
+    // Only the entries of Sprouts whose task or state changed are rebuilt; the rest are just copied in
+    _index = "{ ";
+    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = sprouts->begin(); itr != sprouts->end(); itr++) {
+        const String& entry = (*itr)->getIndexEntry();
+
+        // Leave room for the separator and the closing brace
+        if (_index.length() + entry.length() + 4 > MAX_INDEX_LENGTH) {
+            break;
+        }
+        if (itr != sprouts->begin()) {
+            _index.concat(", ");
+        }
+        _index.concat(entry);
     }
+    _index.concat(" }");
+
+    return _index;
 }
 
 /**
- * Determines if the supplied string failed Particle's toInt() conversion.
- * @param raw String to examine
- * @returns Whether the string failed the conversion
+ * Iterates through the the spouts equipment list and calls work() on each equipment stored in the sprouts list
  */
-bool Ohmbrewer::Rhizome::isFakeZero(String raw) {
-    return raw == NULL || raw.length() == 0 || (raw.toInt() == 0 && isNotActualZero(raw));
+void Ohmbrewer::Rhizome::workSprouts() {
+    std::deque<Ohmbrewer::Equipment*>* sprouts = _registry->getSprouts();
+    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = sprouts->begin(); itr != sprouts->end(); itr++) {
+        (*itr)->work();
+    }
 }
 
 /**
- * Determines if the supplied string's first character is the number 0.
- * @param raw String to examine
- * @returns Whether the string starts with 0
+ * Moves each of the loaded step programs along
  */
-bool Ohmbrewer::Rhizome::isNotActualZero(String raw) {
-    return ((raw.charAt(0) - '0') != 0);
+void Ohmbrewer::Rhizome::workPrograms() {
+    for (std::deque<Ohmbrewer::StepProgram*>::iterator itr = _programs.begin(); itr != _programs.end(); itr++) {
+        (*itr)->work();
+    }
 }
 
 /**
@@ -350,58 +738,87 @@ bool Ohmbrewer::Rhizome::isNotActualZero(String raw) {
  * @returns Whether any of the supplied pins are already in use
  */
 bool Ohmbrewer::Rhizome::arePinsInUse(std::list<int>* newPins) {
-    // Make sure ID isn't in use
-    std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin();
-
-    // Iterate through all Sprouts
-    for (itr; itr != _sprouts->end(); itr++) {
-            std::list<int> pinsInUse;
-            std::list<int>::iterator inusePinItr;
-            std::list<int>::iterator newPinItr;
-
-        // Iterate through all the pins for this Equipment...
-        (*itr)->whichPins(&pinsInUse);
-        for(inusePinItr = pinsInUse.begin(); inusePinItr != pinsInUse.end(); inusePinItr++) {
-            // Compare against all the pins for the new Equipment...
-            for(newPinItr = newPins->begin(); newPinItr != newPins->end(); newPinItr++) {
-                if((*newPinItr) == (*inusePinItr)) {
-                    return true;
-                }
-            }
-        }
+    return _pins->inUse(PinAllocator::maskOf(newPins));
+}
+
+/**
+ * Finds the Equipment an update is for.
+ * @param command The TYPE,ID,UPDATE_STRING argument string of the update (see updateSprout())
+ * @param sprout Set to the Equipment
+ * @param updateArgs Set to the ID,UPDATE_STRING part of the update, for the Equipment's update() method
+ * @returns UpdateSproutError::NONE, or the (negative) error code if the Equipment can't be found
+ */
+int Ohmbrewer::Rhizome::findUpdateTarget(const char* command, Equipment* &sprout, const char* &updateArgs) {
+    CommandParser params = CommandParser(command);
+    CommandParser::Token type;
+    long id;
+
+    // Parse the parameters
+    params.next(type);
+
+    // Type should be valid
+    Equipment::TypeCode typeCode = SproutRegistry::typeFromName(type);
+    if(typeCode == Equipment::TYPE_UNKNOWN || typeCode == Equipment::TYPE_RELAY) {
+        return UpdateSproutError::INVALID_TYPE; // Fail! Bad Type.
+    }
+
+    // Ok, we like this Type. Everything after it goes to the Equipment, starting with the ID.
+    updateArgs = params.remaining();
+
+    if(params.nextInt(id) != CommandParser::ParseError::NONE) {
+        return UpdateSproutError::INVALID_ID; // Fail! Bad ID.
+    }
+
+    sprout = _registry->find(typeCode, id);
+    if(sprout == NULL) {
+        return UpdateSproutError::SPROUT_NOT_FOUND; // Fail! Not Found!
     }
 
-    return false;
+    return UpdateSproutError::NONE;
 }
 
 /**
- * Parses a given string of characters into the pins for a Temperature Sensor
- * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+ * Parses a given string of characters into the pins for a Temperature Sensor.
+ * The sensor may be given either as its onewire index or as its 16 hex digit ROM code.
+ * @param params The argument parser, positioned just past the fields already read
  * @param index The onewire sensor index (-1 if unused / non onewire)
  * @return Error or success code, according to the requirements specified by addSprout
  */
-int Ohmbrewer::Rhizome::parseOnewireSensorPins(char *params, int &index) {
-    String ind = String(strtok(NULL, ","));
+int Ohmbrewer::Rhizome::parseOnewireSensorPins(CommandParser &params, int &index) {
+    CommandParser::Token ind;
+    char romCode[17]; // 16 hex digits
+    uint8_t rom[8];
+    long probeIndex;
 
-    if(ind == NULL) {
+    if(!params.next(ind) || ind.isEmpty()) {
         return AddSproutError::INCORRECT_PIN_COUNT;
     }
-    index = ind.toInt();
+
+    if(ind.copyTo(romCode, sizeof(romCode)) && OnewireBus::parseRom(romCode, rom)) {
+        index = OnewireBus::getInstance()->claimProbe(rom);
+        if(index == -1) {
+            return AddSproutError::PROBE_NOT_FOUND;
+        }
+    } else if(ind.toInt(probeIndex)) {
+        index = probeIndex;
+    } else {
+        return AddSproutError::INVALID_ID;
+    }
 
     return AddSproutError::NONE;
 }
 
 /**
   * Adds a Temperature Sensor
-  * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+  * @param params The argument parser, positioned just past the fields already read
   * @return Error or success code, according to the requirements specified by addSprout
   */
-int Ohmbrewer::Rhizome::addTemperatureSensor(char* params) {
+int Ohmbrewer::Rhizome::addTemperatureSensor(CommandParser &params) {
     int index;
     int errorCode = parseOnewireSensorPins(params, index);
 
     if(errorCode == AddSproutError::NONE) {
-        saveNewSprout(new Ohmbrewer::TemperatureSensor( new Ohmbrewer::Onewire(index) ));
+        errorCode = saveNewSprout(new Ohmbrewer::TemperatureSensor( new Ohmbrewer::Onewire(index) ));
     }
 
     return errorCode;
@@ -409,40 +826,40 @@ int Ohmbrewer::Rhizome::addTemperatureSensor(char* params) {
 
 /**
  * Parses a given string of characters into the pins for a Pump
- * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+ * @param params The argument parser, positioned just past the fields already read
  * @param pin The power pin
  * @return Error or success code, according to the requirements specified by addSprout
  */
-int Ohmbrewer::Rhizome::parsePumpPins(char* params, int &pin) {
-    String powerPin = String(strtok(NULL, ","));
+int Ohmbrewer::Rhizome::parsePumpPins(CommandParser &params, int &pin) {
+    long powerPin;
 
-    // Verify that D0 values are intentional
-    if(isFakeZero(powerPin)) {
+    // Verify that the pin is actually a number
+    if(params.nextInt(powerPin) != CommandParser::ParseError::NONE) {
         return AddSproutError::INVALID_ID;
     }
 
     // Verify that the pins are not in use
     std::list<int> pinTest;
-    pinTest.push_back(powerPin.toInt());
+    pinTest.push_back(powerPin);
     if(arePinsInUse(&pinTest)) {
         return AddSproutError::PIN_IN_USE;
     }
 
-    pin = powerPin.toInt();
+    pin = powerPin;
     return AddSproutError::NONE;
 }
 
 /**
  * Adds a Pump
- * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+ * @param params The argument parser, positioned just past the fields already read
  * @return Error or success code, according to the requirements specified by addSprout
  */
-int Ohmbrewer::Rhizome::addPump(char* params) {
+int Ohmbrewer::Rhizome::addPump(CommandParser &params) {
     int pumpPin;
     int errorCode = parsePumpPins(params, pumpPin);
 
     if(errorCode == AddSproutError::NONE) {
-        saveNewSprout(new Ohmbrewer::Pump(pumpPin ));
+        errorCode = saveNewSprout(new Ohmbrewer::Pump(pumpPin ));
     }
 
     return errorCode;
@@ -450,25 +867,26 @@ int Ohmbrewer::Rhizome::addPump(char* params) {
 
 /**
  * Parses a given string of characters into the pins for a Heating Element
- * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+ * @param params The argument parser, positioned just past the fields already read
  * @param elementPins The heating element pins
  * @return Error or success code, according to the requirements specified by addSprout
  */
-int Ohmbrewer::Rhizome::parseHeatingElementPins(char* params, std::list<int> &elementPins) {
-    String controlPin = String(strtok(NULL, ","));
-    String powerPin   = String(strtok(NULL, ","));
+int Ohmbrewer::Rhizome::parseHeatingElementPins(CommandParser &params, std::list<int> &elementPins) {
+    long controlPin;
+    long powerPin;
+    bool hasPowerPin;
 
-    // Verify that D0 values are intentional
-    if(isFakeZero(controlPin)) {
+    // Verify that the pins are actually numbers
+    if(params.nextInt(controlPin) != CommandParser::ParseError::NONE) {
         return AddSproutError::INVALID_ID;
     }
-    if(powerPin != NULL && isFakeZero(powerPin)) {
+    if(params.nextOptionalInt(powerPin, hasPowerPin) != CommandParser::ParseError::NONE) {
         return AddSproutError::INVALID_ID;
     }
 
-    elementPins.push_back(controlPin.toInt());
-    if(powerPin != NULL && powerPin.toInt() > -1) {
-        elementPins.push_back(powerPin.toInt());
+    elementPins.push_back(controlPin);
+    if(hasPowerPin && powerPin > -1) {
+        elementPins.push_back(powerPin);
     }
     // Verify that the pins are not in use
     if(arePinsInUse(&elementPins)) {
@@ -480,15 +898,15 @@ int Ohmbrewer::Rhizome::parseHeatingElementPins(char* params, std::list<int> &el
 
 /**
  * Adds a Heating Element
- * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+ * @param params The argument parser, positioned just past the fields already read
  * @return Error or success code, according to the requirements specified by addSprout
  */
-int Ohmbrewer::Rhizome::addHeatingElement(char* params) {
+int Ohmbrewer::Rhizome::addHeatingElement(CommandParser &params) {
     std::list<int> elementPins;
     int errorCode = parseHeatingElementPins(params, elementPins);
 
     if(errorCode == AddSproutError::NONE) {
-        saveNewSprout(new Ohmbrewer::HeatingElement(&elementPins ));
+        errorCode = saveNewSprout(new Ohmbrewer::HeatingElement(&elementPins ));
     }
 
     return errorCode;
@@ -496,11 +914,11 @@ int Ohmbrewer::Rhizome::addHeatingElement(char* params) {
 
 /**
  * Parses a given string of characters into the pins for a Thermostat
- * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+ * @param params The argument parser, positioned just past the fields already read
  * @param thermPins The thermostat pins [tempbus, OW probe index, controlpin, powerpin]
  * @return Error or success code, according to the requirements specified by addSprout
  */
-int Ohmbrewer::Rhizome::parseThermostatPins(char* params, std::list<int> &thermPins) {
+int Ohmbrewer::Rhizome::parseThermostatPins(CommandParser &params, std::list<int> &thermPins) {
     int index = -1;
     int errorCode = AddSproutError::NONE;
 
@@ -521,15 +939,15 @@ int Ohmbrewer::Rhizome::parseThermostatPins(char* params, std::list<int> &thermP
 
 /**
  * Adds a Thermostat
- * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+ * @param params The argument parser, positioned just past the fields already read
  * @return Error or success code, according to the requirements specified by addSprout
  */
-int Ohmbrewer::Rhizome::addThermostat(char* params) {
+int Ohmbrewer::Rhizome::addThermostat(CommandParser &params) {
     std::list<int> thermPins;
     int errorCode = parseThermostatPins(params, thermPins);
 
     if(errorCode == AddSproutError::NONE) {
-        saveNewSprout(new Ohmbrewer::Thermostat(&thermPins));
+        errorCode = saveNewSprout(new Ohmbrewer::Thermostat(&thermPins));
     }
 
     return errorCode;
@@ -537,13 +955,13 @@ int Ohmbrewer::Rhizome::addThermostat(char* params) {
 
 /**
  * Parses a given string of characters into the pins for a RIMS
- * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+ * @param params The argument parser, positioned just past the fields already read
  * @param thermPins The thermostat pins
  * @param pumpPin The pump pin
  * @param safetyIndex The onewire index for the safety sensor
  * @return Error or success code, according to the requirements specified by addSprout
  */
-int Ohmbrewer::Rhizome::parseRIMSPins(char* params, std::list<int> &thermPins, int &pumpPin, int &safetyIndex) {
+int Ohmbrewer::Rhizome::parseRIMSPins(CommandParser &params, std::list<int> &thermPins, int &pumpPin, int &safetyIndex) {
     int errorCode = AddSproutError::NONE;
 
     errorCode = parseThermostatPins(params, thermPins);
@@ -566,67 +984,63 @@ int Ohmbrewer::Rhizome::parseRIMSPins(char* params, std::list<int> &thermPins, i
 
 /**
  * Adds a RIMS
- * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+ * @param params The argument parser, positioned just past the fields already read
  * @return Error or success code, according to the requirements specified by addSprout
  */
-int Ohmbrewer::Rhizome::addRIMS(char* params) {
+int Ohmbrewer::Rhizome::addRIMS(CommandParser &params) {
     int pumpPin;
     int safetyIndex;
     std::list<int> thermPins;
     int errorCode = parseRIMSPins(params, thermPins, pumpPin, safetyIndex);
 
     if(errorCode == AddSproutError::NONE) {
-        saveNewSprout(new Ohmbrewer::RIMS(&thermPins, pumpPin, safetyIndex ));
+        errorCode = saveNewSprout(new Ohmbrewer::RIMS(&thermPins, pumpPin, safetyIndex ));
     }
 
     return errorCode;
 }
 
 /**
- * Adds a sprout to the list and rebuids the index
- * @param equipment The sprout being added
+ * Adds a sprout to the registry and rebuids the index
+ * @param equipment The sprout being added. Deleted if it can't be added.
+ * @return Error or success code, according to the requirements specified by addSprout
  */
-void Ohmbrewer::Rhizome::saveNewSprout(Equipment* sprout) {
-    _sprouts->push_back(sprout);
-    rebuildIndex();
+int Ohmbrewer::Rhizome::saveNewSprout(Equipment* sprout) {
+    if(!_pins->claim(sprout)) {
+        // The parsers check the pins they're given, but not everything a Sprout ends up connected to
+        delete sprout;
+        return AddSproutError::PIN_IN_USE;
+    }
+
+    if(!_registry->add(sprout)) {
+        // There's already a Sprout of this type with this ID
+        discardSprout(sprout);
+        return AddSproutError::ID_IN_USE;
+    }
+
+    return AddSproutError::NONE;
 }
 
 /**
- * Rebuilds index based on current list of equipment
+ * Releases a Sprout's pins, deletes its step program and deletes it. It must already be out of the registry.
+ * @param sprout The Sprout being discarded
  */
-void Ohmbrewer::Rhizome::rebuildIndex() {
-
-    String tempIndex = String("{ ");
-
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        tempIndex.concat("{ ");
-        tempIndex.concat(" \"id\": \"");
-        tempIndex.concat((*itr)->getID());
-        tempIndex.concat("\", ");
-        tempIndex.concat("\"type\": \"");
-        tempIndex.concat((*itr)->getType());
-        tempIndex.concat("\", ");
-        tempIndex.concat("\"state\": \"");
-        tempIndex.concat((*itr)->getState());
-        tempIndex.concat("\", ");
-        tempIndex.concat("\"current task\": \"");
-        tempIndex.concat((*itr)->getCurrentTask());
-        tempIndex.concat("\"");
-        tempIndex.concat(" }");
-        if((*itr) != _sprouts->back()) {
-            tempIndex.concat(", ");
+void Ohmbrewer::Rhizome::discardSprout(Equipment* sprout) {
+    for (std::deque<Ohmbrewer::StepProgram*>::iterator itr = _programs.begin(); itr != _programs.end(); itr++) {
+        if ((*itr)->getSprout() == sprout) {
+            delete (*itr);
+            _programs.erase(itr);
+            break;
         }
     }
-    tempIndex.concat(" }");
 
-    _index = tempIndex;
-    Serial.println(_index);
+    _pins->release(sprout);
+    delete sprout;
 }
 
 /**
- * Rebuilds the Sprout index and refreshes the Screen
+ * Refreshes the Screen once Sprouts have been added or removed
  */
 void Ohmbrewer::Rhizome::refreshSprouts() {
-    rebuildIndex();
-    _screen->initScreen();
+    _screen->reinitScreen();
 }
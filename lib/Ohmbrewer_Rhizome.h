@@ -12,6 +12,11 @@
 #include <deque>
 #include "Ohmbrewer_Equipment.h"
 #include "Ohmbrewer_Screen.h"
+#include "Ohmbrewer_Scheduler.h"
+#include "Ohmbrewer_Telemetry.h"
+#include "Ohmbrewer_Sprout_Registry.h"
+#include "Ohmbrewer_Pin_Allocator.h"
+#include "Ohmbrewer_Step_Program.h"
 #include "application.h"
 
 
@@ -35,6 +40,9 @@ namespace Ohmbrewer {
             static const int PIN_IN_USE = -3;
             static const int INCORRECT_PIN_COUNT = -4;
             static const int SPROUT_NOT_IMPLEMENTED = -5;
+            static const int PROBE_NOT_FOUND = -6;
+            static const int TOO_MANY_SPROUTS = -7;
+            static const int OUT_OF_MEMORY = -8;
         };
 
         /**
@@ -43,10 +51,12 @@ namespace Ohmbrewer {
         class UpdateSproutError {
             public:
 
+            static const int NONE = 0;
             static const int INVALID_TYPE = -1;
             static const int INVALID_ID = -2;
             static const int SPROUT_NOT_FOUND = -3;
             static const int UPDATE_FAILURE = -4;
+            static const int INVALID_ARGUMENTS = -5;
         };
 
         /**
@@ -60,6 +70,89 @@ namespace Ohmbrewer {
             static const int SPROUT_NOT_FOUND = -2;
         };
 
+        /**
+         * Provides error codes that may occur while attempting a batch of updates on the Rhizome.
+         */
+        class BatchError {
+            public:
+
+            static const int NONE = 0;
+            static const int EMPTY = -1;
+            static const int TOO_LONG = -2;
+            static const int TOO_MANY_COMMANDS = -3;
+            static const int REJECTED = -4;
+        };
+
+        /**
+         * Provides error codes that may occur while attempting to load or stop a step program on the Rhizome.
+         */
+        class ProgramError {
+            public:
+
+            static const int INVALID_TYPE = -1;
+            static const int INVALID_ID = -2;
+            static const int SPROUT_NOT_FOUND = -3;
+            static const int INVALID_STEP = -4;
+            static const int TOO_MANY_STEPS = -5;
+            static const int NO_PROGRAM = -6;
+        };
+
+        /**
+         * Provides error codes that may occur while attempting to start or stop autotuning on the Rhizome.
+         */
+        class TuneError {
+            public:
+
+            static const int INVALID_TYPE = -1;
+            static const int INVALID_ID = -2;
+            static const int SPROUT_NOT_FOUND = -3;
+            static const int INVALID_TARGET = -4;
+            static const int NOT_TUNING = -5;
+        };
+
+        /**
+         * Provides error codes that may occur while attempting to load the PID gain schedule on the Rhizome.
+         */
+        class GainsError {
+            public:
+
+            static const int INVALID_POINT = -1;
+            static const int TOO_MANY_POINTS = -2;
+            static const int NO_DEFAULT = -3;
+        };
+
+        /**
+         * The most updates a batch may hold
+         */
+        static const int MAX_BATCH_COMMANDS = 8;
+
+        /**
+         * The longest batch argument string accepted. This is the longest a Particle function argument can be.
+         */
+        static const int MAX_BATCH_LENGTH = 622;
+
+        /**
+         * The delimiter between the updates in a batch
+         */
+        static const char BATCH_DELIMITER = ';';
+
+        /**
+         * The most characters the Sprout index will hold - the limit on a Particle.variable String. Sprouts whose
+         * entries don't fit are left out.
+         */
+        static const unsigned int MAX_INDEX_LENGTH = 622;
+
+        /**
+         * How often each of the Rhizome's tasks runs, in milliseconds
+         */
+        static const unsigned long PID_TASK_PERIOD = 200;
+        static const unsigned long TOUCH_TASK_PERIOD = 50;
+        static const unsigned long DISPLAY_TASK_PERIOD = 1000;
+        static const unsigned long FLUSH_TASK_PERIOD = 5;
+        static const unsigned long PUBLISH_TASK_PERIOD = 15000;
+        static const unsigned long STATS_TASK_PERIOD = 5000;
+        static const unsigned long PROGRAM_TASK_PERIOD = 1000;
+
         /**
          * Constructor
          */
@@ -108,6 +201,25 @@ namespace Ohmbrewer {
          */
         int updateSprout(String argsStr);
 
+        /**
+         * Updates several Equipment at once. Every update is checked before any of them are applied, so either
+         * the whole batch is applied or none of it is. Particle runs cloud functions between passes of loop(),
+         * so work() never sees a half-applied batch.
+         *
+         * The argument string for this function must match the following format:
+         * UPDATE;UPDATE;...
+         * where each UPDATE is the TYPE,ID,UPDATE_STRING argument string that updateSprout() takes.
+         *
+         * The result of each update is left in the "batch" Particle variable, comma delimited and in order:
+         * the Equipment ID if it was applied, (negative) error codes for those that were rejected (see
+         * Rhizome::UpdateSproutError), and 0 for those that were fine but not applied because others were rejected.
+         *
+         * @param argsStr The argument string passed via the Particle Cloud.
+         * @returns The number of updates applied if successful,
+         *          (negative) error codes if unsuccessful (see Rhizome::BatchError)
+         */
+        int batchUpdate(String argsStr);
+
         /**
          * Dynamically removes one or more Equipment from the Rhizome.
          *
@@ -120,6 +232,77 @@ namespace Ohmbrewer {
          */
         int removeSprouts(String argsStr);
 
+        /**
+         * Clears the loop timing stats and event counts, so the next "stats" and "events" readings only cover
+         * what happens from now on. The argument string is ignored.
+         *
+         * @param argsStr The argument string passed via the Particle Cloud.
+         * @returns 0
+         */
+        int resetStats(String argsStr);
+
+        /**
+         * Loads a step program (see StepProgram) onto a Thermostat or RIMS and starts it, replacing any program
+         * it was already running. The program then runs on the Rhizome, without any further cloud calls.
+         *
+         * The argument string for this function must match one of the following formats:
+         * TYPE,ID,STEP{,STEP...}
+         * TYPE,ID,stop
+         * where
+         * TYPE is the TYPE_NAME of a Thermostat or RIMS
+         * ID matches the ID of the desired Equipment
+         * STEP is TARGET_TEMP,RAMP_RATE,HOLD_TIME,PUMP_STATE (see StepProgram::parseStep())
+         *
+         * @param argsStr The argument string passed via the Particle Cloud.
+         * @returns Equipment ID if successful,
+         *          (negative) error codes if unsuccessful (see Rhizome::ProgramError)
+         */
+        int loadProgram(String argsStr);
+
+        /**
+         * Tunes the PID gains of a Thermostat or RIMS by relay feedback (see Autotuner), around its target
+         * temperature. The Equipment is turned on, and any step program it was running is stopped. Tuning runs
+         * on the Rhizome; when it's over, the outcome is published to the Equipment's stream and, if it
+         * succeeded, the tuned gains replace the gain schedule's gains for any phase (see GainSchedule).
+         *
+         * The argument string for this function must match one of the following formats:
+         * TYPE,ID{,TARGET_TEMP}
+         * TYPE,ID,stop
+         * where
+         * TYPE is the TYPE_NAME of a Thermostat or RIMS
+         * ID matches the ID of the desired Equipment
+         * TARGET_TEMP is the temperature to tune around, in Celsius. Defaults to the current target.
+         *
+         * @param argsStr The argument string passed via the Particle Cloud.
+         * @returns Equipment ID if successful,
+         *          (negative) error codes if unsuccessful (see Rhizome::TuneError)
+         */
+        int tuneSprout(String argsStr);
+
+        /**
+         * Replaces the gain schedule (see GainSchedule) all of the Thermostats pick their PID gains from, and
+         * saves it to EEPROM. The current schedule is in the "gains" Particle variable.
+         *
+         * The argument string for this function must match one of the following formats:
+         * POINT{,POINT...}
+         * reset
+         * where
+         * POINT is PHASE,ERROR,KP,KI,KD (see GainSchedule::parsePoint())
+         * At least one POINT must be for the "any" phase. reset goes back to the default schedule.
+         *
+         * @param argsStr The argument string passed via the Particle Cloud.
+         * @returns The number of points in the schedule if successful,
+         *          (negative) error codes if unsuccessful (see Rhizome::GainsError)
+         */
+        int loadGains(String argsStr);
+
+        /**
+         * Finds the step program loaded onto a Sprout
+         * @param sprout The Sprout
+         * @returns The program, or NULL if it has none
+         */
+        StepProgram* findProgram(Equipment* sprout);
+
         /**
          * Dynamically removes Equipment from the Rhizome.
          *
@@ -128,7 +311,7 @@ namespace Ohmbrewer {
          * @returns Equipment ID if successful,
          *          (negative) error codes if unsuccessful (see Rhizome::RemoveSproutError)
          */
-        int removeSprout(String type, int id);
+        int removeSprout(Equipment::TypeCode type, int id);
 
         /**
          * Removes all Equipment from the Rhizome.
@@ -145,20 +328,26 @@ namespace Ohmbrewer {
          * @returns 0 if successful
          *          (negative) error codes if unsuccessful (see Rhizome::RemoveSproutError)
          */
-        int removeAllSprouts(String type);
+        int removeAllSprouts(Equipment::TypeCode type);
 
         /**
-         * Publishes any periodic updates that need to be published.
-         * @see _periodicUpdateTimer
+         * Publishes any periodic updates that need to be published - the status of every Sprout,
+         * batched into telemetry frames (see Telemetry). Runs as the scheduler's "publish" task.
          */
         void publishPeriodicUpdates();
 
         /**
-         * Gets the deque of Sprouts
+         * Gets the deque of Sprouts. Read only - add and remove Sprouts through the registry.
          * @returns The Sprouts
          */
         std::deque< Equipment* >* getSprouts();
 
+        /**
+         * Gets the Sprout registry
+         * @returns The registry
+         */
+        SproutRegistry* getRegistry();
+
         /**
          * Gets the current runtime settings
          * @returns The settings
@@ -172,8 +361,21 @@ namespace Ohmbrewer {
         Screen* getScreen();
 
         /**
-         * Called in loop, iterates through the the spouts equipment list
-         * and calls work() on each equipment stored in the sprouts list
+         * Gets the task scheduler
+         * @returns The scheduler
+         */
+        Scheduler* getScheduler();
+
+        /**
+         * Assembles the index of all registered Sprouts from their cached entries (see
+         * Equipment::getIndexEntry()), so it's current whenever it's read. Exposed as the "index" Particle variable.
+         * @returns The index, in JSON format
+         */
+        const String& getIndex();
+
+        /**
+         * Called in loop, fires whichever timers have come due (relay windows, sensor conversions, stop times
+         * and the like), then runs whichever of the Rhizome's tasks have come due (see initScheduler())
          */
         void work();
 
@@ -181,9 +383,19 @@ namespace Ohmbrewer {
 
         /**
          * Each Sprout is a logical collection of physical pins/relays that are connected
-         * to a single piece of Equipment.
+         * to a single piece of Equipment. The registry keeps them indexed by type and ID.
+         */
+        SproutRegistry* _registry;
+
+        /**
+         * Which pins belong to which Sprouts
+         */
+        PinAllocator* _pins;
+
+        /**
+         * The step programs loaded onto Sprouts, at most one each
          */
-        std::deque< Equipment* >* _sprouts;
+        std::deque< StepProgram* > _programs;
 
         /**
          * The touchscreen object. Handles the display for the Rhizome.
@@ -196,32 +408,60 @@ namespace Ohmbrewer {
         RuntimeSettings* _settings;
 
         /**
-         * The system-wide Timer for periodic updates. Kicks off every 15 seconds.
+         * Runs the Rhizome's subsystems (sensors, PID, relays, touch, display, cloud) as periodic tasks
+         */
+        Scheduler* _scheduler;
+
+        /**
+         * Batches every Sprout's periodic status into as few cloud events as possible
          */
-        Timer* _periodicUpdateTimer;
+        Telemetry* _telemetry;
 
         /**
-         * Keeps a json format index of all registered equipment for easy access
-         * to any requesting application. Exposed via particle.variable
+         * The json format index of all registered equipment, for easy access by any requesting application.
+         * Assembled by getIndex() whenever particle.variable reads it, into a buffer reserved up front.
          */
         String _index;
 
+        /**
+         * Summary of the loop timing stats (see LoopStats::toString()). Exposed via particle.variable and
+         * refreshed by the scheduler's "stats" task.
+         */
+        String _stats;
+
+        /**
+         * Published and suppressed event counts (see EventGate::toString()). Exposed via particle.variable and
+         * refreshed by the scheduler's "stats" task.
+         */
+        String _events;
+
+        /**
+         * The result of each update in the last batch (see batchUpdate()). Exposed via particle.variable
+         */
+        String _batchResults;
+
+        /**
+         * The gain schedule (see GainSchedule::toString()). Exposed via particle.variable
+         */
+        String _gains;
+
 
     private:
 
         /**
-         * Determines if the supplied string failed Particle's toInt() conversion.
-         * @param raw String to examine
-         * @returns Whether the string failed the conversion
+         * Sets up the Rhizome's periodic tasks. Tasks run in the order they're added, most time critical first.
          */
-        bool isFakeZero(String raw);
+        void initScheduler();
 
         /**
-         * Determines if the supplied string's first character is the number 0.
-         * @param raw String to examine
-         * @returns Whether the string starts with 0
+         * Iterates through the the spouts equipment list and calls work() on each equipment stored in the sprouts list
          */
-        bool isNotActualZero(String raw);
+        void workSprouts();
+
+        /**
+         * Moves each of the loaded step programs along
+         */
+        void workPrograms();
 
         /**
          * Determines if any of the pins in the supplied list are already assigned to a Sprout.
@@ -231,95 +471,107 @@ namespace Ohmbrewer {
         bool arePinsInUse(std::list<int>* newPins);
 
         /**
-         * Parses a given string of characters into the pins for a Temperature Sensor
-         * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+         * Finds the Equipment an update is for.
+         * @param command The TYPE,ID,UPDATE_STRING argument string of the update (see updateSprout())
+         * @param sprout Set to the Equipment
+         * @param updateArgs Set to the ID,UPDATE_STRING part of the update, for the Equipment's update() method
+         * @returns UpdateSproutError::NONE, or the (negative) error code if the Equipment can't be found
+         */
+        int findUpdateTarget(const char* command, Equipment* &sprout, const char* &updateArgs);
+
+        /**
+         * Parses a given string of characters into the pins for a Temperature Sensor.
+         * The sensor may be given either as its onewire index or as its 16 hex digit ROM code.
+         * @param params The argument parser, positioned just past the fields already read
          * @param index The onewire sensor index (-1 if unused / non onewire)
          * @return Error or success code, according to the requirements specified by addSprout
          */
-        int parseOnewireSensorPins(char* params, int &index);
+        int parseOnewireSensorPins(CommandParser &params, int &index);
 
         /**
          * Adds a Temperature Sensor based on the next chunk of parsed data.
-         * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+         * @param params The argument parser, positioned just past the fields already read
          * @return Error or success code, according to the requirements specified by addSprout
          */
-        int addTemperatureSensor(char* params);
+        int addTemperatureSensor(CommandParser &params);
 
         /**
          * Parses a given string of characters into the pins for a Pump
-         * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+         * @param params The argument parser, positioned just past the fields already read
          * @param pin The power pin
          * @return Error or success code, according to the requirements specified by addSprout
          */
-        int parsePumpPins(char* params, int &pin);
+        int parsePumpPins(CommandParser &params, int &pin);
 
         /**
          * Adds a Pump based on the next chunk of parsed data.
-         * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+         * @param params The argument parser, positioned just past the fields already read
          * @return Error or success code, according to the requirements specified by addSprout
          */
-        int addPump(char* params);
+        int addPump(CommandParser &params);
 
         /**
          * Parses a given string of characters into the pins for a Heating Element
-         * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+         * @param params The argument parser, positioned just past the fields already read
          * @param elementPins The heating element pins
          * @return Error or success code, according to the requirements specified by addSprout
          */
-        int parseHeatingElementPins(char* params, std::list<int> &elementPins);
+        int parseHeatingElementPins(CommandParser &params, std::list<int> &elementPins);
 
         /**
          * Adds a Heating Element based on the next chunk of parsed data.
-         * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+         * @param params The argument parser, positioned just past the fields already read
          * @return Error or success code, according to the requirements specified by addSprout
          */
-        int addHeatingElement(char* params);
+        int addHeatingElement(CommandParser &params);
 
         /**
          * Parses a given string of characters into the pins for a Thermostat
-         * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+         * @param params The argument parser, positioned just past the fields already read
          * @param thermPins The thermostat pins [tempbus, OW probe index, controlpin, powerpin]
          * @return Error or success code, according to the requirements specified by addSprout
          */
-        int parseThermostatPins(char* params, std::list<int> &thermPins);
+        int parseThermostatPins(CommandParser &params, std::list<int> &thermPins);
 
         /**
          * Adds a Thermostat based on the next chunk of parsed data.
-         * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+         * @param params The argument parser, positioned just past the fields already read
          * @return Error or success code, according to the requirements specified by addSprout
          */
-        int addThermostat(char* params);
+        int addThermostat(CommandParser &params);
 
         /**
          * Parses a given string of characters into the pins for a RIMS
-         * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+         * @param params The argument parser, positioned just past the fields already read
          * @param thermPins The thermostat pins
          * @param pumpPin The pump pin
          * @param safetyIndex The onewire index for the safety sensor
          * @return Error or success code, according to the requirements specified by addSprout
          */
-        int parseRIMSPins(char* params, std::list<int> &thmPins, int &pumpPin, int &safetyIndex);
+        int parseRIMSPins(CommandParser &params, std::list<int> &thmPins, int &pumpPin, int &safetyIndex);
 
         /**
          * Adds a RIMS based on the next chunk of parsed data.
-         * @param params The buffer to use for strtok'ing. This method will not delete the buffer!
+         * @param params The argument parser, positioned just past the fields already read
          * @return Error or success code, according to the requirements specified by addSprout
          */
-        int addRIMS(char* params);
+        int addRIMS(CommandParser &params);
 
         /**
-         * Adds a sprout to the list and rebuids the index
-         * @param equipment The sprout being added
+         * Adds a sprout to the registry and rebuids the index
+         * @param equipment The sprout being added. Deleted if it can't be added.
+         * @return Error or success code, according to the requirements specified by addSprout
          */
-        void saveNewSprout(Equipment* sprout);
+        int saveNewSprout(Equipment* sprout);
 
         /**
-         * Rebuilds index based on current list of equipment
+         * Releases a Sprout's pins, deletes its step program and deletes it. It must already be out of the registry.
+         * @param sprout The Sprout being discarded
          */
-        void rebuildIndex();
+        void discardSprout(Equipment* sprout);
 
         /**
-         * Rebuilds the Sprout index and refreshes the Screen
+         * Refreshes the Screen once Sprouts have been added or removed
          */
         void refreshSprouts();
 
@@ -28,6 +28,16 @@ namespace Ohmbrewer {
         static const int EEPROM_TEMP_UNIT_F = 0x01;
         static const int EEPROM_TEMP_UNIT_C = 0x00;
 
+        /**
+         * Where the OnewireBus keeps its table of known probe ROM codes (OnewireBus::MAX_PROBES slots, 8 bytes apiece)
+         */
+        static const int PROBE_TABLE_ADDR = 3;
+
+        /**
+         * Where the GainSchedule keeps its table, just past the probe table
+         */
+        static const int GAIN_SCHEDULE_ADDR = 83;
+
 
         /* Methods */
 
@@ -0,0 +1,118 @@
+#include "Ohmbrewer_Scheduler.h"
+#include "Ohmbrewer_Loop_Stats.h"
+
+/**
+ * Constructor
+ */
+Ohmbrewer::Scheduler::Scheduler() {
+    _numTasks = 0;
+}
+
+/**
+ * Adds a periodic task. The task first comes due on the next call to run(). Its entries in the Rhizome's
+ * LoopStats are reserved (see LoopStats::reserve()).
+ * @param name Short name, for reporting
+ * @param period How often the task should run, in milliseconds
+ * @param deadline How long after coming due the task should be finished, in microseconds
+ * @param fn The work to do
+ * @returns The task's ID, or -1 if the scheduler is full
+ */
+int Ohmbrewer::Scheduler::addTask(const char* name, unsigned long period, unsigned long deadline, task_fn_t fn) {
+    if(_numTasks >= MAX_TASKS) {
+        return -1;
+    }
+
+    Task* task = &_tasks[_numTasks];
+    task->name = name;
+    task->fn = fn;
+    task->period = period;
+    task->deadline = deadline;
+    task->nextRun = millis();
+    task->lastRunTime = 0;
+    task->maxRunTime = 0;
+    task->runs = 0;
+    task->overruns = 0;
+
+    // A task's stats are tracked however much Equipment there is
+    LoopStats::getInstance()->reserve(name, -1, LoopStats::PHASE_RUN);
+    LoopStats::getInstance()->reserve(name, -1, LoopStats::PHASE_LATENESS);
+
+    return _numTasks++;
+}
+
+/**
+ * Runs every task that has come due. Expect to call this once per loop().
+ * Each task's run time and how late it started are recorded in the Rhizome's LoopStats.
+ * @returns The time taken to run the method, in microseconds
+ */
+unsigned long Ohmbrewer::Scheduler::run() {
+    unsigned long start = micros();
+
+    for(int i = 0; i < _numTasks; i++) {
+        Task* task = &_tasks[i];
+
+        // Signed difference, so this keeps working when millis() rolls over
+        if((long)(millis() - task->nextRun) < 0) {
+            continue;
+        }
+
+        unsigned long due = task->nextRun;
+        unsigned long startLateness = (millis() - due) * 1000;
+        unsigned long taskStart = micros();
+        task->fn();
+        unsigned long finished = micros();
+
+        task->lastRunTime = finished - taskStart;
+        if(task->lastRunTime > task->maxRunTime) {
+            task->maxRunTime = task->lastRunTime;
+        }
+        task->runs++;
+        LoopStats::getInstance()->record(task->name, -1, LoopStats::PHASE_RUN, task->lastRunTime);
+        LoopStats::getInstance()->record(task->name, -1, LoopStats::PHASE_LATENESS, startLateness);
+
+        // Count lateness as well as run time against the deadline
+        unsigned long lateness = (millis() - due) * 1000;
+        if(lateness > task->deadline || task->lastRunTime > task->deadline) {
+            task->overruns++;
+        }
+
+        // Keep to the period's grid, but don't try to catch up on runs we've missed entirely
+        task->nextRun = due + task->period;
+        if((long)(millis() - task->nextRun) >= 0) {
+            task->nextRun = millis() + task->period;
+        }
+    }
+
+    return micros() - start;
+}
+
+/**
+ * Gets a task's timing record
+ * @param id The task's ID
+ * @returns The task, or NULL if there's no such task
+ */
+const Ohmbrewer::Scheduler::Task* Ohmbrewer::Scheduler::getTask(int id) const {
+    if(id < 0 || id >= _numTasks) {
+        return NULL;
+    }
+    return &_tasks[id];
+}
+
+/**
+ * @returns The number of tasks
+ */
+int Ohmbrewer::Scheduler::getNumTasks() const {
+    return _numTasks;
+}
+
+/**
+ * Clears the run time and overrun records of every task
+ */
+void Ohmbrewer::Scheduler::resetStats() {
+    for(int i = 0; i < _numTasks; i++) {
+        _tasks[i].lastRunTime = 0;
+        _tasks[i].maxRunTime = 0;
+        _tasks[i].runs = 0;
+        _tasks[i].overruns = 0;
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ * This library provides the Scheduler class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_RHIZOME_SCHEDULER_H
+#define OHMBREWER_RHIZOME_SCHEDULER_H
+
+#include <functional>
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * A cooperative scheduler for the Rhizome's subsystems.
+     *
+     * Each task has a period and a deadline. Every call to run() runs each task that has come due, in the order the
+     * tasks were added (so add the most time critical tasks first). Tasks must never block - they do a slice of work
+     * and return. The scheduler records how long each task takes and counts overruns, i.e. passes where a task
+     * finished later than its deadline after coming due.
+     */
+    class Scheduler {
+
+        public:
+
+            /**
+             * The most tasks the scheduler will hold
+             */
+            static const int MAX_TASKS = 8;
+
+            /**
+             * The work a task does each time it comes due
+             */
+            typedef std::function<void()> task_fn_t;
+
+            /**
+             * A periodic task and its timing record
+             */
+            struct Task {
+                /**
+                 * Short name, for reporting
+                 */
+                const char* name;
+
+                /**
+                 * The work to do
+                 */
+                task_fn_t fn;
+
+                /**
+                 * How often the task should run, in milliseconds
+                 */
+                unsigned long period;
+
+                /**
+                 * How long after coming due the task should be finished, in microseconds
+                 */
+                unsigned long deadline;
+
+                /**
+                 * millis() at which the task next comes due
+                 */
+                unsigned long nextRun;
+
+                /**
+                 * How long the last run took, in microseconds
+                 */
+                unsigned long lastRunTime;
+
+                /**
+                 * The longest any run has taken, in microseconds
+                 */
+                unsigned long maxRunTime;
+
+                /**
+                 * The number of times the task has run
+                 */
+                unsigned long runs;
+
+                /**
+                 * The number of runs that finished after their deadline
+                 */
+                unsigned long overruns;
+            };
+
+            /**
+             * Constructor
+             */
+            Scheduler();
+
+            /**
+             * Adds a periodic task. The task first comes due on the next call to run(). Its entries in the Rhizome's
+             * LoopStats are reserved (see LoopStats::reserve()).
+             * @param name Short name, for reporting
+             * @param period How often the task should run, in milliseconds
+             * @param deadline How long after coming due the task should be finished, in microseconds
+             * @param fn The work to do
+             * @returns The task's ID, or -1 if the scheduler is full
+             */
+            int addTask(const char* name, unsigned long period, unsigned long deadline, task_fn_t fn);
+
+            /**
+             * Runs every task that has come due. Expect to call this once per loop().
+             * Each task's run time and how late it started are recorded in the Rhizome's LoopStats.
+             * @returns The time taken to run the method, in microseconds
+             */
+            unsigned long run();
+
+            /**
+             * Gets a task's timing record
+             * @param id The task's ID
+             * @returns The task, or NULL if there's no such task
+             */
+            const Task* getTask(int id) const;
+
+            /**
+             * @returns The number of tasks
+             */
+            int getNumTasks() const;
+
+            /**
+             * Clears the run time and overrun records of every task
+             */
+            void resetStats();
+
+        protected:
+
+            /**
+             * The tasks, in the order they were added
+             */
+            Task _tasks[MAX_TASKS];
+
+            /**
+             * The number of tasks
+             */
+            int _numTasks;
+    };
+};
+
+#endif
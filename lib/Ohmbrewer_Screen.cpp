@@ -6,6 +6,7 @@
 #include "Ohmbrewer_Relay.h"
 #include "Ohmbrewer_Thermostat.h"
 #include "Ohmbrewer_RIMS.h"
+#include "Ohmbrewer_Sprout_Registry.h"
 #include "Ohmbrewer_Runtime_Settings.h"
 #include "Ohmbrewer_Menu_WiFi.h"
 #include "Ohmbrewer_Menu_Main.h"
@@ -20,9 +21,10 @@
 Ohmbrewer::Screen::Screen(uint8_t CS,
                           uint8_t RS,
                           uint8_t RST,
-                          std::deque< Ohmbrewer::Equipment* >* sprouts,
-                          Ohmbrewer::RuntimeSettings *settings) : Adafruit_ILI9341(CS, RS, RST) {
-    _sprouts = sprouts;
+                          Ohmbrewer::SproutRegistry* registry,
+                          Ohmbrewer::RuntimeSettings *settings) : Adafruit_ILI9341(CS, RS, RST),
+                                                                         _grid(DEFAULT_BG_COLOR) {
+    _registry = registry;
     _settings= settings;
 
     /*
@@ -30,7 +32,7 @@ Ohmbrewer::Screen::Screen(uint8_t CS,
      *  between X+ and X- Use any multimeter to read it
      *  Using value of 285 ohms across the X plate
      */
-    _ts = new TouchScreen(XP, YP, XM, YM, 285);
+    _touch = new TouchSampler(new TouchScreen(XP, YP, XM, YM, 285));
 
     // Build the menu tree
     _homeMenu = new MenuHome(this, settings);
@@ -43,36 +45,203 @@ Ohmbrewer::Screen::Screen(uint8_t CS,
 
     // Set the current menu to be the home menu
     _currentMenu = _homeMenu;
+
+    _status[0] = '\0';
+
+    _cs = CS;
+    _dc = RS;
+    _tileStates[0] = TILE_FREE;
+    _tileStates[1] = TILE_FREE;
+    _renderTile = 0;
+    _sendTile = 0;
 }
 
+Ohmbrewer::Screen* volatile Ohmbrewer::Screen::_flushing = NULL;
+
 /**
  * Destructor
  */
 Ohmbrewer::Screen::~Screen() {
-    delete _ts;
+    delete _touch;
     delete _homeMenu;
 }
 
 /**
- * Initializes the display screen
+ * Initializes the display screen, clearing it and drawing the header and buttons
  */
 void Ohmbrewer::Screen::initScreen() {
+    finishFlush();
     begin();
+
+    // Erase everything. This is the only time the whole screen is filled.
+    fillScreen(DEFAULT_BG_COLOR);
+    _grid.clear();
+
+    // Draw the header and buttons that are always there
+    displayHeader();
+    drawButtons();
+
+    // Start listening for them
+    _touch->begin();
+
     reinitScreen();
 }
 
 /**
- * Reinitializes the display screen
+ * Reinitializes the display screen for a new menu or set of sprouts. Nothing is erased here - the next
+ * refresh only redraws what changed.
  */
 void Ohmbrewer::Screen::reinitScreen() {
-    // Erase everything
-    fillScreen(DEFAULT_BG_COLOR);
+    // Reset the cursor
+    setCursor(LEFT, CONTENT_TOP);
+}
 
-    // Draw the buttons that are always there
-    drawButtons();
+/**
+ * Writes a character to the screen. Size 2 text on the content area goes into the text grid, to be
+ * drawn by flushDisplay() if it's different from what's already there; anything else is drawn directly.
+ * @param c The character
+ * @returns The number of characters written
+ */
+size_t Ohmbrewer::Screen::write(uint8_t c) {
+    int top = cursor_y - CONTENT_TOP;
+    int column = cursor_x / TextGrid::CELL_WIDTH;
+    int row = top / TextGrid::CELL_HEIGHT;
 
-    // Reset the cursor
-    setCursor(LEFT, TOP);
+    if (c == '\n' || c == '\r') {
+        return Adafruit_ILI9341::write(c);
+    }
+
+    // Transparent text, other sizes and anything off the grid's cells are drawn as they come,
+    // and whatever the grid thought was under them is forgotten
+    if (textsize != DEFAULT_TEXT_SIZE || textcolor == textbgcolor ||
+        cursor_x < 0 || cursor_x % TextGrid::CELL_WIDTH != 0 || column >= TextGrid::COLUMNS ||
+        top < 0 || top % TextGrid::CELL_HEIGHT != 0 || row + 1 >= TextGrid::ROWS) {
+        int w = textsize * 6;
+        int h = textsize * 8;
+
+        if (cursor_x + w > 0 && top + h > 0) {
+            int firstColumn = (cursor_x > 0) ? cursor_x / TextGrid::CELL_WIDTH : 0;
+            int firstRow = (top > 0) ? top / TextGrid::CELL_HEIGHT : 0;
+
+            _grid.invalidate(firstColumn, firstRow,
+                             ((cursor_x + w - 1) / TextGrid::CELL_WIDTH) - firstColumn + 1,
+                             ((top + h - 1) / TextGrid::CELL_HEIGHT) - firstRow + 1);
+        }
+        finishFlush();
+        return Adafruit_ILI9341::write(c);
+    }
+
+    _grid.set(column, row, c, false, textcolor, textbgcolor);
+    _grid.set(column, row + 1, c, true, textcolor, textbgcolor);
+
+    // Move along, wrapping as Adafruit_GFX does
+    cursor_x += textsize * 6;
+    if (wrap && (cursor_x > (width() - textsize * 6))) {
+        cursor_y += textsize * 8;
+        cursor_x = 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Ends a refresh: blanks the text grid's cells that weren't printed to
+ */
+void Ohmbrewer::Screen::releaseGrid() {
+    for (int row = 0; row < TextGrid::ROWS; row++) {
+        for (int column = 0; column < TextGrid::COLUMNS; column++) {
+            _grid.release(column, row);
+        }
+    }
+}
+
+/**
+ * Moves the text grid's changes along to the display without waiting for the SPI bus: starts sending the
+ * next finished tile if the bus is free, and renders dirty cells into any tile that isn't in use.
+ * @returns Time it took to run the function
+ */
+unsigned long Ohmbrewer::Screen::flushDisplay() {
+    unsigned long start = micros();
+    int row = 0;
+    int column;
+    int count;
+
+    sendTile();
+
+    // Fill whichever tiles are free with the next runs of dirty cells
+    while (_tileStates[_renderTile] == TILE_FREE && _grid.nextDirtyRun(row, column, count)) {
+        Tile &tile = _tiles[_renderTile];
+
+        tile.place(column * TextGrid::CELL_WIDTH, CONTENT_TOP + (row * TextGrid::CELL_HEIGHT),
+                   count * TextGrid::CELL_WIDTH);
+        for (int i = 0; i < count; i++) {
+            const TextGrid::Cell &cell = _grid.getCell(column + i, row);
+
+            tile.drawCell(i * TextGrid::CELL_WIDTH, cell.glyph, cell.isBottom(), cell.color, cell.bg);
+            _grid.clean(column + i, row);
+        }
+
+        _tileStates[_renderTile] = TILE_READY;
+        _renderTile = 1 - _renderTile;
+        sendTile();
+    }
+
+    return micros() - start;
+}
+
+/**
+ * Waits until every change in the text grid has reached the display. Called before anything is drawn
+ * directly, so it can't be drawn over by a tile sent later.
+ */
+void Ohmbrewer::Screen::finishFlush() {
+    while (!isFlushed()) {
+        flushDisplay();
+        // Let the DMA get on with it
+        delayMicroseconds(10);
+    }
+}
+
+/**
+ * @returns Whether every change in the text grid has reached the display
+ */
+bool Ohmbrewer::Screen::isFlushed() const {
+    int row = 0;
+    int column;
+    int count;
+
+    return _tileStates[0] == TILE_FREE && _tileStates[1] == TILE_FREE && !_grid.nextDirtyRun(row, column, count);
+}
+
+/**
+ * Starts sending the next tile, if it's ready and the bus is free
+ */
+void Ohmbrewer::Screen::sendTile() {
+    Tile &tile = _tiles[_sendTile];
+
+    if (_flushing != NULL || _tileStates[_sendTile] != TILE_READY) {
+        return;
+    }
+
+    // The address window takes a few blocking command bytes; the pixels go by DMA
+    setAddrWindow(tile.getX(), tile.getY(), tile.getX() + tile.getWidth() - 1, tile.getY() + Tile::HEIGHT - 1);
+    _tileStates[_sendTile] = TILE_SENDING;
+    _flushing = this;
+    pinSetFast(_dc);
+    pinResetFast(_cs);
+    SPI.transfer(tile.getData(), NULL, tile.getLength(), tileSent);
+}
+
+/**
+ * Called from the DMA interrupt when a tile has been sent. Frees it; the next flushDisplay() sends the
+ * next one, since setting up the address window takes blocking SPI transfers.
+ */
+void Ohmbrewer::Screen::tileSent() {
+    Screen* screen = _flushing;
+
+    pinSetFast(screen->_cs);
+    screen->_tileStates[screen->_sendTile] = TILE_FREE;
+    screen->_sendTile = 1 - screen->_sendTile;
+    _flushing = NULL;
 }
 
 /**
@@ -82,6 +251,8 @@ void Ohmbrewer::Screen::reinitScreen() {
 unsigned long Ohmbrewer::Screen::displayHeader() {
     unsigned long start = micros();
 
+    finishFlush();
+
     // Add the title
     setCursor(0, 0);
     setTextColor(ILI9341_WHITE, DEFAULT_BG_COLOR);
@@ -109,6 +280,7 @@ void Ohmbrewer::Screen::printMargin(const uint8_t current) {
  * Initializes the display screen
  */
 void Ohmbrewer::Screen::drawButtons() {
+    finishFlush();
 
     setTextColor(ILI9341_WHITE, DEFAULT_BG_COLOR);
 
@@ -146,14 +318,20 @@ void Ohmbrewer::Screen::drawButtons() {
 unsigned long Ohmbrewer::Screen::refreshDisplay() {
     unsigned long start = micros();
 
-    displayHeader();
-
-
+    setCursor(LEFT, CONTENT_TOP);
+    resetTextSizeAndColor();
     _currentMenu->displayMenu();
 
+    // The status line stays up until it's replaced, so it's printed every time too
+    if (_status[0] != '\0') {
+        setTextColor(ILI9341_RED, DEFAULT_BG_COLOR);
+        setCursor(LEFT, STATUS_TOP);
+        resetTextSize();
+        print(_status);
+    }
 
-    // 500 seems like a good refresh delay
-    delay(500);
+    releaseGrid();
+    flushDisplay();
 
     return micros() - start;
 }
@@ -167,31 +345,28 @@ unsigned long Ohmbrewer::Screen::displayManualRelays() {
 
     resetTextSizeAndColor();
 
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        //print out temperature probes
-        if (strcmp((*itr)->getType(), TemperatureSensor::TYPE_NAME) == 0) {
-            setTextColor(CYAN, DEFAULT_BG_COLOR);
-            print("Temp ");
-            writeDegree();
-            print("C ");
-            ((Ohmbrewer::TemperatureSensor*)(*itr))->display(this);
-        }
+    //print out temperature probes
+    const std::deque<Ohmbrewer::Equipment*>& temps = _registry->ofType(Equipment::TYPE_TEMPERATURE_SENSOR);
+    for (std::deque<Ohmbrewer::Equipment*>::const_iterator itr = temps.begin(); itr != temps.end(); itr++) {
+        setTextColor(CYAN, DEFAULT_BG_COLOR);
+        print("Temp ");
+        writeDegree();
+        print("C ");
+        ((Ohmbrewer::TemperatureSensor*)(*itr))->display(this);
     }
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        //print out PUMPS
-        if (strcmp((*itr)->getType(), Pump::TYPE_NAME) == 0) {
-            setTextColor(CYAN, DEFAULT_BG_COLOR);
-            print("Pump    ");
-            ((Ohmbrewer::Pump*)(*itr))->display(this);
-        }
+    //print out PUMPS
+    const std::deque<Ohmbrewer::Equipment*>& pumps = _registry->ofType(Equipment::TYPE_PUMP);
+    for (std::deque<Ohmbrewer::Equipment*>::const_iterator itr = pumps.begin(); itr != pumps.end(); itr++) {
+        setTextColor(CYAN, DEFAULT_BG_COLOR);
+        print("Pump    ");
+        ((Ohmbrewer::Pump*)(*itr))->display(this);
     }
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        //print out relays
-        if (strcmp((*itr)->getType(), Relay::TYPE_NAME) == 0) {
-            setTextColor(CYAN, DEFAULT_BG_COLOR);
-            print("Relay    ");
-            ((Ohmbrewer::Relay*)(*itr))->display(this);
-        }
+    //print out relays
+    const std::deque<Ohmbrewer::Equipment*>& relays = _registry->ofType(Equipment::TYPE_RELAY);
+    for (std::deque<Ohmbrewer::Equipment*>::const_iterator itr = relays.begin(); itr != relays.end(); itr++) {
+        setTextColor(CYAN, DEFAULT_BG_COLOR);
+        print("Relay    ");
+        ((Ohmbrewer::Relay*)(*itr))->display(this);
     }
     //No Heating elements are supported this way, only manual relays. ... safer
 
@@ -210,10 +385,12 @@ unsigned long Ohmbrewer::Screen::displayRelays() {
 
     resetTextSizeAndColor();
 
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        if (strcmp((*itr)->getType(), TemperatureSensor::TYPE_NAME) != 0 &&
-            strcmp((*itr)->getType(), RIMS::TYPE_NAME) != 0 &&
-            strcmp((*itr)->getType(), Thermostat::TYPE_NAME) != 0) {
+    std::deque<Ohmbrewer::Equipment*>* sprouts = _registry->getSprouts();
+    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = sprouts->begin(); itr != sprouts->end(); itr++) {
+        Equipment::TypeCode type = (*itr)->getTypeCode();
+        if (type != Equipment::TYPE_TEMPERATURE_SENSOR &&
+            type != Equipment::TYPE_RIMS &&
+            type != Equipment::TYPE_THERMOSTAT) {
             if(!foundFirst) {
                 // Print the header
                 print("====== Relays ======");
@@ -240,16 +417,15 @@ unsigned long Ohmbrewer::Screen::displayHeatingElements() {
 
     resetTextSizeAndColor();
 
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        if (strcmp((*itr)->getType(), HeatingElement::TYPE_NAME) == 0) {
-            if(!foundFirst) {
-                // Print the header
-                print("======= Heat =======");
-                printMargin(2);
-                foundFirst = true;
-            }
-            ((Ohmbrewer::HeatingElement*)(*itr))->display(this);
+    const std::deque<Ohmbrewer::Equipment*>& elements = _registry->ofType(Equipment::TYPE_HEATING_ELEMENT);
+    for (std::deque<Ohmbrewer::Equipment*>::const_iterator itr = elements.begin(); itr != elements.end(); itr++) {
+        if(!foundFirst) {
+            // Print the header
+            print("======= Heat =======");
+            printMargin(2);
+            foundFirst = true;
         }
+        ((Ohmbrewer::HeatingElement*)(*itr))->display(this);
     }
     if(foundFirst) {
         printMargin(2);
@@ -268,16 +444,15 @@ unsigned long Ohmbrewer::Screen::displayPumps() {
 
     resetTextSizeAndColor();
 
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        if (strcmp((*itr)->getType(), Pump::TYPE_NAME) == 0) {
-            if(!foundFirst) {
-                // Print the header
-                print("======= Pumps ======");
-                printMargin(2);
-                foundFirst = true;
-            }
-            ((Ohmbrewer::Pump*)(*itr))->display(this);
+    const std::deque<Ohmbrewer::Equipment*>& pumps = _registry->ofType(Equipment::TYPE_PUMP);
+    for (std::deque<Ohmbrewer::Equipment*>::const_iterator itr = pumps.begin(); itr != pumps.end(); itr++) {
+        if(!foundFirst) {
+            // Print the header
+            print("======= Pumps ======");
+            printMargin(2);
+            foundFirst = true;
         }
+        ((Ohmbrewer::Pump*)(*itr))->display(this);
     }
     if(foundFirst) {
         printMargin(2);
@@ -296,23 +471,22 @@ unsigned long Ohmbrewer::Screen::displayTemps() {
 
     resetTextSizeAndColor();
 
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        if (strcmp((*itr)->getType(), TemperatureSensor::TYPE_NAME) == 0) {
-            if(!foundFirst) {
-                // Print the header
-                print("= Temperature (");
-                writeDegree(); // Degree symbol
-                if (_settings->isTempUnitCelsius()) {
-                    print("C) =");
-                } else {
-                    print("F) =");
-                }
-
-                printMargin(2);
-                foundFirst = true;
+    const std::deque<Ohmbrewer::Equipment*>& temps = _registry->ofType(Equipment::TYPE_TEMPERATURE_SENSOR);
+    for (std::deque<Ohmbrewer::Equipment*>::const_iterator itr = temps.begin(); itr != temps.end(); itr++) {
+        if(!foundFirst) {
+            // Print the header
+            print("= Temperature (");
+            writeDegree(); // Degree symbol
+            if (_settings->isTempUnitCelsius()) {
+                print("C) =");
+            } else {
+                print("F) =");
             }
-            ((Ohmbrewer::TemperatureSensor*)(*itr))->display(this);
+
+            printMargin(2);
+            foundFirst = true;
         }
+        ((Ohmbrewer::TemperatureSensor*)(*itr))->display(this);
     }
     if(foundFirst) {
         printMargin(2);
@@ -326,16 +500,14 @@ unsigned long Ohmbrewer::Screen::displayTemps() {
  */
 unsigned long Ohmbrewer::Screen::displayThermostats() {
     unsigned long start = micros();
-    bool foundFirst = false;
 
     resetTextSizeAndColor();
 
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        if (strcmp((*itr)->getType(), Thermostat::TYPE_NAME) == 0) {
-            ((Ohmbrewer::Thermostat*)(*itr))->display(this);
-            printMargin(2);
-            printMargin(2);
-        }
+    const std::deque<Ohmbrewer::Equipment*>& thermostats = _registry->ofType(Equipment::TYPE_THERMOSTAT);
+    for (std::deque<Ohmbrewer::Equipment*>::const_iterator itr = thermostats.begin(); itr != thermostats.end(); itr++) {
+        ((Ohmbrewer::Thermostat*)(*itr))->display(this);
+        printMargin(2);
+        printMargin(2);
     }
 
     return micros() - start;
@@ -347,31 +519,39 @@ unsigned long Ohmbrewer::Screen::displayThermostats() {
  */
 unsigned long Ohmbrewer::Screen::displayRIMS() {
     unsigned long start = micros();
-    bool foundFirst = false;
 
     resetTextSizeAndColor();
 
-    for (std::deque<Ohmbrewer::Equipment*>::iterator itr = _sprouts->begin(); itr != _sprouts->end(); itr++) {
-        if (strcmp((*itr)->getType(), RIMS::TYPE_NAME) == 0) {
-            ((Ohmbrewer::RIMS*)(*itr))->display(this);
-            printMargin(2);
-            printMargin(2);
-        }
+    const std::deque<Ohmbrewer::Equipment*>& rims = _registry->ofType(Equipment::TYPE_RIMS);
+    for (std::deque<Ohmbrewer::Equipment*>::const_iterator itr = rims.begin(); itr != rims.end(); itr++) {
+        ((Ohmbrewer::RIMS*)(*itr))->display(this);
+        printMargin(2);
+        printMargin(2);
     }
 
     return micros() - start;
 }
 
 /**
- * Prints out a status message in the two rows above the buttons.
- * @param char* statusUpdate The status message to display. 40 characters or less.
+ * Prints out a status message in the two rows above the buttons. It stays there, redrawn with each
+ * refresh, until it's replaced; a blank message clears it.
+ * @param const char* statusUpdate The status message to display. 40 characters or less.
  * @returns Time it took to run the function
  */
-unsigned long Ohmbrewer::Screen::displayStatusUpdate(char *statusUpdate) {
+unsigned long Ohmbrewer::Screen::displayStatusUpdate(const char *statusUpdate) {
     unsigned long start = micros();
+    int length;
 
+    // Keep it for the refreshes to come. Trailing spaces were only there to erase the last one.
+    strncpy(_status, statusUpdate, sizeof(_status) - 1);
+    _status[sizeof(_status) - 1] = '\0';
+    for (length = strlen(_status); length > 0 && _status[length - 1] == ' '; length--) {
+        _status[length - 1] = '\0';
+    }
+
+    // Show it straight away, spaces and all
     setTextColor(ILI9341_RED, DEFAULT_BG_COLOR);
-    setCursor(LEFT, BUTTONTOP - 40);
+    setCursor(LEFT, STATUS_TOP);
     resetTextSize();
     println(statusUpdate);
 
@@ -379,78 +559,57 @@ unsigned long Ohmbrewer::Screen::displayStatusUpdate(char *statusUpdate) {
 }
 
 /**
- * Checks for a touch event and triggers actions 
+ * Handles the touch events the TouchSampler has queued since the last call, triggering actions
  *  if the the touch was on a screen "button".
+ * Never blocks. Presses are debounced by the sampler, so each is handled once.
  * @returns Time it took to run the function
  */
 unsigned long Ohmbrewer::Screen::captureButtonPress() {
     unsigned long start = micros();
-    char printx [10];
-    char printy [10];
-    char status [40];
-
-    // a point object holds x y and z coordinates
-    TSPoint p =_ts->getPoint();
-    //According to Particle forums, the read below is necessary to get touch to work on Photon
-    _ts->readTouchY();
-
-    // we have some minimum pressure we consider 'valid'
-    // pressure of 0 means no pressing!
-    if (p.z < MINPRESSURE || p.z > MAXPRESSURE) {
-        displayStatusUpdate("                                        ");
-        return micros() - start;
-    }
+    TouchEvent event;
+    const char* action;
+    char status [41];
+
+    while (_touch->getQueue()->pop(event)) {
+        // Only the buttons do anything
+        if (event.y < BUTTONTOP) {
+            continue;
+        }
 
-    // Scale from ~0->1000 to tft.width using the calibration #'s
-    p.x = map(p.x, TS_MINX, TS_MAXX, 0, width()-35); // This -35 is a dirty hack. We need to fix the scaling to get this working without it.
-    p.y = map(p.y, TS_MINY, TS_MAXY, 0, height());
-    
-    // Each of these should pad out with spaces on the right
-    sprintf(printx, "x is %-5d", p.x);
-    sprintf(printy, "y is %-5d", p.y);
-    
-    String statusUpdate = String(printx);
-    statusUpdate.concat(printy);
-    
-    if (p.y >= BUTTONTOP) {
-
-        if (p.x > 0 && p.x <= BUTTONSIZE) {
-            // +                 12345678901234567890
-            _currentMenu->plusPressed();
-            statusUpdate.concat("Pressing +!         ");
-//            Serial.println("Pressing +!    ");
-        } else if (p.x > BUTTONSIZE && p.x <= BUTTONSIZE*2) {
-            // -
-            _currentMenu->minusPressed();
-            statusUpdate.concat("Pressing -!         ");
-//            Serial.println("Pressing -!    ");
-        } else if (p.x > BUTTONSIZE*2 && p.x <= BUTTONSIZE*3) {
-            // Menu
-            _currentMenu->menuPressed();
-            statusUpdate.concat("Pressing Menu!      ");
-//            Serial.println("Pressing Menu!    ");
-        } else if (p.x > BUTTONSIZE*3 && p.x <= BUTTONSIZE*4) {
-            // Select
-            _currentMenu->selectPressed();
-            statusUpdate.concat("Pressing Select!    ");
-//            Serial.println("Pressing Select!    ");
-        } else {
-            // Nothing. Weird.
-            statusUpdate.concat("                    ");
-//            Serial.println("Pressing Nothing!    ");
+        if (event.type == TouchEvent::RELEASE) {
+            // Clear the status line once the press is over
+            displayStatusUpdate("                                        ");
+            continue;
         }
-        
-        // Barf it onto the display...
-        statusUpdate.toCharArray(status, 40);
+
+        switch (event.button) {
+            case TouchEvent::PLUS_BUTTON:
+                _currentMenu->plusPressed();
+                action = "Pressing +!";
+                break;
+            case TouchEvent::MINUS_BUTTON:
+                _currentMenu->minusPressed();
+                action = "Pressing -!";
+                break;
+            case TouchEvent::MENU_BUTTON:
+                _currentMenu->menuPressed();
+                action = "Pressing Menu!";
+                break;
+            case TouchEvent::SELECT_BUTTON:
+                _currentMenu->selectPressed();
+                action = "Pressing Select!";
+                break;
+            default:
+                // Nothing. Weird.
+                action = "";
+                break;
+        }
+
+        // Each of these should pad out with spaces on the right, to 40 characters. Barf it onto the display...
+        snprintf(status, sizeof(status), "x is %-5uy is %-5u%-20s", (uint16_t)event.x, (uint16_t)event.y, action);
         displayStatusUpdate(status);
     }
-    
-    Serial.print("X = "); Serial.print(p.x);
-    Serial.print("\tY = "); Serial.print(p.y);
-    Serial.print("\tPressure = "); Serial.println(p.z);
 
-    // Delay 1 second to allow for some debounce
-    delay(300);
     return micros() - start;
 }
 
@@ -483,5 +642,13 @@ Ohmbrewer::RuntimeSettings* Ohmbrewer::Screen::getSettings() const {
  * @returns Rhizome object
  */
 std::deque< Ohmbrewer::Equipment* >* Ohmbrewer::Screen::getSprouts() const {
-    return _sprouts;
+    return _registry->getSprouts();
+}
+
+/**
+ * Gets the registry of sprouts attached to the Rhizome
+ * @returns The registry
+ */
+Ohmbrewer::SproutRegistry* Ohmbrewer::Screen::getRegistry() const {
+    return _registry;
 }
@@ -16,16 +16,18 @@
 #include "Adafruit_ILI9341.h"
 #include "application.h"
 #include "Touch_4Wire.h"
+#include "Ohmbrewer_Touch_Sampler.h"
 #include "Ohmbrewer_Runtime_Settings.h"
 #include "Ohmbrewer_Menu.h"
+#include "Ohmbrewer_Text_Grid.h"
+#include "Ohmbrewer_Tile.h"
 
 namespace Ohmbrewer {
 
     class Equipment;
     class Menu;
+    class SproutRegistry;
 
-    // TODO: Add a member object to Ohmbrewer::Screen that represents the capacitive touch capabilities
-    // (e.g. an instance of Adafruit Touch 4Wire TouchScreen)
     class Screen : public Adafruit_ILI9341 {
 
         public:
@@ -36,6 +38,8 @@ namespace Ohmbrewer {
             static const int      TOP = 0;
             static const int      BOTTOM = 320;
             static const int      BUTTONTOP = 260;
+            static const int      CONTENT_TOP = 32;
+            static const int      STATUS_TOP = BUTTONTOP - 44;
             static const uint8_t  DEFAULT_TEXT_SIZE = 2;
             static const uint16_t DEFAULT_TEXT_COLOR = ILI9341_GREEN;
             static const uint16_t DEFAULT_BG_COLOR = ILI9341_BLACK;
@@ -59,7 +63,7 @@ namespace Ohmbrewer {
             /**
              * CONSTRUCTOR
              */
-            Screen(uint8_t CS, uint8_t RS, uint8_t RST, std::deque< Ohmbrewer::Equipment* >* sprouts, Ohmbrewer::RuntimeSettings *settings);
+            Screen(uint8_t CS, uint8_t RS, uint8_t RST, Ohmbrewer::SproutRegistry* registry, Ohmbrewer::RuntimeSettings *settings);
 
             /**
              * DESTRUCTOR
@@ -98,12 +102,40 @@ namespace Ohmbrewer {
             void printMargin(const uint8_t current);
 
             /**
-             * Initializes the display screen
+             * Writes a character to the screen. Size 2 text on the content area goes into the text grid, to be
+             * drawn by flushDisplay() if it's different from what's already there; anything else is drawn directly.
+             * @param c The character
+             * @returns The number of characters written
+             */
+            virtual size_t write(uint8_t c);
+            using Adafruit_ILI9341::write;
+
+            /**
+             * Moves the text grid's changes along to the display without waiting for the SPI bus: starts sending the
+             * next finished tile if the bus is free, and renders dirty cells into any tile that isn't in use.
+             * @returns Time it took to run the function
+             */
+            unsigned long flushDisplay();
+
+            /**
+             * Waits until every change in the text grid has reached the display. Called before anything is drawn
+             * directly, so it can't be drawn over by a tile sent later.
+             */
+            void finishFlush();
+
+            /**
+             * @returns Whether every change in the text grid has reached the display
+             */
+            bool isFlushed() const;
+
+            /**
+             * Initializes the display screen, clearing it and drawing the header and buttons
              */
             void initScreen();
 
             /**
-             * Reinitializes the display screen
+             * Reinitializes the display screen for a new menu or set of sprouts. Nothing is erased here - the next
+             * refresh only redraws what changed.
              */
             void reinitScreen();
 
@@ -119,7 +151,8 @@ namespace Ohmbrewer {
             void drawButtons();
 
             /**
-             * Refreshes/redraws the touchscreen display
+             * Refreshes the touchscreen display: prints the current menu and the status line into the text grid,
+             * then erases whatever was left over from the last refresh
              * @returns Time it took to run the function
              */
             unsigned long refreshDisplay();
@@ -167,15 +200,17 @@ namespace Ohmbrewer {
             unsigned long displayRIMS();
 
             /**
-             * Prints out a status message in the two rows above the buttons.
-             * @param char* statusUpdate The status message to display. 40 characters or less.
+             * Prints out a status message in the two rows above the buttons. It stays there, redrawn with each
+             * refresh, until it's replaced; a blank message clears it.
+             * @param const char* statusUpdate The status message to display. 40 characters or less.
              * @returns Time it took to run the function
              */
-            unsigned long displayStatusUpdate(char *statusUpdate);
+            unsigned long displayStatusUpdate(const char *statusUpdate);
             
             /**
-             * Checks for a touch event and triggers actions 
+             * Handles the touch events the TouchSampler has queued since the last call, triggering actions
              *  if the the touch was on a screen "button".
+             * Never blocks. Presses are debounced by the sampler, so each is handled once.
              * @returns Time it took to run the function
              */
             unsigned long captureButtonPress();
@@ -204,21 +239,27 @@ namespace Ohmbrewer {
              */
             std::deque< Equipment* >* getSprouts() const;
 
+            /**
+             * Gets the registry of sprouts attached to the Rhizome
+             * @returns The registry
+             */
+            SproutRegistry* getRegistry() const;
+
         private:
             /**
-             * Pointer to the Rhizome's sprouts list
+             * Pointer to the Rhizome's sprout registry
              */
-            std::deque< Equipment* >* _sprouts;
+            SproutRegistry* _registry;
 
             /**
              * Pointer to the Rhizome's runtime settings
              */
             RuntimeSettings* _settings;
             
-            /** 
-             *  The touchscreen object used to check for taps on the screen
+            /**
+             *  Samples the touchscreen for taps on the screen, in the background
              */
-            TouchScreen* _ts;
+            TouchSampler* _touch;
             
             /**
              * Pointer to the current menu
@@ -230,6 +271,67 @@ namespace Ohmbrewer {
              */
             Menu* _homeMenu;
 
+
+            /**
+             * The status message, without trailing spaces
+             */
+            char _status[41];
+
+            /**
+             * What's on the content area
+             */
+            TextGrid _grid;
+
+            /**
+             * Where a tile is up to
+             */
+            enum TileState {
+                TILE_FREE,    // Ready to render into
+                TILE_READY,   // Rendered, waiting for the bus
+                TILE_SENDING  // Being sent by DMA
+            };
+
+            /**
+             * The offscreen tiles the text grid is rendered into, and where each is up to. There are two, so one can
+             * be rendered while the other's being sent. They're sent in the order they were rendered.
+             */
+            Tile _tiles[2];
+            volatile TileState _tileStates[2];
+
+            /**
+             * The tile to render into next, and the tile to send next
+             */
+            int _renderTile;
+            volatile int _sendTile;
+
+            /**
+             * The display's chip select and data/command pins, for sending tiles
+             */
+            uint8_t _cs;
+            uint8_t _dc;
+
+            /**
+             * The Screen whose tile is being sent, for the DMA callback. The callback clears it from interrupt
+             * context, so it's volatile like the tile states.
+             */
+            static Screen* volatile _flushing;
+
+            /**
+             * Starts sending the next tile, if it's ready and the bus is free
+             */
+            void sendTile();
+
+            /**
+             * Called from the DMA interrupt when a tile has been sent. Frees it; the next flushDisplay() sends the
+             * next one, since setting up the address window takes blocking SPI transfers.
+             */
+            static void tileSent();
+
+            /**
+             * Ends a refresh: erases the text grid's cells that weren't printed to, a run at a time
+             */
+            void releaseGrid();
+
     };
 
 }
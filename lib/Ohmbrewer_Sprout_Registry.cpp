@@ -0,0 +1,256 @@
+#include "Ohmbrewer_Sprout_Registry.h"
+#include "Ohmbrewer_Temperature_Sensor.h"
+#include "Ohmbrewer_Relay.h"
+#include "Ohmbrewer_Pump.h"
+#include "Ohmbrewer_Heating_Element.h"
+#include "Ohmbrewer_Thermostat.h"
+#include "Ohmbrewer_RIMS.h"
+
+/**
+ * Constructor
+ */
+Ohmbrewer::SproutRegistry::SproutRegistry() {
+    _sprouts = new std::deque< Equipment* >;
+    for (int i = 0; i < INDEX_SIZE; i++) {
+        _index[i] = NULL;
+    }
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::SproutRegistry::~SproutRegistry() {
+    delete _sprouts;
+}
+
+/**
+ * Looks up a type code from a type name, ignoring case
+ * @param name The type name, as in TYPE_NAME (e.g. "therm")
+ * @returns The type code, or Equipment::TYPE_UNKNOWN if the name isn't recognized
+ */
+Ohmbrewer::Equipment::TypeCode Ohmbrewer::SproutRegistry::typeFromName(const char* name) {
+    if (name == NULL) {
+        return Equipment::TYPE_UNKNOWN;
+    }
+    if (strcasecmp(name, TemperatureSensor::TYPE_NAME) == 0) {
+        return Equipment::TYPE_TEMPERATURE_SENSOR;
+    }
+    if (strcasecmp(name, Relay::TYPE_NAME) == 0) {
+        return Equipment::TYPE_RELAY;
+    }
+    if (strcasecmp(name, Pump::TYPE_NAME) == 0) {
+        return Equipment::TYPE_PUMP;
+    }
+    if (strcasecmp(name, HeatingElement::TYPE_NAME) == 0) {
+        return Equipment::TYPE_HEATING_ELEMENT;
+    }
+    if (strcasecmp(name, Thermostat::TYPE_NAME) == 0) {
+        return Equipment::TYPE_THERMOSTAT;
+    }
+    if (strcasecmp(name, RIMS::TYPE_NAME) == 0) {
+        return Equipment::TYPE_RIMS;
+    }
+    return Equipment::TYPE_UNKNOWN;
+}
+
+/**
+ * Looks up a type code from a type name, ignoring case
+ * @param name The type name, as in TYPE_NAME (e.g. "therm"), as parsed from a command
+ * @returns The type code, or Equipment::TYPE_UNKNOWN if the name isn't recognized
+ */
+Ohmbrewer::Equipment::TypeCode Ohmbrewer::SproutRegistry::typeFromName(const CommandParser::Token &name) {
+    char typeName[16];
+
+    // No type name is anywhere near this long, so anything that doesn't fit isn't one
+    if (!name.copyTo(typeName, sizeof(typeName))) {
+        return Equipment::TYPE_UNKNOWN;
+    }
+    return typeFromName(typeName);
+}
+
+/**
+ * @param type A type
+ * @returns The most Sprouts of that type there may be (see MAX_PUMPS and the like)
+ */
+int Ohmbrewer::SproutRegistry::maxOfType(Equipment::TypeCode type) {
+    switch (type) {
+        case Equipment::TYPE_TEMPERATURE_SENSOR:
+            return MAX_TEMPERATURE_SENSORS;
+        case Equipment::TYPE_PUMP:
+            return MAX_PUMPS;
+        case Equipment::TYPE_HEATING_ELEMENT:
+            return MAX_HEATING_ELEMENTS;
+        case Equipment::TYPE_THERMOSTAT:
+            return MAX_THERMOSTATS;
+        case Equipment::TYPE_RIMS:
+            return MAX_RIMS;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Adds a Sprout
+ * @param sprout The Sprout
+ * @returns Whether it was added - false if there's already a Sprout of the same type and ID,
+ *          or there are already as many of its type as there may be
+ */
+bool Ohmbrewer::SproutRegistry::add(Equipment* sprout) {
+    Equipment::TypeCode type = sprout->getTypeCode();
+    int id = sprout->getID();
+
+    if (size() >= MAX_SPROUTS || isFull(type) || slotOf(type, id) != -1) {
+        return false;
+    }
+
+    int slot = hash(type, id);
+    while (_index[slot] != NULL) {
+        slot = (slot + 1) & (INDEX_SIZE - 1);
+    }
+    _index[slot] = sprout;
+
+    _sprouts->push_back(sprout);
+    _byType[type].push_back(sprout);
+    return true;
+}
+
+/**
+ * Finds a Sprout
+ * @param type The Sprout's type
+ * @param id The Sprout's ID
+ * @returns The Sprout, or NULL if there isn't one
+ */
+Ohmbrewer::Equipment* Ohmbrewer::SproutRegistry::find(Equipment::TypeCode type, int id) const {
+    int slot = slotOf(type, id);
+    return slot == -1 ? NULL : _index[slot];
+}
+
+/**
+ * Removes a Sprout. The Sprout itself is left alone.
+ * @param type The Sprout's type
+ * @param id The Sprout's ID
+ * @returns The removed Sprout, or NULL if there wasn't one
+ */
+Ohmbrewer::Equipment* Ohmbrewer::SproutRegistry::remove(Equipment::TypeCode type, int id) {
+    int slot = slotOf(type, id);
+    if (slot == -1) {
+        return NULL;
+    }
+
+    Equipment* sprout = _index[slot];
+    _index[slot] = NULL;
+
+    // Shift any later entries in the run back into the gap, so lookups never stop short at it
+    int next = (slot + 1) & (INDEX_SIZE - 1);
+    while (_index[next] != NULL) {
+        int home = hash(_index[next]->getTypeCode(), _index[next]->getID());
+
+        // Move the entry if its home slot isn't in the (cyclic) range (slot, next]
+        bool homeInRange = (slot <= next) ? (home > slot && home <= next) : (home > slot || home <= next);
+        if (!homeInRange) {
+            _index[slot] = _index[next];
+            _index[next] = NULL;
+            slot = next;
+        }
+        next = (next + 1) & (INDEX_SIZE - 1);
+    }
+
+    erase(*_sprouts, sprout);
+    erase(_byType[type], sprout);
+    return sprout;
+}
+
+/**
+ * Removes every Sprout. The Sprouts themselves are left alone.
+ */
+void Ohmbrewer::SproutRegistry::clear() {
+    _sprouts->clear();
+    for (int i = 0; i < Equipment::NUM_TYPE_CODES; i++) {
+        _byType[i].clear();
+    }
+    for (int i = 0; i < INDEX_SIZE; i++) {
+        _index[i] = NULL;
+    }
+}
+
+/**
+ * @returns Every Sprout, in the order they were added. Read only!
+ */
+std::deque< Ohmbrewer::Equipment* >* Ohmbrewer::SproutRegistry::getSprouts() {
+    return _sprouts;
+}
+
+/**
+ * @param type A type
+ * @returns Every Sprout of that type, in the order they were added. Read only!
+ */
+const std::deque< Ohmbrewer::Equipment* >& Ohmbrewer::SproutRegistry::ofType(Equipment::TypeCode type) const {
+    return _byType[type];
+}
+
+/**
+ * @param type A type
+ * @returns The number of Sprouts of that type
+ */
+int Ohmbrewer::SproutRegistry::count(Equipment::TypeCode type) const {
+    return _byType[type].size();
+}
+
+/**
+ * @param type A type
+ * @returns Whether there are as many Sprouts of that type as there may be, so another can't be added
+ */
+bool Ohmbrewer::SproutRegistry::isFull(Equipment::TypeCode type) const {
+    return count(type) >= maxOfType(type);
+}
+
+/**
+ * @returns The number of Sprouts
+ */
+int Ohmbrewer::SproutRegistry::size() const {
+    return _sprouts->size();
+}
+
+/**
+ * @param type A type
+ * @param id An ID
+ * @returns The index slot a (type, ID) hashes to
+ */
+int Ohmbrewer::SproutRegistry::hash(Equipment::TypeCode type, int id) {
+    // Fibonacci hashing: the top bits of the product are well mixed even for small, sequential keys
+    uint32_t key = ((uint32_t)type << 16) ^ (uint32_t)(id & 0xFFFF);
+    return (int)((key * 2654435769u) >> 26) & (INDEX_SIZE - 1);
+}
+
+/**
+ * Finds a Sprout's slot in the index
+ * @param type The Sprout's type
+ * @param id The Sprout's ID
+ * @returns The slot, or -1 if it isn't there
+ */
+int Ohmbrewer::SproutRegistry::slotOf(Equipment::TypeCode type, int id) const {
+    int slot = hash(type, id);
+
+    while (_index[slot] != NULL) {
+        if (_index[slot]->getTypeCode() == type && _index[slot]->getID() == id) {
+            return slot;
+        }
+        slot = (slot + 1) & (INDEX_SIZE - 1);
+    }
+
+    return -1;
+}
+
+/**
+ * Removes a Sprout from a list of Sprouts
+ * @param list The list
+ * @param sprout The Sprout
+ */
+void Ohmbrewer::SproutRegistry::erase(std::deque< Equipment* > &list, Equipment* sprout) {
+    for (std::deque< Equipment* >::iterator itr = list.begin(); itr != list.end(); itr++) {
+        if (*itr == sprout) {
+            list.erase(itr);
+            return;
+        }
+    }
+}
@@ -0,0 +1,182 @@
+/**
+ * This library provides the SproutRegistry class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_SPROUT_REGISTRY_H
+#define OHMBREWER_SPROUT_REGISTRY_H
+
+// Kludge to allow us to use std::deque - for now we have to undefine these macros.
+#undef min
+#undef max
+#undef swap
+#include <deque>
+#include "application.h"
+#include "Ohmbrewer_Equipment.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * Keeps track of the Rhizome's Sprouts. Besides the list of every Sprout in the order they were added,
+     * it keeps:
+     *   - an open-addressed hash index from (type, ID) to Sprout, so finding a Sprout takes constant time
+     *     however many are attached
+     *   - a list per type, so code that only cares about one type of Equipment visits only that type
+     *
+     * Sprouts must be added and removed through the registry, never by editing getSprouts() directly,
+     * or the index and type lists will go stale.
+     */
+    class SproutRegistry {
+
+        public:
+
+            /**
+             * The most Sprouts the registry can hold. Far more than a Photon has pins for.
+             */
+            static const int MAX_SPROUTS = 32;
+
+            /**
+             * Slots in the hash index. A power of two, and twice MAX_SPROUTS so probes stay short.
+             */
+            static const int INDEX_SIZE = 64;
+
+            /**
+             * The most Sprouts of each type. Each type of Equipment, and the parts it's made of, is allocated from
+             * an ObjectPool sized for these, so adding and removing Sprouts doesn't fragment the heap.
+             */
+            static const int MAX_TEMPERATURE_SENSORS = 10; // One per probe the OnewireBus can hold
+            static const int MAX_PUMPS = 8;
+            static const int MAX_HEATING_ELEMENTS = 4;
+            static const int MAX_THERMOSTATS = 4;
+            static const int MAX_RIMS = 2;
+
+            /**
+             * Constructor
+             */
+            SproutRegistry();
+
+            /**
+             * Destructor
+             */
+            virtual ~SproutRegistry();
+
+            /**
+             * Looks up a type code from a type name, ignoring case
+             * @param name The type name, as in TYPE_NAME (e.g. "therm")
+             * @returns The type code, or Equipment::TYPE_UNKNOWN if the name isn't recognized
+             */
+            static Equipment::TypeCode typeFromName(const char* name);
+
+            /**
+             * Looks up a type code from a type name, ignoring case
+             * @param name The type name, as in TYPE_NAME (e.g. "therm"), as parsed from a command
+             * @returns The type code, or Equipment::TYPE_UNKNOWN if the name isn't recognized
+             */
+            static Equipment::TypeCode typeFromName(const CommandParser::Token &name);
+
+            /**
+             * @param type A type
+             * @returns The most Sprouts of that type there may be (see MAX_PUMPS and the like)
+             */
+            static int maxOfType(Equipment::TypeCode type);
+
+            /**
+             * Adds a Sprout
+             * @param sprout The Sprout
+             * @returns Whether it was added - false if there's already a Sprout of the same type and ID,
+             *          or there are already as many of its type as there may be
+             */
+            bool add(Equipment* sprout);
+
+            /**
+             * Finds a Sprout
+             * @param type The Sprout's type
+             * @param id The Sprout's ID
+             * @returns The Sprout, or NULL if there isn't one
+             */
+            Equipment* find(Equipment::TypeCode type, int id) const;
+
+            /**
+             * Removes a Sprout. The Sprout itself is left alone.
+             * @param type The Sprout's type
+             * @param id The Sprout's ID
+             * @returns The removed Sprout, or NULL if there wasn't one
+             */
+            Equipment* remove(Equipment::TypeCode type, int id);
+
+            /**
+             * Removes every Sprout. The Sprouts themselves are left alone.
+             */
+            void clear();
+
+            /**
+             * @returns Every Sprout, in the order they were added. Read only!
+             */
+            std::deque< Equipment* >* getSprouts();
+
+            /**
+             * @param type A type
+             * @returns Every Sprout of that type, in the order they were added. Read only!
+             */
+            const std::deque< Equipment* >& ofType(Equipment::TypeCode type) const;
+
+            /**
+             * @param type A type
+             * @returns The number of Sprouts of that type
+             */
+            int count(Equipment::TypeCode type) const;
+
+            /**
+             * @param type A type
+             * @returns Whether there are as many Sprouts of that type as there may be, so another can't be added
+             */
+            bool isFull(Equipment::TypeCode type) const;
+
+            /**
+             * @returns The number of Sprouts
+             */
+            int size() const;
+
+        protected:
+
+            /**
+             * Every Sprout, in the order they were added
+             */
+            std::deque< Equipment* >* _sprouts;
+
+            /**
+             * The Sprouts of each type, in the order they were added
+             */
+            std::deque< Equipment* > _byType[Equipment::NUM_TYPE_CODES];
+
+            /**
+             * The hash index. Empty slots are NULL; each Sprout sits at or after the slot its
+             * (type, ID) hashes to, with no empty slots in between.
+             */
+            Equipment* _index[INDEX_SIZE];
+
+            /**
+             * @param type A type
+             * @param id An ID
+             * @returns The index slot a (type, ID) hashes to
+             */
+            static int hash(Equipment::TypeCode type, int id);
+
+            /**
+             * Finds a Sprout's slot in the index
+             * @param type The Sprout's type
+             * @param id The Sprout's ID
+             * @returns The slot, or -1 if it isn't there
+             */
+            int slotOf(Equipment::TypeCode type, int id) const;
+
+            /**
+             * Removes a Sprout from a list of Sprouts
+             * @param list The list
+             * @param sprout The Sprout
+             */
+            static void erase(std::deque< Equipment* > &list, Equipment* sprout);
+    };
+};
+
+#endif
@@ -0,0 +1,270 @@
+#include "Ohmbrewer_Step_Program.h"
+#include "Ohmbrewer_Equipment.h"
+#include "Ohmbrewer_Thermostat.h"
+#include "Ohmbrewer_RIMS.h"
+#include "Ohmbrewer_Publisher.h"
+#include "Ohmbrewer_Sprout_Registry.h"
+
+/**
+ * Reads a step of a program: TARGET_TEMP,RAMP_RATE,HOLD_TIME,PUMP_STATE. Only the target is required.
+ * @param args The arguments supplied to the Rhizome, positioned at the step
+ * @param result The step, parsed
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+ */
+int Ohmbrewer::StepProgram::parseStep(CommandParser &args, Step &result) {
+    bool given;
+    long holdTime = 0;
+    int errorCode;
+
+    errorCode = args.nextOptionalNumber(result.targetTemp, given);
+    if(errorCode == CommandParser::ParseError::NONE && !given) {
+        errorCode = CommandParser::ParseError::MISSING_FIELD;
+    }
+
+    if(errorCode == CommandParser::ParseError::NONE) {
+        result.rampRate = 0;
+        errorCode = args.nextOptionalNumber(result.rampRate, given);
+        if(errorCode == CommandParser::ParseError::NONE && result.rampRate < 0) {
+            errorCode = CommandParser::ParseError::INVALID_NUMBER;
+        }
+    }
+
+    if(errorCode == CommandParser::ParseError::NONE) {
+        errorCode = args.nextOptionalInt(holdTime, given);
+        if(errorCode == CommandParser::ParseError::NONE && holdTime < 0) {
+            errorCode = CommandParser::ParseError::INVALID_INTEGER;
+        }
+        result.holdTime = holdTime;
+    }
+
+    if(errorCode == CommandParser::ParseError::NONE) {
+        errorCode = args.nextSwitch(result.pumpState);
+    }
+
+    return errorCode;
+}
+
+/**
+ * Constructor
+ * @param sprout The Thermostat or RIMS to run the program on
+ */
+Ohmbrewer::StepProgram::StepProgram(Equipment* sprout) : _holdTimer([this]() { endHold(); }) {
+    _sprout = sprout;
+    clear();
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::StepProgram::~StepProgram() {
+    // Nothing to do here...
+}
+
+/**
+ * Allocates from the pool of step programs rather than the heap (see getPool())
+ * @param size The size of the object
+ * @returns The memory for it
+ */
+void* Ohmbrewer::StepProgram::operator new(size_t size) {
+    return getPool()->allocate(size);
+}
+
+/**
+ * Gives the memory back to the pool of step programs
+ * @param ptr The memory
+ */
+void Ohmbrewer::StepProgram::operator delete(void* ptr) {
+    getPool()->release(ptr);
+}
+
+/**
+ * @returns The pool step programs are allocated from, with room for one on every Sprout that can
+ *          run one (see SproutRegistry)
+ */
+Ohmbrewer::ObjectPool* Ohmbrewer::StepProgram::getPool() {
+    // Only Thermostats and RIMSes run programs, and each has at most one loaded
+    const int size = SproutRegistry::MAX_THERMOSTATS + SproutRegistry::MAX_RIMS;
+    static uint64_t storage[ObjectPool::words(sizeof(StepProgram), size)];
+    static ObjectPool pool = ObjectPool(storage, sizeof(StepProgram), size);
+    return &pool;
+}
+
+/**
+ * The Equipment the program runs on
+ * @returns The Thermostat or RIMS
+ */
+Ohmbrewer::Equipment* Ohmbrewer::StepProgram::getSprout() const {
+    return _sprout;
+}
+
+/**
+ * Adds a step to the end of the program
+ * @param step The step. It's copied.
+ * @returns Whether there was room for it
+ */
+bool Ohmbrewer::StepProgram::addStep(const Step &step) {
+    if (_numSteps == MAX_STEPS) {
+        return false;
+    }
+
+    _steps[_numSteps++] = step;
+    return true;
+}
+
+/**
+ * Stops the program and removes all of its steps
+ */
+void Ohmbrewer::StepProgram::clear() {
+    overridePump(CommandParser::SWITCH_UNCHANGED);
+    _numSteps = 0;
+    _currentStep = 0;
+    _phase = IDLE;
+    _phaseStart = 0;
+    _rampFrom = 0;
+    TimerWheel::getInstance()->cancel(&_holdTimer);
+}
+
+/**
+ * @returns The number of steps in the program
+ */
+int Ohmbrewer::StepProgram::getStepCount() const {
+    return _numSteps;
+}
+
+/**
+ * @returns The index of the step the program is on
+ */
+int Ohmbrewer::StepProgram::getCurrentStep() const {
+    return _currentStep;
+}
+
+/**
+ * @returns Where the program is up to
+ */
+Ohmbrewer::StepProgram::Phase Ohmbrewer::StepProgram::getPhase() const {
+    return _phase;
+}
+
+/**
+ * Starts the program from its first step, turning the Equipment on
+ */
+void Ohmbrewer::StepProgram::start() {
+    if (_numSteps == 0) {
+        return;
+    }
+
+    _sprout->setState(true);
+    beginStep(0);
+}
+
+/**
+ * Stops the program where it is. The Equipment is left as it is, except that a RIMS's pump is no longer
+ * forced on or off.
+ */
+void Ohmbrewer::StepProgram::stop() {
+    _phase = IDLE;
+    overridePump(CommandParser::SWITCH_UNCHANGED);
+    getThermostat()->setPhase(GainSchedule::HOLD);
+    TimerWheel::getInstance()->cancel(&_holdTimer);
+}
+
+/**
+ * Moves the program along: ramps the target temperature, and starts the hold once it's reached.
+ * Expect to call this periodically during loop(). Holds end on their own timer.
+ */
+void Ohmbrewer::StepProgram::work() {
+    const Step &step = _steps[_currentStep];
+    Thermostat* therm = getThermostat();
+    unsigned long elapsed = millis() - _phaseStart;
+
+    if (_phase == RAMPING) {
+        double target = step.targetTemp;
+
+        // Move the target along the ramp, without overshooting the step's
+        if (step.rampRate > 0) {
+            double ramped = step.rampRate * (elapsed / 60000.0);
+            if (target > _rampFrom && _rampFrom + ramped < target) {
+                target = _rampFrom + ramped;
+            } else if (target < _rampFrom && _rampFrom - ramped > target) {
+                target = _rampFrom - ramped;
+            }
+        }
+        therm->setTargetTemp(target);
+
+        // The hold only starts once the temperature has actually got there
+        if (target == step.targetTemp &&
+            abs(therm->getSensor()->getTemp()->raw() - therm->getTargetTemp()->raw()) <= REACHED_TOLERANCE) {
+            _phase = HOLDING;
+            therm->setPhase(GainSchedule::HOLD);
+            TimerWheel::getInstance()->schedule(&_holdTimer, step.holdTime * 1000UL);
+            publishTransition("Step holding.");
+        }
+    }
+}
+
+/**
+ * Moves on to the next step, or finishes the program, once a hold is over
+ */
+void Ohmbrewer::StepProgram::endHold() {
+    if (_currentStep + 1 < _numSteps) {
+        beginStep(_currentStep + 1);
+    } else {
+        _phase = FINISHED;
+        overridePump(CommandParser::SWITCH_UNCHANGED);
+        getThermostat()->setPhase(GainSchedule::HOLD);
+        publishTransition("Program finished.");
+    }
+}
+
+/**
+ * The Thermostat that does the heating - the Equipment itself, or a RIMS's tube
+ * @returns The Thermostat
+ */
+Ohmbrewer::Thermostat* Ohmbrewer::StepProgram::getThermostat() const {
+    if (_sprout->getTypeCode() == Equipment::TYPE_RIMS) {
+        return ((RIMS*)_sprout)->getTube();
+    }
+    return (Thermostat*)_sprout;
+}
+
+/**
+ * Forces a RIMS's recirculation pump on or off, or lets it follow the tube again. Does nothing on a
+ * Thermostat.
+ * @param pumpState SWITCH_ON, SWITCH_OFF, or SWITCH_UNCHANGED to stop forcing it
+ */
+void Ohmbrewer::StepProgram::overridePump(CommandParser::Switch pumpState) const {
+    if (_sprout->getTypeCode() == Equipment::TYPE_RIMS) {
+        ((RIMS*)_sprout)->setPumpOverride(pumpState);
+    }
+}
+
+/**
+ * Starts a step's ramp
+ * @param step The index of the step
+ */
+void Ohmbrewer::StepProgram::beginStep(int step) {
+    _currentStep = step;
+    _phase = RAMPING;
+    _phaseStart = millis();
+    _rampFrom = getThermostat()->getSensor()->getTemp()->c();
+    getThermostat()->setPhase(GainSchedule::RAMP);
+
+    // An empty PUMP_STATE lets the pump follow the tube for this step
+    overridePump(_steps[step].pumpState);
+
+    publishTransition("Step started.");
+}
+
+/**
+ * Publishes a transition to the Equipment's stream
+ * @param msg Description of the transition
+ */
+void Ohmbrewer::StepProgram::publishTransition(const char* msg) const {
+    char stream[Publisher::MAX_STREAM_LENGTH + 1];
+
+    _sprout->getStream(stream, sizeof(stream));
+    Publisher pub = Publisher(stream, "msg", msg);
+    pub.add("step", (long)_currentStep);
+    pub.add("target", _steps[_currentStep].targetTemp, 1);
+    pub.publish();
+}
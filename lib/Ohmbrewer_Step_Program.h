@@ -0,0 +1,227 @@
+/**
+ * This library provides the StepProgram class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_STEP_PROGRAM_H
+#define OHMBREWER_STEP_PROGRAM_H
+
+#include "Ohmbrewer_Command_Parser.h"
+#include "Ohmbrewer_Timer_Wheel.h"
+#include "Ohmbrewer_Temperature.h"
+#include "Ohmbrewer_Object_Pool.h"
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    class Equipment;
+    class Thermostat;
+
+    /**
+     * Runs a mash schedule on a Thermostat or RIMS without needing the cloud for each step.
+     *
+     * A program is an ordered list of steps. Each step ramps the target temperature toward its own at the
+     * step's ramp rate, waits for the temperature to actually get there, and then holds it for the step's
+     * hold time before moving on to the next step. A RIMS's recirculation pump can also be forced on or off per
+     * step (see RIMS::setPumpOverride()); it goes back to following the tube once the program stops or finishes.
+     * Only the transitions (a step starting, a hold starting, the program finishing) are published.
+     *
+     * The last step's target is kept once the program has finished, until something else changes it.
+     */
+    class StepProgram {
+
+        public:
+
+            /**
+             * The most steps a program can hold
+             */
+            static const int MAX_STEPS = 8;
+
+            /**
+             * How close (raw, 0.5 C) the temperature must come to a step's target before its hold starts
+             */
+            static const int32_t REACHED_TOLERANCE = Temperature::ONE_DEGREE / 2;
+
+            /**
+             * A single step of the program
+             */
+            struct Step {
+                double targetTemp;             // Celsius
+                double rampRate;               // Celsius per minute. 0 goes straight to the target.
+                unsigned long holdTime;        // Seconds, once the target is reached
+                CommandParser::Switch pumpState; // Only used by a RIMS
+            };
+
+            /**
+             * Where the program is up to
+             */
+            enum Phase {
+                IDLE,     // Not started, or stopped
+                RAMPING,  // Moving toward the current step's target
+                HOLDING,  // Holding the current step's target
+                FINISHED  // Every step is done
+            };
+
+            /**
+             * Reads a step of a program: TARGET_TEMP,RAMP_RATE,HOLD_TIME,PUMP_STATE. Only the target is required.
+             * @param args The arguments supplied to the Rhizome, positioned at the step
+             * @param result The step, parsed
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+             */
+            static int parseStep(CommandParser &args, Step &result);
+
+            /**
+             * Constructor
+             * @param sprout The Thermostat or RIMS to run the program on
+             */
+            StepProgram(Equipment* sprout);
+
+            /**
+             * Destructor
+             */
+            virtual ~StepProgram();
+
+            /**
+             * Allocates from the pool of step programs rather than the heap (see getPool())
+             * @param size The size of the object
+             * @returns The memory for it
+             */
+            static void* operator new(size_t size);
+
+            /**
+             * Gives the memory back to the pool of step programs
+             * @param ptr The memory
+             */
+            static void operator delete(void* ptr);
+
+            /**
+             * @returns The pool step programs are allocated from, with room for one on every Sprout that can
+             *          run one (see SproutRegistry)
+             */
+            static ObjectPool* getPool();
+
+            /**
+             * The Equipment the program runs on
+             * @returns The Thermostat or RIMS
+             */
+            Equipment* getSprout() const;
+
+            /**
+             * Adds a step to the end of the program
+             * @param step The step. It's copied.
+             * @returns Whether there was room for it
+             */
+            bool addStep(const Step &step);
+
+            /**
+             * Stops the program and removes all of its steps
+             */
+            void clear();
+
+            /**
+             * @returns The number of steps in the program
+             */
+            int getStepCount() const;
+
+            /**
+             * @returns The index of the step the program is on
+             */
+            int getCurrentStep() const;
+
+            /**
+             * @returns Where the program is up to
+             */
+            Phase getPhase() const;
+
+            /**
+             * Starts the program from its first step, turning the Equipment on
+             */
+            void start();
+
+            /**
+             * Stops the program where it is. The Equipment is left as it is, except that a RIMS's pump is no longer
+             * forced on or off.
+             */
+            void stop();
+
+            /**
+             * Moves the program along: ramps the target temperature, and starts the hold once it's reached.
+             * Expect to call this periodically during loop(). Holds end on their own timer.
+             */
+            void work();
+
+        protected:
+
+            /**
+             * The Thermostat or RIMS the program runs on
+             */
+            Equipment* _sprout;
+
+            /**
+             * The steps of the program
+             */
+            Step _steps[MAX_STEPS];
+
+            /**
+             * The number of steps in _steps
+             */
+            int _numSteps;
+
+            /**
+             * The index of the step the program is on
+             */
+            int _currentStep;
+
+            /**
+             * Where the program is up to
+             */
+            Phase _phase;
+
+            /**
+             * When the current step's ramp started, in milliseconds
+             */
+            unsigned long _phaseStart;
+
+            /**
+             * Fires when the current step's hold is over
+             */
+            TimerWheel::Timer _holdTimer;
+
+            /**
+             * The temperature the current step's ramp started from, in Celsius
+             */
+            double _rampFrom;
+
+            /**
+             * The Thermostat that does the heating - the Equipment itself, or a RIMS's tube
+             * @returns The Thermostat
+             */
+            Thermostat* getThermostat() const;
+
+            /**
+             * Forces a RIMS's recirculation pump on or off, or lets it follow the tube again. Does nothing on a
+             * Thermostat.
+             * @param pumpState SWITCH_ON, SWITCH_OFF, or SWITCH_UNCHANGED to stop forcing it
+             */
+            void overridePump(CommandParser::Switch pumpState) const;
+
+            /**
+             * Starts a step's ramp
+             * @param step The index of the step
+             */
+            void beginStep(int step);
+
+            /**
+             * Moves on to the next step, or finishes the program, once a hold is over
+             */
+            void endHold();
+
+            /**
+             * Publishes a transition to the Equipment's stream
+             * @param msg Description of the transition
+             */
+            void publishTransition(const char* msg) const;
+    };
+};
+
+#endif
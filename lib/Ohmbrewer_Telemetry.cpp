@@ -0,0 +1,213 @@
+#include "Ohmbrewer_Telemetry.h"
+#include "Ohmbrewer_Equipment.h"
+#include "Ohmbrewer_Temperature_Sensor.h"
+#include "Ohmbrewer_Pump.h"
+#include "Ohmbrewer_Heating_Element.h"
+#include "Ohmbrewer_Thermostat.h"
+#include "Ohmbrewer_RIMS.h"
+
+/**
+ * Constructor
+ */
+Ohmbrewer::Telemetry::Telemetry() {
+    _length = 0;
+    _sequence = 0;
+    _frameTime = 0;
+    _encoded[0] = '\0';
+}
+
+/**
+ * Publishes the status of every Sprout, in as few frames as they fit in.
+ * @param sprouts The Rhizome's Sprouts
+ * @returns The number of frames published
+ */
+int Ohmbrewer::Telemetry::publish(std::deque< Equipment* >* sprouts) {
+    return encode(sprouts, Time.now(), [](const char* frame) {
+        Particle.publish(STREAM_NAME, frame, 30, PRIVATE);
+    });
+}
+
+/**
+ * Builds the frames for the status of every Sprout without publishing them.
+ * @param sprouts The Rhizome's Sprouts
+ * @param now The time to stamp the frames with, as from Time.now()
+ * @param sink Handed each frame as it's finished
+ * @returns The number of frames built
+ */
+int Ohmbrewer::Telemetry::encode(std::deque< Equipment* >* sprouts, unsigned long now, frame_sink_t sink) {
+    int frames = 0;
+
+    _frameTime = now;
+    beginFrame();
+
+    for (std::deque< Equipment* >::iterator itr = sprouts->begin(); itr != sprouts->end(); itr++) {
+        Equipment* sprout = *itr;
+        uint8_t type = typeCodeFor(sprout);
+        uint8_t flags = sprout->getState() ? FLAG_ON : 0;
+
+        switch (type) {
+            case TypeCode::TEMPERATURE_SENSOR:
+                frames += addRecord(sink, sprout->getID(), type, flags, (TemperatureSensor*)sprout);
+                break;
+            case TypeCode::THERMOSTAT:
+                frames += addRecord(sink, sprout->getID(), type, flags, ((Thermostat*)sprout)->getSensor());
+                break;
+            case TypeCode::RIMS:
+                frames += addRecord(sink, sprout->getID(), type, flags, ((RIMS*)sprout)->getTunSensor());
+                frames += addRecord(sink, sprout->getID(), type, flags | FLAG_SAFETY,
+                                    ((RIMS*)sprout)->getSafetySensor());
+                break;
+            default:
+                frames += addRecord(sink, sprout->getID(), type, flags, NULL);
+                break;
+        }
+    }
+
+    return frames + endFrame(sink);
+}
+
+/**
+ * @returns The sequence number the next frame will carry
+ */
+uint8_t Ohmbrewer::Telemetry::getSequence() const {
+    return _sequence;
+}
+
+/**
+ * Starts a new frame
+ */
+void Ohmbrewer::Telemetry::beginFrame() {
+    _frame[0] = FRAME_VERSION;
+    _frame[1] = _sequence;
+    _frame[2] = (uint8_t)(_frameTime & 0xFF);
+    _frame[3] = (uint8_t)((_frameTime >> 8) & 0xFF);
+    _frame[4] = (uint8_t)((_frameTime >> 16) & 0xFF);
+    _frame[5] = (uint8_t)((_frameTime >> 24) & 0xFF);
+    _frame[6] = 0;
+    _length = HEADER_SIZE;
+}
+
+/**
+ * Finishes the current frame, if it holds any records, and hands it to the sink base64 encoded
+ * @param sink Handed the frame
+ * @returns The number of frames finished - 0 or 1
+ */
+int Ohmbrewer::Telemetry::endFrame(frame_sink_t &sink) {
+    if (_frame[6] == 0) {
+        return 0;
+    }
+
+    toBase64(_frame, _length, _encoded);
+    sink(_encoded);
+    _sequence++;
+    beginFrame();
+    return 1;
+}
+
+/**
+ * Appends a record, starting a new frame if the current one is full. Sprouts whose ID doesn't fit in
+ * a record (see MIN_ID and MAX_ID) are left out rather than reported under some other ID.
+ * @param sink Handed the current frame if it's full
+ * @param id The Sprout's ID
+ * @param type The Sprout's type code
+ * @param flags Record flags
+ * @param sensor The Temperature Sensor whose reading to report, or NULL if there isn't one
+ * @returns The number of frames finished to make room - 0 or 1
+ */
+int Ohmbrewer::Telemetry::addRecord(frame_sink_t &sink, int id, uint8_t type, uint8_t flags,
+                                    TemperatureSensor* sensor) {
+    int frames = 0;
+    int16_t temperature = NO_TEMPERATURE;
+    uint16_t age = AGE_UNKNOWN;
+
+    if (id < MIN_ID || id > MAX_ID) {
+        return 0;
+    }
+
+    if (_length + RECORD_SIZE > MAX_FRAME_SIZE) {
+        frames = endFrame(sink);
+    }
+
+    if (sensor != NULL && sensor->getTemp()->isValid()) {
+        // 1/16ths to 1/100ths, rounding half away from zero
+        int32_t hundredths = sensor->getTemp()->raw() * 100;
+        hundredths += (hundredths < 0) ? -(Temperature::ONE_DEGREE / 2) : (Temperature::ONE_DEGREE / 2);
+        hundredths /= Temperature::ONE_DEGREE;
+        if (hundredths > 32767) {
+            hundredths = 32767;
+        } else if (hundredths < -32767) {
+            hundredths = -32767;
+        }
+        temperature = (int16_t)hundredths;
+
+        long elapsed = (long)(_frameTime - (unsigned long)sensor->getLastReadTime());
+        if (elapsed < 0) {
+            age = 0;
+        } else if (elapsed < AGE_UNKNOWN) {
+            age = (uint16_t)elapsed;
+        }
+    }
+
+    uint8_t* record = _frame + _length;
+    record[0] = (uint8_t)(int8_t)id;
+    record[1] = type;
+    record[2] = flags;
+    record[3] = (uint8_t)(temperature & 0xFF);
+    record[4] = (uint8_t)((temperature >> 8) & 0xFF);
+    record[5] = (uint8_t)(age & 0xFF);
+    record[6] = (uint8_t)((age >> 8) & 0xFF);
+
+    _length += RECORD_SIZE;
+    _frame[6]++;
+    return frames;
+}
+
+/**
+ * @param equipment Some Equipment
+ * @returns The Equipment's type code
+ */
+uint8_t Ohmbrewer::Telemetry::typeCodeFor(const Equipment* equipment) {
+    // The wire codes are fixed by the frame format, so they're mapped rather than cast
+    switch (equipment->getTypeCode()) {
+        case Equipment::TYPE_TEMPERATURE_SENSOR:
+            return TypeCode::TEMPERATURE_SENSOR;
+        case Equipment::TYPE_PUMP:
+            return TypeCode::PUMP;
+        case Equipment::TYPE_HEATING_ELEMENT:
+            return TypeCode::HEATING_ELEMENT;
+        case Equipment::TYPE_THERMOSTAT:
+            return TypeCode::THERMOSTAT;
+        case Equipment::TYPE_RIMS:
+            return TypeCode::RIMS;
+        default:
+            return TypeCode::UNKNOWN;
+    }
+}
+
+/**
+ * Base64 encodes some bytes
+ * @param data The bytes
+ * @param length The number of bytes
+ * @param result Filled with the encoded bytes and a terminating null. Must have room for them.
+ */
+void Ohmbrewer::Telemetry::toBase64(const uint8_t* data, int length, char* result) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    int out = 0;
+
+    for (int i = 0; i < length; i += 3) {
+        uint32_t chunk = (uint32_t)data[i] << 16;
+        if (i + 1 < length) {
+            chunk |= (uint32_t)data[i + 1] << 8;
+        }
+        if (i + 2 < length) {
+            chunk |= data[i + 2];
+        }
+
+        result[out++] = ALPHABET[(chunk >> 18) & 0x3F];
+        result[out++] = ALPHABET[(chunk >> 12) & 0x3F];
+        result[out++] = (i + 1 < length) ? ALPHABET[(chunk >> 6) & 0x3F] : '=';
+        result[out++] = (i + 2 < length) ? ALPHABET[chunk & 0x3F] : '=';
+    }
+
+    result[out] = '\0';
+}
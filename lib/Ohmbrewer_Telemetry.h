@@ -0,0 +1,210 @@
+/**
+ * This library provides the Telemetry class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_TELEMETRY_H
+#define OHMBREWER_TELEMETRY_H
+
+// Kludge to allow us to use std::deque - for now we have to undefine these macros.
+#undef min
+#undef max
+#undef swap
+#include <deque>
+#include <functional>
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    class Equipment;
+    class TemperatureSensor;
+
+    /**
+     * Batches the periodic status of every Sprout into compact binary frames, published base64 encoded
+     * to a single Particle event stream. One frame carries up to MAX_RECORDS readings, so a whole Rhizome
+     * normally costs one publish per period instead of one per Temperature Sensor.
+     *
+     * Frame layout (all multi-byte fields little-endian):
+     *   Header - 7 bytes
+     *     uint8  version       FRAME_VERSION
+     *     uint8  sequence      Increments with every frame, so dropped frames can be spotted
+     *     uint32 time          Time.now() when the frame was built
+     *     uint8  count         Number of records that follow
+     *   Record - 7 bytes each
+     *     int8   id            The Sprout's ID
+     *     uint8  type          See Telemetry::TypeCode
+     *     uint8  flags         See FLAG_ON and FLAG_SAFETY
+     *     int16  temperature   Hundredths of a degree Celsius, or NO_TEMPERATURE
+     *     uint16 age           Seconds between the reading and the frame's time, or AGE_UNKNOWN
+     *
+     * A RIMS gets two records: its tun reading, then its safety sensor's reading with FLAG_SAFETY set. Sprout IDs are
+     * pin numbers and probe indices, so they fit in the id field; any that don't are left out of the frame.
+     * See test/lib/telemetry_frame.rb for a decoder.
+     */
+    class Telemetry {
+
+        public:
+
+            /**
+             * Receives each finished frame, base64 encoded and null terminated
+             */
+            typedef std::function<void(const char*)> frame_sink_t;
+
+            /**
+             * Provides the type codes used in a record's type field.
+             */
+            class TypeCode {
+                public:
+
+                static const uint8_t UNKNOWN = 0;
+                static const uint8_t TEMPERATURE_SENSOR = 1;
+                static const uint8_t PUMP = 2;
+                static const uint8_t HEATING_ELEMENT = 3;
+                static const uint8_t THERMOSTAT = 4;
+                static const uint8_t RIMS = 5;
+            };
+
+            /**
+             * The Particle cloud event stream frames are published to
+             */
+            const static constexpr char* STREAM_NAME = "telemetry";
+
+            /**
+             * The layout version written to each frame's header
+             */
+            static const uint8_t FRAME_VERSION = 1;
+
+            static const int HEADER_SIZE = 7;
+            static const int RECORD_SIZE = 7;
+
+            /**
+             * The largest frame, in bytes. Encodes to 252 characters, inside the 255 a Particle event may carry.
+             */
+            static const int MAX_FRAME_SIZE = 189;
+
+            /**
+             * The longest a base64 encoded frame can be, in characters
+             */
+            static const int MAX_ENCODED_SIZE = ((MAX_FRAME_SIZE + 2) / 3) * 4;
+
+            /**
+             * The most records a single frame holds
+             */
+            static const int MAX_RECORDS = (MAX_FRAME_SIZE - HEADER_SIZE) / RECORD_SIZE;
+
+            /**
+             * Record flags
+             */
+            static const uint8_t FLAG_ON = 0x01;     // The Sprout is on
+            static const uint8_t FLAG_SAFETY = 0x02; // The reading is from a RIMS's safety sensor
+
+            /**
+             * The range of Sprout IDs a record's id field holds
+             */
+            static const int MIN_ID = -128;
+            static const int MAX_ID = 127;
+
+            /**
+             * Temperature field value for Sprouts that don't have a reading
+             */
+            static const int16_t NO_TEMPERATURE = -32768;
+
+            /**
+             * Age field value for Sprouts that don't have a reading, or whose reading is too old to tell
+             */
+            static const uint16_t AGE_UNKNOWN = 0xFFFF;
+
+            /**
+             * Constructor
+             */
+            Telemetry();
+
+            /**
+             * Publishes the status of every Sprout, in as few frames as they fit in.
+             * @param sprouts The Rhizome's Sprouts
+             * @returns The number of frames published
+             */
+            int publish(std::deque< Equipment* >* sprouts);
+
+            /**
+             * Builds the frames for the status of every Sprout without publishing them.
+             * @param sprouts The Rhizome's Sprouts
+             * @param now The time to stamp the frames with, as from Time.now()
+             * @param sink Handed each frame as it's finished
+             * @returns The number of frames built
+             */
+            int encode(std::deque< Equipment* >* sprouts, unsigned long now, frame_sink_t sink);
+
+            /**
+             * @returns The sequence number the next frame will carry
+             */
+            uint8_t getSequence() const;
+
+        protected:
+
+            /**
+             * The frame currently being built
+             */
+            uint8_t _frame[MAX_FRAME_SIZE];
+
+            /**
+             * Bytes used in _frame so far
+             */
+            int _length;
+
+            /**
+             * The sequence number the next frame will carry
+             */
+            uint8_t _sequence;
+
+            /**
+             * The time stamped on the frame currently being built
+             */
+            unsigned long _frameTime;
+
+            /**
+             * The frame currently being built, base64 encoded
+             */
+            char _encoded[MAX_ENCODED_SIZE + 1];
+
+            /**
+             * Starts a new frame
+             */
+            void beginFrame();
+
+            /**
+             * Finishes the current frame, if it holds any records, and hands it to the sink base64 encoded
+             * @param sink Handed the frame
+             * @returns The number of frames finished - 0 or 1
+             */
+            int endFrame(frame_sink_t &sink);
+
+            /**
+             * Appends a record, starting a new frame if the current one is full. Sprouts whose ID doesn't fit in
+             * a record (see MIN_ID and MAX_ID) are left out rather than reported under some other ID.
+             * @param sink Handed the current frame if it's full
+             * @param id The Sprout's ID
+             * @param type The Sprout's type code
+             * @param flags Record flags
+             * @param sensor The Temperature Sensor whose reading to report, or NULL if there isn't one
+             * @returns The number of frames finished to make room - 0 or 1
+             */
+            int addRecord(frame_sink_t &sink, int id, uint8_t type, uint8_t flags, TemperatureSensor* sensor);
+
+            /**
+             * @param equipment Some Equipment
+             * @returns The Equipment's type code
+             */
+            static uint8_t typeCodeFor(const Equipment* equipment);
+
+            /**
+             * Base64 encodes some bytes
+             * @param data The bytes
+             * @param length The number of bytes
+             * @param result Filled with the encoded bytes and a terminating null. Must have room for them.
+             */
+            static void toBase64(const uint8_t* data, int length, char* result);
+    };
+};
+
+#endif
@@ -1,10 +1,21 @@
 #include "Ohmbrewer_Temperature.h"
+#include "Ohmbrewer_Sprout_Registry.h"
+
+/**
+ * Converts a Celsius value to raw, rounding to the nearest 1/16th of a degree
+ * @param temp The temperature in Celsius
+ * @returns The temperature in 1/16ths of a degree Celsius
+ */
+int32_t Ohmbrewer::Temperature::toRaw(const double temp) {
+    double scaled = temp * ONE_DEGREE;
+    return (int32_t)(scaled + ((scaled < 0) ? -0.5 : 0.5));
+}
 
 /**
  * Constructor.
  */
 Ohmbrewer::Temperature::Temperature() {
-    _temp = Temperature::INVALID_TEMPERATURE;
+    _temp = Temperature::INVALID_RAW;
 }
 
 /**
@@ -12,7 +23,7 @@ Ohmbrewer::Temperature::Temperature() {
  * @param temp The temperature in Celsius
  */
 Ohmbrewer::Temperature::Temperature(const double temp) {
-    _temp = temp;
+    _temp = toRaw(temp);
 }
 
 /**
@@ -20,7 +31,7 @@ Ohmbrewer::Temperature::Temperature(const double temp) {
  * @param copy The Temperature to copy
  */
 Ohmbrewer::Temperature::Temperature(const Temperature& copy) {
-    _temp = copy.c();
+    _temp = copy.raw();
 }
 
 /**
@@ -30,6 +41,37 @@ Ohmbrewer::Temperature::~Temperature() {
     // Nothing to do here...
 }
 
+/**
+ * Allocates from the pool of Temperatures rather than the heap (see getPool())
+ * @param size The size of the object
+ * @returns The memory for it
+ */
+void* Ohmbrewer::Temperature::operator new(size_t size) {
+    return getPool()->allocate(size);
+}
+
+/**
+ * Gives the memory back to the pool of Temperatures
+ * @param ptr The memory
+ */
+void Ohmbrewer::Temperature::operator delete(void* ptr) {
+    getPool()->release(ptr);
+}
+
+/**
+ * @returns The pool Temperatures are allocated from, sized for the most the Rhizome may have
+ *          (see SproutRegistry)
+ */
+Ohmbrewer::ObjectPool* Ohmbrewer::Temperature::getPool() {
+    // A last reading for each Temperature Sensor, a target for each Thermostat and a safety temperature for each RIMS.
+    // Temperatures made on the stack, as most are, don't come out of it.
+    const int size = SproutRegistry::MAX_TEMPERATURE_SENSORS + (2 * SproutRegistry::MAX_THERMOSTATS) +
+                     (4 * SproutRegistry::MAX_RIMS);
+    static uint64_t storage[ObjectPool::words(sizeof(Temperature), size)];
+    static ObjectPool pool = ObjectPool(storage, sizeof(Temperature), size);
+    return &pool;
+}
+
 /**
  * The temperature in Fahrenheit
  * @returns The temperature in Fahrenheit
@@ -51,9 +93,24 @@ double Ohmbrewer::Temperature::c() const {
  * @returns The temperature in Celsius
  */
 double Ohmbrewer::Temperature::get() const {
+    return _temp / (double)ONE_DEGREE;
+}
+
+/**
+ * The temperature in fixed point
+ * @returns The temperature in 1/16ths of a degree Celsius
+ */
+int32_t Ohmbrewer::Temperature::raw() const {
     return _temp;
 }
 
+/**
+ * @returns Whether the temperature is a real reading, rather than INVALID_TEMPERATURE
+ */
+bool Ohmbrewer::Temperature::isValid() const {
+    return _temp != INVALID_RAW;
+}
+
 /**
  * Fills a provided C-string buffer with the temperature, formatted for display.
  * Note that this expects your buffer to be sufficiently large!
@@ -79,7 +136,7 @@ void Ohmbrewer::Temperature::toStrF(char* buffer, unsigned int width, unsigned p
  * @param temp The temperature in Fahrenheit
  */
 const bool Ohmbrewer::Temperature::fromF(const double temp) {
-    _temp = (temp - 32)/1.8;
+    _temp = toRaw((temp - 32)/1.8);
     return true;
 }
 
@@ -88,7 +145,7 @@ const bool Ohmbrewer::Temperature::fromF(const double temp) {
  * @param temp The temperature in Celsius
  */
 const bool Ohmbrewer::Temperature::fromC(const double temp) {
-    _temp = temp;
+    _temp = toRaw(temp);
     return true;
 }
 
@@ -97,6 +154,15 @@ const bool Ohmbrewer::Temperature::fromC(const double temp) {
  * @param temp The temperature in Celsius
  */
 const bool Ohmbrewer::Temperature::set(const double temp) {
+    _temp = toRaw(temp);
+    return true;
+}
+
+/**
+ * Sets the temperature from a fixed point value
+ * @param temp The temperature in 1/16ths of a degree Celsius
+ */
+const bool Ohmbrewer::Temperature::fromRaw(const int32_t temp) {
     _temp = temp;
     return true;
 }
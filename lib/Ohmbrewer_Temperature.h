@@ -7,11 +7,19 @@
 #define OHMBREWER_TEMPERATURE_H
 
 #include "application.h"
+#include "Ohmbrewer_Object_Pool.h"
 #include "Ohmbrewer_Screen.h"
 
 
 namespace Ohmbrewer {
 
+    /**
+     * A temperature, held in fixed point as a whole number of 1/16ths of a degree Celsius - the DS18B20's own
+     * resolution, so a probe's reading is stored exactly as it comes off the bus.
+     *
+     * The Photon has no FPU, so every double operation is a software routine. The control path (sensor decoding,
+     * comparisons, hysteresis) works on raw() values; c() and f() are for the display and for publishing.
+     */
     class Temperature {
       
         public:
@@ -21,6 +29,28 @@ namespace Ohmbrewer {
              */
             const static constexpr double INVALID_TEMPERATURE = -69.0;
 
+            /**
+             * The number of fractional bits in a raw temperature
+             */
+            static const int FRACTION_BITS = 4;
+
+            /**
+             * One degree Celsius, raw
+             */
+            static const int32_t ONE_DEGREE = 1 << FRACTION_BITS;
+
+            /**
+             * INVALID_TEMPERATURE, raw
+             */
+            static const int32_t INVALID_RAW = -69 * ONE_DEGREE;
+
+            /**
+             * Converts a Celsius value to raw, rounding to the nearest 1/16th of a degree
+             * @param temp The temperature in Celsius
+             * @returns The temperature in 1/16ths of a degree Celsius
+             */
+            static int32_t toRaw(const double temp);
+
             /**
              * Constructor.
              */
@@ -43,6 +73,25 @@ namespace Ohmbrewer {
              */
             virtual ~Temperature();
 
+            /**
+             * Allocates from the pool of Temperatures rather than the heap (see getPool())
+             * @param size The size of the object
+             * @returns The memory for it
+             */
+            static void* operator new(size_t size);
+
+            /**
+             * Gives the memory back to the pool of Temperatures
+             * @param ptr The memory
+             */
+            static void operator delete(void* ptr);
+
+            /**
+             * @returns The pool Temperatures are allocated from, sized for the most the Rhizome may have
+             *          (see SproutRegistry)
+             */
+            static ObjectPool* getPool();
+
             /**
              * The temperature in Fahrenheit
              * @returns The temperature in Fahrenheit
@@ -61,6 +110,17 @@ namespace Ohmbrewer {
              */
             double get() const;
 
+            /**
+             * The temperature in fixed point
+             * @returns The temperature in 1/16ths of a degree Celsius
+             */
+            int32_t raw() const;
+
+            /**
+             * @returns Whether the temperature is a real reading, rather than INVALID_TEMPERATURE
+             */
+            bool isValid() const;
+
             /**
              * Fills a provided C-string buffer with the temperature, formatted for display.
              * Note that this expects your buffer to be sufficiently large!
@@ -97,6 +157,12 @@ namespace Ohmbrewer {
              */
             const bool set(const double temp);
 
+            /**
+             * Sets the temperature from a fixed point value
+             * @param temp The temperature in 1/16ths of a degree Celsius
+             */
+            const bool fromRaw(const int32_t temp);
+
 //            /**
 //             * Prints the temperature information for temp in yellow onto the touchscreen.
 //             * @param screen The Rhizome's touchscreen
@@ -114,9 +180,9 @@ namespace Ohmbrewer {
 
     protected:
             /**
-             * The temperature in Celsius
+             * The temperature in 1/16ths of a degree Celsius
              */
-            double _temp;
+            int32_t _temp;
     };
 };
 
@@ -3,6 +3,7 @@
 #include "Ohmbrewer_Onewire.h"
 #include "Ohmbrewer_Publisher.h"
 #include "Ohmbrewer_Temperature.h"
+#include "Ohmbrewer_Sprout_Registry.h"
 
 
 /**
@@ -13,6 +14,7 @@ Ohmbrewer::TemperatureSensor::TemperatureSensor(Probe* probe) {
     _probe = probe;                 //For now all probes are all onewire
     _lastReading = new Temperature();
     _lastReadTime = Time.now();
+    _lastProbeReadTime = 0;
 //    registerUpdateFunction();
 }
 
@@ -27,6 +29,7 @@ Ohmbrewer::TemperatureSensor::TemperatureSensor(Probe* probe, int stopTime, bool
     _probe = probe;
     _lastReading = new Temperature();
     _lastReadTime = Time.now();
+    _lastProbeReadTime = 0;
 //    registerUpdateFunction();
 }
 
@@ -38,6 +41,7 @@ Ohmbrewer::TemperatureSensor::TemperatureSensor(const TemperatureSensor& clonee)
     _probe = clonee.getProbe();
     _lastReading = clonee.getTemp();
     _lastReadTime = Time.now();
+    _lastProbeReadTime = 0;
 //    registerUpdateFunction();
 }
 
@@ -49,6 +53,37 @@ Ohmbrewer::TemperatureSensor::~TemperatureSensor() {
     delete _probe;
 }
 
+/**
+ * Allocates from the pool of Temperature Sensors rather than the heap (see getPool())
+ * @param size The size of the object
+ * @returns The memory for it
+ */
+void* Ohmbrewer::TemperatureSensor::operator new(size_t size) {
+    return getPool()->allocate(size);
+}
+
+/**
+ * Gives the memory back to the pool of Temperature Sensors
+ * @param ptr The memory
+ */
+void Ohmbrewer::TemperatureSensor::operator delete(void* ptr) {
+    getPool()->release(ptr);
+}
+
+/**
+ * @returns The pool Temperature Sensors are allocated from, sized for the most the Rhizome may have
+ *          (see SproutRegistry)
+ */
+Ohmbrewer::ObjectPool* Ohmbrewer::TemperatureSensor::getPool() {
+    // Every Temperature Sensor Sprout, plus the one in each Thermostat (a RIMS has one too) and each RIMS's
+    // safety sensor
+    const int size = SproutRegistry::MAX_TEMPERATURE_SENSORS + SproutRegistry::MAX_THERMOSTATS +
+                     (2 * SproutRegistry::MAX_RIMS);
+    static uint64_t storage[ObjectPool::words(sizeof(TemperatureSensor), size)];
+    static ObjectPool pool = ObjectPool(storage, sizeof(TemperatureSensor), size);
+    return &pool;
+}
+
 /**
  * The Equipment ID
  * @returns The Sprout ID to use for this piece of Equipment
@@ -99,28 +134,17 @@ int Ohmbrewer::TemperatureSensor::getBusPin() const{
     //TODO will need work once more probe subclasses are added
 }
 
-/**
- * Specifies the interface for arguments sent to this TemperatureSensor's associated function.
- * Parses the supplied string into an array of strings for setting the TemperatureSensor's values.
- * Most likely will be called during update().
- * @param args The arguments supplied as an update to the Rhizome.
- * @param argsMap A map representing the key/value pairs for the update
- */
-void Ohmbrewer::TemperatureSensor::parseArgs(const String &args, Ohmbrewer::Equipment::args_map_t &argsMap) {
-    // Nothing special to parse out for this class.
-}
-
 /**
  * Sets the TemperatureSensor state. True => On, False => Off
  * @param state Whether the TemperatureSensor is ON (or OFF). True => ON, False => OFF
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::TemperatureSensor::setState(const bool state) {
-    unsigned long start = millis();
+    unsigned long start = micros();
 
     _state = state;
 
-    return start - millis();
+    return micros() - start;
 }
 
 /**
@@ -151,15 +175,25 @@ bool Ohmbrewer::TemperatureSensor::isOff() const {
  * Performs the TemperatureSensor's current task. Expect to use this during loop().
  * This function is called by work().
  *
- * This analyzes the connected DS18B20 probes and updates temperature.from_c with the Celsius value.
+ * This analyzes the connected DS18B20 probes and updates the temperature with the probe's raw reading.
+ * The probe never blocks waiting on a conversion; the temperature and last read time only change when
+ * the probe reports a newly completed reading.
  *
  *
  * @returns The time taken to run the method
  */
 int Ohmbrewer::TemperatureSensor::doWork() {
-    int startTime = millis();
-    getTemp()->fromC(_probe->getReading());
-    return (millis()-startTime);
+    unsigned long startTime = micros();
+    int32_t reading = _probe->getReading();
+
+    // The probe converts in the background, so only take the reading once it has finished a new one
+    if(_probe->getLastReadTime() != _lastProbeReadTime) {
+        _lastProbeReadTime = _probe->getLastReadTime();
+        getTemp()->fromRaw(reading);
+        _lastReadTime = Time.now();
+    }
+
+    return micros() - startTime;
 }
 
 /**
@@ -204,14 +238,12 @@ int Ohmbrewer::TemperatureSensor::doDisplay(Ohmbrewer::Screen *screen) {
 /**
  * Publishes updates to Ohmbrewer, etc.
  * This function is called by update().
- * @param args The argument string passed into the Particle Cloud
- * @param argsMap A map representing the key/value pairs for the update
- * @returns The time taken to run the method
+ * @param args The rest of the arguments passed into the Particle Cloud
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
  */
-int Ohmbrewer::TemperatureSensor::doUpdate(String &args, Ohmbrewer::Equipment::args_map_t &argsMap) {
-    unsigned long start = millis();
+int Ohmbrewer::TemperatureSensor::doUpdate(CommandParser &args) {
     // Nothing to do as it is...
-    return millis() - start;
+    return CommandParser::ParseError::NONE;
 }
 
 /**
@@ -227,8 +259,9 @@ void Ohmbrewer::TemperatureSensor::whichPins(std::list<int>* pins) {
  * Publishes the latest reading
  */
 void Ohmbrewer::TemperatureSensor::publishSensorReading() {
-    Publisher pub = Publisher(new String(getStream()),
-                              String("temperature"),
-                              String(getTemp()->c()));
+    char stream[Publisher::MAX_STREAM_LENGTH + 1];
+    getStream(stream, sizeof(stream));
+    Publisher pub = Publisher(stream);
+    pub.add("temperature", getTemp()->c());
     pub.publish();
 }
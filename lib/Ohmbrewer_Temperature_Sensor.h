@@ -14,9 +14,9 @@
 #include "Ohmbrewer_Equipment.h"
 #include "Ohmbrewer_Temperature.h"
 #include "application.h"
+#include "Ohmbrewer_Object_Pool.h"
 #include "Ohmbrewer_Probe.h"
 
-
 namespace Ohmbrewer {
 
     class TemperatureSensor : public Equipment {
@@ -34,6 +34,12 @@ namespace Ohmbrewer {
              */
             virtual const char* getType() const { return TemperatureSensor::TYPE_NAME; };
 
+            /**
+             * The Equipment Type
+             * @returns The Equipment type code
+             */
+            virtual TypeCode getTypeCode() const { return TYPE_TEMPERATURE_SENSOR; };
+
             /**
              * Constructor
              * @param pins The list of physical pins this TemperatureSensor is attached to
@@ -60,6 +66,25 @@ namespace Ohmbrewer {
              */
             virtual ~TemperatureSensor();
 
+            /**
+             * Allocates from the pool of Temperature Sensors rather than the heap (see getPool())
+             * @param size The size of the object
+             * @returns The memory for it
+             */
+            static void* operator new(size_t size);
+
+            /**
+             * Gives the memory back to the pool of Temperature Sensors
+             * @param ptr The memory
+             */
+            static void operator delete(void* ptr);
+
+            /**
+             * @returns The pool Temperature Sensors are allocated from, sized for the most the Rhizome may have
+             *          (see SproutRegistry)
+             */
+            static ObjectPool* getPool();
+
             /**
              * The Equipment ID
              * @returns The Sprout ID to use for this piece of Equipment
@@ -96,14 +121,6 @@ namespace Ohmbrewer {
              */
             Probe* getProbe() const;
 
-            /**
-             * Specifies the interface for arguments sent to this TemperatureSensor's associated function.
-             * Parses the supplied string into an array of strings for setting the TemperatureSensor's values.
-             * Most likely will be called during update().
-             * @param argsStr The arguments supplied as an update to the Rhizome.
-             * @param result A map representing the key/value pairs for the update
-             */
-            static void parseArgs(const String &argsStr, args_map_t &result);
 
             /**
              * Sets the TemperatureSensor state. True => On, False => Off
@@ -148,11 +165,10 @@ namespace Ohmbrewer {
             /**
              * Publishes updates to Ohmbrewer, etc.
              * This function is called by update().
-             * @param args The argument string passed into the Particle Cloud
-             * @param argsMap A map representing the key/value pairs for the update
-             * @returns The time taken to run the method
+             * @param args The rest of the arguments passed into the Particle Cloud
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
              */
-            int doUpdate(String &args, args_map_t &argsMap);
+            int doUpdate(CommandParser &args);
 
             /**
              * Reports which of the Rhizome's pins are occupied by the
@@ -178,6 +194,11 @@ namespace Ohmbrewer {
              */
             int _lastReadTime;
 
+            /**
+             * The probe's timestamp for the last reading we took from it
+             */
+            unsigned long _lastProbeReadTime;
+
             /**
              * temperature Probe
              */
@@ -0,0 +1,162 @@
+#include "Ohmbrewer_Text_Grid.h"
+
+/**
+ * Constructor. Starts out blank.
+ * @param background The background color, which a blank cell is filled with
+ */
+Ohmbrewer::TextGrid::TextGrid(uint16_t background) {
+    _background = background;
+    clear();
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::TextGrid::~TextGrid() {
+    // Nothing to do here...
+}
+
+/**
+ * Marks every cell blank, e.g. after the screen is cleared
+ */
+void Ohmbrewer::TextGrid::clear() {
+    for (int row = 0; row < ROWS; row++) {
+        for (int column = 0; column < COLUMNS; column++) {
+            _cells[row][column].glyph = ' ';
+            _cells[row][column].flags = 0;
+            _cells[row][column].color = _background;
+            _cells[row][column].bg = _background;
+        }
+    }
+}
+
+/**
+ * Puts half a glyph into a cell, and marks it as printed this frame
+ * @param column The cell's column
+ * @param row The cell's row
+ * @param glyph The character
+ * @param bottom Whether this is the glyph's bottom half, rather than its top
+ * @param color The glyph's color
+ * @param bg The background color behind it
+ * @returns Whether the cell changed, and so is dirty
+ */
+bool Ohmbrewer::TextGrid::set(int column, int row, uint8_t glyph, bool bottom, uint16_t color, uint16_t bg) {
+    Cell &cell = _cells[row][column];
+    uint8_t flags = bottom ? BOTTOM : 0;
+
+    // Both halves of a space are just background, whatever the text color
+    if (glyph == ' ') {
+        flags = 0;
+        color = bg;
+    }
+
+    bool changed = (cell.flags & UNKNOWN) || cell.glyph != glyph || (cell.flags & BOTTOM) != flags ||
+                   cell.color != color || cell.bg != bg;
+
+    // A cell that's still waiting to be drawn stays dirty, even if it's set back to what it was
+    if (changed || (cell.flags & DIRTY)) {
+        flags |= DIRTY;
+    }
+
+    cell.glyph = glyph;
+    cell.flags = flags | PRINTED;
+    cell.color = color;
+    cell.bg = bg;
+
+    return changed;
+}
+
+/**
+ * Forgets what's in a block of cells, e.g. because something was drawn over them directly. They'll be
+ * drawn the next time they're set, or erased at the end of the next frame if they aren't. Until then
+ * they aren't dirty, so whatever was drawn over them stays.
+ * @param column The first column
+ * @param row The first row
+ * @param columns The number of columns
+ * @param rows The number of rows
+ */
+void Ohmbrewer::TextGrid::invalidate(int column, int row, int columns, int rows) {
+    int lastRow = (row + rows < ROWS) ? row + rows : ROWS;
+    int lastColumn = (column + columns < COLUMNS) ? column + columns : COLUMNS;
+
+    for (int r = (row > 0) ? row : 0; r < lastRow; r++) {
+        for (int c = (column > 0) ? column : 0; c < lastColumn; c++) {
+            // Printed or not, it has to be drawn again
+            _cells[r][c].flags = (_cells[r][c].flags & PRINTED) | UNKNOWN;
+        }
+    }
+}
+
+/**
+ * Ends the frame for a cell. A cell that wasn't set this frame goes blank.
+ * @param column The cell's column
+ * @param row The cell's row
+ * @returns Whether the cell went blank from something else, and so is dirty
+ */
+bool Ohmbrewer::TextGrid::release(int column, int row) {
+    Cell &cell = _cells[row][column];
+
+    if (cell.flags & PRINTED) {
+        cell.flags &= ~PRINTED;
+        return false;
+    }
+
+    if (isBlank(cell)) {
+        return false;
+    }
+
+    cell.glyph = ' ';
+    cell.flags = DIRTY;
+    cell.color = _background;
+    cell.bg = _background;
+    return true;
+}
+
+/**
+ * Finds the next run of dirty cells, reading left to right and then down
+ * @param row The row to start looking from. Set to the run's row.
+ * @param column Set to the run's first column
+ * @param count Set to the number of cells in the run
+ * @returns Whether there was a run. If not, every cell from row down is clean.
+ */
+bool Ohmbrewer::TextGrid::nextDirtyRun(int &row, int &column, int &count) const {
+    for (; row < ROWS; row++) {
+        for (column = 0; column < COLUMNS; column++) {
+            if (_cells[row][column].flags & DIRTY) {
+                count = 1;
+                while (column + count < COLUMNS && (_cells[row][column + count].flags & DIRTY)) {
+                    count++;
+                }
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @param column The cell's column
+ * @param row The cell's row
+ * @returns What's in the cell
+ */
+const Ohmbrewer::TextGrid::Cell& Ohmbrewer::TextGrid::getCell(int column, int row) const {
+    return _cells[row][column];
+}
+
+/**
+ * Marks a cell clean, once it's been drawn
+ * @param column The cell's column
+ * @param row The cell's row
+ */
+void Ohmbrewer::TextGrid::clean(int column, int row) {
+    _cells[row][column].flags &= ~DIRTY;
+}
+
+/**
+ * @param cell A cell
+ * @returns Whether it's blank: a space on the background color
+ */
+bool Ohmbrewer::TextGrid::isBlank(const Cell &cell) const {
+    return cell.glyph == ' ' && cell.bg == _background && !(cell.flags & UNKNOWN);
+}
@@ -0,0 +1,155 @@
+/**
+ * This library provides the TextGrid class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_TEXT_GRID_H
+#define OHMBREWER_TEXT_GRID_H
+
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * What's on the Screen's content area, as a grid of text cells, so a redraw only has to push the cells that
+     * actually changed.
+     *
+     * A cell is half of a size 2 glyph: 12 pixels wide and 8 high. That's the Screen's line pitch, since a margin
+     * line is 8 pixels, so any size 2 text printed from the left edge lands on a cell boundary. Each glyph covers
+     * the cell it's anchored in (its top half) and the one below (its bottom half).
+     *
+     * Each frame, the Screen sets the cells it prints to and then releases the rest - the cells that were printed
+     * last frame but not this one - blanking any that aren't blank already. Cells that changed either way are
+     * dirty until they've been drawn, a run at a time.
+     */
+    class TextGrid {
+
+        public:
+
+            /**
+             * A cell's contents
+             */
+            struct Cell {
+                uint8_t glyph;
+                uint8_t flags;
+                uint16_t color;
+                uint16_t bg;
+
+                /**
+                 * @returns Whether the cell holds the bottom half of its glyph
+                 */
+                bool isBottom() const { return (flags & BOTTOM) != 0; }
+            };
+
+            /**
+             * The grid's size. 20 columns fill the Screen's width; 28 rows reach from below the header to the
+             * buttons.
+             */
+            static const int COLUMNS = 20;
+            static const int ROWS = 28;
+
+            /**
+             * A cell's size, in pixels
+             */
+            static const int CELL_WIDTH = 12;
+            static const int CELL_HEIGHT = 8;
+
+            /**
+             * Constructor. Starts out blank.
+             * @param background The background color, which a blank cell is filled with
+             */
+            TextGrid(uint16_t background);
+
+            /**
+             * Destructor
+             */
+            virtual ~TextGrid();
+
+            /**
+             * Marks every cell blank, e.g. after the screen is cleared
+             */
+            void clear();
+
+            /**
+             * Puts half a glyph into a cell, and marks it as printed this frame
+             * @param column The cell's column
+             * @param row The cell's row
+             * @param glyph The character
+             * @param bottom Whether this is the glyph's bottom half, rather than its top
+             * @param color The glyph's color
+             * @param bg The background color behind it
+             * @returns Whether the cell changed, and so is dirty
+             */
+            bool set(int column, int row, uint8_t glyph, bool bottom, uint16_t color, uint16_t bg);
+
+            /**
+             * Forgets what's in a block of cells, e.g. because something was drawn over them directly. They'll be
+             * drawn the next time they're set, or erased at the end of the next frame if they aren't. Until then
+             * they aren't dirty, so whatever was drawn over them stays.
+             * @param column The first column
+             * @param row The first row
+             * @param columns The number of columns
+             * @param rows The number of rows
+             */
+            void invalidate(int column, int row, int columns, int rows);
+
+            /**
+             * Ends the frame for a cell. A cell that wasn't set this frame goes blank.
+             * @param column The cell's column
+             * @param row The cell's row
+             * @returns Whether the cell went blank from something else, and so is dirty
+             */
+            bool release(int column, int row);
+
+            /**
+             * Finds the next run of dirty cells, reading left to right and then down
+             * @param row The row to start looking from. Set to the run's row.
+             * @param column Set to the run's first column
+             * @param count Set to the number of cells in the run
+             * @returns Whether there was a run. If not, every cell from row down is clean.
+             */
+            bool nextDirtyRun(int &row, int &column, int &count) const;
+
+            /**
+             * @param column The cell's column
+             * @param row The cell's row
+             * @returns What's in the cell
+             */
+            const Cell& getCell(int column, int row) const;
+
+            /**
+             * Marks a cell clean, once it's been drawn
+             * @param column The cell's column
+             * @param row The cell's row
+             */
+            void clean(int column, int row);
+
+            /**
+             * Cell flags
+             */
+            static const uint8_t BOTTOM = 0x01;  // The cell holds the bottom half of its glyph
+            static const uint8_t PRINTED = 0x02; // The cell was set this frame
+            static const uint8_t UNKNOWN = 0x04; // Something else was drawn over the cell
+            static const uint8_t DIRTY = 0x08;   // The cell has changed since it was last drawn
+
+        protected:
+
+            /**
+             * The cells, a row at a time
+             */
+            Cell _cells[ROWS][COLUMNS];
+
+            /**
+             * The background color a blank cell is filled with
+             */
+            uint16_t _background;
+
+            /**
+             * @param cell A cell
+             * @returns Whether it's blank: a space on the background color
+             */
+            bool isBlank(const Cell &cell) const;
+    };
+};
+
+#endif
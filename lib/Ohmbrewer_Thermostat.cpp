@@ -2,6 +2,7 @@
 #include "Ohmbrewer_Screen.h"
 #include "Ohmbrewer_Publisher.h"
 #include "Ohmbrewer_Onewire.h"
+#include "Ohmbrewer_Sprout_Registry.h"
 
 
 /**
@@ -69,6 +70,10 @@ Ohmbrewer::Thermostat::Thermostat(const Ohmbrewer::Thermostat& clonee) : Ohmbrew
     _heatingElm = clonee.getElement();
     _tempSensor = clonee.getSensor();
     _targetTemp = clonee.getTargetTemp();
+    _phase = clonee.getPhase();
+    _targetReached = new EventGate(this, "target", EventGate::RISING);
+    initRelayWindow();
+    initPID();
 //    registerUpdateFunction();
 }
 
@@ -79,20 +84,52 @@ Ohmbrewer::Thermostat::~Thermostat() {
     delete _heatingElm;
     delete _tempSensor;
     delete _targetTemp;
-    delete _thermPID;
+    delete _targetReached;
+    delete _autotuner;
     //delete _timer;
 }
 
+/**
+ * Allocates from the pool of Thermostats rather than the heap (see getPool())
+ * @param size The size of the object
+ * @returns The memory for it
+ */
+void* Ohmbrewer::Thermostat::operator new(size_t size) {
+    return getPool()->allocate(size);
+}
+
+/**
+ * Gives the memory back to the pool of Thermostats
+ * @param ptr The memory
+ */
+void Ohmbrewer::Thermostat::operator delete(void* ptr) {
+    getPool()->release(ptr);
+}
+
+/**
+ * @returns The pool Thermostats are allocated from, sized for the most the Rhizome may have
+ *          (see SproutRegistry)
+ */
+Ohmbrewer::ObjectPool* Ohmbrewer::Thermostat::getPool() {
+    // Every Thermostat Sprout, plus each RIMS's tube
+    const int size = SproutRegistry::MAX_THERMOSTATS + SproutRegistry::MAX_RIMS;
+    static uint64_t storage[ObjectPool::words(sizeof(Thermostat), size)];
+    static ObjectPool pool = ObjectPool(storage, sizeof(Thermostat), size);
+    return &pool;
+}
+
 /**
  * logic for initializing equipment and PID in the constructors
  * @param thermPins list with formatting of: [ temp busPin ; onewire index ; heating controlPin ; heating powerPin ]
  * NOTE: if a Pin value is not enabled pass -1 as the value for that pin.
  */
 void Ohmbrewer::Thermostat::initThermostat(std::list<int>* thermPins){
+    _targetReached = new EventGate(this, "target", EventGate::RISING);
+    initRelayWindow();
 
     // Initialize equipment components
     int size = thermPins->size();
-    if (size == 4) {
+    if (size == 3 || size == 4) { // The heating element's power pin is optional
 
         thermPins->pop_front();//remove busPIN - unused for now.
         int index = thermPins->front();
@@ -101,9 +138,8 @@ void Ohmbrewer::Thermostat::initThermostat(std::list<int>* thermPins){
         _heatingElm = new HeatingElement(thermPins);
     } else {//not correct number on PINS
         // Publish error
-        Ohmbrewer::Publisher::publish_map_t pMap;
-        Ohmbrewer::Publisher pub(new String("error_log"), &pMap);
-        pMap[String("list_check_thermostat")] = String("improperly formed input - Thermostat(int id, int<list>)");
+        Ohmbrewer::Publisher pub("error_log", "list_check_thermostat",
+                                 "improperly formed input - Thermostat(int id, int<list>)");
         pub.publish();
 
         // Disable and GTFO
@@ -112,25 +148,70 @@ void Ohmbrewer::Thermostat::initThermostat(std::list<int>* thermPins){
     }
     _targetTemp = new Temperature();
 
-    // PID set up
-    _thermPID = new PID(&input, &output, &setPoint,
-                        cons.kP(), cons.kI(), cons.kD(),
-                        PID::DIRECT);
+    initPID();
+
+    //Timer timer(5000, doPID);
+    //_timer = &timer;
+
+}
+
+/**
+ * Starts tuning the PID gains by relay feedback (see Autotuner), around the current target temperature.
+ * The PID loop steps aside until tuning is over. If it succeeds, the GainSchedule's gains for any phase
+ * are replaced with the tuned ones and saved; either way, the outcome is published to the Thermostat's
+ * stream. Any tuning already under way starts over.
+ */
+void Ohmbrewer::Thermostat::startAutotune() {
+    delete _autotuner;
+    _autotuner = new Autotuner(getTargetTemp()->raw(), windowSize);
+    _pid.setAutomatic(false, getSensor()->getTemp()->raw());
+}
 
-    // Initialize the variables we're linked to
-    windowStartTime = millis();
-    setPoint = _targetTemp->c();
-    input = _tempSensor->getTemp()->c();
+/**
+ * Abandons tuning, if it's under way, and hands back to the PID loop. The gains are left as they were.
+ */
+void Ohmbrewer::Thermostat::stopAutotune() {
+    if (_autotuner != NULL) {
+        delete _autotuner;
+        _autotuner = NULL;
+        _pid.setAutomatic(true, getSensor()->getTemp()->raw());
+    }
+}
+
+/**
+ * @returns The tuning under way, or NULL if there isn't any
+ */
+Ohmbrewer::Autotuner* Ohmbrewer::Thermostat::getAutotuner() const {
+    return _autotuner;
+}
+
+/**
+ * Sets the PID loop's limits and starting gains, and starts it
+ */
+void Ohmbrewer::Thermostat::initPID() {
+    PIDController::Gains gains;
 
     // Tell the PID to range between 0 and the full window size
-    _thermPID->SetOutputLimits(0, windowSize);
+    _pid.setOutputLimits(0, windowSize);
 
-    // Turn the PID on
-    _thermPID->SetMode(PID::AUTOMATIC);
+    GainSchedule::getInstance()->lookup(_phase, getTargetTemp()->raw() - _tempSensor->getTemp()->raw(), gains);
+    _pid.setGains(gains);
 
-    //Timer timer(5000, doPID);
-    //_timer = &timer;
+    // Turn the PID on
+    _pid.setAutomatic(true, _tempSensor->getTemp()->raw());
+}
 
+/**
+ * Sets up the relay window timers and starts the first window
+ */
+void Ohmbrewer::Thermostat::initRelayWindow() {
+    _windowTimer.fn = [this]() {
+        TimerWheel::getInstance()->schedule(&_windowTimer, windowSize);
+        updateRelayWindow();
+    };
+    _pulseTimer.fn = [this]() { updateRelayWindow(); };
+
+    TimerWheel::getInstance()->schedule(&_windowTimer, windowSize);
 }
 
 /**
@@ -155,9 +236,9 @@ Ohmbrewer::Temperature* Ohmbrewer::Thermostat::getTargetTemp() const {
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::Thermostat::setTargetTemp(const double targetTemp) {
-    unsigned long start = millis();
+    unsigned long start = micros();
     _targetTemp->set(targetTemp);
-    return start - millis();
+    return micros() - start;
 }
 
 /**
@@ -182,48 +263,69 @@ Ohmbrewer::TemperatureSensor* Ohmbrewer::Thermostat::getSensor() const {
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::Thermostat::setSensor(Ohmbrewer::TemperatureSensor* sensor){
-    unsigned long start = millis();
+    unsigned long start = micros();
     _tempSensor = sensor;
-    return start - millis();
+    return micros() - start;
 }
 
 /**
  * Specifies the interface for arguments sent to this Thermostat's associated function.
- * Parses the supplied string into an array of strings for setting the Thermostat's values.
+ * Reads the arguments particular to a Thermostat, which follow the common ones.
  * Most likely will be called during update().
- * @param argsStr The arguments supplied as an update to the Rhizome.
- * @param result A map representing the key/value pairs for the update
+ * @param args The arguments supplied as an update to the Rhizome.
+ * @param result The arguments, parsed
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
  */
-void Ohmbrewer::Thermostat::parseArgs(const String &argsStr, Ohmbrewer::Equipment::args_map_t &result) {
-
-    if(argsStr.length() > 0) {
-        char* params = new char[argsStr.length() + 1];
-        strcpy(params, argsStr.c_str());
+int Ohmbrewer::Thermostat::parseArgs(CommandParser &args, ThermostatArgs &result) {
+    int errorCode = args.nextOptionalNumber(result.targetTemp, result.hasTargetTemp);
 
-        // Parse the parameters
-        String targetTemp  = String(strtok(params, ","));
-        String sensorState = String(strtok(NULL, ","));
-        String elmState    = String(strtok(NULL, ","));
+    if(errorCode == CommandParser::ParseError::NONE) {
+        errorCode = args.nextSwitch(result.sensorState);
+    }
+    if(errorCode == CommandParser::ParseError::NONE) {
+        errorCode = args.nextSwitch(result.elementState);
+    }
 
-        result[String("target_temp")] = targetTemp;
+    return errorCode;
+}
 
-        // Save them to the map
-        if(sensorState.length() > 0) {
-            result[String("sensor_state")] = sensorState;
-        }
-        if(sensorState.length() > 0) {
-            result[String("element_state")] = elmState;
-        }
+/**
+ * Applies the arguments particular to a Thermostat. Anything not given is left as it is.
+ * @param args The arguments, parsed
+ */
+void Ohmbrewer::Thermostat::applyArgs(const ThermostatArgs &args) {
+    if(args.hasTargetTemp) {
+        setTargetTemp(args.targetTemp);
+    }
 
-        // Serial.println("Got these additional Thermostat results: ");
-        // Serial.println(targetTemp);
-        // Serial.println(sensorState);
-        // Serial.println(elmState);
+    // The remaining settings are optional/convenience parameters
+    if(args.sensorState == CommandParser::SWITCH_ON) {
+        getSensor()->setState(true);
+    } else if(args.sensorState == CommandParser::SWITCH_OFF) {
+        getSensor()->setState(false);
+    }
 
-        // Clear out that dynamically allocated buffer
-        delete params;
+    if(args.elementState == CommandParser::SWITCH_ON) {
+        getElement()->setState(true);
+    } else if(args.elementState == CommandParser::SWITCH_OFF) {
+        getElement()->setState(false);
     }
+}
 
+/**
+ * @returns What the Thermostat is doing, as far as picking gains goes
+ */
+Ohmbrewer::GainSchedule::Phase Ohmbrewer::Thermostat::getPhase() const {
+    return _phase;
+}
+
+/**
+ * Tells the Thermostat what it's doing, so it can pick gains for it from the GainSchedule.
+ * It works out for itself when it's cooling.
+ * @param phase GainSchedule::RAMP while the target is moving, otherwise GainSchedule::HOLD
+ */
+void Ohmbrewer::Thermostat::setPhase(GainSchedule::Phase phase) {
+    _phase = phase;
 }
 
 /**
@@ -232,12 +334,12 @@ void Ohmbrewer::Thermostat::parseArgs(const String &argsStr, Ohmbrewer::Equipmen
  * @returns The time taken to run the method
  */
 const int Ohmbrewer::Thermostat::setState(const bool state) {
-    unsigned long start = millis();
+    unsigned long start = micros();
     _state = state;
 //    getElement()->setState(state);
 //    getSensor()->setState(state);
 
-    return start - millis();
+    return micros() - start;
 }
 
 /**
@@ -295,7 +397,7 @@ int Ohmbrewer::Thermostat::doWork() {
 
 /**
  * Controls all the inner workings of the PID functionality
- * Should be called by _timer
+ * Refreshes the sensor, then runs computePID() and updateRelayWindow() back to back.
  *
  * Controls the heating element Relays manually, overriding the standard relay
  * functionality
@@ -308,28 +410,35 @@ int Ohmbrewer::Thermostat::doWork() {
  * window being "Relay Off Time"
  *
  * PID Adaptive Tuning
- * You can change the tuning parameters.  this can be
- * helpful if we want the controller to be agressive at some
- * times, and conservative at others.
+ * The tuning parameters come from the GainSchedule, by how far the temperature is from the target
+ * and what the Thermostat is doing, so the controller is aggressive when far off and conservative
+ * when close.
  *
  */
 void Ohmbrewer::Thermostat::doPID(){
     getSensor()->work();
+    computePID();
+    updateRelayWindow();
+}
 
-    setPoint = getTargetTemp()->c();        //targetTemp
-    input = getSensor()->getTemp()->c();//currentTemp
-    double gap = abs(setPoint-input);   //distance away from target temp
-    //SET TUNING PARAMETERS
-    if (gap<10) {  //we're close to targetTemp, use conservative tuning parameters
-        _thermPID->SetTunings(cons.kP(), cons.kI(), cons.kD());
-    }else {//we're far from targetTemp, use aggressive tuning parameters
-        _thermPID->SetTunings(agg.kP(), agg.kI(), agg.kD());
+/**
+ * Runs the PID computation against the latest sensor reading and decides whether the heating element should be on.
+ * Cheap enough to call every loop; the PID itself only recomputes once its sample time has passed.
+ */
+void Ohmbrewer::Thermostat::computePID(){
+    int32_t target = getTargetTemp()->raw();
+    int32_t current = getSensor()->getTemp()->raw();
+    if (_autotuner != NULL) {
+        computeAutotune(current);
+        return;
     }
+    int32_t gap = abs(target - current);    //distance away from target temp
+    //SET TUNING PARAMETERS - from the schedule, by the gap and what we're doing
+    PIDController::Gains gains;
+    GainSchedule::getInstance()->lookup((target < current) ? GainSchedule::COOL : _phase, gap, gains);
+    _pid.setGains(gains);
     //COMPUTATIONS
-    _thermPID->Compute();
-    if (millis() - windowStartTime>windowSize) { //time to shift the Relay Window
-        windowStartTime += windowSize;
-    }
+    _pid.compute(current, target);
     //TURN ON
     if (getState() && gap!=0) {//if we want to turn on the element (thermostat is ON)
         //TURN ON state and powerPin
@@ -339,31 +448,99 @@ void Ohmbrewer::Thermostat::doPID(){
                 digitalWrite(getElement()->getPowerPin(), HIGH); //turn it on (only once each time you switch state)
             }
         }
-        //RELAY MODULATION
-        if (output < millis() - windowStartTime) {
-            digitalWrite(getElement()->getControlPin(), HIGH);
-        } else {
-            digitalWrite(getElement()->getControlPin(), LOW);
-        }
     }
     //TURN OFF
-    if (gap == 0 || getTargetTemp()->c() <= getSensor()->getTemp()->c() ) {//once reached target temp
+    if (gap == 0 || target <= current) {//once reached target temp
         getElement()->setState(false); //turn off element
         getElement()->work();
 //        if (getElement()->getPowerPin() != -1) { // if powerPin enabled
 //            digitalWrite(getElement()->getPowerPin(), LOW); //turn it off too TODO check this
 //        }
 
-        // Notify Ohmbrewer that the target temperature has been reached.
-        Publisher pub = Publisher(new String(getStream()),
-                                  String("msg"),
-                                  String("Target Temperature Reached."));
-        pub.add(String("last_read_time"),
-                String(getSensor()->getLastReadTime()));
-        pub.add(String("temperature"),
-                String(getSensor()->getTemp()->c()));
+    }
+
+    // Notify Ohmbrewer when the target temperature is reached - once, rather than on every pass spent there.
+    if (_targetReached->update(current, target, TARGET_REACHED_HYSTERESIS)) {
+        char stream[Publisher::MAX_STREAM_LENGTH + 1];
+        getStream(stream, sizeof(stream));
+        Publisher pub = Publisher(stream, "msg", "Target Temperature Reached.");
+        pub.add("last_read_time", (long)getSensor()->getLastReadTime());
+        pub.add("temperature", getSensor()->getTemp()->c());
+        pub.publish();
+    }
+}
+
+/**
+ * Moves tuning along in place of the PID loop: drives the element from the Autotuner's relay, and
+ * finishes up once it's done. Called by computePID() while tuning.
+ * @param current The current raw temperature
+ */
+void Ohmbrewer::Thermostat::computeAutotune(int32_t current) {
+    // The relay decides, not the target - the element stays enabled even above it
+    _autotuner->update(current);
+    _pid.setOutput(_autotuner->getOutput());
+    if (getState() && !(getElement()->getState())) {
+        getElement()->setState(true);
+        if (getElement()->getPowerPin() != -1) {
+            digitalWrite(getElement()->getPowerPin(), HIGH);
+        }
+    }
+
+    if (!_autotuner->isFinished()) {
+        return;
+    }
+
+    char stream[Publisher::MAX_STREAM_LENGTH + 1];
+    PIDProfile conservative;
+    PIDProfile aggressive;
+    getStream(stream, sizeof(stream));
+
+    if (_autotuner->getProfiles(conservative, aggressive) &&
+        GainSchedule::getInstance()->setDefaultGains(conservative, aggressive)) {
+        GainSchedule::getInstance()->save();
+
+        Publisher pub = Publisher(stream, "msg", "Autotune finished.");
+        pub.add("ku", _autotuner->getUltimateGain(), 1);
+        pub.add("tu", _autotuner->getUltimatePeriod(), 1);
+        pub.add("cons_kp", conservative.kP(), 2);
+        pub.add("cons_ki", conservative.kI(), 4);
+        pub.add("agg_kp", aggressive.kP(), 2);
+        pub.add("agg_ki", aggressive.kI(), 4);
+        pub.publish();
+    } else {
+        Publisher pub = Publisher(stream, "msg", "Autotune failed.");
+        pub.add("reason", _autotuner->getState() == Autotuner::DONE ? "gains rejected"
+                                                                     : Autotuner::failureName(_autotuner->getFailure()));
+        pub.add("cycles", (long)_autotuner->getCycles());
         pub.publish();
     }
+
+    // Hand back to the PID loop. It starts from the relay being off.
+    stopAutotune();
+}
+
+/**
+ * Time proportions the heating element's control pin according to the last PID output: the element is
+ * on for the first "output" milliseconds of each window. Called at the start of each window, when the
+ * element's time is up, and after each computePID(), with the timers doing the switching in between.
+ */
+void Ohmbrewer::Thermostat::updateRelayWindow(){
+    TimerWheel* wheel = TimerWheel::getInstance();
+
+    //RELAY MODULATION - the element is on for the first "output" milliseconds of each window
+    if (getState() && getElement()->getState()) {
+        // How far into the window we are, going by when the next one starts. A window that's due is starting.
+        unsigned long elapsed = (windowSize - wheel->remaining(&_windowTimer)) % windowSize;
+        unsigned long onTime = (unsigned long)_pid.getOutput();
+
+        if (onTime > elapsed) {
+            digitalWrite(getElement()->getControlPin(), HIGH);
+            wheel->schedule(&_pulseTimer, onTime - elapsed);
+        } else {
+            digitalWrite(getElement()->getControlPin(), LOW);
+            wheel->cancel(&_pulseTimer);
+        }
+    }
 }
 
 /**
@@ -409,10 +586,10 @@ unsigned long Ohmbrewer::Thermostat::displayThermTemp(Ohmbrewer::Screen *screen)
     // If current == target, we'll default to yellow, 'cause we're golden...
     uint16_t color = screen->YELLOW;
 
-    if(getSensor()->getTemp()->c() > getTargetTemp()->c()) {
+    if(getSensor()->getTemp()->raw() > getTargetTemp()->raw()) {
         // above target temp
         color = screen->RED;
-    } else if(getSensor()->getTemp()->c() < getTargetTemp()->c()) {
+    } else if(getSensor()->getTemp()->raw() < getTargetTemp()->raw()) {
         // below target temp
         color = screen->CYAN;
     }
@@ -440,7 +617,6 @@ unsigned long Ohmbrewer::Thermostat::displayThermTemp(Ohmbrewer::Screen *screen)
  */
 int Ohmbrewer::Thermostat::displayRelay(Ohmbrewer::Screen *screen) {
     unsigned long start = micros();
-    char relay_id[2];
     screen->setTextColor(screen->WHITE, screen->DEFAULT_BG_COLOR);
 
     // Print a fancy identifier
@@ -466,53 +642,29 @@ int Ohmbrewer::Thermostat::displayRelay(Ohmbrewer::Screen *screen) {
 /**
  * Publishes updates to Ohmbrewer, etc.
  * This function is called by update().
- * @param args The argument string passed into the Particle Cloud
- * @param argsMap A map representing the key/value pairs for the update
- * @returns The time taken to run the method
+ * @param args The rest of the arguments passed into the Particle Cloud
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
  */
-int Ohmbrewer::Thermostat::doUpdate(String &args, Ohmbrewer::Equipment::args_map_t &argsMap) {
-    unsigned long start = millis();
-
-    // If there are any remaining parameters
-    if(args.length() > 0) {
-        String targetKey = String("target_temp");
-        String sensorKey = String("sensor_state");
-        String elmKey = String("element_state");
-
-        parseArgs(args, argsMap);
-
-        // If there are any arguments, the will be a new Target Temperature value
-        setTargetTemp(argsMap[targetKey].toFloat());
-
-        // The remaining settings are optional/convenience parameters
-        if(argsMap.count(sensorKey) != 0) {
-            if(argsMap[sensorKey].equalsIgnoreCase("ON")) {
-                getSensor()->setState(true);
-            } else if(argsMap[sensorKey].equalsIgnoreCase("OFF")) {
-                getSensor()->setState(false);
-            } else if(argsMap[sensorKey].equalsIgnoreCase("--")) {
-                // Do nothing. Intentional.
-            } else {
-                // Do nothing. TODO: Should probably raise an error code...
-            }
-        }
-
-        if(argsMap.count(elmKey) != 0) {
-            if(argsMap[elmKey].equalsIgnoreCase("ON")) {
-                getElement()->setState(true);
-            } else if(argsMap[elmKey].equalsIgnoreCase("OFF")) {
-                getElement()->setState(false);
-            } else if(argsMap[elmKey].equalsIgnoreCase("--")) {
-                // Do nothing. Intentional.
-            } else {
-                // Do nothing. TODO: Should probably raise an error code...
-            }
-        }
+int Ohmbrewer::Thermostat::doUpdate(CommandParser &args) {
+    ThermostatArgs thermArgs;
+    int errorCode = parseArgs(args, thermArgs);
 
+    if(errorCode == CommandParser::ParseError::NONE) {
+        applyArgs(thermArgs);
     }
 
+    return errorCode;
+}
 
-    return millis() - start;
+/**
+ * Checks the arguments particular to a Thermostat, without applying them.
+ * This function is called by checkUpdate().
+ * @param args The rest of the arguments passed into the Particle Cloud
+ * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+ */
+int Ohmbrewer::Thermostat::doCheckUpdate(CommandParser &args) {
+    ThermostatArgs thermArgs;
+    return parseArgs(args, thermArgs);
 }
 
 /**
@@ -16,8 +16,11 @@
 #include "Ohmbrewer_Temperature_Sensor.h"
 #include "Ohmbrewer_Temperature.h"
 #include "application.h"
-#include "pid.h"
-#include "Ohmbrewer_PID_Profile.h"
+#include "Ohmbrewer_Object_Pool.h"
+#include "Ohmbrewer_PID_Controller.h"
+#include "Ohmbrewer_Gain_Schedule.h"
+#include "Ohmbrewer_Autotuner.h"
+#include "Ohmbrewer_Event_Gate.h"
 
 namespace Ohmbrewer {
 
@@ -30,12 +33,35 @@ namespace Ohmbrewer {
              */
             const static constexpr char* TYPE_NAME = "therm";
 
+            /**
+             * How far below the target the temperature has to fall (raw, 0.5 C) before reaching the target again
+             * is worth another "Target Temperature Reached." message
+             */
+            const static int32_t TARGET_REACHED_HYSTERESIS = Temperature::ONE_DEGREE / 2;
+
+            /**
+             * The arguments particular to a Thermostat's update, in order:
+             * TARGET_TEMP,SENSOR_STATE,ELEMENT_STATE
+             */
+            struct ThermostatArgs {
+                bool hasTargetTemp;
+                double targetTemp;
+                CommandParser::Switch sensorState;
+                CommandParser::Switch elementState;
+            };
+
             /**
              * The Equipment Type
              * @returns The Equipment type name
              */
             virtual const char* getType() const { return Thermostat::TYPE_NAME; };
 
+            /**
+             * The Equipment Type
+             * @returns The Equipment type code
+             */
+            virtual TypeCode getTypeCode() const { return TYPE_THERMOSTAT; };
+
             /**
              * Constructor
              * @param thermPins list with formatting of: [ temp busPin ; onewire index ; heating controlPin ; heating powerPin ]
@@ -83,6 +109,25 @@ namespace Ohmbrewer {
              */
             virtual ~Thermostat();
 
+            /**
+             * Allocates from the pool of Thermostats rather than the heap (see getPool())
+             * @param size The size of the object
+             * @returns The memory for it
+             */
+            static void* operator new(size_t size);
+
+            /**
+             * Gives the memory back to the pool of Thermostats
+             * @param ptr The memory
+             */
+            static void operator delete(void* ptr);
+
+            /**
+             * @returns The pool Thermostats are allocated from, sized for the most the Rhizome may have
+             *          (see SproutRegistry)
+             */
+            static ObjectPool* getPool();
+
             /**
              * logic for initializing the constructors
              * @param thermPins list with formatting of: [ temp busPin ; onewire index ; heating controlPin ; heating powerPin ]
@@ -130,12 +175,49 @@ namespace Ohmbrewer {
 
             /**
              * Specifies the interface for arguments sent to this Thermostat's associated function.
-             * Parses the supplied string into an array of strings for setting the Thermostat's values.
+             * Reads the arguments particular to a Thermostat, which follow the common ones.
              * Most likely will be called during update().
-             * @param argsStr The arguments supplied as an update to the Rhizome.
-             * @param result A map representing the key/value pairs for the update
+             * @param args The arguments supplied as an update to the Rhizome.
+             * @param result The arguments, parsed
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+             */
+            static int parseArgs(CommandParser &args, ThermostatArgs &result);
+
+            /**
+             * Applies the arguments particular to a Thermostat. Anything not given is left as it is.
+             * @param args The arguments, parsed
+             */
+            void applyArgs(const ThermostatArgs &args);
+
+            /**
+             * @returns What the Thermostat is doing, as far as picking gains goes
              */
-            static void parseArgs(const String &argsStr, args_map_t &result);
+            GainSchedule::Phase getPhase() const;
+
+            /**
+             * Tells the Thermostat what it's doing, so it can pick gains for it from the GainSchedule.
+             * It works out for itself when it's cooling.
+             * @param phase GainSchedule::RAMP while the target is moving, otherwise GainSchedule::HOLD
+             */
+            void setPhase(GainSchedule::Phase phase);
+
+            /**
+             * Starts tuning the PID gains by relay feedback (see Autotuner), around the current target temperature.
+             * The PID loop steps aside until tuning is over. If it succeeds, the GainSchedule's gains for any phase
+             * are replaced with the tuned ones and saved; either way, the outcome is published to the Thermostat's
+             * stream. Any tuning already under way starts over.
+             */
+            void startAutotune();
+
+            /**
+             * Abandons tuning, if it's under way, and hands back to the PID loop. The gains are left as they were.
+             */
+            void stopAutotune();
+
+            /**
+             * @returns The tuning under way, or NULL if there isn't any
+             */
+            Autotuner* getAutotuner() const;
 
             /**
              * Sets the Thermostat state. True => On, False => Off
@@ -171,7 +253,7 @@ namespace Ohmbrewer {
 
             /**
             * Controls all the inner workings of the PID functionality
-            * Should be called by _timer
+            * Refreshes the sensor, then runs computePID() and updateRelayWindow() back to back.
             *
             * Controls the heating element Relays manually, overriding the standard relay
             * functionality
@@ -184,13 +266,34 @@ namespace Ohmbrewer {
             * window being "Relay Off Time"
             *
             * PID Adaptive Tuning
-            * You can change the tuning parameters.  this can be
-            * helpful if we want the controller to be agressive at some
-            * times, and conservative at others.
+            * The tuning parameters come from the GainSchedule, by how far the temperature is from the target
+            * and what the Thermostat is doing, so the controller is aggressive when far off and conservative
+            * when close.
             *
             */
             void doPID();
 
+            /**
+             * Runs the PID computation against the latest sensor reading and decides whether the heating element
+             * should be on. Cheap enough to call every loop; the PID itself only recomputes once its sample time
+             * has passed.
+             */
+            void computePID();
+
+            /**
+             * Moves tuning along in place of the PID loop: drives the element from the Autotuner's relay, and
+             * finishes up once it's done. Called by computePID() while tuning.
+             * @param current The current raw temperature
+             */
+            void computeAutotune(int32_t current);
+
+            /**
+             * Time proportions the heating element's control pin according to the last PID output: the element is
+             * on for the first "output" milliseconds of each window. Called at the start of each window, when the
+             * element's time is up, and after each computePID(), with the timers doing the switching in between.
+             */
+            void updateRelayWindow();
+
             /**
              * Draws information to the Rhizome's display.
              * This function is called by display().
@@ -216,11 +319,18 @@ namespace Ohmbrewer {
             /**
              * Publishes updates to Ohmbrewer, etc.
              * This function is called by update().
-             * @param args The argument string passed into the Particle Cloud
-             * @param argsMap A map representing the key/value pairs for the update
-             * @returns The time taken to run the method
+             * @param args The rest of the arguments passed into the Particle Cloud
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
+             */
+            int doUpdate(CommandParser &args);
+
+            /**
+             * Checks the arguments particular to a Thermostat, without applying them.
+             * This function is called by checkUpdate().
+             * @param args The rest of the arguments passed into the Particle Cloud
+             * @returns CommandParser::ParseError::NONE, or the (negative) error in the arguments
              */
-            int doUpdate(String &args, args_map_t &argsMap);
+            int doCheckUpdate(CommandParser &args);
 
             /**
              * Reports which of the Rhizome's pins are occupied by the
@@ -246,14 +356,14 @@ namespace Ohmbrewer {
             Temperature* _targetTemp;
 
             /**
-             * PID instance for the thermostat
+             * PID loop for the thermostat. Its output is the element's on-time in each window, in milliseconds.
              */
-            PID* _thermPID;
+            PIDController _pid = PIDController(0, 1, Temperature::ONE_DEGREE);
 
             /**
-             * Aggressive Tuning Parameters profile for the PID
+             * Decides when reaching the target temperature is worth telling Ohmbrewer about
              */
-            PIDProfile agg  = PIDProfile(4, 0.2, 1);
+            EventGate* _targetReached;
 
             /**
              * Timer to control PID functionality
@@ -261,19 +371,37 @@ namespace Ohmbrewer {
             //Timer* _timer;
 
             /**
-             * Conservative Tuning Parameters profile for the PID
+             * What the thermostat is doing, for picking gains from the GainSchedule. Cooling is worked out as it goes.
              */
-            PIDProfile cons = PIDProfile(1, 0.05, 0.25);
-
+            GainSchedule::Phase _phase = GainSchedule::HOLD;
 
-            // Define Variables we'll be connecting to with PID
-            double setPoint;
-            double input;
-            double output;
+            /**
+             * The tuning under way, or NULL if the PID loop is in charge
+             */
+            Autotuner* _autotuner = NULL;
 
             // PID windowing variables
             int windowSize = 5000;
-            unsigned long windowStartTime;
+
+            /**
+             * Fires at the start of each relay window
+             */
+            TimerWheel::Timer _windowTimer;
+
+            /**
+             * Fires when the heating element's time in the current window is up
+             */
+            TimerWheel::Timer _pulseTimer;
+
+            /**
+             * Sets up the relay window timers and starts the first window
+             */
+            void initRelayWindow();
+
+            /**
+             * Sets the PID loop's limits and starting gains, and starts it
+             */
+            void initPID();
 
     };
 };
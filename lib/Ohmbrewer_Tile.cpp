@@ -0,0 +1,107 @@
+#include "Ohmbrewer_Tile.h"
+
+/**
+ * Constructor
+ */
+Ohmbrewer::Tile::Tile() : Adafruit_GFX(WIDTH, HEIGHT) {
+    _x = 0;
+    _y = 0;
+    _w = WIDTH;
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::Tile::~Tile() {
+    // Nothing to do here...
+}
+
+/**
+ * Places the tile on the screen, ready to render into
+ * @param x The tile's left edge on the screen
+ * @param y The tile's top edge on the screen
+ * @param w The tile's width, at most WIDTH
+ */
+void Ohmbrewer::Tile::place(int16_t x, int16_t y, int16_t w) {
+    _x = x;
+    _y = y;
+    _w = (w < WIDTH) ? w : WIDTH;
+}
+
+/**
+ * Renders half of a size 2 glyph into a cell of the tile
+ * @param x The cell's left edge, relative to the tile
+ * @param glyph The character
+ * @param bottom Whether this is the glyph's bottom half, rather than its top
+ * @param color The glyph's color
+ * @param bg The background color behind it
+ */
+void Ohmbrewer::Tile::drawCell(int16_t x, uint8_t glyph, bool bottom, uint16_t color, uint16_t bg) {
+    // drawChar() takes a glyph the same color as its background to be transparent, which isn't what a blank means
+    if (color == bg) {
+        fillRect(x, 0, TextGrid::CELL_WIDTH, HEIGHT, bg);
+        return;
+    }
+
+    // The tile's one cell high, so the other half of the glyph falls outside it
+    drawChar(x, bottom ? -TextGrid::CELL_HEIGHT : 0, glyph, color, bg, 2);
+}
+
+/**
+ * Sets a pixel, relative to the tile
+ */
+void Ohmbrewer::Tile::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x >= 0 && y >= 0 && x < _w && y < HEIGHT) {
+        _pixels[(y * _w) + x] = (uint16_t)((color >> 8) | (color << 8));
+    }
+}
+
+/**
+ * Fills a rectangle, relative to the tile
+ */
+void Ohmbrewer::Tile::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    uint16_t swapped = (uint16_t)((color >> 8) | (color << 8));
+    int16_t right = (x + w < _w) ? x + w : _w;
+    int16_t bottom = (y + h < HEIGHT) ? y + h : HEIGHT;
+
+    for (int16_t row = (y > 0) ? y : 0; row < bottom; row++) {
+        for (int16_t col = (x > 0) ? x : 0; col < right; col++) {
+            _pixels[(row * _w) + col] = swapped;
+        }
+    }
+}
+
+/**
+ * @returns The tile's left edge on the screen
+ */
+int16_t Ohmbrewer::Tile::getX() const {
+    return _x;
+}
+
+/**
+ * @returns The tile's top edge on the screen
+ */
+int16_t Ohmbrewer::Tile::getY() const {
+    return _y;
+}
+
+/**
+ * @returns The tile's width
+ */
+int16_t Ohmbrewer::Tile::getWidth() const {
+    return _w;
+}
+
+/**
+ * @returns The tile's pixels, row by row, as the ILI9341 takes them
+ */
+uint8_t* Ohmbrewer::Tile::getData() {
+    return (uint8_t*)_pixels;
+}
+
+/**
+ * @returns The number of bytes in getData()
+ */
+size_t Ohmbrewer::Tile::getLength() const {
+    return (size_t)_w * HEIGHT * sizeof(uint16_t);
+}
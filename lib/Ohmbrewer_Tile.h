@@ -0,0 +1,119 @@
+/**
+ * This library provides the Tile class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_TILE_H
+#define OHMBREWER_TILE_H
+
+#undef min
+#undef max
+#undef swap
+
+#include "Adafruit_ILI9341.h"
+#include "application.h"
+#include "Ohmbrewer_Text_Grid.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * An offscreen strip of the Screen, one text cell high and up to the full width, that text cells are rendered
+     * into so they can be sent to the display in a single DMA transfer rather than a transaction per pixel block.
+     *
+     * It's an Adafruit_GFX like the display itself, so glyphs are rendered with the same font and drawChar() as
+     * drawing them directly would. Pixels are held in the order and byte order the ILI9341 takes them.
+     */
+    class Tile : public Adafruit_GFX {
+
+        public:
+
+            /**
+             * The largest tile, in pixels: a full row of cells
+             */
+            static const int WIDTH = TextGrid::COLUMNS * TextGrid::CELL_WIDTH;
+            static const int HEIGHT = TextGrid::CELL_HEIGHT;
+
+            /**
+             * Constructor
+             */
+            Tile();
+
+            /**
+             * Destructor
+             */
+            virtual ~Tile();
+
+            /**
+             * Places the tile on the screen, ready to render into
+             * @param x The tile's left edge on the screen
+             * @param y The tile's top edge on the screen
+             * @param w The tile's width, at most WIDTH
+             */
+            void place(int16_t x, int16_t y, int16_t w);
+
+            /**
+             * Renders half of a size 2 glyph into a cell of the tile
+             * @param x The cell's left edge, relative to the tile
+             * @param glyph The character
+             * @param bottom Whether this is the glyph's bottom half, rather than its top
+             * @param color The glyph's color
+             * @param bg The background color behind it
+             */
+            void drawCell(int16_t x, uint8_t glyph, bool bottom, uint16_t color, uint16_t bg);
+
+            /**
+             * Sets a pixel, relative to the tile
+             */
+            virtual void drawPixel(int16_t x, int16_t y, uint16_t color);
+
+            /**
+             * Fills a rectangle, relative to the tile
+             */
+            virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+            /**
+             * @returns The tile's left edge on the screen
+             */
+            int16_t getX() const;
+
+            /**
+             * @returns The tile's top edge on the screen
+             */
+            int16_t getY() const;
+
+            /**
+             * @returns The tile's width
+             */
+            int16_t getWidth() const;
+
+            /**
+             * @returns The tile's pixels, row by row, as the ILI9341 takes them
+             */
+            uint8_t* getData();
+
+            /**
+             * @returns The number of bytes in getData()
+             */
+            size_t getLength() const;
+
+        protected:
+
+            /**
+             * The pixels, big-endian RGB565. Only the first _w * HEIGHT are used.
+             */
+            uint16_t _pixels[WIDTH * HEIGHT];
+
+            /**
+             * Where the tile is on the screen
+             */
+            int16_t _x;
+            int16_t _y;
+
+            /**
+             * The tile's width
+             */
+            int16_t _w;
+    };
+};
+
+#endif
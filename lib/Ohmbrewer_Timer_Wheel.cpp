@@ -0,0 +1,225 @@
+#include "Ohmbrewer_Timer_Wheel.h"
+
+/**
+ * Constructor
+ */
+Ohmbrewer::TimerWheel::Timer::Timer() {
+    _expires = 0;
+    _next = NULL;
+    _pprev = NULL;
+}
+
+/**
+ * Constructor
+ * @param fn The work to do when the timer fires
+ */
+Ohmbrewer::TimerWheel::Timer::Timer(timer_fn_t fn) {
+    this->fn = fn;
+    _expires = 0;
+    _next = NULL;
+    _pprev = NULL;
+}
+
+/**
+ * Destructor. Cancels the timer.
+ */
+Ohmbrewer::TimerWheel::Timer::~Timer() {
+    TimerWheel::unlink(this);
+}
+
+/**
+ * @returns Whether the timer is scheduled and hasn't fired yet
+ */
+bool Ohmbrewer::TimerWheel::Timer::isPending() const {
+    return _pprev != NULL;
+}
+
+/**
+ * The Rhizome's timer wheel.
+ * @returns The shared wheel
+ */
+Ohmbrewer::TimerWheel* Ohmbrewer::TimerWheel::getInstance() {
+    static TimerWheel wheel = TimerWheel();
+    return &wheel;
+}
+
+/**
+ * Constructor
+ */
+Ohmbrewer::TimerWheel::TimerWheel() {
+    _now = 0;
+    _lastTick = millis();
+
+    for (int level = 0; level < LEVELS; level++) {
+        for (int slot = 0; slot < SLOTS; slot++) {
+            _slots[level][slot] = NULL;
+        }
+    }
+}
+
+/**
+ * Schedules a timer, replacing any time it was already scheduled for
+ * @param timer The timer
+ * @param delay How long from now the timer should fire, in milliseconds
+ */
+void Ohmbrewer::TimerWheel::schedule(Timer* timer, unsigned long delay) {
+    // Round up, and always wait for at least the next tick - this tick's timers may already have fired
+    unsigned long ticks = (delay / TICK_MS) + ((delay % TICK_MS) != 0 ? 1 : 0);
+    if (ticks == 0) {
+        ticks = 1;
+    } else if (ticks > MAX_TICKS) {
+        ticks = MAX_TICKS;
+    }
+
+    unlink(timer);
+    timer->_expires = _now + ticks;
+    insert(timer);
+}
+
+/**
+ * Cancels a timer. Cancelling a timer that isn't pending does nothing.
+ * @param timer The timer
+ */
+void Ohmbrewer::TimerWheel::cancel(Timer* timer) {
+    unlink(timer);
+}
+
+/**
+ * @param timer The timer
+ * @returns How long until the timer fires, in milliseconds, or 0 if it isn't pending
+ */
+unsigned long Ohmbrewer::TimerWheel::remaining(const Timer* timer) const {
+    if (!timer->isPending()) {
+        return 0;
+    }
+    return (timer->_expires - _now) * TICK_MS;
+}
+
+/**
+ * Runs every tick that has passed since the last call, firing the timers that have come due.
+ * Expect to call this once per loop().
+ * @returns The time taken to run the method, in microseconds
+ */
+unsigned long Ohmbrewer::TimerWheel::advance() {
+    unsigned long start = micros();
+
+    // Signed difference, so this keeps working when millis() rolls over
+    while ((long)(millis() - _lastTick) >= (long)TICK_MS) {
+        _lastTick += TICK_MS;
+        tick();
+    }
+
+    return micros() - start;
+}
+
+/**
+ * @returns The number of ticks the wheel has run
+ */
+uint32_t Ohmbrewer::TimerWheel::getTicks() const {
+    return _now;
+}
+
+/**
+ * Runs a single tick
+ */
+void Ohmbrewer::TimerWheel::tick() {
+    Timer* due;
+
+    _now++;
+
+    // Each time a level comes round to its first slot, the level above has moved on a slot, so bring that slot down
+    int slot = _now & (SLOTS - 1);
+    if (slot == 0) {
+        for (int level = 1; level < LEVELS; level++) {
+            int upper = (_now >> (level * SLOT_BITS)) & (SLOTS - 1);
+            cascade(level, upper);
+            if (upper != 0) {
+                break;
+            }
+        }
+    }
+
+    // Fire off everything in the bottom level's slot. The list is ours now, so timers can freely reschedule.
+    detach(&_slots[0][slot], due);
+    while (due != NULL) {
+        Timer* timer = due;
+        unlink(timer);
+        timer->fn();
+    }
+}
+
+/**
+ * Files a timer in the slot its expiry falls in
+ * @param timer The timer
+ */
+void Ohmbrewer::TimerWheel::insert(Timer* timer) {
+    uint32_t delta = timer->_expires - _now;
+
+    for (int level = 0; level < LEVELS; level++) {
+        if (level == LEVELS - 1 || delta < (1UL << ((level + 1) * SLOT_BITS))) {
+            int slot = (timer->_expires >> (level * SLOT_BITS)) & (SLOTS - 1);
+            link(timer, &_slots[level][slot]);
+            return;
+        }
+    }
+}
+
+/**
+ * Empties a slot of a level above the bottom one, filing its timers again a level or more down
+ * @param level The level
+ * @param slot The slot
+ */
+void Ohmbrewer::TimerWheel::cascade(int level, int slot) {
+    Timer* list;
+
+    detach(&_slots[level][slot], list);
+    while (list != NULL) {
+        Timer* timer = list;
+        unlink(timer);
+        insert(timer);
+    }
+}
+
+/**
+ * Takes every timer out of a slot, leaving them linked to a list of their own
+ * @param slot The slot
+ * @param list Set to the head of the list
+ */
+void Ohmbrewer::TimerWheel::detach(Timer** slot, Timer* &list) {
+    list = *slot;
+    *slot = NULL;
+    if (list != NULL) {
+        list->_pprev = &list;
+    }
+}
+
+/**
+ * Adds a timer to the front of a list
+ * @param timer The timer
+ * @param head The head of the list
+ */
+void Ohmbrewer::TimerWheel::link(Timer* timer, Timer** head) {
+    timer->_next = *head;
+    if (timer->_next != NULL) {
+        timer->_next->_pprev = &timer->_next;
+    }
+    *head = timer;
+    timer->_pprev = head;
+}
+
+/**
+ * Takes a timer out of whichever list it's in
+ * @param timer The timer
+ */
+void Ohmbrewer::TimerWheel::unlink(Timer* timer) {
+    if (timer->_pprev == NULL) {
+        return;
+    }
+
+    *timer->_pprev = timer->_next;
+    if (timer->_next != NULL) {
+        timer->_next->_pprev = timer->_pprev;
+    }
+    timer->_next = NULL;
+    timer->_pprev = NULL;
+}
@@ -0,0 +1,217 @@
+/**
+ * This library provides the TimerWheel class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_TIMER_WHEEL_H
+#define OHMBREWER_TIMER_WHEEL_H
+
+#include <functional>
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * One-shot timers for the Rhizome's deadlines - stop times, relay windows and the like.
+     *
+     * The wheel is hierarchical: LEVELS rings of SLOTS slots each, every level's slot covering SLOTS times as many
+     * ticks as the level below. A timer is filed in the slot its expiry falls in at the lowest level that reaches it.
+     * Each tick fires only the timers in one slot of the bottom level, and every SLOTS ticks the next slot up is
+     * emptied down a level, so both scheduling and firing are O(1) per timer however many timers are pending.
+     *
+     * Timers are intrusive - each lives in the object it belongs to - so nothing is allocated. A timer's function
+     * may reschedule the timer, or schedule and cancel others.
+     */
+    class TimerWheel {
+
+        public:
+
+            /**
+             * The work a timer does when it fires
+             */
+            typedef std::function<void()> timer_fn_t;
+
+            /**
+             * The length of a tick, in milliseconds. Timers fire on the first tick at or after they're due.
+             */
+            static const unsigned long TICK_MS = 10;
+
+            /**
+             * The number of bits of the tick count each level of the wheel covers
+             */
+            static const int SLOT_BITS = 6;
+
+            /**
+             * The number of slots in each level of the wheel
+             */
+            static const int SLOTS = 1 << SLOT_BITS;
+
+            /**
+             * The number of levels in the wheel
+             */
+            static const int LEVELS = 4;
+
+            /**
+             * The longest delay a timer can be given, in ticks - around 46 hours. Longer delays are cut short to it.
+             */
+            static const uint32_t MAX_TICKS = (1UL << (SLOT_BITS * LEVELS)) - 1;
+
+            /**
+             * A one-shot timer
+             */
+            class Timer {
+
+                public:
+
+                    /**
+                     * Constructor
+                     */
+                    Timer();
+
+                    /**
+                     * Constructor
+                     * @param fn The work to do when the timer fires
+                     */
+                    Timer(timer_fn_t fn);
+
+                    /**
+                     * Destructor. Cancels the timer.
+                     */
+                    virtual ~Timer();
+
+                    /**
+                     * @returns Whether the timer is scheduled and hasn't fired yet
+                     */
+                    bool isPending() const;
+
+                    /**
+                     * The work to do when the timer fires
+                     */
+                    timer_fn_t fn;
+
+                protected:
+
+                    friend class TimerWheel;
+
+                    /**
+                     * The tick the timer fires on
+                     */
+                    uint32_t _expires;
+
+                    /**
+                     * The next timer in the same slot
+                     */
+                    Timer* _next;
+
+                    /**
+                     * Whatever points at this timer - the slot, or the previous timer's _next. NULL when not pending.
+                     */
+                    Timer** _pprev;
+
+                private:
+
+                    // A pending timer is linked into the wheel, so it can't be copied
+                    Timer(const Timer&);
+                    Timer& operator=(const Timer&);
+            };
+
+            /**
+             * The Rhizome's timer wheel.
+             * @returns The shared wheel
+             */
+            static TimerWheel* getInstance();
+
+            /**
+             * Constructor
+             */
+            TimerWheel();
+
+            /**
+             * Schedules a timer, replacing any time it was already scheduled for
+             * @param timer The timer
+             * @param delay How long from now the timer should fire, in milliseconds
+             */
+            void schedule(Timer* timer, unsigned long delay);
+
+            /**
+             * Cancels a timer. Cancelling a timer that isn't pending does nothing.
+             * @param timer The timer
+             */
+            void cancel(Timer* timer);
+
+            /**
+             * @param timer The timer
+             * @returns How long until the timer fires, in milliseconds, or 0 if it isn't pending
+             */
+            unsigned long remaining(const Timer* timer) const;
+
+            /**
+             * Runs every tick that has passed since the last call, firing the timers that have come due.
+             * Expect to call this once per loop().
+             * @returns The time taken to run the method, in microseconds
+             */
+            unsigned long advance();
+
+            /**
+             * @returns The number of ticks the wheel has run
+             */
+            uint32_t getTicks() const;
+
+        protected:
+
+            /**
+             * The timers in each slot of each level
+             */
+            Timer* _slots[LEVELS][SLOTS];
+
+            /**
+             * The number of ticks the wheel has run
+             */
+            uint32_t _now;
+
+            /**
+             * millis() at the last tick
+             */
+            unsigned long _lastTick;
+
+            /**
+             * Runs a single tick
+             */
+            void tick();
+
+            /**
+             * Files a timer in the slot its expiry falls in
+             * @param timer The timer
+             */
+            void insert(Timer* timer);
+
+            /**
+             * Empties a slot of a level above the bottom one, filing its timers again a level or more down
+             * @param level The level
+             * @param slot The slot
+             */
+            void cascade(int level, int slot);
+
+            /**
+             * Takes every timer out of a slot, leaving them linked to a list of their own
+             * @param slot The slot
+             * @param list Set to the head of the list
+             */
+            static void detach(Timer** slot, Timer* &list);
+
+            /**
+             * Adds a timer to the front of a list
+             * @param timer The timer
+             * @param head The head of the list
+             */
+            static void link(Timer* timer, Timer** head);
+
+            /**
+             * Takes a timer out of whichever list it's in
+             * @param timer The timer
+             */
+            static void unlink(Timer* timer);
+    };
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "Ohmbrewer_Touch_Queue.h"
+
+/**
+ * Constructor
+ */
+Ohmbrewer::TouchQueue::TouchQueue() {
+    _head = 0;
+    _tail = 0;
+    _dropped = 0;
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::TouchQueue::~TouchQueue() {
+    // Nothing to do here...
+}
+
+/**
+ * Adds an event. Only the producer calls this.
+ * @param event The event
+ * @returns Whether there was room for it
+ */
+bool Ohmbrewer::TouchQueue::push(const TouchEvent &event) {
+    uint8_t head = _head;
+    uint8_t next = (head + 1) & (CAPACITY - 1);
+
+    if (next == _tail) {
+        _dropped++;
+        return false;
+    }
+
+    _events[head] = event;
+    // The event must be in place before the consumer can see it
+    __sync_synchronize();
+    _head = next;
+    return true;
+}
+
+/**
+ * Takes the oldest event. Only the consumer calls this.
+ * @param event Set to the event
+ * @returns Whether there was one
+ */
+bool Ohmbrewer::TouchQueue::pop(TouchEvent &event) {
+    uint8_t tail = _tail;
+
+    if (tail == _head) {
+        return false;
+    }
+
+    // Read the event the head says is there before handing the slot back
+    __sync_synchronize();
+    event = _events[tail];
+    __sync_synchronize();
+    _tail = (tail + 1) & (CAPACITY - 1);
+    return true;
+}
+
+/**
+ * @returns Whether there are no events waiting
+ */
+bool Ohmbrewer::TouchQueue::isEmpty() const {
+    return _head == _tail;
+}
+
+/**
+ * @returns The number of events dropped because the queue was full
+ */
+unsigned long Ohmbrewer::TouchQueue::getDropped() const {
+    return _dropped;
+}
@@ -0,0 +1,114 @@
+/**
+ * This library provides the TouchQueue class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_TOUCH_QUEUE_H
+#define OHMBREWER_TOUCH_QUEUE_H
+
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * Something that happened on the touchscreen
+     */
+    struct TouchEvent {
+
+        /**
+         * What happened
+         */
+        enum Type {
+            PRESS,
+            RELEASE
+        };
+
+        /**
+         * The on-screen buttons, left to right
+         */
+        enum Button {
+            NO_BUTTON,
+            PLUS_BUTTON,
+            MINUS_BUTTON,
+            MENU_BUTTON,
+            SELECT_BUTTON
+        };
+
+        Type type;
+        Button button;      // The button pressed. A release has the button its press had.
+        int16_t x;          // Where, in screen coordinates
+        int16_t y;
+        unsigned long time; // millis() when it was sampled
+    };
+
+    /**
+     * A fixed size queue of TouchEvents, handed from the TouchSampler's timer to the loop.
+     *
+     * It's lock-free for a single producer and a single consumer: only push() moves the head and only pop() moves
+     * the tail, so the timer never has to wait for the loop or the other way around. When it's full, new events are
+     * dropped and counted rather than overwriting ones the loop hasn't seen.
+     */
+    class TouchQueue {
+
+        public:
+
+            /**
+             * The most events the queue holds. A power of two, so the indexes wrap with a mask.
+             */
+            static const uint8_t CAPACITY = 8;
+
+            /**
+             * Constructor
+             */
+            TouchQueue();
+
+            /**
+             * Destructor
+             */
+            virtual ~TouchQueue();
+
+            /**
+             * Adds an event. Only the producer calls this.
+             * @param event The event
+             * @returns Whether there was room for it
+             */
+            bool push(const TouchEvent &event);
+
+            /**
+             * Takes the oldest event. Only the consumer calls this.
+             * @param event Set to the event
+             * @returns Whether there was one
+             */
+            bool pop(TouchEvent &event);
+
+            /**
+             * @returns Whether there are no events waiting
+             */
+            bool isEmpty() const;
+
+            /**
+             * @returns The number of events dropped because the queue was full
+             */
+            unsigned long getDropped() const;
+
+        protected:
+
+            /**
+             * The events. Slots from _tail up to _head hold events; one is always left empty.
+             */
+            TouchEvent _events[CAPACITY];
+
+            /**
+             * Where the next event goes, and where the oldest is
+             */
+            volatile uint8_t _head;
+            volatile uint8_t _tail;
+
+            /**
+             * Events dropped because the queue was full
+             */
+            volatile unsigned long _dropped;
+    };
+};
+
+#endif
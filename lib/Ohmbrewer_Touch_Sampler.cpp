@@ -0,0 +1,141 @@
+#include "Ohmbrewer_Touch_Sampler.h"
+#include "Ohmbrewer_Screen.h"
+
+/**
+ * Constructor. Sampling doesn't start until begin().
+ * @param touchScreen The touchscreen to sample. The sampler takes ownership of it.
+ */
+Ohmbrewer::TouchSampler::TouchSampler(TouchScreen* touchScreen) : _timer(SAMPLE_PERIOD, &TouchSampler::sample, *this) {
+    _ts = touchScreen;
+    _state = UP;
+    _samples = 0;
+    _press.type = TouchEvent::PRESS;
+    _press.button = TouchEvent::NO_BUTTON;
+    _press.x = 0;
+    _press.y = 0;
+    _press.time = 0;
+}
+
+/**
+ * Destructor
+ */
+Ohmbrewer::TouchSampler::~TouchSampler() {
+    _timer.stop();
+    delete _ts;
+}
+
+/**
+ * Starts sampling
+ */
+void Ohmbrewer::TouchSampler::begin() {
+    _timer.start();
+}
+
+/**
+ * @returns The events sampled so far, for the loop to drain
+ */
+Ohmbrewer::TouchQueue* Ohmbrewer::TouchSampler::getQueue() {
+    return &_queue;
+}
+
+/**
+ * Takes a sample and moves the state machine along. Called by the timer.
+ */
+void Ohmbrewer::TouchSampler::sample() {
+    int16_t x;
+    int16_t y;
+    bool touched = read(x, y);
+
+    switch (_state) {
+        case UP:
+            if (touched) {
+                _state = PRESSING;
+                _samples = 1;
+                _press.x = x;
+                _press.y = y;
+            }
+            break;
+        case PRESSING:
+            if (!touched) {
+                // Just a bounce
+                _state = UP;
+            } else if (++_samples >= PRESS_SAMPLES) {
+                _press.type = TouchEvent::PRESS;
+                _press.button = buttonAt(_press.x, _press.y);
+                _press.time = millis();
+                _queue.push(_press);
+                _state = DOWN;
+            }
+            break;
+        case DOWN:
+            if (!touched) {
+                _state = RELEASING;
+                _samples = 1;
+            }
+            break;
+        case RELEASING:
+            if (touched) {
+                // Still down, it just bounced
+                _state = DOWN;
+            } else if (++_samples >= RELEASE_SAMPLES) {
+                TouchEvent release = _press;
+
+                release.type = TouchEvent::RELEASE;
+                release.time = millis();
+                _queue.push(release);
+                _state = UP;
+            }
+            break;
+    }
+}
+
+/**
+ * Works out which of the Screen's buttons a point is on
+ * @param x The point's X, in screen coordinates
+ * @param y The point's Y, in screen coordinates
+ * @returns The button, or NO_BUTTON if it isn't on one
+ */
+Ohmbrewer::TouchEvent::Button Ohmbrewer::TouchSampler::buttonAt(int16_t x, int16_t y) {
+    if (y < Screen::BUTTONTOP || x <= 0) {
+        return TouchEvent::NO_BUTTON;
+    } else if (x <= Screen::BUTTONSIZE) {
+        return TouchEvent::PLUS_BUTTON;
+    } else if (x <= Screen::BUTTONSIZE * 2) {
+        return TouchEvent::MINUS_BUTTON;
+    } else if (x <= Screen::BUTTONSIZE * 3) {
+        return TouchEvent::MENU_BUTTON;
+    } else if (x <= Screen::BUTTONSIZE * 4) {
+        return TouchEvent::SELECT_BUTTON;
+    }
+    return TouchEvent::NO_BUTTON;
+}
+
+/**
+ * Reads the touchscreen
+ * @param x Set to the X touched, in screen coordinates
+ * @param y Set to the Y touched, in screen coordinates
+ * @returns Whether the screen's being touched
+ */
+bool Ohmbrewer::TouchSampler::read(int16_t &x, int16_t &y) {
+    // The pressure alone is cheaper than a full point, and most samples find nothing
+    uint16_t pressure = _ts->pressure();
+    if (pressure < Screen::MINPRESSURE || pressure > Screen::MAXPRESSURE) {
+        return false;
+    }
+
+    // a point object holds x y and z coordinates
+    TSPoint p = _ts->getPoint();
+    //According to Particle forums, the read below is necessary to get touch to work on Photon
+    _ts->readTouchY();
+
+    // we have some minimum pressure we consider 'valid'
+    // pressure of 0 means no pressing!
+    if (p.z < Screen::MINPRESSURE || p.z > Screen::MAXPRESSURE) {
+        return false;
+    }
+
+    // Scale from ~0->1000 to the screen using the calibration #'s
+    x = map(p.x, Screen::TS_MINX, Screen::TS_MAXX, 0, Screen::RIGHT - 35); // This -35 is a dirty hack. We need to fix the scaling to get this working without it.
+    y = map(p.y, Screen::TS_MINY, Screen::TS_MAXY, 0, Screen::BOTTOM);
+    return true;
+}
@@ -0,0 +1,120 @@
+/**
+ * This library provides the TouchSampler class for the Rhizome PID/equipment controller.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_TOUCH_SAMPLER_H
+#define OHMBREWER_TOUCH_SAMPLER_H
+
+#include "application.h"
+#include "Touch_4Wire.h"
+#include "Ohmbrewer_Touch_Queue.h"
+
+namespace Ohmbrewer {
+
+    /**
+     * Samples the resistive touchscreen from a software timer, so presses are caught however long the loop is
+     * busy, and turns the samples into PRESS and RELEASE events on a TouchQueue.
+     *
+     * Samples are debounced by a small state machine: a press has to be seen PRESS_SAMPLES times in a row before
+     * it counts, and a release RELEASE_SAMPLES times. A press held down is a single PRESS, however long it's held.
+     * While nothing's touching the screen, each sample only measures the pressure.
+     */
+    class TouchSampler {
+
+        public:
+
+            /**
+             * How often the screen is sampled, in milliseconds
+             */
+            static const unsigned SAMPLE_PERIOD = 10;
+
+            /**
+             * The samples in a row it takes to press and release
+             */
+            static const uint8_t PRESS_SAMPLES = 2;
+            static const uint8_t RELEASE_SAMPLES = 3;
+
+            /**
+             * Constructor. Sampling doesn't start until begin().
+             * @param touchScreen The touchscreen to sample. The sampler takes ownership of it.
+             */
+            TouchSampler(TouchScreen* touchScreen);
+
+            /**
+             * Destructor
+             */
+            virtual ~TouchSampler();
+
+            /**
+             * Starts sampling
+             */
+            void begin();
+
+            /**
+             * @returns The events sampled so far, for the loop to drain
+             */
+            TouchQueue* getQueue();
+
+            /**
+             * Takes a sample and moves the state machine along. Called by the timer.
+             */
+            void sample();
+
+            /**
+             * Works out which of the Screen's buttons a point is on
+             * @param x The point's X, in screen coordinates
+             * @param y The point's Y, in screen coordinates
+             * @returns The button, or NO_BUTTON if it isn't on one
+             */
+            static TouchEvent::Button buttonAt(int16_t x, int16_t y);
+
+        protected:
+
+            /**
+             * Where the state machine is up to
+             */
+            enum State {
+                UP,        // Nothing touching the screen
+                PRESSING,  // Touched, but not for long enough to count yet
+                DOWN,      // Pressed
+                RELEASING  // Lifted, but not for long enough to count yet
+            };
+
+            /**
+             * The touchscreen
+             */
+            TouchScreen* _ts;
+
+            /**
+             * The timer that calls sample()
+             */
+            Timer _timer;
+
+            /**
+             * The events sampled, for the loop to drain
+             */
+            TouchQueue _queue;
+
+            /**
+             * Where the state machine is up to, and the samples in a row it's seen toward the next state
+             */
+            State _state;
+            uint8_t _samples;
+
+            /**
+             * The press being made, or the one that's down
+             */
+            TouchEvent _press;
+
+            /**
+             * Reads the touchscreen
+             * @param x Set to the X touched, in screen coordinates
+             * @param y Set to the Y touched, in screen coordinates
+             * @returns Whether the screen's being touched
+             */
+            bool read(int16_t &x, int16_t &y);
+    };
+};
+
+#endif
@@ -0,0 +1,229 @@
+/**
+ * This library provides the controls for the host-side simulation of the Rhizome's hardware.
+ * The stand-in Particle headers in sim/particle are backed by the state exposed here: a virtual clock,
+ * simulated GPIO, simulated EEPROM, an in-memory cloud bus and a simulated DS18B20 bus.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_SIM_H
+#define OHMBREWER_SIM_H
+
+#include <vector>
+#include <functional>
+#include "application.h"
+
+namespace Ohmbrewer {
+
+    namespace Sim {
+
+        /**
+         * An event published via Particle.publish / Spark.publish
+         */
+        struct Event {
+            String name;
+            String data;
+            unsigned long publishedAt;
+        };
+
+        /**
+         * Called whenever a digital pin changes level.
+         */
+        typedef std::function<void(pin_t pin, uint8_t level)> pin_listener_t;
+
+        /**
+         * Called whenever the virtual clock moves, with the number of microseconds it moved by.
+         */
+        typedef std::function<void(unsigned long long elapsedUs)> clock_listener_t;
+
+        /**
+         * Resets the clock, pins, EEPROM, cloud and OneWire bus to their power-on state.
+         */
+        void reset();
+
+        /* Virtual clock */
+
+        /**
+         * @returns The simulated time since boot, in microseconds
+         */
+        unsigned long long nowMicros();
+
+        /**
+         * Moves the virtual clock forward. Nothing runs while the clock moves; it simply costs time.
+         * @param us Microseconds to advance
+         */
+        void advanceMicros(unsigned long long us);
+
+        /**
+         * Moves the virtual clock forward.
+         * @param ms Milliseconds to advance
+         */
+        void advance(unsigned long ms);
+
+        /**
+         * Sets the Unix time reported by Time.now() at boot.
+         * @param epoch Seconds since 1970
+         */
+        void setEpoch(time_t epoch);
+
+        /**
+         * Registers a listener for clock movement. Anything simulated in continuous time (e.g. the thermal plant)
+         * hooks in here, so it keeps pace with the firmware no matter what the firmware spends its time on.
+         */
+        void onAdvance(clock_listener_t listener);
+
+        /**
+         * Runs loop() repeatedly until the given amount of simulated time has passed. Software Timers are
+         * serviced as the clock moves, within passes as well as between them.
+         * @param loopFn The firmware's loop()
+         * @param durationMs How long to run for, in simulated milliseconds
+         * @param minPassUs Simulated cost of an otherwise empty loop() pass, so idle loops still move the clock
+         * @returns The number of loop() passes made
+         */
+        unsigned long runLoop(void (*loopFn)(), unsigned long durationMs, unsigned long minPassUs = 1000);
+
+        /* GPIO */
+
+        /**
+         * @returns The current level of a digital pin
+         */
+        uint8_t pinLevel(pin_t pin);
+
+        /**
+         * @returns The number of times a digital pin has changed level since reset
+         */
+        unsigned long pinTransitions(pin_t pin);
+
+        /**
+         * Sets the value an analog pin will report
+         */
+        void setAnalog(pin_t pin, int32_t value);
+
+        /**
+         * Registers a listener for digital pin changes
+         */
+        void onPinChange(pin_listener_t listener);
+
+        /* Cloud */
+
+        /**
+         * Whether the simulated device is connected to the cloud
+         */
+        void setConnected(bool connected);
+
+        /**
+         * Calls a registered Particle.function
+         * @param name The function name
+         * @param args The argument string
+         * @param result Filled with the function's return value
+         * @returns Whether the function exists
+         */
+        bool callFunction(const char* name, const String& args, int& result);
+
+        /**
+         * Reads a registered Particle.variable
+         * @param name The variable name
+         * @param value Filled with the variable's value
+         * @returns Whether the variable exists
+         */
+        bool readVariable(const char* name, String& value);
+
+        /**
+         * @returns Every event published since the last clearEvents()
+         */
+        const std::vector<Event>& events();
+
+        /**
+         * Forgets the recorded events
+         */
+        void clearEvents();
+
+        /**
+         * Echoes Serial output and published events to stderr
+         */
+        void setEcho(bool echo);
+
+        /* DS18B20 bus */
+
+        /**
+         * Attaches a simulated DS18B20 to the OneWire bus.
+         * @param rom The 8 byte ROM code. The CRC byte is filled in for you.
+         * @param tempC The probe's initial temperature
+         * @returns The probe's handle
+         */
+        int addProbe(const uint8_t rom[8], double tempC);
+
+        /**
+         * Attaches a simulated DS18B20 with a generated ROM code.
+         * @param tempC The probe's initial temperature
+         * @returns The probe's handle
+         */
+        int addProbe(double tempC);
+
+        /**
+         * Sets the temperature a probe will latch at its next conversion
+         */
+        void setProbeTemp(int handle, double tempC);
+
+        /**
+         * Connects or disconnects a probe from the bus without forgetting it
+         */
+        void setProbePresent(int handle, bool present);
+
+        /**
+         * Makes a probe's scratchpad fail its CRC check
+         */
+        void setProbeCorrupt(int handle, bool corrupt);
+
+        /**
+         * Copies out a probe's ROM code
+         */
+        void getProbeRom(int handle, uint8_t rom[8]);
+
+        /**
+         * @returns The number of bus transactions (conversions, searches, scratchpad reads) made
+         */
+        unsigned long busConversions();
+        unsigned long busSearches();
+        unsigned long busReads();
+
+        /* Touchscreen */
+
+        /**
+         * Presses the touchscreen at the given raw coordinates (as reported by the resistive panel)
+         */
+        void setTouch(int16_t x, int16_t y, int16_t pressure);
+
+        /**
+         * Lifts the touch
+         */
+        void releaseTouch();
+
+        /**
+         * Reads back the simulated touch state
+         */
+        void getTouch(int16_t &x, int16_t &y, int16_t &pressure);
+
+        /* Framebuffer */
+
+        /**
+         * @returns The simulated ILI9341's RGB565 framebuffer, 240x320
+         */
+        uint16_t* framebuffer();
+
+        /**
+         * Writes the framebuffer out as a binary PPM image, e.g. to compare screens against known good ones
+         * @param path Where to write it
+         * @returns Whether it was written
+         */
+        bool dumpFramebuffer(const char* path);
+
+        /* SPI */
+
+        /**
+         * @returns How long the SPI bus has spent on DMA transfers, in microseconds. The CPU isn't charged for this.
+         */
+        unsigned long long spiBusyMicros();
+    };
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include <cmath>
+#include "Ohmbrewer_Thermal_Plant.h"
+
+/**
+ * @returns A 20 L kettle-style mash tun with a 3500 W element in it and a single probe
+ */
+Ohmbrewer::Sim::ThermalPlant::Config Ohmbrewer::Sim::ThermalPlant::kettle() {
+    Config config;
+    config.tunMassKg = 20.0;
+    config.tunLossWPerK = 6.0;
+    config.ambientC = 20.0;
+    config.startC = 20.0;
+    config.heaterWatts = 3500.0;
+    config.heaterControlPin = D2;
+    config.heaterPowerPin = -1;
+    config.heaterInTube = false;
+    config.tubeMassKg = 0.0;
+    config.tubeLossWPerK = 0.0;
+    config.pumpPin = -1;
+    config.flowKgPerSec = 0.0;
+    config.sensorLagSec = 5.0;
+    config.tunProbe = -1;
+    config.tubeProbe = -1;
+    return config;
+}
+
+/**
+ * @returns A 25 kg mash, doughed in at 64C, recirculating at 6 L/min through a 1500 W RIMS tube, with probes in the
+ *          tun and tube
+ */
+Ohmbrewer::Sim::ThermalPlant::Config Ohmbrewer::Sim::ThermalPlant::rims() {
+    Config config;
+    config.tunMassKg = 25.0;
+    config.tunLossWPerK = 4.0;
+    config.ambientC = 20.0;
+    config.startC = 64.0; // Doughed in with strike water, just under the first rest
+    config.heaterWatts = 1500.0;
+    config.heaterControlPin = D2;
+    config.heaterPowerPin = -1;
+    config.heaterInTube = true;
+    config.tubeMassKg = 0.4;
+    config.tubeLossWPerK = 0.5;
+    config.pumpPin = D4;
+    config.flowKgPerSec = 0.1;
+    config.sensorLagSec = 5.0;
+    config.tunProbe = -1;
+    config.tubeProbe = -1;
+    return config;
+}
+
+/**
+ * Constructor. Attaches the plant to the simulated clock and pins; it can't be detached again,
+ * so a plant should live as long as the simulation does.
+ * @param config The physical setup
+ */
+Ohmbrewer::Sim::ThermalPlant::ThermalPlant(const Config &config) {
+    _config = config;
+    _tunTemp = config.startC;
+    _tubeTemp = config.startC;
+    _tunProbeTemp = config.startC;
+    _tubeProbeTemp = config.startC;
+    _heaterOn = heaterPinsOn();
+    _switches = 0;
+    _energyJ = 0;
+    _pendingUs = 0;
+
+    if(_config.tunProbe != -1) {
+        setProbeTemp(_config.tunProbe, _tunProbeTemp);
+    }
+    if(_config.tubeProbe != -1) {
+        setProbeTemp(_config.tubeProbe, _tubeProbeTemp);
+    }
+
+    onAdvance([this](unsigned long long elapsedUs) { clockAdvanced(elapsedUs); });
+    onPinChange([this](pin_t pin, uint8_t level) { pinChanged(pin, level); });
+}
+
+/**
+ * @returns The true temperature of the mash, in Celsius
+ */
+double Ohmbrewer::Sim::ThermalPlant::getTunTemp() const {
+    return _tunTemp;
+}
+
+/**
+ * @returns The true temperature of the wort in the RIMS tube, in Celsius
+ */
+double Ohmbrewer::Sim::ThermalPlant::getTubeTemp() const {
+    return _tubeTemp;
+}
+
+/**
+ * @returns Whether the element is currently energized
+ */
+bool Ohmbrewer::Sim::ThermalPlant::isHeaterOn() const {
+    return _heaterOn;
+}
+
+/**
+ * @returns Whether the recirculation pump is currently running
+ */
+bool Ohmbrewer::Sim::ThermalPlant::isPumpOn() const {
+    return _config.pumpPin != -1 && pinLevel(_config.pumpPin) == HIGH;
+}
+
+/**
+ * @returns The number of times the element has been switched on or off
+ */
+unsigned long Ohmbrewer::Sim::ThermalPlant::getSwitchCount() const {
+    return _switches;
+}
+
+/**
+ * @returns The energy delivered by the element, in watt hours
+ */
+double Ohmbrewer::Sim::ThermalPlant::getEnergyWh() const {
+    return _energyJ / 3600.0;
+}
+
+/**
+ * Zeroes the switch count and energy meters
+ */
+void Ohmbrewer::Sim::ThermalPlant::resetMeters() {
+    _switches = 0;
+    _energyJ = 0;
+}
+
+/**
+ * Whether the element's pins are both driven HIGH
+ */
+bool Ohmbrewer::Sim::ThermalPlant::heaterPinsOn() const {
+    return pinLevel(_config.heaterControlPin) == HIGH &&
+           (_config.heaterPowerPin == -1 || pinLevel(_config.heaterPowerPin) == HIGH);
+}
+
+/**
+ * Clock listener. Integrates in STEP_US slices as the clock moves.
+ */
+void Ohmbrewer::Sim::ThermalPlant::clockAdvanced(unsigned long long elapsedUs) {
+    _pendingUs += elapsedUs;
+    while(_pendingUs >= STEP_US) {
+        integrate(STEP_US / 1000000.0);
+        _pendingUs -= STEP_US;
+    }
+}
+
+/**
+ * Pin listener. Counts element switching.
+ */
+void Ohmbrewer::Sim::ThermalPlant::pinChanged(pin_t pin, uint8_t /* level */) {
+    if(pin != _config.heaterControlPin && pin != _config.heaterPowerPin) {
+        return;
+    }
+
+    bool on = heaterPinsOn();
+    if(on != _heaterOn) {
+        _heaterOn = on;
+        _switches++;
+    }
+}
+
+/**
+ * Moves the model forward
+ * @param dt Seconds
+ */
+void Ohmbrewer::Sim::ThermalPlant::integrate(double dt) {
+    double heaterW = _heaterOn ? _config.heaterWatts : 0.0;
+    double tunW = -_config.tunLossWPerK * (_tunTemp - _config.ambientC);
+    _energyJ += heaterW * dt;
+
+    if(_config.heaterInTube) {
+        double tubeW = heaterW - _config.tubeLossWPerK * (_tubeTemp - _config.ambientC);
+
+        // Whatever the pump pushes out of the tube lands back in the tun
+        if(isPumpOn()) {
+            double exchangeW = _config.flowKgPerSec * WATER_SPECIFIC_HEAT * (_tubeTemp - _tunTemp);
+            tubeW -= exchangeW;
+            tunW += exchangeW;
+        }
+
+        _tubeTemp += tubeW * dt / (_config.tubeMassKg * WATER_SPECIFIC_HEAT);
+    } else {
+        tunW += heaterW;
+        _tubeTemp = _tunTemp;
+    }
+
+    _tunTemp += tunW * dt / (_config.tunMassKg * WATER_SPECIFIC_HEAT);
+
+    // Probes see the wort through a thermowell, so they trail it
+    double lag = 1.0 - exp(-dt / _config.sensorLagSec);
+    _tunProbeTemp += (_tunTemp - _tunProbeTemp) * lag;
+    _tubeProbeTemp += (_tubeTemp - _tubeProbeTemp) * lag;
+
+    if(_config.tunProbe != -1) {
+        setProbeTemp(_config.tunProbe, _tunProbeTemp);
+    }
+    if(_config.tubeProbe != -1) {
+        setProbeTemp(_config.tubeProbe, _tubeProbeTemp);
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * This library provides the ThermalPlant class for the host-side simulation of the Rhizome's hardware.
+ * The plant is a lumped model of a mash tun, optionally recirculating through a RIMS tube. It heats when the
+ * firmware drives the heating element's pins, moves wort when it drives the recirculation pump's pin, and feeds
+ * the (lagged) temperatures back to the firmware through the simulated DS18B20 probes.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_THERMAL_PLANT_H
+#define OHMBREWER_THERMAL_PLANT_H
+
+#include "Ohmbrewer_Sim.h"
+
+namespace Ohmbrewer {
+
+    namespace Sim {
+
+        class ThermalPlant {
+
+            public:
+
+                /**
+                 * Specific heat of water, J/(kg K). Grain is folded into the tun's mass as water equivalent.
+                 */
+                static constexpr double WATER_SPECIFIC_HEAT = 4186.0;
+
+                /**
+                 * How finely the plant integrates, in microseconds
+                 */
+                static const unsigned long STEP_US = 50000;
+
+                /**
+                 * The physical setup being simulated
+                 */
+                struct Config {
+                    double tunMassKg;        // Mash (water + grain as water equivalent)
+                    double tunLossWPerK;     // Heat lost to the room per degree above ambient
+                    double ambientC;
+                    double startC;           // Everything (tun, tube and probes) starts here
+
+                    double heaterWatts;
+                    int heaterControlPin;
+                    int heaterPowerPin;      // -1 if the element only has a control pin
+                    bool heaterInTube;       // Whether the element heats the RIMS tube or sits in the tun itself
+
+                    double tubeMassKg;       // Wort held in the RIMS tube. Ignored if heaterInTube is false.
+                    double tubeLossWPerK;
+                    int pumpPin;             // -1 if there's no recirculation pump
+                    double flowKgPerSec;     // Recirculation rate while the pump is on
+
+                    double sensorLagSec;     // Time constant of a probe in its thermowell
+                    int tunProbe;            // Sim::addProbe() handle, -1 if none
+                    int tubeProbe;           // Sim::addProbe() handle, -1 if none
+                };
+
+                /**
+                 * @returns A 20 L kettle-style mash tun with a 3500 W element in it and a single probe
+                 */
+                static Config kettle();
+
+                /**
+                 * @returns A 25 kg mash, doughed in at 64C, recirculating at 6 L/min through a 1500 W RIMS tube, with
+                 *          probes in the tun and tube
+                 */
+                static Config rims();
+
+                /**
+                 * Constructor. Attaches the plant to the simulated clock and pins; it can't be detached again,
+                 * so a plant should live as long as the simulation does.
+                 * @param config The physical setup
+                 */
+                ThermalPlant(const Config &config);
+
+                /**
+                 * @returns The true temperature of the mash, in Celsius
+                 */
+                double getTunTemp() const;
+
+                /**
+                 * @returns The true temperature of the wort in the RIMS tube, in Celsius
+                 */
+                double getTubeTemp() const;
+
+                /**
+                 * @returns Whether the element is currently energized
+                 */
+                bool isHeaterOn() const;
+
+                /**
+                 * @returns Whether the recirculation pump is currently running
+                 */
+                bool isPumpOn() const;
+
+                /**
+                 * @returns The number of times the element has been switched on or off
+                 */
+                unsigned long getSwitchCount() const;
+
+                /**
+                 * @returns The energy delivered by the element, in watt hours
+                 */
+                double getEnergyWh() const;
+
+                /**
+                 * Zeroes the switch count and energy meters
+                 */
+                void resetMeters();
+
+            private:
+                Config _config;
+                double _tunTemp;
+                double _tubeTemp;
+                double _tunProbeTemp;
+                double _tubeProbeTemp;
+                bool _heaterOn;
+                unsigned long _switches;
+                double _energyJ;
+                unsigned long long _pendingUs;
+
+                /**
+                 * Whether the element's pins are both driven HIGH
+                 */
+                bool heaterPinsOn() const;
+
+                /**
+                 * Clock listener. Integrates in STEP_US slices as the clock moves.
+                 */
+                void clockAdvanced(unsigned long long elapsedUs);
+
+                /**
+                 * Pin listener. Counts element switching.
+                 */
+                void pinChanged(pin_t pin, uint8_t level);
+
+                /**
+                 * Moves the model forward
+                 * @param dt Seconds
+                 */
+                void integrate(double dt);
+        };
+    };
+};
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * Benchmark for the Rhizome's touchscreen. Runs firmware/rhizome.ino's Screen with a Thermostat, a RIMS and a pump
+ * attached, and measures the simulated SPI time (see Adafruit_ILI9341::NS_PER_PIXEL) that redrawing it costs, both
+ * the time the loop is blocked for and the time the bus spends on DMA transfers in the background:
+ *
+ *   rhizome_display_bench [FRAMES]
+ *
+ *   steady - a display refresh where only a temperature digit or two has changed, as in most of a mash
+ *   menu   - pressing Menu and then Menu again, back to the home screen
+ *   add    - adding a Sprout, which refreshes the Sprout index and the screen
+ *
+ * The clock only moves when pixels are pushed, so the blocking figure is the time the loop spends on the display.
+ * The tiles are flushed as the flush task would, a pass every FLUSH_TASK_PERIOD.
+ *
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#include "Ohmbrewer_Sim.h"
+
+// The firmware itself. Arduino-style .ino files are plain C++ once the prototypes are known.
+void setup();
+void loop();
+#include "../firmware/rhizome.ino"
+
+namespace {
+
+    /**
+     * Formats a probe's ROM code the way the add function takes it
+     */
+    String romString(int handle) {
+        uint8_t rom[8];
+        char hex[17];
+        Ohmbrewer::Sim::getProbeRom(handle, rom);
+        for(int i = 0; i < 8; i++) {
+            snprintf(hex + (2 * i), 3, "%02X", rom[i]);
+        }
+        return String(hex);
+    }
+
+    /**
+     * Calls a cloud function, bailing out if it fails
+     */
+    int call(const char* name, const String &args) {
+        int result = -1;
+        if(!Ohmbrewer::Sim::callFunction(name, args, result) || result < 0) {
+            fprintf(stderr, "%s(%s) failed: %d\n", name, args.c_str(), result);
+            exit(1);
+        }
+        return result;
+    }
+
+    /**
+     * Simulated time the loop and the SPI bus spend on a redraw, in microseconds
+     */
+    struct Cost {
+        unsigned long long blockingUs;
+        unsigned long long busUs;
+    };
+
+    /**
+     * Runs fn, then flushes the display to the end. Only the flush passes count as blocking, not the waits between.
+     */
+    template <typename F>
+    void timed(Cost &cost, F fn) {
+        Ohmbrewer::Screen* screen = rhizome.getScreen();
+        unsigned long long busStart = Ohmbrewer::Sim::spiBusyMicros();
+        unsigned long long start = Ohmbrewer::Sim::nowMicros();
+
+        fn();
+        cost.blockingUs += Ohmbrewer::Sim::nowMicros() - start;
+        while(!screen->isFlushed()) {
+            Ohmbrewer::Sim::advance(Ohmbrewer::Rhizome::FLUSH_TASK_PERIOD);
+            start = Ohmbrewer::Sim::nowMicros();
+            screen->flushDisplay();
+            cost.blockingUs += Ohmbrewer::Sim::nowMicros() - start;
+        }
+        // Let the last tile finish
+        Ohmbrewer::Sim::advance(Ohmbrewer::Rhizome::FLUSH_TASK_PERIOD);
+        cost.busUs += Ohmbrewer::Sim::spiBusyMicros() - busStart;
+    }
+
+    /**
+     * Prints a line of the results
+     */
+    void report(const char* name, const Cost &cost, unsigned long divisor) {
+        printf("%-8s %12.2f %12.2f\n", name, cost.blockingUs / 1000.0 / divisor, cost.busUs / 1000.0 / divisor);
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned long frames = 100;
+
+    if(argc > 2 || (argc == 2 && (frames = strtoul(argv[1], NULL, 10)) == 0)) {
+        fprintf(stderr, "usage: %s [FRAMES]\n", argv[0]);
+        return 1;
+    }
+
+    int thermProbe = Ohmbrewer::Sim::addProbe(66.0);
+    int tunProbe = Ohmbrewer::Sim::addProbe(65.5);
+    int tubeProbe = Ohmbrewer::Sim::addProbe(68.0);
+    int spareProbe = Ohmbrewer::Sim::addProbe(20.0);
+
+    setup();
+    call("add", String("therm,") + romString(thermProbe) + ",2,-1");
+    call("add", String("rims,") + romString(tunProbe) + ",3,-1,4," + romString(tubeProbe));
+    call("add", "pump,5");
+
+    // Read the probes once, so there are temperatures to show
+    Ohmbrewer::Sim::runLoop(loop, 5000);
+
+    Ohmbrewer::Screen* screen = rhizome.getScreen();
+    std::deque<Ohmbrewer::Equipment*>* sprouts = rhizome.getSprouts();
+    Ohmbrewer::Thermostat* therm = (Ohmbrewer::Thermostat*)(*sprouts)[0];
+    Ohmbrewer::RIMS* rims = (Ohmbrewer::RIMS*)(*sprouts)[1];
+    Cost settle = { 0, 0 };
+    timed(settle, [screen]() { screen->refreshDisplay(); });
+
+    // A mash drifting by a sixteenth of a degree at a time
+    Cost steady = { 0, 0 };
+    for(unsigned long i = 0; i < frames; i++) {
+        Ohmbrewer::Temperature* temp = (i % 2 == 0) ? therm->getSensor()->getTemp() : rims->getTunSensor()->getTemp();
+        temp->fromRaw(temp->raw() + ((i % 4 < 2) ? 1 : -1));
+        timed(steady, [screen]() { screen->refreshDisplay(); });
+    }
+
+    Cost menu = { 0, 0 };
+    timed(menu, [screen]() {
+        screen->getCurrentMenu()->menuPressed();
+        screen->refreshDisplay();
+    });
+    timed(menu, [screen]() {
+        screen->getCurrentMenu()->menuPressed();
+        screen->refreshDisplay();
+    });
+
+    Cost add = { 0, 0 };
+    timed(add, [spareProbe]() {
+        call("add", String("temp,") + romString(spareProbe));
+        rhizome.getScreen()->refreshDisplay();
+    });
+
+    printf("%-8s %12s %12s\n", "redraw", "blocking ms", "bus ms");
+    report("steady", steady, frames);
+    report("menu", menu, 1);
+    report("add", add, 1);
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+#include <utility>
+#include "Adafruit_ILI9341.h"
+#include "sim_internal.h"
+#include "Ohmbrewer_Sim.h"
+
+namespace {
+
+    uint16_t frame[ILI9341_TFTWIDTH * ILI9341_TFTHEIGHT];
+
+    // The display whose address window was set last, which pixel data sent over SPI goes to
+    Adafruit_ILI9341* selected = NULL;
+
+    // Fractional nanoseconds of SPI time that haven't yet moved the clock
+    unsigned long long pendingNs = 0;
+
+    void chargePixels(unsigned long pixels) {
+        pendingNs += (unsigned long long)pixels * Adafruit_ILI9341::NS_PER_PIXEL;
+        if(pendingNs >= 1000) {
+            Ohmbrewer::Sim::advanceMicros(pendingNs / 1000);
+            pendingNs %= 1000;
+        }
+    }
+
+    void store(int16_t x, int16_t y, uint16_t color) {
+        if(x >= 0 && y >= 0 && x < ILI9341_TFTWIDTH && y < ILI9341_TFTHEIGHT) {
+            frame[y * ILI9341_TFTWIDTH + x] = color;
+        }
+    }
+}
+
+uint16_t* Ohmbrewer::Sim::framebuffer() {
+    return frame;
+}
+
+bool Ohmbrewer::Sim::dumpFramebuffer(const char* path) {
+    FILE* out = fopen(path, "wb");
+    if(out == NULL) {
+        return false;
+    }
+
+    // Binary PPM, with RGB565 widened to 8 bits a channel
+    fprintf(out, "P6\n%d %d\n255\n", ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT);
+    for(int i = 0; i < ILI9341_TFTWIDTH * ILI9341_TFTHEIGHT; i++) {
+        uint8_t rgb[3] = { (uint8_t)(((frame[i] >> 11) & 0x1F) * 255 / 31),
+                           (uint8_t)(((frame[i] >> 5) & 0x3F) * 255 / 63),
+                           (uint8_t)((frame[i] & 0x1F) * 255 / 31) };
+        fwrite(rgb, 1, sizeof(rgb), out);
+    }
+
+    return fclose(out) == 0;
+}
+
+void Ohmbrewer::Sim::Internal::displayData(const uint8_t* data, size_t length) {
+    if(selected == NULL) {
+        return;
+    }
+    for(size_t i = 0; i + 1 < length; i += 2) {
+        selected->storeWindowed((uint16_t)((data[i] << 8) | data[i + 1]));
+    }
+}
+
+unsigned long long Ohmbrewer::Sim::Internal::displayTransferNs(size_t length) {
+    return (unsigned long long)(length / 2) * Adafruit_ILI9341::NS_PER_PIXEL;
+}
+
+void Ohmbrewer::Sim::Internal::resetDisplay() {
+    memset(frame, 0, sizeof(frame));
+    pendingNs = 0;
+}
+
+/* ========================================================================= */
+/* Adafruit_GFX                                                              */
+/* ========================================================================= */
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) {
+    _width = w;
+    _height = h;
+    cursor_x = 0;
+    cursor_y = 0;
+    textcolor = 0xFFFF;
+    textbgcolor = 0xFFFF;
+    textsize = 1;
+    wrap = true;
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    drawLine(x, y, x, y + h - 1, color);
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    drawLine(x, y, x + w - 1, y, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for(int16_t i = x; i < x + w; i++) {
+        drawFastVLine(i, y, h, color);
+    }
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+    fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    // Bresenham, as in Adafruit_GFX
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if(steep) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if(x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    int16_t dx = x1 - x0;
+    int16_t dy = abs(y1 - y0);
+    int16_t err = dx / 2;
+    int16_t ystep = (y0 < y1) ? 1 : -1;
+
+    for(; x0 <= x1; x0++) {
+        if(steep) {
+            drawPixel(y0, x0, color);
+        } else {
+            drawPixel(x0, y0, color);
+        }
+        err -= dy;
+        if(err < 0) {
+            y0 += ystep;
+            err += dx;
+        }
+    }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+    if(x >= _width || y >= _height || (x + 6 * size - 1) < 0 || (y + 8 * size - 1) < 0) {
+        return;
+    }
+
+    // Same 6x8 cell and draw calls as the real 5x7 font, but with a placeholder glyph derived from the character
+    for(int8_t i = 0; i < 6; i++) {
+        uint8_t line = (i == 5 || c == ' ') ? 0x00 : (uint8_t)((c * 0x9D + i * 0x3B) & 0x7F);
+        for(int8_t j = 0; j < 8; j++, line >>= 1) {
+            if(line & 0x1) {
+                if(size == 1) {
+                    drawPixel(x + i, y + j, color);
+                } else {
+                    fillRect(x + (i * size), y + (j * size), size, size, color);
+                }
+            } else if(bg != color) {
+                if(size == 1) {
+                    drawPixel(x + i, y + j, bg);
+                } else {
+                    fillRect(x + i * size, y + j * size, size, size, bg);
+                }
+            }
+        }
+    }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+    if(c == '\n') {
+        cursor_y += textsize * 8;
+        cursor_x = 0;
+    } else if(c == '\r') {
+        // skip
+    } else {
+        drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+        cursor_x += textsize * 6;
+        if(wrap && (cursor_x > (_width - textsize * 6))) {
+            cursor_y += textsize * 8;
+            cursor_x = 0;
+        }
+    }
+    return 1;
+}
+
+/* ========================================================================= */
+/* Adafruit_ILI9341                                                          */
+/* ========================================================================= */
+
+Adafruit_ILI9341::Adafruit_ILI9341(uint8_t CS, uint8_t RS, uint8_t RST) : Adafruit_GFX(ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT) {
+    _windowX0 = _windowY0 = _windowX1 = _windowY1 = 0;
+    _windowX = _windowY = 0;
+}
+
+void Adafruit_ILI9341::begin() {
+    // The real init sequence includes ~150ms of delays
+    delay(150);
+}
+
+void Adafruit_ILI9341::setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    _windowX0 = _windowX = x0;
+    _windowY0 = _windowY = y0;
+    _windowX1 = x1;
+    _windowY1 = y1;
+    selected = this;
+    // Column and page address commands
+    chargePixels(5);
+}
+
+void Adafruit_ILI9341::pushColor(uint16_t color) {
+    storeWindowed(color);
+    chargePixels(1);
+}
+
+void Adafruit_ILI9341::storeWindowed(uint16_t color) {
+    store(_windowX, _windowY, color);
+    if(++_windowX > _windowX1) {
+        _windowX = _windowX0;
+        if(++_windowY > _windowY1) {
+            _windowY = _windowY0;
+        }
+    }
+}
+
+void Adafruit_ILI9341::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if((x < 0) || (x >= _width) || (y < 0) || (y >= _height)) {
+        return;
+    }
+    setAddrWindow(x, y, x + 1, y + 1);
+    store(x, y, color);
+    chargePixels(1);
+}
+
+void Adafruit_ILI9341::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+void Adafruit_ILI9341::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void Adafruit_ILI9341::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    // Clip as the real driver does
+    if((x >= _width) || (y >= _height)) {
+        return;
+    }
+    if(x < 0) { w += x; x = 0; }
+    if(y < 0) { h += y; y = 0; }
+    if((x + w - 1) >= _width) {
+        w = _width - x;
+    }
+    if((y + h - 1) >= _height) {
+        h = _height - y;
+    }
+    if(w <= 0 || h <= 0) {
+        return;
+    }
+
+    setAddrWindow(x, y, x + w - 1, y + h - 1);
+    for(int16_t row = y; row < y + h; row++) {
+        for(int16_t col = x; col < x + w; col++) {
+            store(col, row, color);
+        }
+    }
+    chargePixels((unsigned long)w * h);
+}
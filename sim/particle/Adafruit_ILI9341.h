@@ -0,0 +1,120 @@
+/**
+ * Host stand-in for the Adafruit_ILI9341 / Adafruit_mfGFX libraries.
+ * Draws into an in-memory 240x320 RGB565 framebuffer (see Ohmbrewer::Sim::framebuffer()) and charges simulated
+ * SPI time per pixel pushed, so the cost of redrawing the screen shows up on the virtual clock.
+ * Glyphs are a deterministic placeholder pattern rather than the real 5x7 font.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_SIM_ADAFRUIT_ILI9341_H
+#define OHMBREWER_SIM_ADAFRUIT_ILI9341_H
+
+#include "application.h"
+
+namespace Ohmbrewer {
+    namespace Sim {
+        namespace Internal {
+            void displayData(const uint8_t* data, size_t length);
+        };
+    };
+};
+
+#define ILI9341_TFTWIDTH  240
+#define ILI9341_TFTHEIGHT 320
+
+#define ILI9341_BLACK       0x0000
+#define ILI9341_NAVY        0x000F
+#define ILI9341_DARKGREEN   0x03E0
+#define ILI9341_DARKCYAN    0x03EF
+#define ILI9341_MAROON      0x7800
+#define ILI9341_PURPLE      0x780F
+#define ILI9341_OLIVE       0x7BE0
+#define ILI9341_LIGHTGREY   0xC618
+#define ILI9341_DARKGREY    0x7BEF
+#define ILI9341_BLUE        0x001F
+#define ILI9341_GREEN       0x07E0
+#define ILI9341_CYAN        0x07FF
+#define ILI9341_RED         0xF800
+#define ILI9341_MAGENTA     0xF81F
+#define ILI9341_YELLOW      0xFFE0
+#define ILI9341_WHITE       0xFFFF
+#define ILI9341_ORANGE      0xFD20
+#define ILI9341_GREENYELLOW 0xAFE5
+#define ILI9341_PINK        0xF81F
+
+/**
+ * The subset of Adafruit_GFX the Rhizome uses.
+ */
+class Adafruit_GFX : public Print {
+    public:
+        Adafruit_GFX(int16_t w, int16_t h);
+        virtual ~Adafruit_GFX() {}
+
+        virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+        virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+        virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+        virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+        virtual void fillScreen(uint16_t color);
+
+        void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+        void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+        void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+        void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+        int16_t getCursorX() const { return cursor_x; }
+        int16_t getCursorY() const { return cursor_y; }
+        void setTextColor(uint16_t c) { textcolor = c; textbgcolor = c; }
+        void setTextColor(uint16_t c, uint16_t bg) { textcolor = c; textbgcolor = bg; }
+        void setTextSize(uint8_t s) { textsize = (s > 0) ? s : 1; }
+        void setTextWrap(bool w) { wrap = w; }
+        void setRotation(uint8_t r) {}
+
+        int16_t width() const { return _width; }
+        int16_t height() const { return _height; }
+
+        virtual size_t write(uint8_t c);
+        using Print::write;
+
+    protected:
+        int16_t  _width, _height;
+        int16_t  cursor_x, cursor_y;
+        uint16_t textcolor, textbgcolor;
+        uint8_t  textsize;
+        bool     wrap;
+};
+
+/**
+ * The ILI9341 controller, backed by the simulated framebuffer.
+ */
+class Adafruit_ILI9341 : public Adafruit_GFX {
+    public:
+        /**
+         * Simulated cost of pushing one pixel over SPI, in nanoseconds. Roughly 16 bits at the Photon's 30MHz
+         * SPI clock plus per-transaction overhead.
+         */
+        static const unsigned long NS_PER_PIXEL = 600;
+
+        Adafruit_ILI9341(uint8_t CS, uint8_t RS, uint8_t RST);
+
+        void begin();
+        void setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+        void pushColor(uint16_t color);
+
+        virtual void drawPixel(int16_t x, int16_t y, uint16_t color);
+        virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+        virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+        virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+    private:
+        uint16_t _windowX0, _windowY0, _windowX1, _windowY1;
+        uint16_t _windowX, _windowY;
+
+        /**
+         * Stores a pixel at the next position in the address window
+         */
+        void storeWindowed(uint16_t color);
+
+        friend void Ohmbrewer::Sim::Internal::displayData(const uint8_t* data, size_t length);
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "Touch_4Wire.h"
+#include "sim_internal.h"
+#include "Ohmbrewer_Sim.h"
+
+namespace {
+    int16_t touchX = 0;
+    int16_t touchY = 0;
+    int16_t touchZ = 0;
+}
+
+void Ohmbrewer::Sim::Internal::resetTouch() {
+    touchX = 0;
+    touchY = 0;
+    touchZ = 0;
+}
+
+void Ohmbrewer::Sim::setTouch(int16_t x, int16_t y, int16_t pressure) {
+    touchX = x;
+    touchY = y;
+    touchZ = pressure;
+}
+
+void Ohmbrewer::Sim::releaseTouch() {
+    touchZ = 0;
+}
+
+void Ohmbrewer::Sim::getTouch(int16_t &x, int16_t &y, int16_t &pressure) {
+    x = touchX;
+    y = touchY;
+    pressure = touchZ;
+}
+
+TSPoint::TSPoint(void) {
+    x = y = z = 0;
+}
+
+TSPoint::TSPoint(int16_t x0, int16_t y0, int16_t z0) {
+    x = x0;
+    y = y0;
+    z = z0;
+}
+
+bool TSPoint::operator==(TSPoint p1) {
+    return ((p1.x == x) && (p1.y == y) && (p1.z == z));
+}
+
+bool TSPoint::operator!=(TSPoint p1) {
+    return ((p1.x != x) || (p1.y != y) || (p1.z != z));
+}
+
+TouchScreen::TouchScreen(uint8_t xp, uint8_t yp, uint8_t xm, uint8_t ym) : TouchScreen(xp, yp, xm, ym, 0) {}
+
+TouchScreen::TouchScreen(uint8_t xp, uint8_t yp, uint8_t xm, uint8_t ym, uint16_t rxplate) {
+    _yp = yp;
+    _xm = xm;
+    _ym = ym;
+    _xp = xp;
+    _rxplate = rxplate;
+    pressureThreshhold = 10;
+}
+
+int TouchScreen::readTouchX(void) {
+    Ohmbrewer::Sim::advanceMicros(US_PER_AXIS);
+    return touchZ > 0 ? touchX : 0;
+}
+
+int TouchScreen::readTouchY(void) {
+    Ohmbrewer::Sim::advanceMicros(US_PER_AXIS);
+    return touchZ > 0 ? touchY : 0;
+}
+
+uint16_t TouchScreen::pressure(void) {
+    Ohmbrewer::Sim::advanceMicros(US_PER_AXIS);
+    return touchZ;
+}
+
+bool TouchScreen::isTouching(void) {
+    return pressure() > pressureThreshhold;
+}
+
+TSPoint TouchScreen::getPoint(void) {
+    // X, Y and the two Z plates
+    Ohmbrewer::Sim::advanceMicros(US_PER_AXIS * 4);
+    if(touchZ <= 0) {
+        return TSPoint(0, 0, 0);
+    }
+    return TSPoint(touchX, touchY, touchZ);
+}
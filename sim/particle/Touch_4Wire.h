@@ -0,0 +1,46 @@
+/**
+ * Host stand-in for the Touch_4Wire (Adafruit resistive TouchScreen) library.
+ * Touches are injected with Ohmbrewer::Sim::setTouch() / releaseTouch().
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_SIM_TOUCH_4WIRE_H
+#define OHMBREWER_SIM_TOUCH_4WIRE_H
+
+#include "application.h"
+
+class TSPoint {
+    public:
+        TSPoint(void);
+        TSPoint(int16_t x, int16_t y, int16_t z);
+
+        bool operator==(TSPoint);
+        bool operator!=(TSPoint);
+
+        int16_t x, y, z;
+};
+
+class TouchScreen {
+    public:
+        /**
+         * Simulated cost of one axis measurement: settle time plus a couple of ADC conversions.
+         */
+        static const unsigned long US_PER_AXIS = 150;
+
+        TouchScreen(uint8_t xp, uint8_t yp, uint8_t xm, uint8_t ym);
+        TouchScreen(uint8_t xp, uint8_t yp, uint8_t xm, uint8_t ym, uint16_t rx);
+
+        bool isTouching(void);
+        uint16_t pressure(void);
+        int readTouchY();
+        int readTouchX();
+        TSPoint getPoint();
+
+        int16_t pressureThreshhold;
+
+    private:
+        uint8_t _yp, _ym, _xm, _xp;
+        uint16_t _rxplate;
+};
+
+#endif
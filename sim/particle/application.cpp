@@ -0,0 +1,862 @@
+#include <cstdarg>
+#include <cctype>
+#include <map>
+#include <string>
+#include "application.h"
+#include "sim_internal.h"
+#include "Ohmbrewer_Sim.h"
+
+/* ========================================================================= */
+/* Simulation state                                                          */
+/* ========================================================================= */
+
+namespace {
+
+    const time_t DEFAULT_EPOCH = 1459468800; // 2016-04-01, around when the Rhizome was brewing
+
+    unsigned long long nowUs = 0;
+    time_t epoch = DEFAULT_EPOCH;
+
+    uint8_t pinLevels[TOTAL_PINS];
+    unsigned long pinTransitionCounts[TOTAL_PINS];
+    int32_t analogLevels[TOTAL_PINS];
+    std::vector<Ohmbrewer::Sim::pin_listener_t> pinListeners SIM_STATE;
+    std::vector<Ohmbrewer::Sim::clock_listener_t> clockListeners SIM_STATE;
+
+    uint8_t eeprom[EEPROMClass::SIZE];
+
+    // Erased flash reads back as 0xFF, even before the first Sim::reset()
+    struct EraseEEPROM {
+        EraseEEPROM() { memset(eeprom, 0xFF, sizeof(eeprom)); }
+    } eraseEEPROM SIM_STATE;
+
+    bool cloudConnected = true;
+    bool echo = false;
+    std::map<std::string, user_function_t> functions SIM_STATE;
+    std::map<std::string, std::function<String()> > variables SIM_STATE;
+    std::vector<Ohmbrewer::Sim::Event> publishedEvents SIM_STATE;
+
+    Timer* timers = NULL;
+
+    // Set while Timer callbacks are running, so the clock moves they make don't run them again
+    bool servicingTimers = false;
+
+    bool validPin(uint16_t pin) {
+        return pin < TOTAL_PINS;
+    }
+
+    void move(unsigned long long us) {
+        nowUs += us;
+        for(std::vector<Ohmbrewer::Sim::clock_listener_t>::iterator itr = clockListeners.begin(); itr != clockListeners.end(); itr++) {
+            (*itr)(us);
+        }
+        Ohmbrewer::Sim::Internal::serviceSPI();
+    }
+
+    // Every move of the clock goes through here so that clock listeners see all of it
+    void tick(unsigned long long us) {
+        unsigned long long target = nowUs + us;
+        unsigned long long dueUs = 0;
+
+        // Stop for each Timer that comes due on the way, as the timer thread would run it then - even in the
+        // middle of a loop() pass or a long delay()
+        while(!servicingTimers && Timer::nextDue(dueUs) && dueUs < target) {
+            if(dueUs > nowUs) {
+                move(dueUs - nowUs);
+            }
+            Timer::serviceAll();
+        }
+        move(target - nowUs);
+        Timer::serviceAll();
+    }
+}
+
+void Ohmbrewer::Sim::reset() {
+    nowUs = 0;
+    epoch = DEFAULT_EPOCH;
+    memset(pinLevels, 0, sizeof(pinLevels));
+    memset(pinTransitionCounts, 0, sizeof(pinTransitionCounts));
+    memset(analogLevels, 0, sizeof(analogLevels));
+    pinListeners.clear();
+    clockListeners.clear();
+    // Erased flash reads back as 0xFF
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    cloudConnected = true;
+    functions.clear();
+    variables.clear();
+    publishedEvents.clear();
+    Internal::resetOneWire();
+    Internal::resetTouch();
+    Internal::resetDisplay();
+    Internal::resetSPI();
+}
+
+unsigned long long Ohmbrewer::Sim::nowMicros() {
+    return nowUs;
+}
+
+void Ohmbrewer::Sim::advanceMicros(unsigned long long us) {
+    tick(us);
+}
+
+void Ohmbrewer::Sim::advance(unsigned long ms) {
+    tick((unsigned long long)ms * 1000);
+}
+
+void Ohmbrewer::Sim::onAdvance(clock_listener_t listener) {
+    clockListeners.push_back(listener);
+}
+
+void Ohmbrewer::Sim::setEpoch(time_t newEpoch) {
+    epoch = newEpoch;
+}
+
+unsigned long Ohmbrewer::Sim::runLoop(void (*loopFn)(), unsigned long durationMs, unsigned long minPassUs) {
+    unsigned long long stopAt = nowUs + (unsigned long long)durationMs * 1000;
+    unsigned long passes = 0;
+
+    while(nowUs < stopAt) {
+        unsigned long long passStart = nowUs;
+        loopFn();
+        if(nowUs - passStart < minPassUs) {
+            tick(passStart + minPassUs - nowUs);
+        }
+        passes++;
+    }
+
+    return passes;
+}
+
+uint8_t Ohmbrewer::Sim::pinLevel(pin_t pin) {
+    return validPin(pin) ? pinLevels[pin] : LOW;
+}
+
+unsigned long Ohmbrewer::Sim::pinTransitions(pin_t pin) {
+    return validPin(pin) ? pinTransitionCounts[pin] : 0;
+}
+
+void Ohmbrewer::Sim::setAnalog(pin_t pin, int32_t value) {
+    if(validPin(pin)) {
+        analogLevels[pin] = value;
+    }
+}
+
+void Ohmbrewer::Sim::onPinChange(pin_listener_t listener) {
+    pinListeners.push_back(listener);
+}
+
+void Ohmbrewer::Sim::setConnected(bool connected) {
+    cloudConnected = connected;
+}
+
+bool Ohmbrewer::Sim::callFunction(const char* name, const String& args, int& result) {
+    std::map<std::string, user_function_t>::iterator itr = functions.find(name);
+    if(itr == functions.end()) {
+        return false;
+    }
+    result = itr->second(args);
+    return true;
+}
+
+bool Ohmbrewer::Sim::readVariable(const char* name, String& value) {
+    std::map<std::string, std::function<String()> >::iterator itr = variables.find(name);
+    if(itr == variables.end()) {
+        return false;
+    }
+    value = itr->second();
+    return true;
+}
+
+const std::vector<Ohmbrewer::Sim::Event>& Ohmbrewer::Sim::events() {
+    return publishedEvents;
+}
+
+void Ohmbrewer::Sim::clearEvents() {
+    publishedEvents.clear();
+}
+
+void Ohmbrewer::Sim::setEcho(bool shouldEcho) {
+    echo = shouldEcho;
+}
+
+/* ========================================================================= */
+/* Pins                                                                      */
+/* ========================================================================= */
+
+void pinMode(uint16_t pin, PinMode mode) {
+    // Modes aren't simulated
+}
+
+void digitalWrite(uint16_t pin, uint8_t value) {
+    if(!validPin(pin)) {
+        return;
+    }
+
+    value = value ? HIGH : LOW;
+    if(pinLevels[pin] != value) {
+        pinLevels[pin] = value;
+        pinTransitionCounts[pin]++;
+        for(unsigned int i = 0; i < pinListeners.size(); i++) {
+            pinListeners[i](pin, value);
+        }
+    }
+}
+
+int32_t digitalRead(uint16_t pin) {
+    return validPin(pin) ? pinLevels[pin] : LOW;
+}
+
+int32_t analogRead(uint16_t pin) {
+    return validPin(pin) ? analogLevels[pin] : 0;
+}
+
+void pinSetFast(uint16_t pin) {
+    digitalWrite(pin, HIGH);
+}
+
+void pinResetFast(uint16_t pin) {
+    digitalWrite(pin, LOW);
+}
+
+/* ========================================================================= */
+/* Time                                                                      */
+/* ========================================================================= */
+
+unsigned long millis() {
+    return (unsigned long)(nowUs / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)nowUs;
+}
+
+void delay(unsigned long ms) {
+    Ohmbrewer::Sim::advance(ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+    Ohmbrewer::Sim::advanceMicros(us);
+}
+
+long map(long value, long fromStart, long fromEnd, long toStart, long toEnd) {
+    if(fromEnd == fromStart) {
+        return toStart;
+    }
+    return (value - fromStart) * (toEnd - toStart) / (fromEnd - fromStart) + toStart;
+}
+
+TimeClass Time;
+
+time_t TimeClass::now() {
+    return epoch + (time_t)(nowUs / 1000000);
+}
+
+/* ========================================================================= */
+/* String                                                                    */
+/* ========================================================================= */
+
+void String::init() {
+    _buffer = NULL;
+    _capacity = 0;
+    _len = 0;
+    reserve(0);
+}
+
+unsigned char String::reserve(unsigned int size) {
+    if(_buffer != NULL && _capacity >= size) {
+        return 1;
+    }
+
+    char* newBuffer = (char*)realloc(_buffer, size + 1);
+    if(newBuffer == NULL) {
+        return 0;
+    }
+    if(_buffer == NULL) {
+        newBuffer[0] = '\0';
+    }
+    _buffer = newBuffer;
+    _capacity = size;
+    return 1;
+}
+
+void String::copy(const char* cstr, unsigned int length) {
+    reserve(length);
+    memcpy(_buffer, cstr, length);
+    _buffer[length] = '\0';
+    _len = length;
+}
+
+String::String(const char* cstr) {
+    init();
+    if(cstr != NULL) {
+        copy(cstr, strlen(cstr));
+    }
+}
+
+String::String(const String& str) {
+    init();
+    copy(str._buffer, str._len);
+}
+
+String::String(String&& rval) {
+    _buffer = rval._buffer;
+    _capacity = rval._capacity;
+    _len = rval._len;
+    rval.init();
+}
+
+String::String(char c) {
+    init();
+    char buf[2] = { c, '\0' };
+    copy(buf, 1);
+}
+
+String::String(unsigned char value, unsigned char base) : String((unsigned long)value, base) {}
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) {
+    char buf[34];
+    init();
+    if(base == 16) {
+        snprintf(buf, sizeof(buf), "%lx", value);
+    } else {
+        snprintf(buf, sizeof(buf), "%ld", value);
+    }
+    copy(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base) {
+    char buf[34];
+    init();
+    if(base == 16) {
+        snprintf(buf, sizeof(buf), "%lx", value);
+    } else {
+        snprintf(buf, sizeof(buf), "%lu", value);
+    }
+    copy(buf, strlen(buf));
+}
+
+String::String(float value, int decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, int decimalPlaces) {
+    char buf[64];
+    init();
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+    copy(buf, strlen(buf));
+}
+
+String::~String() {
+    free(_buffer);
+}
+
+String& String::operator=(const String& rhs) {
+    if(this != &rhs) {
+        copy(rhs._buffer, rhs._len);
+    }
+    return *this;
+}
+
+String& String::operator=(String&& rval) {
+    if(this != &rval) {
+        free(_buffer);
+        _buffer = rval._buffer;
+        _capacity = rval._capacity;
+        _len = rval._len;
+        rval.init();
+    }
+    return *this;
+}
+
+String& String::operator=(const char* cstr) {
+    if(cstr == NULL) {
+        copy("", 0);
+    } else {
+        copy(cstr, strlen(cstr));
+    }
+    return *this;
+}
+
+unsigned char String::concat(const char* cstr, unsigned int length) {
+    if(cstr == NULL) {
+        return 0;
+    }
+    reserve(_len + length);
+    memcpy(_buffer + _len, cstr, length);
+    _len += length;
+    _buffer[_len] = '\0';
+    return 1;
+}
+
+unsigned char String::concat(const String& str) { return concat(str._buffer, str._len); }
+unsigned char String::concat(const char* cstr) { return cstr == NULL ? 0 : concat(cstr, strlen(cstr)); }
+unsigned char String::concat(char c) { return concat(&c, 1); }
+unsigned char String::concat(unsigned char num) { return concat(String(num)); }
+unsigned char String::concat(int num) { return concat(String(num)); }
+unsigned char String::concat(unsigned int num) { return concat(String(num)); }
+unsigned char String::concat(long num) { return concat(String(num)); }
+unsigned char String::concat(unsigned long num) { return concat(String(num)); }
+unsigned char String::concat(float num) { return concat(String(num)); }
+unsigned char String::concat(double num) { return concat(String(num)); }
+
+String operator+(const String& lhs, const String& rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String& lhs, const char* cstr) {
+    String result(lhs);
+    result.concat(cstr);
+    return result;
+}
+
+int String::compareTo(const String& s) const {
+    return strcmp(_buffer, s._buffer);
+}
+
+unsigned char String::equals(const String& s) const {
+    return _len == s._len && compareTo(s) == 0;
+}
+
+unsigned char String::equals(const char* cstr) const {
+    if(_len == 0) {
+        return cstr == NULL || *cstr == '\0';
+    }
+    if(cstr == NULL) {
+        return _buffer[0] == '\0';
+    }
+    return strcmp(_buffer, cstr) == 0;
+}
+
+unsigned char String::equalsIgnoreCase(const String& s) const {
+    if(_len != s._len) {
+        return 0;
+    }
+    return strcasecmp(_buffer, s._buffer) == 0;
+}
+
+unsigned char String::startsWith(const String& prefix) const {
+    return _len >= prefix._len && strncmp(_buffer, prefix._buffer, prefix._len) == 0;
+}
+
+unsigned char String::endsWith(const String& suffix) const {
+    return _len >= suffix._len && strcmp(_buffer + _len - suffix._len, suffix._buffer) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+    return index < _len ? _buffer[index] : '\0';
+}
+
+void String::setCharAt(unsigned int index, char c) {
+    if(index < _len) {
+        _buffer[index] = c;
+    }
+}
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const {
+    if(bufsize == 0 || buf == NULL) {
+        return;
+    }
+    if(index >= _len) {
+        buf[0] = '\0';
+        return;
+    }
+    unsigned int n = bufsize - 1;
+    if(n > _len - index) {
+        n = _len - index;
+    }
+    memcpy(buf, _buffer + index, n);
+    buf[n] = '\0';
+}
+
+void String::toCharArray(char* buf, unsigned int bufsize, unsigned int index) const {
+    getBytes((unsigned char*)buf, bufsize, index);
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+    if(fromIndex >= _len) {
+        return -1;
+    }
+    const char* found = strchr(_buffer + fromIndex, ch);
+    return found == NULL ? -1 : (int)(found - _buffer);
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+    if(fromIndex >= _len) {
+        return -1;
+    }
+    const char* found = strstr(_buffer + fromIndex, str._buffer);
+    return found == NULL ? -1 : (int)(found - _buffer);
+}
+
+int String::lastIndexOf(char ch) const {
+    const char* found = strrchr(_buffer, ch);
+    return found == NULL ? -1 : (int)(found - _buffer);
+}
+
+String String::substring(unsigned int beginIndex) const {
+    return substring(beginIndex, _len);
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+    if(beginIndex > endIndex) {
+        unsigned int temp = endIndex;
+        endIndex = beginIndex;
+        beginIndex = temp;
+    }
+    String result;
+    if(beginIndex >= _len) {
+        return result;
+    }
+    if(endIndex > _len) {
+        endIndex = _len;
+    }
+    result.copy(_buffer + beginIndex, endIndex - beginIndex);
+    return result;
+}
+
+String& String::remove(unsigned int index) {
+    return remove(index, (unsigned int)-1);
+}
+
+String& String::remove(unsigned int index, unsigned int count) {
+    if(index >= _len || count == 0) {
+        return *this;
+    }
+    if(count > _len - index) {
+        count = _len - index;
+    }
+    memmove(_buffer + index, _buffer + index + count, _len - index - count);
+    _len -= count;
+    _buffer[_len] = '\0';
+    return *this;
+}
+
+String& String::toLowerCase() {
+    for(unsigned int i = 0; i < _len; i++) {
+        _buffer[i] = tolower(_buffer[i]);
+    }
+    return *this;
+}
+
+String& String::toUpperCase() {
+    for(unsigned int i = 0; i < _len; i++) {
+        _buffer[i] = toupper(_buffer[i]);
+    }
+    return *this;
+}
+
+String& String::trim() {
+    unsigned int begin = 0;
+    while(begin < _len && isspace(_buffer[begin])) {
+        begin++;
+    }
+    unsigned int end = _len;
+    while(end > begin && isspace(_buffer[end - 1])) {
+        end--;
+    }
+    memmove(_buffer, _buffer + begin, end - begin);
+    _len = end - begin;
+    _buffer[_len] = '\0';
+    return *this;
+}
+
+long String::toInt() const {
+    return atol(_buffer);
+}
+
+float String::toFloat() const {
+    return (float)atof(_buffer);
+}
+
+/* ========================================================================= */
+/* Print / Serial                                                            */
+/* ========================================================================= */
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while(size--) {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::print(const char* str) { return write(str); }
+size_t Print::print(const String& str) { return write(str.c_str()); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char value, int base) { return print((unsigned long)value, base); }
+size_t Print::print(int value, int base) { return print((long)value, base); }
+size_t Print::print(unsigned int value, int base) { return print((unsigned long)value, base); }
+
+size_t Print::print(long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(double value, int digits) {
+    return print(String(value, digits));
+}
+
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const char* str) { return print(str) + println(); }
+size_t Print::println(const String& str) { return print(str) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char value, int base) { return print(value, base) + println(); }
+size_t Print::println(int value, int base) { return print(value, base) + println(); }
+size_t Print::println(unsigned int value, int base) { return print(value, base) + println(); }
+size_t Print::println(long value, int base) { return print(value, base) + println(); }
+size_t Print::println(unsigned long value, int base) { return print(value, base) + println(); }
+size_t Print::println(double value, int digits) { return print(value, digits) + println(); }
+
+size_t Print::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    return print(buf);
+}
+
+USBSerial Serial;
+
+size_t USBSerial::write(uint8_t c) {
+    if(echo) {
+        fputc(c, stderr);
+    }
+    return 1;
+}
+
+/* ========================================================================= */
+/* EEPROM                                                                    */
+/* ========================================================================= */
+
+EEPROMClass EEPROM;
+
+uint8_t EEPROMClass::read(int address) {
+    if(address < 0 || address >= SIZE) {
+        return 0xFF;
+    }
+    return eeprom[address];
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if(address >= 0 && address < SIZE) {
+        eeprom[address] = value;
+    }
+}
+
+/* ========================================================================= */
+/* Cloud                                                                     */
+/* ========================================================================= */
+
+CloudClass Particle;
+WiFiClass WiFi;
+
+bool CloudClass::function(const char* name, user_function_t fn) {
+    // Like the real cloud, the first registration of a name wins
+    if(functions.count(name) != 0) {
+        return false;
+    }
+    functions[name] = fn;
+    return true;
+}
+
+bool CloudClass::variable(const char* name, const String& var) {
+    const String* ptr = &var;
+    return variable(name, std::function<String()>([ptr]() { return *ptr; }));
+}
+
+bool CloudClass::variable(const char* name, const int& var) {
+    const int* ptr = &var;
+    return variable(name, std::function<String()>([ptr]() { return String(*ptr); }));
+}
+
+bool CloudClass::variable(const char* name, const double& var) {
+    const double* ptr = &var;
+    return variable(name, std::function<String()>([ptr]() { return String(*ptr); }));
+}
+
+bool CloudClass::variable(const char* name, const char* var) {
+    return variable(name, std::function<String()>([var]() { return String(var); }));
+}
+
+bool CloudClass::variable(const char* name, std::function<String()> fn) {
+    if(variables.count(name) != 0) {
+        return false;
+    }
+    variables[name] = fn;
+    return true;
+}
+
+bool CloudClass::publish(const char* name, const char* data, int ttl, Spark_Event_TypeDef type) {
+    if(!cloudConnected) {
+        return false;
+    }
+
+    Ohmbrewer::Sim::Event event;
+    event.name = String(name);
+    event.data = String(data);
+    event.publishedAt = millis();
+    publishedEvents.push_back(event);
+
+    if(echo) {
+        fprintf(stderr, "[%10lu] %s: %s\n", event.publishedAt, name, data);
+    }
+
+    return true;
+}
+
+bool CloudClass::connected() {
+    return cloudConnected;
+}
+
+void CloudClass::connect() {
+    cloudConnected = true;
+}
+
+void CloudClass::disconnect() {
+    cloudConnected = false;
+}
+
+bool WiFiClass::ready() {
+    return cloudConnected;
+}
+
+/* ========================================================================= */
+/* Software timers                                                           */
+/* ========================================================================= */
+
+Timer::Timer(unsigned period, timer_callback_fn callback, bool oneShot) {
+    _period = period;
+    _callback = callback;
+    _oneShot = oneShot;
+    _active = false;
+    _startedAt = 0;
+    _next = timers;
+    timers = this;
+}
+
+Timer::~Timer() {
+    Timer** itr = &timers;
+    while(*itr != NULL) {
+        if(*itr == this) {
+            *itr = _next;
+            break;
+        }
+        itr = &((*itr)->_next);
+    }
+}
+
+void Timer::start() {
+    _active = true;
+    _startedAt = millis();
+}
+
+void Timer::stop() {
+    _active = false;
+}
+
+void Timer::reset() {
+    start();
+}
+
+void Timer::changePeriod(unsigned period) {
+    _period = period;
+    start();
+}
+
+bool Timer::nextDue(unsigned long long &dueUs) {
+    bool found = false;
+
+    for(Timer* itr = timers; itr != NULL; itr = itr->_next) {
+        unsigned long long due = ((unsigned long long)itr->_startedAt + itr->_period) * 1000;
+        if(itr->_active && (!found || due < dueUs)) {
+            dueUs = due;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+void Timer::serviceAll() {
+    if(servicingTimers) {
+        return;
+    }
+    servicingTimers = true;
+
+    for(Timer* itr = timers; itr != NULL; itr = itr->_next) {
+        if(itr->_active && (millis() - itr->_startedAt) >= itr->_period) {
+            itr->_startedAt += itr->_period;
+            if(itr->_oneShot) {
+                itr->_active = false;
+            }
+            itr->_callback();
+        }
+    }
+
+    servicingTimers = false;
+}
+
+/* ========================================================================= */
+/* SPI                                                                       */
+/* ========================================================================= */
+
+SPIClass SPI;
+
+namespace {
+
+    // The DMA transfer in flight, if any
+    const uint8_t* dmaData = NULL;
+    size_t dmaLength = 0;
+    wiring_spi_dma_transfercomplete_callback_t dmaCallback = NULL;
+    unsigned long long dmaDoneNs = 0;
+
+    // Nanoseconds the bus has spent on DMA transfers
+    unsigned long long dmaBusyNs = 0;
+}
+
+void SPIClass::transfer(void* tx_buffer, void* rx_buffer, size_t length,
+                        wiring_spi_dma_transfercomplete_callback_t user_callback) {
+    unsigned long long ns = Ohmbrewer::Sim::Internal::displayTransferNs(length);
+
+    dmaData = (const uint8_t*)tx_buffer;
+    dmaLength = length;
+    dmaCallback = user_callback;
+    dmaDoneNs = (nowUs * 1000) + ns;
+    dmaBusyNs += ns;
+}
+
+void SPIClass::transferCancel() {
+    dmaData = NULL;
+    dmaCallback = NULL;
+}
+
+void Ohmbrewer::Sim::Internal::resetSPI() {
+    dmaData = NULL;
+    dmaCallback = NULL;
+    dmaBusyNs = 0;
+}
+
+void Ohmbrewer::Sim::Internal::serviceSPI() {
+    if(dmaData != NULL && (nowUs * 1000) >= dmaDoneNs) {
+        wiring_spi_dma_transfercomplete_callback_t callback = dmaCallback;
+
+        displayData(dmaData, dmaLength);
+        dmaData = NULL;
+        dmaCallback = NULL;
+
+        // May start the next transfer
+        if(callback != NULL) {
+            callback();
+        }
+    }
+}
+
+unsigned long long Ohmbrewer::Sim::spiBusyMicros() {
+    return dmaBusyNs / 1000;
+}
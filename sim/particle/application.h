@@ -0,0 +1,386 @@
+/**
+ * Host stand-in for the Particle firmware's application.h.
+ * Provides just enough of the Wiring/Particle API for the Rhizome libraries to build and run on Linux, backed by
+ * the simulated clock, GPIO, EEPROM and cloud found in Ohmbrewer_Sim.h.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_SIM_APPLICATION_H
+#define OHMBREWER_SIM_APPLICATION_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <functional>
+
+using std::abs;
+
+/* ========================================================================= */
+/* Pins                                                                      */
+/* ========================================================================= */
+
+typedef uint16_t pin_t;
+
+const pin_t D0 = 0;
+const pin_t D1 = 1;
+const pin_t D2 = 2;
+const pin_t D3 = 3;
+const pin_t D4 = 4;
+const pin_t D5 = 5;
+const pin_t D6 = 6;
+const pin_t D7 = 7;
+const pin_t A0 = 10;
+const pin_t A1 = 11;
+const pin_t A2 = 12;
+const pin_t A3 = 13;
+const pin_t A4 = 14;
+const pin_t A5 = 15;
+const pin_t A6 = 16;
+const pin_t A7 = 17;
+const pin_t TOTAL_PINS = 24;
+
+#define LOW    0
+#define HIGH   1
+
+typedef enum {
+    INPUT, OUTPUT, INPUT_PULLUP, INPUT_PULLDOWN, AN_INPUT, AN_OUTPUT
+} PinMode;
+
+void pinMode(uint16_t pin, PinMode mode);
+void digitalWrite(uint16_t pin, uint8_t value);
+int32_t digitalRead(uint16_t pin);
+int32_t analogRead(uint16_t pin);
+void pinSetFast(uint16_t pin);
+void pinResetFast(uint16_t pin);
+
+/* ========================================================================= */
+/* Time                                                                      */
+/* ========================================================================= */
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+long map(long value, long fromStart, long fromEnd, long toStart, long toEnd);
+
+class TimeClass {
+    public:
+        /**
+         * @returns The current (simulated) Unix time
+         */
+        time_t now();
+};
+extern TimeClass Time;
+
+/* ========================================================================= */
+/* String                                                                    */
+/* ========================================================================= */
+
+/**
+ * A subset of the Wiring String class. Behaves like Particle's String where the Rhizome relies on it
+ * (e.g. NULL constructs an empty String, doubles default to 6 decimal places).
+ */
+class String {
+    public:
+        String(const char* cstr = "");
+        String(const String& str);
+        String(String&& rval);
+        explicit String(char c);
+        explicit String(unsigned char value, unsigned char base = 10);
+        explicit String(int value, unsigned char base = 10);
+        explicit String(unsigned int value, unsigned char base = 10);
+        explicit String(long value, unsigned char base = 10);
+        explicit String(unsigned long value, unsigned char base = 10);
+        explicit String(float value, int decimalPlaces = 6);
+        explicit String(double value, int decimalPlaces = 6);
+        ~String();
+
+        String& operator=(const String& rhs);
+        String& operator=(String&& rval);
+        String& operator=(const char* cstr);
+
+        unsigned char reserve(unsigned int size);
+        unsigned int length() const { return _len; }
+        const char* c_str() const { return _buffer; }
+
+        unsigned char concat(const String& str);
+        unsigned char concat(const char* cstr);
+        unsigned char concat(const char* cstr, unsigned int length);
+        unsigned char concat(char c);
+        unsigned char concat(unsigned char num);
+        unsigned char concat(int num);
+        unsigned char concat(unsigned int num);
+        unsigned char concat(long num);
+        unsigned char concat(unsigned long num);
+        unsigned char concat(float num);
+        unsigned char concat(double num);
+
+        String& operator+=(const String& rhs) { concat(rhs); return *this; }
+        String& operator+=(const char* cstr) { concat(cstr); return *this; }
+        String& operator+=(char c) { concat(c); return *this; }
+        String& operator+=(int num) { concat(num); return *this; }
+        String& operator+=(unsigned int num) { concat(num); return *this; }
+        String& operator+=(long num) { concat(num); return *this; }
+        String& operator+=(unsigned long num) { concat(num); return *this; }
+
+        friend String operator+(const String& lhs, const String& rhs);
+        friend String operator+(const String& lhs, const char* cstr);
+
+        int compareTo(const String& s) const;
+        unsigned char equals(const String& s) const;
+        unsigned char equals(const char* cstr) const;
+        unsigned char operator==(const String& rhs) const { return equals(rhs); }
+        unsigned char operator==(const char* cstr) const { return equals(cstr); }
+        unsigned char operator!=(const String& rhs) const { return !equals(rhs); }
+        unsigned char operator!=(const char* cstr) const { return !equals(cstr); }
+        unsigned char operator<(const String& rhs) const { return compareTo(rhs) < 0; }
+        unsigned char operator>(const String& rhs) const { return compareTo(rhs) > 0; }
+        unsigned char equalsIgnoreCase(const String& s) const;
+        unsigned char startsWith(const String& prefix) const;
+        unsigned char endsWith(const String& suffix) const;
+
+        char charAt(unsigned int index) const;
+        void setCharAt(unsigned int index, char c);
+        char operator[](unsigned int index) const { return charAt(index); }
+        void getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index = 0) const;
+        void toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const;
+
+        int indexOf(char ch, unsigned int fromIndex = 0) const;
+        int indexOf(const String& str, unsigned int fromIndex = 0) const;
+        int lastIndexOf(char ch) const;
+        String substring(unsigned int beginIndex) const;
+        String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+        String& remove(unsigned int index);
+        String& remove(unsigned int index, unsigned int count);
+        String& toLowerCase();
+        String& toUpperCase();
+        String& trim();
+
+        long toInt() const;
+        float toFloat() const;
+
+    private:
+        char* _buffer;
+        unsigned int _capacity;
+        unsigned int _len;
+
+        void init();
+        void copy(const char* cstr, unsigned int length);
+};
+
+/* ========================================================================= */
+/* Print / Serial                                                            */
+/* ========================================================================= */
+
+#define DEC 10
+#define HEX 16
+
+/**
+ * Base class for anything that renders text, mirroring Wiring's Print.
+ */
+class Print {
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t* buffer, size_t size);
+        size_t write(const char* str) { return str == NULL ? 0 : write((const uint8_t*)str, strlen(str)); }
+
+        size_t print(const char* str);
+        size_t print(const String& str);
+        size_t print(char c);
+        size_t print(unsigned char value, int base = DEC);
+        size_t print(int value, int base = DEC);
+        size_t print(unsigned int value, int base = DEC);
+        size_t print(long value, int base = DEC);
+        size_t print(unsigned long value, int base = DEC);
+        size_t print(double value, int digits = 2);
+
+        size_t println();
+        size_t println(const char* str);
+        size_t println(const String& str);
+        size_t println(char c);
+        size_t println(unsigned char value, int base = DEC);
+        size_t println(int value, int base = DEC);
+        size_t println(unsigned int value, int base = DEC);
+        size_t println(long value, int base = DEC);
+        size_t println(unsigned long value, int base = DEC);
+        size_t println(double value, int digits = 2);
+
+        size_t printf(const char* format, ...);
+};
+
+/**
+ * USB serial. Output is discarded unless echoing is enabled via Ohmbrewer::Sim::setEcho().
+ */
+class USBSerial : public Print {
+    public:
+        void begin(long baud) {}
+        int available() { return 0; }
+        int read() { return -1; }
+        size_t write(uint8_t c);
+        using Print::write;
+};
+extern USBSerial Serial;
+
+/* ========================================================================= */
+/* EEPROM                                                                    */
+/* ========================================================================= */
+
+class EEPROMClass {
+    public:
+        static const int SIZE = 2048;
+
+        uint8_t read(int address);
+        void write(int address, uint8_t value);
+        uint16_t length() { return SIZE; }
+
+        template <typename T> T& get(int address, T& value) {
+            uint8_t* ptr = (uint8_t*)&value;
+            for(unsigned int i = 0; i < sizeof(T); i++) {
+                ptr[i] = read(address + i);
+            }
+            return value;
+        }
+
+        template <typename T> const T& put(int address, const T& value) {
+            const uint8_t* ptr = (const uint8_t*)&value;
+            for(unsigned int i = 0; i < sizeof(T); i++) {
+                write(address + i, ptr[i]);
+            }
+            return value;
+        }
+};
+extern EEPROMClass EEPROM;
+
+/* ========================================================================= */
+/* Cloud                                                                     */
+/* ========================================================================= */
+
+typedef enum {
+    PUBLIC = 0, PRIVATE = 1
+} Spark_Event_TypeDef;
+
+typedef std::function<int(String)> user_function_t;
+
+/**
+ * The in-memory Particle cloud. Functions, variables and published events are recorded and
+ * can be driven from the host via Ohmbrewer::Sim.
+ */
+class CloudClass {
+    public:
+        bool function(const char* name, user_function_t fn);
+        bool function(const char* name, int (*fn)(String)) { return function(name, user_function_t(fn)); }
+
+        template <typename T>
+        bool function(const char* name, int (T::*fn)(String), T* instance) {
+            return function(name, user_function_t(std::bind(fn, instance, std::placeholders::_1)));
+        }
+
+        bool variable(const char* name, const String& var);
+        bool variable(const char* name, const int& var);
+        bool variable(const char* name, const double& var);
+        bool variable(const char* name, const char* var);
+        bool variable(const char* name, std::function<String()> fn);
+
+        bool publish(const char* name, const char* data, int ttl = 60, Spark_Event_TypeDef type = PUBLIC);
+        bool publish(const String& name, const String& data, int ttl = 60, Spark_Event_TypeDef type = PUBLIC) {
+            return publish(name.c_str(), data.c_str(), ttl, type);
+        }
+
+        bool connected();
+        void connect();
+        void disconnect();
+        void process() {}
+};
+extern CloudClass Particle;
+#define Spark Particle
+
+class WiFiClass {
+    public:
+        bool ready();
+};
+extern WiFiClass WiFi;
+
+/* ========================================================================= */
+/* Software timers                                                           */
+/* ========================================================================= */
+
+/**
+ * A software timer. On the host, due timers are serviced whenever the clock moves, so like the Photon's timer thread
+ * they run even while loop() is busy.
+ */
+class Timer {
+    public:
+        typedef std::function<void(void)> timer_callback_fn;
+
+        Timer(unsigned period, timer_callback_fn callback, bool oneShot = false);
+
+        template <typename T>
+        Timer(unsigned period, void (T::*handler)(), T& instance, bool oneShot = false) :
+            Timer(period, std::bind(handler, &instance), oneShot) {}
+
+        virtual ~Timer();
+
+        void start();
+        void stop();
+        void reset();
+        void changePeriod(unsigned period);
+        bool isActive() const { return _active; }
+
+        /**
+         * Fires every active Timer whose period has elapsed. Does nothing if called from a Timer's callback.
+         */
+        static void serviceAll();
+
+        /**
+         * Finds when the next active Timer comes due
+         * @param dueUs Set to the time it's due, in microseconds
+         * @returns Whether there's an active Timer
+         */
+        static bool nextDue(unsigned long long &dueUs);
+
+    private:
+        unsigned _period;
+        timer_callback_fn _callback;
+        bool _oneShot;
+        bool _active;
+        unsigned long _startedAt;
+        Timer* _next;
+};
+
+/* ========================================================================= */
+/* SPI                                                                       */
+/* ========================================================================= */
+
+typedef void (*wiring_spi_dma_transfercomplete_callback_t)(void);
+
+/**
+ * The SPI bus. Only DMA transfers are simulated, and the ILI9341 is the only thing on the bus: the bytes land in its
+ * address window once the transfer completes, Adafruit_ILI9341::NS_PER_PIXEL per two bytes after it started. The
+ * caller isn't charged for that time. The callback runs when the clock passes the end of the transfer, as the DMA
+ * interrupt would.
+ */
+class SPIClass {
+    public:
+        void begin() {}
+        void transfer(void* tx_buffer, void* rx_buffer, size_t length,
+                      wiring_spi_dma_transfercomplete_callback_t user_callback);
+        void transferCancel();
+};
+extern SPIClass SPI;
+
+/* ========================================================================= */
+/* System                                                                    */
+/* ========================================================================= */
+
+typedef enum {
+    AUTOMATIC, SEMI_AUTOMATIC, MANUAL
+} System_Mode_TypeDef;
+
+#define SYSTEM_MODE(mode) static const System_Mode_TypeDef __system_mode = (mode)
+
+#endif
@@ -0,0 +1,20 @@
+/**
+ * Host stand-in for the particle-ds18x20 library's crc8.h.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_SIM_CRC8_H
+#define OHMBREWER_SIM_CRC8_H
+
+#include "application.h"
+
+#define CRC8INIT  0x00
+#define CRC8POLY  0x18
+
+/**
+ * The Dallas/Maxim CRC8 used by ROM codes and scratchpads.
+ * @returns 0 when run over data that ends in its own valid CRC
+ */
+uint8_t crc8(uint8_t* data, uint16_t number_of_bytes_in_data);
+
+#endif
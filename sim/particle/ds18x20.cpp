@@ -0,0 +1,311 @@
+#include <vector>
+#include <algorithm>
+#include "ds18x20.h"
+#include "onewire.h"
+#include "crc8.h"
+#include "sim_internal.h"
+#include "Ohmbrewer_Sim.h"
+
+namespace {
+
+    // Standard speed: a reset slot is ~960us, a read/write slot ~70us
+    const unsigned long RESET_US = 960;
+    const unsigned long SLOT_US = 70;
+
+    struct SimProbe {
+        uint8_t rom[OW_ROMCODE_SIZE];
+        double tempC;            // What the probe is sitting in right now
+        int16_t scratchpad;      // Last completed conversion, in 1/16ths of a degree
+        int16_t pending;         // The conversion in progress
+        unsigned long long convertingUntil;
+        bool converting;
+        bool present;
+        bool corrupt;
+    };
+
+    std::vector<SimProbe> probes SIM_STATE;
+    unsigned long conversions = 0;
+    unsigned long searches = 0;
+    unsigned long reads = 0;
+    uint8_t generatedSerial = 0;
+
+    void chargeSlots(unsigned long slots) {
+        Ohmbrewer::Sim::advanceMicros((unsigned long long)slots * SLOT_US);
+    }
+
+    void chargeReset() {
+        Ohmbrewer::Sim::advanceMicros(RESET_US);
+    }
+
+    void chargeBytes(unsigned long bytes) {
+        chargeSlots(bytes * 8);
+    }
+
+    int16_t toRaw(double tempC) {
+        return (int16_t)lround(tempC * 16.0);
+    }
+
+    /**
+     * Moves finished conversions into the scratchpad
+     */
+    void settle() {
+        for(unsigned int i = 0; i < probes.size(); i++) {
+            if(probes[i].converting && Ohmbrewer::Sim::nowMicros() >= probes[i].convertingUntil) {
+                probes[i].scratchpad = probes[i].pending;
+                probes[i].converting = false;
+            }
+        }
+    }
+
+    bool anyPresent() {
+        for(unsigned int i = 0; i < probes.size(); i++) {
+            if(probes[i].present) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    SimProbe* findProbe(const uint8_t* id) {
+        for(unsigned int i = 0; i < probes.size(); i++) {
+            if(probes[i].present && memcmp(probes[i].rom, id, OW_ROMCODE_SIZE) == 0) {
+                return &probes[i];
+            }
+        }
+        return NULL;
+    }
+
+    /**
+     * ROM search order: bits are walked least significant first, taking the 0 branch first.
+     */
+    bool searchOrder(const SimProbe* a, const SimProbe* b) {
+        for(int bit = 0; bit < OW_ROMCODE_SIZE * 8; bit++) {
+            int aBit = (a->rom[bit / 8] >> (bit % 8)) & 0x1;
+            int bBit = (b->rom[bit / 8] >> (bit % 8)) & 0x1;
+            if(aBit != bBit) {
+                return aBit < bBit;
+            }
+        }
+        return false;
+    }
+
+    bool validHandle(int handle) {
+        return handle >= 0 && (unsigned int)handle < probes.size();
+    }
+
+    void startConversion(SimProbe& probe) {
+        probe.pending = toRaw(probe.tempC);
+        probe.converting = true;
+        probe.convertingUntil = Ohmbrewer::Sim::nowMicros() + (unsigned long long)DS18B20_TCONV_12BIT * 1000;
+    }
+}
+
+void Ohmbrewer::Sim::Internal::resetOneWire() {
+    probes.clear();
+    conversions = 0;
+    searches = 0;
+    reads = 0;
+    generatedSerial = 0;
+}
+
+int Ohmbrewer::Sim::addProbe(const uint8_t rom[8], double tempC) {
+    SimProbe probe;
+    memcpy(probe.rom, rom, OW_ROMCODE_SIZE);
+    probe.rom[OW_ROMCODE_SIZE - 1] = crc8(probe.rom, OW_ROMCODE_SIZE - 1);
+    probe.tempC = tempC;
+    probe.scratchpad = toRaw(85.0); // Power-on reset value
+    probe.pending = probe.scratchpad;
+    probe.convertingUntil = 0;
+    probe.converting = false;
+    probe.present = true;
+    probe.corrupt = false;
+    probes.push_back(probe);
+    return (int)probes.size() - 1;
+}
+
+int Ohmbrewer::Sim::addProbe(double tempC) {
+    // Serial numbers scattered across the ROM so search order doesn't simply follow insertion order
+    uint8_t rom[8] = { DS18B20_FAMILY_CODE, 0, 0, 0, 0, 0, 0, 0 };
+    generatedSerial++;
+    rom[1] = (uint8_t)(generatedSerial * 0x5B);
+    rom[2] = (uint8_t)(generatedSerial * 0x3D + 0x11);
+    rom[3] = 0x04;
+    rom[4] = 0x16;
+    rom[5] = 0xA2;
+    return addProbe(rom, tempC);
+}
+
+void Ohmbrewer::Sim::setProbeTemp(int handle, double tempC) {
+    if(validHandle(handle)) {
+        probes[handle].tempC = tempC;
+    }
+}
+
+void Ohmbrewer::Sim::setProbePresent(int handle, bool present) {
+    if(validHandle(handle)) {
+        probes[handle].present = present;
+    }
+}
+
+void Ohmbrewer::Sim::setProbeCorrupt(int handle, bool corrupt) {
+    if(validHandle(handle)) {
+        probes[handle].corrupt = corrupt;
+    }
+}
+
+void Ohmbrewer::Sim::getProbeRom(int handle, uint8_t rom[8]) {
+    if(validHandle(handle)) {
+        memcpy(rom, probes[handle].rom, OW_ROMCODE_SIZE);
+    }
+}
+
+unsigned long Ohmbrewer::Sim::busConversions() {
+    return conversions;
+}
+
+unsigned long Ohmbrewer::Sim::busSearches() {
+    return searches;
+}
+
+unsigned long Ohmbrewer::Sim::busReads() {
+    return reads;
+}
+
+/* ========================================================================= */
+/* crc8.h                                                                    */
+/* ========================================================================= */
+
+uint8_t crc8(uint8_t* data, uint16_t number_of_bytes_in_data) {
+    uint8_t crc = CRC8INIT;
+
+    for(uint16_t loop_count = 0; loop_count != number_of_bytes_in_data; loop_count++) {
+        uint8_t b = data[loop_count];
+        uint8_t bit_counter = 8;
+        do {
+            uint8_t feedback_bit = (crc ^ b) & 0x01;
+            if(feedback_bit == 0x01) {
+                crc = crc ^ CRC8POLY;
+            }
+            crc = (crc >> 1) & 0x7F;
+            if(feedback_bit == 0x01) {
+                crc = crc | 0x80;
+            }
+            b = b >> 1;
+            bit_counter--;
+        } while(bit_counter > 0);
+    }
+
+    return crc;
+}
+
+/* ========================================================================= */
+/* onewire.h                                                                 */
+/* ========================================================================= */
+
+void ow_setPin(uint8_t pin) {
+    // Only one bus is simulated
+}
+
+uint8_t ow_reset(void) {
+    chargeReset();
+    return anyPresent() ? 0 : 1;
+}
+
+uint8_t ow_search_sensors(uint8_t num, uint8_t* sensors) {
+    std::vector<const SimProbe*> found;
+
+    searches++;
+    settle();
+
+    for(unsigned int i = 0; i < probes.size(); i++) {
+        if(probes[i].present) {
+            found.push_back(&probes[i]);
+        }
+    }
+    std::sort(found.begin(), found.end(), searchOrder);
+
+    // Every device found costs a reset, the search command and 64 triplets of slots
+    chargeReset();
+    chargeBytes(1);
+    uint8_t count = 0;
+    for(unsigned int i = 0; i < found.size() && count < num; i++, count++) {
+        chargeSlots(OW_ROMCODE_SIZE * 8 * 3);
+        memcpy(&sensors[count * OW_ROMCODE_SIZE], found[i]->rom, OW_ROMCODE_SIZE);
+        if(i + 1 < found.size()) {
+            chargeReset();
+            chargeBytes(1);
+        }
+    }
+
+    return count;
+}
+
+/* ========================================================================= */
+/* ds18x20.h                                                                 */
+/* ========================================================================= */
+
+uint8_t DS18X20_start_meas(uint8_t with_power_extern, uint8_t id[]) {
+    if(ow_reset() != 0) {
+        return DS18X20_START_FAIL;
+    }
+
+    conversions++;
+    settle();
+
+    if(id == NULL) {
+        // Skip ROM + Convert T
+        chargeBytes(2);
+        for(unsigned int i = 0; i < probes.size(); i++) {
+            if(probes[i].present) {
+                startConversion(probes[i]);
+            }
+        }
+    } else {
+        // Match ROM + ROM code + Convert T
+        chargeBytes(2 + OW_ROMCODE_SIZE);
+        SimProbe* probe = findProbe(id);
+        if(probe != NULL) {
+            startConversion(*probe);
+        }
+    }
+
+    return DS18X20_OK;
+}
+
+uint8_t DS18X20_conversion_in_progress(void) {
+    chargeSlots(1);
+    settle();
+    for(unsigned int i = 0; i < probes.size(); i++) {
+        if(probes[i].present && probes[i].converting) {
+            return DS18X20_CONVERTING;
+        }
+    }
+    return DS18X20_CONVERSION_DONE;
+}
+
+uint8_t DS18X20_read_meas(uint8_t id[], uint8_t* subzero, uint8_t* cel, uint8_t* cel_frac_bits) {
+    reads++;
+
+    // Reset + Match ROM + ROM code + Read Scratchpad + the scratchpad itself
+    chargeReset();
+    chargeBytes(2 + OW_ROMCODE_SIZE + DS18X20_SP_SIZE);
+    settle();
+
+    SimProbe* probe = findProbe(id);
+    if(probe == NULL || probe->corrupt) {
+        // Nobody drove the bus (all 1s) or the scratchpad was garbled; either way the CRC fails
+        return DS18X20_ERROR_CRC;
+    }
+
+    // A read during a conversion returns the previous scratchpad, like the real part
+    int16_t meas = probe->scratchpad;
+    *subzero = 0;
+    if(meas < 0) {
+        meas = -meas;
+        *subzero = 1;
+    }
+    *cel = (uint8_t)(meas >> 4);
+    *cel_frac_bits = (uint8_t)(meas & 0x000F);
+
+    return DS18X20_OK;
+}
@@ -0,0 +1,53 @@
+/**
+ * Host stand-in for the particle-ds18x20 library's ds18x20.h.
+ * Simulated DS18B20s latch their temperature when a conversion starts and only expose it once the 750ms
+ * conversion has finished; before then the scratchpad still holds the previous value (85C at power-on).
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_SIM_DS18X20_H
+#define OHMBREWER_SIM_DS18X20_H
+
+#include "application.h"
+#include "onewire.h"
+
+#define DS18S20_FAMILY_CODE 0x10
+#define DS18B20_FAMILY_CODE 0x28
+
+#define DS18X20_OK          0x00
+#define DS18X20_ERROR       0x01
+#define DS18X20_START_FAIL  0x02
+#define DS18X20_ERROR_CRC   0x03
+
+#define DS18X20_POWER_PARASITE 0x00
+#define DS18X20_POWER_EXTERN   0x01
+
+#define DS18X20_CONVERSION_DONE 0x00
+#define DS18X20_CONVERTING      0x01
+
+#define DS18X20_CONVERT_T       0x44
+#define DS18X20_READ            0xBE
+
+#define DS18B20_TCONV_12BIT     750
+
+#define DS18X20_FRACCONV        625
+#define DS18X20_SP_SIZE         9
+
+/**
+ * Starts a temperature conversion on one device, or on every device when id is NULL.
+ * @returns DS18X20_OK or DS18X20_START_FAIL if nothing is on the bus
+ */
+uint8_t DS18X20_start_meas(uint8_t with_power_extern, uint8_t id[]);
+
+/**
+ * @returns DS18X20_CONVERTING while any conversion is still running, DS18X20_CONVERSION_DONE otherwise
+ */
+uint8_t DS18X20_conversion_in_progress(void);
+
+/**
+ * Reads the scratchpad of the given device and decodes its temperature.
+ * @returns DS18X20_OK or DS18X20_ERROR_CRC
+ */
+uint8_t DS18X20_read_meas(uint8_t id[], uint8_t* subzero, uint8_t* cel, uint8_t* cel_frac_bits);
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * Host stand-in for the particle-ds18x20 library's onewire.h.
+ * The bus is simulated (see Ohmbrewer::Sim::addProbe()); each bus operation costs roughly the time it would take at
+ * standard OneWire speed, charged to the virtual clock.
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_SIM_ONEWIRE_H
+#define OHMBREWER_SIM_ONEWIRE_H
+
+#include "application.h"
+
+#define OW_MATCH_ROM    0x55
+#define OW_SKIP_ROM     0xCC
+#define OW_SEARCH_ROM   0xF0
+
+#define OW_SEARCH_FIRST 0xFF
+#define OW_PRESENCE_ERR 0xFF
+#define OW_DATA_ERR     0xFE
+#define OW_LAST_DEVICE  0x00
+
+#define OW_ROMCODE_SIZE 8
+
+/**
+ * Selects the pin the bus is on.
+ */
+void ow_setPin(uint8_t pin);
+
+/**
+ * Resets the bus.
+ * @returns 0 if at least one device answered with a presence pulse, 1 otherwise
+ */
+uint8_t ow_reset(void);
+
+/**
+ * Searches the bus, filling sensors with the ROM codes of up to num devices, OW_ROMCODE_SIZE bytes apiece.
+ * Devices come back in ROM search order (least significant bit first, 0 branch before 1).
+ * @returns The number of devices found
+ */
+uint8_t ow_search_sensors(uint8_t num, uint8_t* sensors);
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * Host stand-in for the Spark-PID library (Brett Beauregard's Arduino PID Library v1.1.1).
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#ifndef OHMBREWER_SIM_PID_H
+#define OHMBREWER_SIM_PID_H
+
+#include "application.h"
+
+class PID {
+    public:
+        static const uint8_t AUTOMATIC = 1;
+        static const uint8_t MANUAL    = 0;
+        static const uint8_t DIRECT    = 0;
+        static const uint8_t REVERSE   = 1;
+
+        PID(double* Input, double* Output, double* Setpoint, double Kp, double Ki, double Kd, int ControllerDirection);
+
+        void SetMode(int Mode);
+        bool Compute();
+        void SetOutputLimits(double Min, double Max);
+        void SetTunings(double Kp, double Ki, double Kd);
+        void SetControllerDirection(int Direction);
+        void SetSampleTime(int NewSampleTime);
+
+        double GetKp();
+        double GetKi();
+        double GetKd();
+        int GetMode();
+        int GetDirection();
+
+    private:
+        void Initialize();
+
+        double dispKp;
+        double dispKi;
+        double dispKd;
+
+        double kp;
+        double ki;
+        double kd;
+
+        int controllerDirection;
+
+        double* myInput;
+        double* myOutput;
+        double* mySetpoint;
+
+        unsigned long lastTime;
+        double ITerm, lastInput;
+
+        unsigned long SampleTime;
+        double outMin, outMax;
+        bool inAuto;
+};
+
+#endif
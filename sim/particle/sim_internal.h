@@ -0,0 +1,41 @@
+/**
+ * Hooks shared between the host stand-ins for the Particle libraries.
+ * Not for use by the Rhizome libraries themselves - use Ohmbrewer_Sim.h instead.
+ */
+
+#ifndef OHMBREWER_SIM_INTERNAL_H
+#define OHMBREWER_SIM_INTERNAL_H
+
+/**
+ * Marks simulation state that must be constructed before any of the firmware's globals (e.g. the Rhizome
+ * itself, whose constructor registers cloud functions and reads EEPROM).
+ */
+#define SIM_STATE __attribute__((init_priority(101)))
+
+namespace Ohmbrewer {
+    namespace Sim {
+        namespace Internal {
+            void resetOneWire();
+            void resetTouch();
+            void resetDisplay();
+            void resetSPI();
+
+            /**
+             * Moves any DMA transfer along, now that the clock has moved
+             */
+            void serviceSPI();
+
+            /**
+             * Receives pixel data (big-endian RGB565) into the ILI9341's current address window
+             */
+            void displayData(const uint8_t* data, size_t length);
+
+            /**
+             * @returns How long a transfer of length bytes keeps the bus busy, in nanoseconds
+             */
+            unsigned long long displayTransferNs(size_t length);
+        };
+    };
+};
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * Micro-benchmark for the Thermostat's PID loop. Feeds the same mash temperatures, one per sample time, to the
+ * fixed point PIDController and to the Arduino PID library it replaced (sim/particle/pid.h), picking the gains the
+ * way the Thermostat did before it had a GainSchedule, and reports the time per pass and how closely the outputs agree.
+ *
+ *   rhizome_pid_bench [SAMPLES]
+ *
+ * The temperatures stay within the conservative band, so both loops run on the same gains throughout and any
+ * difference in output is the fixed point's rounding. Switching gains is bumpless in PIDController and not in the
+ * library, so runs that cross the band diverge by design; rhizome_thermal_bench covers those in closed loop.
+ *
+ * This runs on the host, which has an FPU. The Photon's Cortex-M3 doesn't, so the library's doubles are software
+ * routines there, and the gap on the device is wider than the one reported here.
+ *
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "pid.h"
+#include "Ohmbrewer_Sim.h"
+#include "Ohmbrewer_PID_Controller.h"
+#include "Ohmbrewer_Temperature.h"
+
+namespace {
+
+    const double TARGET_C = 66.0;
+    const int WINDOW_SIZE = 5000;
+    const int32_t AGGRESSIVE_GAP = 10 * Ohmbrewer::Temperature::ONE_DEGREE;
+
+    // The Thermostat's old tunings, now GainSchedule's defaults
+    Ohmbrewer::PIDProfile agg = Ohmbrewer::PIDProfile(1000, 20, 0);
+    Ohmbrewer::PIDProfile cons = Ohmbrewer::PIDProfile(600, 10, 0);
+
+    /**
+     * A mash wandering a few degrees either side of the target, in 1/16ths, with a little probe noise
+     */
+    std::vector<int32_t> makeReadings(unsigned long samples) {
+        std::vector<int32_t> readings;
+        uint32_t seed = 12345;
+
+        for(unsigned long i = 0; i < samples; i++) {
+            seed = seed * 1103515245 + 12345;
+            double wander = 3.0 * sin(i / 500.0);
+            int32_t noise = (int32_t)((seed >> 16) % 3) - 1;
+            readings.push_back(Ohmbrewer::Temperature::toRaw(TARGET_C + wander) + noise);
+        }
+
+        return readings;
+    }
+
+    double nsPerSample(std::chrono::steady_clock::time_point start, unsigned long samples) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / samples;
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned long samples = 200000;
+
+    if(argc > 2 || (argc == 2 && (samples = strtoul(argv[1], NULL, 10)) == 0)) {
+        fprintf(stderr, "usage: %s [SAMPLES]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<int32_t> readings = makeReadings(samples);
+    std::vector<int32_t> libraryOutputs(samples);
+    std::vector<int32_t> fixedOutputs(samples);
+    int32_t target = Ohmbrewer::Temperature::toRaw(TARGET_C);
+
+    // The library, as the Thermostat used it
+    double setPoint = TARGET_C;
+    double input = readings[0] / (double)Ohmbrewer::Temperature::ONE_DEGREE;
+    double output = 0;
+    PID library(&input, &output, &setPoint, cons.kP(), cons.kI(), cons.kD(), PID::DIRECT);
+    library.SetOutputLimits(0, WINDOW_SIZE);
+    library.SetMode(PID::AUTOMATIC);
+
+    // Its replacement
+    Ohmbrewer::PIDController fixed(0, WINDOW_SIZE, Ohmbrewer::Temperature::ONE_DEGREE);
+    Ohmbrewer::PIDController::Gains aggGains;
+    Ohmbrewer::PIDController::Gains consGains;
+    fixed.makeGains(agg, aggGains);
+    fixed.makeGains(cons, consGains);
+    fixed.setGains(consGains);
+    fixed.setAutomatic(true, readings[0]);
+
+    // Both compute once per sample time, so the clock has to move on each pass. Time that on its own first.
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < samples; i++) {
+        Ohmbrewer::Sim::advance(Ohmbrewer::PIDController::DEFAULT_SAMPLE_TIME);
+    }
+    double clockNs = nsPerSample(start, samples);
+
+    start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < samples; i++) {
+        Ohmbrewer::Sim::advance(Ohmbrewer::PIDController::DEFAULT_SAMPLE_TIME);
+        input = readings[i] / (double)Ohmbrewer::Temperature::ONE_DEGREE;
+        if(std::abs(target - readings[i]) < AGGRESSIVE_GAP) {
+            library.SetTunings(cons.kP(), cons.kI(), cons.kD());
+        } else {
+            library.SetTunings(agg.kP(), agg.kI(), agg.kD());
+        }
+        library.Compute();
+        libraryOutputs[i] = (int32_t)lround(output);
+    }
+    double libraryNs = nsPerSample(start, samples) - clockNs;
+
+    start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < samples; i++) {
+        Ohmbrewer::Sim::advance(Ohmbrewer::PIDController::DEFAULT_SAMPLE_TIME);
+        if(std::abs(target - readings[i]) < AGGRESSIVE_GAP) {
+            fixed.setGains(consGains);
+        } else {
+            fixed.setGains(aggGains);
+        }
+        fixed.compute(readings[i], target);
+        fixedOutputs[i] = fixed.getOutput();
+    }
+    double fixedNs = nsPerSample(start, samples) - clockNs;
+
+    int32_t maxDiff = 0;
+    double totalDiff = 0;
+    for(unsigned long i = 0; i < samples; i++) {
+        int32_t diff = std::abs(libraryOutputs[i] - fixedOutputs[i]);
+        maxDiff = diff > maxDiff ? diff : maxDiff;
+        totalDiff += diff;
+    }
+
+    printf("%lu samples, outputs 0-%d ms\n\n", samples, WINDOW_SIZE);
+    printf("%-8s %12s %14s\n", "loop", "ns/pass", "bytes/loop");
+    printf("%-8s %12.2f %14u\n", "library", libraryNs, (unsigned int)(sizeof(PID) + 3 * sizeof(double)));
+    printf("%-8s %12.2f %14u\n", "fixed", fixedNs, (unsigned int)sizeof(Ohmbrewer::PIDController));
+    printf("\nfixed point is %.2fx the speed of the library on this host\n", libraryNs / fixedNs);
+    printf("output difference: max %d ms, mean %.3f ms\n", maxDiff, totalDiff / samples);
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+/**
+ * Host-side driver for the Rhizome firmware. Runs firmware/rhizome.ino against the simulated hardware in
+ * sim/particle and takes commands, one per line, on stdin. Every command is answered with a single line
+ * beginning with "ok" or "error" (the events command prints its events first). "ok ready" is printed once
+ * setup() has run.
+ *
+ *   probe TEMP              Attaches a DS18B20 reading TEMP degrees C, replies with its handle
+ *   probe-temp HANDLE TEMP  Changes the temperature a probe will read
+ *   probe-present HANDLE 0|1
+ *   rom HANDLE              Replies with the probe's ROM code, as accepted by the add function
+ *   call NAME [ARGS]        Calls a Particle.function, replies with its return value
+ *   var NAME                Reads a Particle.variable
+ *   run MS                  Runs loop() for MS simulated milliseconds, replies with the number of passes
+ *   events                  Prints "event NAME DATA" for each event published since the last call
+ *   connect 0|1             Connects or disconnects the simulated cloud
+ *   touch X Y Z / release   Presses or lifts the touchscreen
+ *   screen FILE             Writes what's on the display to FILE, as a binary PPM image
+ *   time                    Replies with millis()
+ *   now                     Replies with Time.now(), the simulated Unix time
+ *   quit
+ *
+ * Command line options (all before setup() runs):
+ *   --probe TEMP            Attaches a probe, may be repeated
+ *   --echo                  Echoes Serial output and published events to stderr
+ *
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "Ohmbrewer_Sim.h"
+
+// The firmware itself. Arduino-style .ino files are plain C++ once the prototypes are known.
+void setup();
+void loop();
+#include "../firmware/rhizome.ino"
+
+namespace {
+
+    /**
+     * Answers a command
+     */
+    void reply(const std::string& status, const std::string& detail = "") {
+        std::cout << status;
+        if(!detail.empty()) {
+            std::cout << " " << detail;
+        }
+        std::cout << std::endl;
+    }
+
+    /**
+     * Formats a probe's ROM code as 16 hex digits, family code first
+     */
+    std::string romString(int handle) {
+        uint8_t rom[8];
+        char hex[17];
+        Ohmbrewer::Sim::getProbeRom(handle, rom);
+        for(int i = 0; i < 8; i++) {
+            snprintf(hex + (2 * i), 3, "%02X", rom[i]);
+        }
+        return std::string(hex);
+    }
+
+    /**
+     * Runs a single command
+     * @returns False once the driver should exit
+     */
+    bool runCommand(const std::string& line) {
+        std::istringstream in(line);
+        std::string cmd;
+        in >> cmd;
+
+        if(cmd.empty() || cmd[0] == '#') {
+            return true;
+        } else if(cmd == "quit") {
+            reply("ok");
+            return false;
+        } else if(cmd == "probe") {
+            double tempC;
+            if(!(in >> tempC)) {
+                reply("error", "usage: probe TEMP");
+            } else {
+                reply("ok", std::to_string(Ohmbrewer::Sim::addProbe(tempC)));
+            }
+        } else if(cmd == "probe-temp") {
+            int handle;
+            double tempC;
+            if(!(in >> handle >> tempC)) {
+                reply("error", "usage: probe-temp HANDLE TEMP");
+            } else {
+                Ohmbrewer::Sim::setProbeTemp(handle, tempC);
+                reply("ok");
+            }
+        } else if(cmd == "probe-present") {
+            int handle, present;
+            if(!(in >> handle >> present)) {
+                reply("error", "usage: probe-present HANDLE 0|1");
+            } else {
+                Ohmbrewer::Sim::setProbePresent(handle, present != 0);
+                reply("ok");
+            }
+        } else if(cmd == "rom") {
+            int handle;
+            if(!(in >> handle)) {
+                reply("error", "usage: rom HANDLE");
+            } else {
+                reply("ok", romString(handle));
+            }
+        } else if(cmd == "call") {
+            std::string name, args;
+            int result;
+            in >> name;
+            in >> args;
+            if(name.empty()) {
+                reply("error", "usage: call NAME [ARGS]");
+            } else if(!Ohmbrewer::Sim::callFunction(name.c_str(), String(args.c_str()), result)) {
+                reply("error", "no such function " + name);
+            } else {
+                reply("ok", std::to_string(result));
+            }
+        } else if(cmd == "var") {
+            std::string name;
+            String value;
+            in >> name;
+            if(!Ohmbrewer::Sim::readVariable(name.c_str(), value)) {
+                reply("error", "no such variable " + name);
+            } else {
+                reply("ok", value.c_str());
+            }
+        } else if(cmd == "run") {
+            unsigned long ms;
+            if(!(in >> ms)) {
+                reply("error", "usage: run MS");
+            } else {
+                reply("ok", std::to_string(Ohmbrewer::Sim::runLoop(loop, ms)));
+            }
+        } else if(cmd == "events") {
+            const std::vector<Ohmbrewer::Sim::Event>& events = Ohmbrewer::Sim::events();
+            for(std::vector<Ohmbrewer::Sim::Event>::const_iterator itr = events.begin(); itr != events.end(); itr++) {
+                std::cout << "event " << itr->name.c_str() << " " << itr->data.c_str() << std::endl;
+            }
+            reply("ok", std::to_string(events.size()));
+            Ohmbrewer::Sim::clearEvents();
+        } else if(cmd == "connect") {
+            int connected;
+            if(!(in >> connected)) {
+                reply("error", "usage: connect 0|1");
+            } else {
+                Ohmbrewer::Sim::setConnected(connected != 0);
+                reply("ok");
+            }
+        } else if(cmd == "touch") {
+            int16_t x, y, z;
+            if(!(in >> x >> y >> z)) {
+                reply("error", "usage: touch X Y Z");
+            } else {
+                Ohmbrewer::Sim::setTouch(x, y, z);
+                reply("ok");
+            }
+        } else if(cmd == "release") {
+            Ohmbrewer::Sim::releaseTouch();
+            reply("ok");
+        } else if(cmd == "screen") {
+            std::string path;
+            if(!(in >> path)) {
+                reply("error", "usage: screen FILE");
+            } else if(!Ohmbrewer::Sim::dumpFramebuffer(path.c_str())) {
+                reply("error", "couldn't write " + path);
+            } else {
+                reply("ok");
+            }
+        } else if(cmd == "time") {
+            reply("ok", std::to_string(millis()));
+        } else if(cmd == "now") {
+            reply("ok", std::to_string((long)Time.now()));
+        } else {
+            reply("error", "unknown command " + cmd);
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    for(int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if(arg == "--probe" && i + 1 < argc) {
+            Ohmbrewer::Sim::addProbe(atof(argv[++i]));
+        } else if(arg == "--echo") {
+            Ohmbrewer::Sim::setEcho(true);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--probe TEMP]... [--echo]" << std::endl;
+            return 1;
+        }
+    }
+
+    setup();
+    reply("ok", "ready");
+
+    std::string line;
+    while(std::getline(std::cin, line)) {
+        if(!runCommand(line)) {
+            break;
+        }
+    }
+
+    return 0;
+}
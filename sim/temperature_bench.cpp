@@ -0,0 +1,223 @@
+/**
+ * Micro-benchmark for the temperature handling on the Rhizome's control path. Replays a stream of DS18B20 readings
+ * through the fixed point path the firmware uses (OnewireBus::decodeReading(), Temperature::raw() comparisons and
+ * hysteresis) and through the double arithmetic it replaced, and reports the time per reading for each.
+ *
+ *   rhizome_temperature_bench [PASSES]
+ *
+ * Each pass over a reading does what a Thermostat or RIMS does with it between the bus and the PID library: decode,
+ * store, pick the tunings by the gap to the target, decide whether the element is on, feed the target reached
+ * hysteresis, and make the RIMS pump and safety comparisons. Both paths have to come to the same decisions.
+ *
+ * This runs on the host, which has an FPU. The Photon's Cortex-M3 doesn't, so every double operation in the old path
+ * is a software routine there, and the gap on the device is wider than the one reported here.
+ *
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "Ohmbrewer_Temperature.h"
+#include "Ohmbrewer_Onewire_Bus.h"
+
+namespace {
+
+    /**
+     * A reading as DS18X20_read_meas() hands it over
+     */
+    struct Scratchpad {
+        uint8_t subzero;
+        uint8_t cel;
+        uint8_t celFracBits;
+    };
+
+    /**
+     * The decisions a pass comes to, folded together so the paths can be compared and nothing is optimized away
+     */
+    struct Decisions {
+        unsigned long aggressive;
+        unsigned long elementOff;
+        unsigned long reached;
+        unsigned long pumpOn;
+        unsigned long heatAllowed;
+
+        bool operator==(const Decisions &other) const {
+            return aggressive == other.aggressive && elementOff == other.elementOff && reached == other.reached &&
+                   pumpOn == other.pumpOn && heatAllowed == other.heatAllowed;
+        }
+    };
+
+    /**
+     * Temperature as it was, holding a double. Kept out of line like the real one, which lives in its own
+     * translation unit, so neither path gets inlined into the loop where the other can't.
+     */
+    class LegacyTemperature {
+        public:
+            __attribute__((noinline)) void fromC(const double temp) { _temp = temp; }
+            __attribute__((noinline)) double c() const { return _temp; }
+        protected:
+            double _temp;
+    };
+
+    const double TARGET_C = 66.0;
+    const double SAFETY_C = 85.0;
+    const unsigned int READINGS = 4096;
+
+    /**
+     * A mash heating from 20 C through the target and hovering around it, with a little probe noise
+     */
+    std::vector<Scratchpad> makeReadings() {
+        std::vector<Scratchpad> readings;
+        uint32_t seed = 12345;
+
+        for(unsigned int i = 0; i < READINGS; i++) {
+            seed = seed * 1103515245 + 12345;
+            int noise = (int)((seed >> 16) % 5) - 2;
+            int raw = (i < READINGS / 2) ? (20 * 16) + (int)(i * (50 * 16) / (READINGS / 2))
+                                         : (66 * 16) + (int)((i % 64) - 32);
+            raw += noise;
+
+            Scratchpad pad;
+            pad.subzero = raw < 0 ? 1 : 0;
+            pad.cel = (uint8_t)(std::abs(raw) >> 4);
+            pad.celFracBits = (uint8_t)(std::abs(raw) & 0x0F);
+            readings.push_back(pad);
+        }
+
+        return readings;
+    }
+
+    /**
+     * The control path as it was, in doubles
+     */
+    Decisions runDouble(const std::vector<Scratchpad> &readings, unsigned long passes) {
+        Decisions result = Decisions();
+        LegacyTemperature reading;
+        volatile double target = TARGET_C;
+        volatile double safety = SAFETY_C;
+        double hysteresis = 0.5;
+        bool level = false;
+
+        for(unsigned long pass = 0; pass < passes; pass++) {
+            for(unsigned int i = 0; i < readings.size(); i++) {
+                const Scratchpad &pad = readings[i];
+
+                int frac = pad.celFracBits * 625;
+                double tempC = (double) pad.cel;
+                tempC = tempC + (.0001 * (double) frac);
+                if (pad.subzero) {
+                    tempC = tempC * -1;
+                }
+                reading.fromC(tempC);
+                tempC = reading.c();
+
+                // The tube runs up to a few degrees over the tun
+                double tube = tempC + (i % 8) * 0.5;
+                double gap = std::fabs(target - tempC);
+
+                result.aggressive += (gap < 10) ? 1 : 0;
+                result.elementOff += (gap == 0 || target <= tempC) ? 1 : 0;
+                if (tempC >= target) {
+                    level = true;
+                } else if (tempC < target - hysteresis) {
+                    level = false;
+                }
+                result.reached += level ? 1 : 0;
+                result.pumpOn += (tube > tempC + 3) ? 1 : 0;
+                result.heatAllowed += (safety > tube) ? 1 : 0;
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * The control path as the firmware runs it now, in fixed point
+     */
+    Decisions runFixed(const std::vector<Scratchpad> &readings, unsigned long passes) {
+        Decisions result = Decisions();
+        Ohmbrewer::Temperature reading;
+        volatile int32_t target = Ohmbrewer::Temperature::toRaw(TARGET_C);
+        volatile int32_t safety = Ohmbrewer::Temperature::toRaw(SAFETY_C);
+        const int32_t hysteresis = Ohmbrewer::Temperature::ONE_DEGREE / 2;
+        const int32_t aggressiveGap = 10 * Ohmbrewer::Temperature::ONE_DEGREE;
+        const int32_t pumpMargin = 3 * Ohmbrewer::Temperature::ONE_DEGREE;
+        bool level = false;
+
+        for(unsigned long pass = 0; pass < passes; pass++) {
+            for(unsigned int i = 0; i < readings.size(); i++) {
+                const Scratchpad &pad = readings[i];
+
+                reading.fromRaw(Ohmbrewer::OnewireBus::decodeReading(pad.subzero, pad.cel, pad.celFracBits));
+                int32_t current = reading.raw();
+
+                // The tube runs up to a few degrees over the tun
+                int32_t tube = current + (int32_t)(i % 8) * (Ohmbrewer::Temperature::ONE_DEGREE / 2);
+                int32_t gap = std::abs(target - current);
+
+                result.aggressive += (gap < aggressiveGap) ? 1 : 0;
+                result.elementOff += (gap == 0 || target <= current) ? 1 : 0;
+                if (current >= target) {
+                    level = true;
+                } else if (current < target - hysteresis) {
+                    level = false;
+                }
+                result.reached += level ? 1 : 0;
+                result.pumpOn += (tube > current + pumpMargin) ? 1 : 0;
+                result.heatAllowed += (safety > tube) ? 1 : 0;
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * Runs a path, returning the time per reading in nanoseconds
+     */
+    template<typename Path>
+    double timePath(Path path, const std::vector<Scratchpad> &readings, unsigned long passes, Decisions &decisions) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        decisions = path(readings, passes);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return (secs * 1e9) / ((double)passes * readings.size());
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned long passes = 5000;
+
+    if(argc > 2 || (argc == 2 && (passes = strtoul(argv[1], NULL, 10)) == 0)) {
+        fprintf(stderr, "usage: %s [PASSES]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Scratchpad> readings = makeReadings();
+    Decisions doubleDecisions;
+    Decisions fixedDecisions;
+
+    // Once through each first, so neither pays for warming the caches
+    runDouble(readings, 1);
+    runFixed(readings, 1);
+
+    double doubleNs = timePath(runDouble, readings, passes, doubleDecisions);
+    double fixedNs = timePath(runFixed, readings, passes, fixedDecisions);
+
+    printf("%lu readings through the control path\n\n", passes * readings.size());
+    printf("%-8s %12s\n", "path", "ns/reading");
+    printf("%-8s %12.2f\n", "double", doubleNs);
+    printf("%-8s %12.2f\n", "fixed", fixedNs);
+    printf("\nfixed point is %.2fx the speed of double on this host\n", doubleNs / fixedNs);
+
+    if(!(doubleDecisions == fixedDecisions)) {
+        printf("the paths disagree: aggressive %lu/%lu, element off %lu/%lu, reached %lu/%lu, pump %lu/%lu, "
+               "heat %lu/%lu\n",
+               doubleDecisions.aggressive, fixedDecisions.aggressive, doubleDecisions.elementOff,
+               fixedDecisions.elementOff, doubleDecisions.reached, fixedDecisions.reached,
+               doubleDecisions.pumpOn, fixedDecisions.pumpOn, doubleDecisions.heatAllowed,
+               fixedDecisions.heatAllowed);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,273 @@
+/**
+ * Closed-loop benchmark for the Rhizome's temperature control. Runs firmware/rhizome.ino against a simulated
+ * mash (see Ohmbrewer_Thermal_Plant.h), plays a mash schedule through the cloud API as Ohmbrewer would, and
+ * reports how well each step was held.
+ *
+ *   rhizome_thermal_bench [kettle|rims] [--trace SECONDS] [--gains POINTS] [--autotune]
+ *
+ * kettle drives a Thermostat whose element sits in the tun; rims drives a RIMS. Without either, both run, one after
+ * the other (each in a process of its own, since the firmware's globals can only be set up once). --trace prints the tun, tube and
+ * element state every SECONDS of simulated time. --gains loads a gain schedule through the "gains" function first
+ * (see GainSchedule::parsePoint()). --autotune runs the "tune" function at the first step's target before the
+ * schedule, and reports what it measured and the gains it left; the schedule then runs on those gains, starting
+ * from wherever tuning left the mash. To compare tuned gains from a cold start, pass them back in with --gains.
+ * For every step of the schedule it reports:
+ *   overshoot - how far the mash went past the target (or above it, if the step cools), in degrees C
+ *   settle    - time from the start of the step until the mash stayed within SETTLE_BAND of the target
+ *   switches  - element relay operations
+ *   energy    - watt hours delivered by the element
+ *
+ * Rhizome is part of the Ohmbrewer project (see http://ohmbrewer.org for details).
+ */
+
+#include <chrono>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Ohmbrewer_Sim.h"
+#include "Ohmbrewer_Thermal_Plant.h"
+
+// The firmware itself. Arduino-style .ino files are plain C++ once the prototypes are known.
+void setup();
+void loop();
+#include "../firmware/rhizome.ino"
+
+namespace {
+
+    /**
+     * A rest in the mash schedule
+     */
+    struct MashStep {
+        const char* name;
+        double targetC;
+        unsigned long minutes;
+    };
+
+    /**
+     * A single infusion mash with a mash out: 90 minutes in all
+     */
+    const MashStep SCHEDULE[] = {
+        { "saccharification", 66.0, 60 },
+        { "mash out",         76.0, 30 }
+    };
+    const int SCHEDULE_STEPS = sizeof(SCHEDULE) / sizeof(SCHEDULE[0]);
+
+    /**
+     * Counts as settled once the mash stays this close to the target, degrees C
+     */
+    const double SETTLE_BAND = 0.5;
+
+    /**
+     * How often the mash temperature is sampled, in simulated milliseconds
+     */
+    const unsigned long SAMPLE_MS = 1000;
+
+    /**
+     * What RIMS safety cut-off the bench uses, degrees C
+     */
+    const double RIMS_SAFETY_C = 85.0;
+
+    /**
+     * Formats a probe's ROM code the way the add function takes it, so the bench doesn't depend on bus order
+     */
+    String romString(int handle) {
+        uint8_t rom[8];
+        char hex[17];
+        Ohmbrewer::Sim::getProbeRom(handle, rom);
+        for(int i = 0; i < 8; i++) {
+            snprintf(hex + (2 * i), 3, "%02X", rom[i]);
+        }
+        return String(hex);
+    }
+
+    /**
+     * Calls a cloud function, bailing out if it fails
+     */
+    int call(const char* name, const String &args) {
+        int result = -1;
+        if(!Ohmbrewer::Sim::callFunction(name, args, result) || result < 0) {
+            fprintf(stderr, "%s(%s) failed: %d\n", name, args.c_str(), result);
+            exit(1);
+        }
+        return result;
+    }
+}
+
+/**
+ * Runs the mash schedule against one of the simulated mashes and prints its report
+ */
+static int runScenario(const std::string &scenario, unsigned long traceSecs, const std::string &gains, bool autotune);
+
+int main(int argc, char** argv) {
+    std::string scenario;
+    unsigned long traceSecs = 0;
+    std::string gains;
+    bool autotune = false;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if(arg == "--trace" && i + 1 < argc) {
+            traceSecs = strtoul(argv[++i], NULL, 10);
+        } else if(arg == "--gains" && i + 1 < argc) {
+            gains = argv[++i];
+        } else if(arg == "--autotune") {
+            autotune = true;
+        } else if(arg == "kettle" || arg == "rims") {
+            scenario = arg;
+        } else {
+            fprintf(stderr, "usage: %s [kettle|rims] [--trace SECONDS] [--gains POINTS] [--autotune]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(!scenario.empty()) {
+        return runScenario(scenario, traceSecs, gains, autotune);
+    }
+
+    const char* scenarios[] = { "kettle", "rims" };
+    int status = 0;
+    for(int i = 0; i < 2; i++) {
+        if(i > 0) {
+            printf("\n");
+        }
+        fflush(stdout);
+
+        pid_t child = fork();
+        if(child == 0) {
+            exit(runScenario(scenarios[i], traceSecs, gains, autotune));
+        }
+
+        int childStatus = 1;
+        if(child < 0 || waitpid(child, &childStatus, 0) < 0 || !WIFEXITED(childStatus) ||
+           WEXITSTATUS(childStatus) != 0) {
+            status = 1;
+        }
+    }
+
+    return status;
+}
+
+static int runScenario(const std::string &scenario, unsigned long traceSecs, const std::string &gains,
+                       bool autotune) {
+    bool isRIMS = (scenario == "rims");
+    Ohmbrewer::Sim::ThermalPlant::Config config = isRIMS ? Ohmbrewer::Sim::ThermalPlant::rims()
+                                                         : Ohmbrewer::Sim::ThermalPlant::kettle();
+    config.tunProbe = Ohmbrewer::Sim::addProbe(config.startC);
+    if(isRIMS) {
+        config.tubeProbe = Ohmbrewer::Sim::addProbe(config.startC);
+    }
+    Ohmbrewer::Sim::ThermalPlant plant(config);
+
+    setup();
+
+    // Wire up the equipment the same way Ohmbrewer would
+    int id;
+    if(isRIMS) {
+        id = call("add", String("rims,") + romString(config.tunProbe) + "," + String(config.heaterControlPin) +
+                         ",-1," + String(config.pumpPin) + "," + romString(config.tubeProbe));
+        ((Ohmbrewer::RIMS*)rhizome.getSprouts()->back())->setSafetyTemp(RIMS_SAFETY_C);
+    } else {
+        id = call("add", String("therm,") + romString(config.tunProbe) + "," + String(config.heaterControlPin) + ",-1");
+    }
+
+    printf("%s: %.1f kg mash, %.0f W element%s\n\n", scenario.c_str(), config.tunMassKg, config.heaterWatts,
+           isRIMS ? " in a RIMS tube" : "");
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    unsigned long totalSwitches = 0;
+    double totalEnergyWh = 0;
+    unsigned long simulatedMs = 0;
+
+    if(!gains.empty()) {
+        call("gains", String(gains.c_str()));
+    }
+
+    if(autotune) {
+        Ohmbrewer::Equipment* sprout = rhizome.getSprouts()->back();
+        Ohmbrewer::Thermostat* therm = isRIMS ? ((Ohmbrewer::RIMS*)sprout)->getTube() : (Ohmbrewer::Thermostat*)sprout;
+
+        Ohmbrewer::Sim::clearEvents();
+        call("tune", String(isRIMS ? "rims," : "therm,") + String(id) + "," + String(SCHEDULE[0].targetC, 1));
+
+        // Tuning gives up on its own if it runs too long
+        unsigned long tuneMs = 0;
+        while(therm->getAutotuner() != NULL) {
+            Ohmbrewer::Sim::runLoop(loop, SAMPLE_MS);
+            tuneMs += SAMPLE_MS;
+        }
+        simulatedMs += tuneMs;
+
+        printf("autotune at %.1f: %lu s, %lu switches, tun at %.2f\n", SCHEDULE[0].targetC, tuneMs / 1000,
+               plant.getSwitchCount(), plant.getTunTemp());
+        const std::vector<Ohmbrewer::Sim::Event> &events = Ohmbrewer::Sim::events();
+        for(std::vector<Ohmbrewer::Sim::Event>::const_iterator itr = events.begin(); itr != events.end(); itr++) {
+            if(strstr(itr->data.c_str(), "Autotune") != NULL) {
+                printf("  %s\n", itr->data.c_str());
+            }
+        }
+    }
+
+    if(!gains.empty() || autotune) {
+        String table;
+        Ohmbrewer::GainSchedule::getInstance()->toString(table);
+        printf("gains: %s\n\n", table.c_str());
+    }
+
+    printf("%-18s %8s %10s %10s %9s %10s\n", "step", "target", "overshoot", "settle(s)", "switches", "energy(Wh)");
+
+    for(int step = 0; step < SCHEDULE_STEPS; step++) {
+        const MashStep &mashStep = SCHEDULE[step];
+        String target = String(mashStep.targetC, 1);
+
+        if(isRIMS) {
+            call("update", String("rims,") + String(id) + ",bench,ON,0,ON,--," + target + ",ON,ON");
+        } else {
+            call("update", String("therm,") + String(id) + ",bench,ON,0," + target + ",ON,ON");
+        }
+        plant.resetMeters();
+
+        bool rising = plant.getTunTemp() < mashStep.targetC;
+        double overshoot = 0;
+        unsigned long lastOutOfBand = 0;
+        unsigned long stepMs = mashStep.minutes * 60 * 1000;
+
+        for(unsigned long elapsed = 0; elapsed < stepMs; elapsed += SAMPLE_MS) {
+            Ohmbrewer::Sim::runLoop(loop, SAMPLE_MS);
+
+            double error = plant.getTunTemp() - mashStep.targetC;
+            double past = rising ? error : -error;
+            if(past > overshoot) {
+                overshoot = past;
+            }
+            if(fabs(error) > SETTLE_BAND) {
+                lastOutOfBand = elapsed + SAMPLE_MS;
+            }
+
+            if(traceSecs > 0 && ((simulatedMs + elapsed) / SAMPLE_MS) % traceSecs == 0) {
+                printf("  t=%6lus tun=%6.2f tube=%6.2f element=%s pump=%s\n",
+                       (simulatedMs + elapsed) / 1000, plant.getTunTemp(), plant.getTubeTemp(),
+                       plant.isHeaterOn() ? "ON " : "OFF", plant.isPumpOn() ? "ON " : "OFF");
+            }
+        }
+        simulatedMs += stepMs;
+
+        char settle[24];
+        if(lastOutOfBand >= stepMs) {
+            snprintf(settle, sizeof(settle), "never");
+        } else {
+            snprintf(settle, sizeof(settle), "%lu", lastOutOfBand / 1000);
+        }
+
+        printf("%-18s %8.1f %10.2f %10s %9lu %10.1f\n", mashStep.name, mashStep.targetC, overshoot, settle,
+               plant.getSwitchCount(), plant.getEnergyWh());
+        totalSwitches += plant.getSwitchCount();
+        totalEnergyWh += plant.getEnergyWh();
+    }
+
+    double wallSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    printf("%-18s %8s %10s %10s %9lu %10.1f\n", "total", "", "", "", totalSwitches, totalEnergyWh);
+    printf("\n%lu simulated minutes in %.2f s (%.0fx real time)\n", simulatedMs / 60000, wallSecs,
+           (simulatedMs / 1000.0) / wallSecs);
+
+    return 0;
+}
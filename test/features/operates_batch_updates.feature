@@ -0,0 +1,33 @@
+Feature: Rhizome applies a batch of updates all at once, or not at all
+
+  Background:
+    Given the Rhizome is configured
+    And   the Rhizome is connected
+    And   the Rhizome has Pump 1
+    And   the Rhizome has Pump 2
+    When  I send this update to the Rhizome's Pump 1:
+      | state     | off               |
+    And   I send this update to the Rhizome's Pump 2:
+      | state     | off               |
+    # Additionally, the "Fake Pump" rig must be wired up twice, with power on pins 1 and 2.
+    # To run against the simulator instead, pass sim=../build/rhizome_sim
+
+  Scenario: Rhizome rejects a whole batch when one of its updates is bad
+    When  I call the Rhizome's batch function with:
+      | pump,1,batch,ON;pump,2,batch,SIDEWAYS |
+    Then  the function returns -4
+    When  I check the Rhizome's batch variable
+    Then  the batch variable reads:
+      | 0,-5 |
+    And   Pump 1 is OFF, working on "cucumber"
+    And   Pump 2 is OFF, working on "cucumber"
+
+  Scenario: Rhizome applies every update in a good batch
+    When  I call the Rhizome's batch function with:
+      | pump,1,batch,ON;pump,2,batch,ON |
+    Then  the function returns 2
+    When  I check the Rhizome's batch variable
+    Then  the batch variable reads:
+      | 1,2 |
+    And   Pump 1 is ON, working on "batch"
+    And   Pump 2 is ON, working on "batch"
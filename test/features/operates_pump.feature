@@ -3,53 +3,31 @@ Feature: Rhizome operates a pump
   Background:
     Given the Rhizome is configured
     And   the Rhizome is connected
+    And   the Rhizome has Pump 1
+    And   the Rhizome has a telemetry webhook
     And   the Rhizome has a webhook for Pump 1
     # Additionally, the Rhizome must be physically connected to the pump equipment
-    # or the "Fake Pump" rig must be wired up.
+    # or the "Fake Pump" rig must be wired up, with its power on pin 1.
+    # To run against the simulator instead, pass sim=../build/rhizome_sim
 
   @uc_re_1
   Scenario: Rhizome operates a pump based on a message sent over the network
-    When  I send this message to the Rhizome's Pump 1 function:
+    When  I send this update to the Rhizome's Pump 1:
       | state     | on                |
       | stop time | after 60 minutes  |
-      | speed     | 1                 |
-    # Give a little time for network lag...
-    And   I wait 5 seconds
-    Then  I receive a webhook message confirming success
+    Then  telemetry reports Pump 1 is ON within 30 seconds
 
-    When  I send this message to the Rhizome's Pump 1 function:
+    When  I send this update to the Rhizome's Pump 1:
       | state    | off   |
-    # Give a little time for network lag...
-    And   I wait 5 seconds
-    Then  I receive a webhook message confirming success
-
-  @uc_re_3
-  Scenario: Rhizome varies the pump speed
-    When  I send this message to the Rhizome's Pump 1 function:
-      | state     | on                |
-      | stop time | after 30 minutes  |
-      | speed     | 2                 |
-    # Give a little time for network lag...
-    And   I wait 5 seconds
-    Then  I receive a webhook message confirming success
-
-    When  I send this message to the Rhizome's Pump 1 function:
-      | state     | on                |
-      | stop time | after 60 minutes  |
-      | speed     | 3                 |
-    # Give a little time for network lag...
-    And   I wait 5 seconds
-    Then  I receive a webhook message confirming success
+    Then  telemetry reports Pump 1 is OFF within 30 seconds
 
   @uc_re_4
   Scenario: Rhizome deactivates a pump based on a given stopping time
-    When  I send this message to the Rhizome's Pump 1 function:
+    When  I send this update to the Rhizome's Pump 1:
       | state     | on                |
       | stop time | after 15 seconds  |
-      | speed     | 3                 |
-    # Give a little time for network lag...
-    And   I wait 5 seconds
-    Then  I receive a webhook message confirming success
+    Then  telemetry reports Pump 1 is ON within 30 seconds
 
-    When I wait 10 seconds
+    When I wait 20 seconds
     Then I receive a webhook message confirming the Rhizome shutdown Pump 1 on its own
+    And  telemetry reports Pump 1 is OFF within 30 seconds
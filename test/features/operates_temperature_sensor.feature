@@ -3,12 +3,14 @@ Feature: Rhizome operates a temperature sensor
   Background:
     Given the Rhizome is configured
     And   the Rhizome is connected
-    And   the Rhizome has a webhook for Temperature Sensor 1
+    And   the Rhizome has Temperature Sensor 0 turned on
+    And   the Rhizome has a telemetry webhook
     # Additionally, the Rhizome must be physically connected to the sensor equipment
-    # or the "Fake Temperature Sensor" rig must be wired up.
+    # or the "Fake Temperature Sensor" rig must be wired up, as the only probe on the bus.
+    # To run against the simulator instead, pass sim=../build/rhizome_sim sim_probes=68.888
 
   @uc_re_5
   Scenario: Rhizome retrieves a temperature sensor reading
-    When  I wait for a webhook message from Temperature Sensor 1 for no longer than 30 seconds
-    Then  the temperature reading for Temperature Sensor 1 is within 0.5 degrees of 68.888 degrees Celsius
+    When  I wait for telemetry from Temperature Sensor 0 for no longer than 30 seconds
+    Then  the temperature reading for Temperature Sensor 0 is within 0.5 degrees of 68.888 degrees Celsius
     # Note that this doesn't do the display testing listed in the Use Case, you'll need to verify that manually.
\ No newline at end of file
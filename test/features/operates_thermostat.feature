@@ -0,0 +1,62 @@
+Feature: Rhizome runs mash programs on a thermostat and tunes it
+
+  Background:
+    Given the Rhizome is configured
+    And   the Rhizome is connected
+    And   the Rhizome has Thermostat 3 reading probe 0
+    And   the Rhizome has a webhook for Thermostat 3
+    # Additionally, the "Fake Temperature Sensor" rig must be wired up as the only probe on the bus,
+    # with a heating element (or a stand-in relay) on pin 3.
+    # To run against the simulator instead, pass sim=../build/rhizome_sim sim_probes=20
+
+  Scenario: Rhizome runs a program on its own once it's loaded
+    When  I call the Rhizome's program function with:
+      | therm,3,65,1,600,,76,1,600, |
+    Then  the function returns 3
+    And   the Rhizome publishes "Step started." for Thermostat 3 within 10 seconds
+    And   Thermostat 3 is ON, working on ""
+
+    When  I call the Rhizome's program function with:
+      | therm,3,stop |
+    Then  the function returns 3
+
+  Scenario: Rhizome rejects a program that's too long
+    When  I call the Rhizome's program function with:
+      | therm,3,60,,,,61,,,,62,,,,63,,,,64,,,,65,,,,66,,,,67,,,,68,,, |
+    Then  the function returns -5
+
+  Scenario: Rhizome keeps the gains it's given, and goes back to the defaults
+    When  I call the Rhizome's gains function with:
+      | any,0,600,10,0,hold,0,400,5,0 |
+    Then  the function returns 2
+    When  I check the Rhizome's gains variable
+    Then  the gains variable reads:
+      | any,0.00,600,10,0,hold,0.00,400,5,0 |
+
+    When  I call the Rhizome's gains function with:
+      | hold,0,400,5,0 |
+    Then  the function returns -3
+    When  I check the Rhizome's gains variable
+    Then  the gains variable reads:
+      | any,0.00,600,10,0,hold,0.00,400,5,0 |
+
+    When  I call the Rhizome's gains function with:
+      | reset |
+    Then  the function returns 2
+    When  I check the Rhizome's gains variable
+    Then  the gains variable reads:
+      | any,0.00,600,10,0,any,10.00,1000,20,0 |
+
+  Scenario: Rhizome starts and abandons tuning a thermostat
+    When  I call the Rhizome's tune function with:
+      | therm,3 |
+    Then  the function returns 3
+    And   Thermostat 3 is ON, working on ""
+
+    When  I call the Rhizome's tune function with:
+      | therm,3,stop |
+    Then  the function returns 3
+
+    When  I call the Rhizome's tune function with:
+      | therm,9 |
+    Then  the function returns -3
@@ -1,8 +1,16 @@
 require_relative '../../lib/load_config'
+require_relative '../../lib/sim_rhizome'
+require_relative '../../lib/utilities'
 require 'particlerb'
 require 'rspec/expectations'
 
 Given(/^the Rhizome is configured$/) do
+  unless ENV['sim'].nil?
+    # Run against the host-side simulator rather than real hardware
+    @rhizome = SimRhizome.new(ENV['sim'], (ENV['sim_probes'] || '').split(',').map(&:to_f))
+    next
+  end
+
   @global_settings = Hash.new if @global_settings.nil?
   @global_settings[:rig] ||= LoadConfig::from_file(ENV['rhizomes'])['development'][ENV['rig'].to_sym]
   @global_settings[:endpoint] = ENV['endpoint']
@@ -17,4 +25,23 @@ Given(/^the Rhizome is connected$/) do
   expect(info).to be_a(Hash)
   expect(info).to_not be_empty
   expect(info[:connected]).to be true
-end
\ No newline at end of file
+end
+
+And(/^the Rhizome has (Temperature Sensor|Pump) (\d+)( turned on)?$/) do |equipment, id, turned_on|
+  # The ID is the probe index of a Temperature Sensor and the power pin of a Pump
+  type = { 'Temperature Sensor' => 'temp', 'Pump' => 'pump' }[equipment]
+
+  # A real Rhizome may have it already
+  unless @rhizome.variable('index') =~ /"id": "#{id}", "type": "#{type}"/
+    expect(@rhizome.function('add', "#{type},#{id}")).to eq id.to_i
+  end
+
+  expect(@rhizome.function('update', "#{type},#{id},,ON")).to eq id.to_i unless turned_on.nil?
+end
+
+And(/^the Rhizome has Thermostat (\d+) reading probe (\d+)$/) do |therm_id, probe|
+  # The ID is the heating element's control pin. The element has no power pin.
+  unless @rhizome.variable('index') =~ /"id": "#{therm_id}", "type": "therm"/
+    expect(@rhizome.function('add', "therm,#{probe},#{therm_id},-1")).to eq therm_id.to_i
+  end
+end
@@ -8,6 +8,14 @@ Given(/^I post this message to the Rhizome's (.*) path:$/) do |spark_func, msg_t
   expect(result).to eq 1
 end
 
+When(/^I call the Rhizome's (.*) function with:$/) do |spark_func, args_table|
+  @last_result = @rhizome.function(spark_func, args_table.raw.first.first)
+end
+
+Then(/^the function returns (-?\d+)$/) do |result|
+  expect(@last_result).to eq result.to_i
+end
+
 When(/^I check the Rhizome's (.*) variable$/) do |spark_var|
   instance_variable_set "@#{spark_var}", @rhizome.variable(spark_var)
 end
@@ -17,18 +25,24 @@ Then(/^the (.*) variable reads:$/) do |spark_var, msg_table|
   expect(instance_variable_get("@#{spark_var}")).to eq msg
 end
 
-When(/^I send this message to the Rhizome's Pump (\d+) function:$/) do |pump_id, args_table|
-  # Unfortunately, order matters... we want ID,STATE,SPEED
-  # ID and STATE are required, speed is not.
-  @last_args_str = "#{pump_id},#{args_table.rows_hash['state']}"
+When(/^I send this update to the Rhizome's Pump (\d+):$/) do |pump_id, args_table|
+  # TYPE,ID,CURRENT_TASK,STATE,STOP_TIME - see the update function in README.md. A Pump takes nothing more.
+  @last_update = { id: pump_id, state: args_table.rows_hash['state'].upcase, stop_time: '' }
+  unless args_table.rows_hash['stop time'].nil?
+    @last_update[:stop_time] = get_named_time(args_table.rows_hash['stop time'], rhizome_now).to_s
+  end
 
-  @last_args_str += ",#{get_named_time(args_table.rows_hash['stop time'])}" unless args_table.rows_hash['stop time'].nil?
-
-  @last_args_str += ",#{args_table.rows_hash['speed']}" unless args_table.rows_hash['speed'].nil?
-
-  expect { @rhizome.function('pumps', @last_args_str) }.to_not raise_exception
+  args_str = "pump,#{pump_id},cucumber,#{@last_update[:state]},#{@last_update[:stop_time]}"
+  expect(@rhizome.function('update', args_str)).to eq pump_id.to_i
 end
 
 And(/^I wait (\d+) seconds$/) do |secs|
-  sleep secs.to_i
+  wait_for secs.to_i
+end
+
+Then(/^(Pump|Thermostat) (\d+) is (ON|OFF), working on "(.*)"$/) do |equipment, id, state, task|
+  type = { 'Pump' => 'pump', 'Thermostat' => 'therm' }[equipment]
+  entry = "\"id\": \"#{id}\", \"type\": \"#{type}\", \"state\": \"#{state == 'ON' ? 1 : 0}\", " \
+          "\"current task\": \"#{task}\""
+  expect(@rhizome.variable('index')).to include entry
 end
@@ -1,104 +1,110 @@
 require 'particlerb'
 require 'rspec/expectations'
-require 'httparty'
-require 'json'
+require_relative '../../lib/utilities'
 
-And(/^the Rhizome has a webhook for Pump (\d+)$/) do |pump_id|
-  if @particle_client.webhooks.any? { |wh| wh.event == "pumps/#{pump_id}" && wh.url == "#{@global_settings[:endpoint]}/pumps" }
-    @pump_webhook = @particle_client.webhooks.find { |wh| wh.event == "pumps/#{pump_id}" && wh.url == "#{@global_settings[:endpoint]}/pumps" }
+And(/^the Rhizome has a webhook for (Pump|Thermostat) (\d+)$/) do |equipment, id|
+  # The simulator's events are read straight from it instead
+  next if simulated?
+
+  type = { 'Pump' => 'pump', 'Thermostat' => 'therm' }[equipment]
+  if @particle_client.webhooks.any? { |wh| wh.event == "#{type}/#{id}" && wh.url == "#{@global_settings[:endpoint]}/#{type}s" }
+    @webhook = @particle_client.webhooks.find { |wh| wh.event == "#{type}/#{id}" && wh.url == "#{@global_settings[:endpoint]}/#{type}s" }
   else
     expect {
-      @pump_webhook = @particle_client.webhook(
+      @webhook = @particle_client.webhook(
           mydevices: true,
           deviceid: @rhizome.id,
-          event: "pumps/#{pump_id}",
-          url: "#{@global_settings[:endpoint]}/pumps",
+          event: "#{type}/#{id}",
+          url: "#{@global_settings[:endpoint]}/#{type}s",
           json: {
-              id:      '{{id}}',
-              state:   '{{state}}',
-              speed:   '{{speed}}',
-              stopTime:   '{{stopTime}}',
-              rhizome: '{{SPARK_CORE_ID}}'
+              msg:      '{{msg}}',
+              id:       '{{id}}',
+              state:    '{{state}}',
+              stopTime: '{{stopTime}}',
+              step:     '{{step}}',
+              target:   '{{target}}',
+              reason:   '{{reason}}',
+              rhizome:  '{{SPARK_CORE_ID}}'
           }).create
     }.to_not raise_exception
   end
 end
 
-Then(/^I receive a webhook message confirming success$/) do
-  k = {
-      id:       0,
-      state:    1,
-      stopTime: 2,
-      speed:    3
-  }
-  get_result = HTTParty.get("#{@global_settings[:endpoint]}/last/pumps")
-                       .parsed_response
-  webhook_result = JSON.parse(get_result,
-                              symbolize_names: true)
-
-  args = @last_args_str.split(',')
-  expect(webhook_result[:id]).to eq args[k[:id]]
-  expect(webhook_result[:state]).to eq args[k[:state]]
-  expect(webhook_result[:stopTime]).to eq args[k[:stopTime]] if args.length > 2
-  expect(webhook_result[:speed]).to eq args[k[:speed]] if args.length > 3
+Then(/^I receive a webhook message confirming the Rhizome shutdown Pump (\d+) on its own$/) do |pump_id|
+  webhook_result = last_published("pump/#{pump_id}", 'pumps')
+  expect(webhook_result).to_not be_nil
 
+  expect(webhook_result[:msg]).to eq 'Stop time reached.'
+  expect(webhook_result[:id]).to eq pump_id
+  expect(webhook_result[:state]).to match /#{'off'}/i
+  expect(webhook_result[:stopTime]).to eq @last_update[:stop_time]
 end
 
+Then(/^telemetry reports Pump (\d+) is (ON|OFF) within (\d+) seconds$/) do |pump_id, state, wait_time|
+  start_time = rhizome_now
 
-Then(/^I receive a webhook message confirming the Rhizome shutdown Pump (\d+) on its own$/) do |pump_id|
-  get_result = HTTParty.get("#{@global_settings[:endpoint]}/last/pumps")
-                       .parsed_response
-  webhook_result = JSON.parse(get_result,
-                              symbolize_names: true)
+  # Telemetry goes out every 15 seconds, so the latest frame may be from before the change
+  loop do
+    pump = latest_telemetry.reverse.find { |sprout| sprout[:type] == 'pump' && sprout[:id] == pump_id.to_i }
+    break if !pump.nil? && pump[:state] == state
 
-  stop_time_arg = @last_args_str.split(',')[2]
-  expect(webhook_result[:id]).to eq pump_id
-  expect(webhook_result[:state]).to match /#{'off'}/i
-  expect(webhook_result[:stopTime]).to eq stop_time_arg
-  # We're assuming that the shutoff method doesn't wipe the stopTime value as shutting off manually does.
+    expect(rhizome_now - start_time).to be <= wait_time.to_i
+    wait_for 5
+  end
 end
 
-And(/^the Rhizome has a webhook for Temperature Sensor (\d+)$/) do |temp_id|
-  if @particle_client.webhooks.any? { |wh| wh.event == "temps/#{temp_id}" && wh.url == "#{@global_settings[:endpoint]}/temps" }
-    @pump_webhook = @particle_client.webhooks.find { |wh| wh.event == "temps/#{temp_id}" && wh.url == "#{@global_settings[:endpoint]}/temps" }
+And(/^the Rhizome has a telemetry webhook$/) do
+  # The simulator's telemetry is read straight from it instead
+  next if simulated?
+
+  if @particle_client.webhooks.any? { |wh| wh.event == 'telemetry' && wh.url == "#{@global_settings[:endpoint]}/telemetry" }
+    @telemetry_webhook = @particle_client.webhooks.find { |wh| wh.event == 'telemetry' && wh.url == "#{@global_settings[:endpoint]}/telemetry" }
   else
     expect {
-      @pump_webhook = @particle_client.webhook(
+      @telemetry_webhook = @particle_client.webhook(
           mydevices: true,
           deviceid: @rhizome.id,
-          event: "temps/#{temp_id}",
-          url: "#{@global_settings[:endpoint]}/temps",
+          event: 'telemetry',
+          url: "#{@global_settings[:endpoint]}/telemetry",
           json: {
-              id:           '{{id}}',
-              current_temp: '{{current_temp}}',
-              rhizome:      '{{SPARK_CORE_ID}}'
+              frame:   '{{SPARK_EVENT_VALUE}}',
+              rhizome: '{{SPARK_CORE_ID}}'
           }).create
     }.to_not raise_exception
   end
 end
 
-When(/^I wait for a webhook message from Temperature Sensor (\d+) for no longer than (\d+) seconds$/) do |temp_id, wait_time|
-  start_time = Time.now
-
-  get_result = HTTParty.get("#{@global_settings[:endpoint]}/last/temps")
-                       .parsed_response
-  webhook_result = JSON.parse(get_result,
-                              symbolize_names: true)
-
-  # If we haven't gotten a reading yet, try again every 5 seconds until we pass the wait time
-  while webhook_result[:current_temp].nil? do
-    expect(Time.now.sec - start_time.sec).to be <= wait_time.to_i
-    sleep 5
-    get_result = HTTParty.get("#{@global_settings[:endpoint]}/last/temps")
-                         .parsed_response
-    webhook_result = JSON.parse(get_result,
-                                symbolize_names: true)
+When(/^I wait for telemetry from Temperature Sensor (\d+) for no longer than (\d+) seconds$/) do |temp_id, wait_time|
+  start_time = rhizome_now
+  sensor = nil
+
+  # If the last frame doesn't have a reading for the sensor yet, try again every 5 seconds until we pass the wait time
+  loop do
+    sensor = latest_telemetry.reverse.find do |sprout|
+      sprout[:type] == 'temp' && sprout[:id] == temp_id.to_i
+    end
+    break unless sensor.nil? || sensor[:temperature].nil?
+
+    expect(rhizome_now - start_time).to be <= wait_time.to_i
+    wait_for 5
   end
 
   @last_temp_reading = Array.new
-  @last_temp_reading[temp_id.to_i] = webhook_result[:current_temp].to_f
+  @last_temp_reading[temp_id.to_i] = sensor[:temperature]
 end
 
 Then(/^the temperature reading for Temperature Sensor (\d+) is within (.*) degrees of (.*) degrees Celsius/) do |temp_id, range, expected_temp|
   expect(@last_temp_reading[temp_id.to_i]).to be_within(range.to_f).of(expected_temp.to_f)
 end
+
+Then(/^the Rhizome publishes "(.*)" for Thermostat (\d+) within (\d+) seconds$/) do |msg, therm_id, wait_time|
+  start_time = rhizome_now
+
+  loop do
+    webhook_result = last_published("therm/#{therm_id}", 'therms')
+    break if !webhook_result.nil? && webhook_result[:msg] == msg
+
+    expect(rhizome_now - start_time).to be <= wait_time.to_i
+    wait_for 1
+  end
+end
@@ -0,0 +1,91 @@
+require 'open3'
+
+# Stands in for a Particle::Device when running the features against the host-side simulator (sim/rhizome_sim)
+# instead of a real Rhizome. Set the sim environment variable to the path of the rhizome_sim executable to use it.
+class SimRhizome
+
+  # @param [String] executable Path to the rhizome_sim executable
+  # @param [Array<Float>] probes Temperatures (in Celsius) of the DS18B20 probes to attach before setup() runs
+  def initialize(executable, probes = [])
+    args = probes.map { |temp| ['--probe', temp.to_s] }.flatten
+    @stdin, @stdout, @wait_thr = Open3.popen2(executable, *args)
+    @events = []
+    expect_ok
+  end
+
+  def id
+    'simulated'
+  end
+
+  # Mirrors Particle::Device#attributes, as far as the features need it
+  def attributes
+    { id: id, name: 'rhizome_sim', connected: true }
+  end
+
+  # Calls a Particle.function
+  # @return [Integer] The function's return value
+  def function(name, args = '')
+    command("call #{name} #{args}").to_i
+  end
+
+  # Reads a Particle.variable
+  # @return [String] The variable's value
+  def variable(name)
+    command("var #{name}")
+  end
+
+  # Runs the firmware for some amount of simulated time
+  # @param [Integer] secs Seconds of simulated time
+  def wait(secs)
+    command("run #{secs.to_i * 1000}")
+  end
+
+  # The Rhizome's clock, which only moves with simulated time
+  # @return [Time] The simulated time
+  def now
+    Time.at(command('now').to_i)
+  end
+
+  # Events published since the simulator started, oldest first
+  # @param [String] name Only return events with this name, if given
+  # @return [Array<Hash>] Each event's :name and :data
+  def events(name = nil)
+    command('events')
+    name.nil? ? @events : @events.select { |event| event[:name] == name }
+  end
+
+  # Sends a raw command to the simulator (see sim/rhizome_sim.cpp for the list)
+  # @return [String] Whatever followed "ok" in the reply
+  def command(line)
+    @stdin.puts line
+    @stdin.flush
+    expect_ok
+  end
+
+  def close
+    command('quit')
+    @stdin.close
+    @stdout.close
+    @wait_thr.join
+  end
+
+  private
+
+  def expect_ok
+    loop do
+      reply = @stdout.gets
+      raise IOError, 'rhizome_sim exited unexpectedly' if reply.nil?
+
+      reply.chomp!
+      if reply.start_with?('event ')
+        name, data = reply.sub('event ', '').split(' ', 2)
+        @events << { name: name, data: data }
+      elsif reply == 'ok' || reply.start_with?('ok ')
+        return reply.sub(/\Aok ?/, '')
+      else
+        raise ArgumentError, "rhizome_sim: #{reply}"
+      end
+    end
+  end
+
+end
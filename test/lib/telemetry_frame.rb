@@ -0,0 +1,79 @@
+require 'base64'
+
+# Decodes the compact telemetry frames the Rhizome publishes to its "telemetry" event stream.
+# See lib/Ohmbrewer_Telemetry.h for the layout; keep the two in step.
+module TelemetryFrame
+
+  extend self
+
+  FRAME_VERSION = 1
+  HEADER_SIZE = 7
+  RECORD_SIZE = 7
+
+  TYPES = { 0 => 'unknown', 1 => 'temp', 2 => 'pump', 3 => 'heat', 4 => 'therm', 5 => 'rims' }
+
+  FLAG_ON = 0x01
+  FLAG_SAFETY = 0x02
+
+  NO_TEMPERATURE = -32_768
+  AGE_UNKNOWN = 0xFFFF
+
+  # Decodes a single frame
+  # @param [String] data The event's data, as published
+  # @return [Hash] The frame's :sequence and :time (a Time), and its :sprouts - one Hash per Sprout with its
+  #   :id, :type, :state ('ON' or 'OFF'), :temperature (Celsius, nil if none) and :last_read_time (a Time, nil if
+  #   unknown). A RIMS also gets :safety_temperature and :safety_last_read_time.
+  def decode(data)
+    bytes = Base64.strict_decode64(data)
+    raise ArgumentError, 'Telemetry frame is too short' if bytes.bytesize < HEADER_SIZE
+
+    version, sequence, time, count = bytes.unpack('CCVC')
+    raise ArgumentError, "Unknown telemetry frame version #{version}" unless version == FRAME_VERSION
+    if bytes.bytesize != HEADER_SIZE + (count * RECORD_SIZE)
+      raise ArgumentError, "Telemetry frame should hold #{count} records but is #{bytes.bytesize} bytes long"
+    end
+
+    frame_time = Time.at(time)
+    sprouts = []
+    count.times do |i|
+      id, type, flags, temperature, age = bytes.byteslice(HEADER_SIZE + (i * RECORD_SIZE), RECORD_SIZE).unpack('cCCs<v')
+      reading = temperature == NO_TEMPERATURE ? nil : temperature / 100.0
+      read_time = age == AGE_UNKNOWN ? nil : frame_time - age
+
+      if flags & FLAG_SAFETY != 0
+        # The safety sensor's reading belongs to the RIMS record just before it
+        sprouts.last[:safety_temperature] = reading
+        sprouts.last[:safety_last_read_time] = read_time
+        next
+      end
+
+      sprouts << { id: id,
+                   type: TYPES.fetch(type, 'unknown'),
+                   state: flags & FLAG_ON != 0 ? 'ON' : 'OFF',
+                   temperature: reading,
+                   last_read_time: read_time }
+    end
+
+    { sequence: sequence, time: frame_time, sprouts: sprouts }
+  end
+
+  # Decodes several frames, which may have been split from one period's update, into one list of Sprouts
+  # @param [Array<String>] frames The events' data, as published
+  # @return [Array<Hash>] The Sprouts, as from decode
+  def decode_all(frames)
+    frames.map { |data| decode(data)[:sprouts] }.flatten
+  end
+
+end
+
+# Decodes frames given as arguments, or one per line on stdin
+if __FILE__ == $PROGRAM_NAME
+  frames = ARGV.empty? ? STDIN.read.split : ARGV
+  frames.each do |data|
+    frame = TelemetryFrame.decode(data)
+    puts "frame #{frame[:sequence]} at #{frame[:time].utc}"
+    frame[:sprouts].each do |sprout|
+      puts "  #{sprout.map { |key, value| "#{key}=#{value}" }.join(' ')}"
+    end
+  end
+end
@@ -1,7 +1,13 @@
+require 'json'
+require 'httparty'
+require_relative 'telemetry_frame'
+require_relative 'sim_rhizome'
+
 # Returns a named expression of time as seconds after the epoch
 # @param [String] time_expression An expression of a duration, such as "after 30 seconds" or "right now"
+# @param [Time] now What time it is now, by the Rhizome's clock
 # @return [Integer] Seconds after the epoch represented by the given expression
-def get_named_time(time_expression)
+def get_named_time(time_expression, now = Time.now)
   time_expression.chomp!
   expr_parts = time_expression.split(' ')
   prefix = 0
@@ -11,22 +17,71 @@ def get_named_time(time_expression)
   case expr_parts.length
     when 1
       if time_expression == 'right now'
-        return Time.now.to_i
+        return now.to_i
       end
     when 3
       if expr_parts[prefix] == 'after'
         case expr_parts[unit]
           when 'seconds'
-            return (Time.now + expr_parts[amount].to_i).to_i
+            return (now + expr_parts[amount].to_i).to_i
           when 'minutes'
-            return (Time.now + (expr_parts[amount].to_i * 60)).to_i
+            return (now + (expr_parts[amount].to_i * 60)).to_i
           when 'hours'
-            return (Time.now + (expr_parts[amount].to_i * 360)).to_i
+            return (now + (expr_parts[amount].to_i * 360)).to_i
           when 'days'
-            return (Time.now + (expr_parts[amount].to_i * 360 * 24)).to_i
+            return (now + (expr_parts[amount].to_i * 360 * 24)).to_i
         end
       end
   end
 
   raise ArgumentError, "I don't know what you mean by: '#{time_expression}'..."
 end
+
+# Whether the features are running against the host-side simulator (see SimRhizome) rather than a real Rhizome
+# @return [Boolean] True if @rhizome is a SimRhizome
+def simulated?
+  @rhizome.is_a?(SimRhizome)
+end
+
+# What time it is by the Rhizome's clock. The simulator's only moves with simulated time.
+# @return [Time] The time
+def rhizome_now
+  simulated? ? @rhizome.now : Time.now
+end
+
+# Lets some time pass - real time on a real Rhizome, simulated time on the simulator
+# @param [Integer] secs Seconds to wait
+def wait_for(secs)
+  if simulated?
+    @rhizome.wait secs
+  else
+    sleep secs
+  end
+end
+
+# The data of the last event the Rhizome published to a stream. A real Rhizome's events are read back from the
+# webhook endpoint; the simulator has no webhooks, so its events are read straight from it.
+# @param [String] stream The event name, such as "pump/1"
+# @param [String] path Where the stream's webhook posts to on the endpoint, such as "pumps"
+# @return [Hash] The event's data, or nil if there hasn't been one
+def last_published(stream, path)
+  if simulated?
+    event = @rhizome.events(stream).last
+    return event.nil? ? nil : JSON.parse(event[:data], symbolize_names: true)
+  end
+
+  get_result = HTTParty.get("#{@global_settings[:endpoint]}/last/#{path}")
+                       .parsed_response
+  JSON.parse(get_result, symbolize_names: true)
+end
+
+# The Sprouts in the latest telemetry from the Rhizome (see TelemetryFrame)
+# @return [Array<Hash>] The Sprouts, as from TelemetryFrame.decode, latest last. Empty if there's been no telemetry.
+def latest_telemetry
+  if simulated?
+    return TelemetryFrame.decode_all(@rhizome.events('telemetry').map { |event| event[:data] })
+  end
+
+  webhook_result = last_published('telemetry', 'telemetry')
+  webhook_result.nil? || webhook_result[:frame].nil? ? [] : TelemetryFrame.decode(webhook_result[:frame])[:sprouts]
+end